@@ -319,6 +319,7 @@ pub fn build(b: *std.Build) void {
         "src/core/json_scan.c",
         "src/core/request_json.c",
         "src/utils/logging.c",
+        "src/utils/log_binary.c",
         "src/utils/memory.c",
         "src/utils/colors.c",
         "src/io/input.c",
@@ -332,6 +333,7 @@ pub fn build(b: *std.Build) void {
         "src/cli/commands_info.c",
         "src/cli/commands_doctor.c",
         "src/cli/commands_menu.c",
+        "src/cli/commands_log.c",
         "src/cli/opencli_contract.c",
         "src/cli/commands_opencli.c",
     };
@@ -384,6 +386,95 @@ pub fn build(b: *std.Build) void {
     }
     c_flags.append(b.allocator, b.fmt("-DAPP_HAVE_TERMINFO={d}", .{@intFromBool(have_terminfo)})) catch |err| oom(err);
 
+    // Build-time RGB -> ANSI-16 quantization table. The generator runs on the
+    // host and links the real color_math.c (without the table), so the
+    // candidate masks it emits always agree with the runtime metric.
+    const gen_color_lut = b.addExecutable(.{
+        .name = "gen-color-lut",
+        .root_module = b.createModule(.{
+            .root_source_file = null,
+            .target = b.graph.host,
+            .optimize = .ReleaseFast,
+            .link_libc = true,
+        }),
+    });
+    gen_color_lut.root_module.addCSourceFiles(.{
+        .files = &.{
+            "tools/gen_color_lut.c",
+            "src/style/color_math.c",
+        },
+        .flags = &base_flags,
+    });
+    const gen_color_lut_run = b.addRunArtifact(gen_color_lut);
+    const color_lut_dir = gen_color_lut_run.addOutputFileArg("color_lut.h").dirname();
+    c_flags.append(b.allocator, "-DAPP_HAVE_COLOR_LUT=1") catch |err| oom(err);
+
+    // Build-time compiled default CLI theme, one app_cli_styles_t per profile,
+    // bright-fold and mode. Same pattern: the generator links the real theme
+    // compiler and palette, so editing either regenerates the table.
+    const gen_cli_theme = b.addExecutable(.{
+        .name = "gen-cli-theme",
+        .root_module = b.createModule(.{
+            .root_source_file = null,
+            .target = b.graph.host,
+            .optimize = .ReleaseFast,
+            .link_libc = true,
+        }),
+    });
+    gen_cli_theme.root_module.addCSourceFiles(.{
+        .files = &.{
+            "tools/gen_cli_theme.c",
+            "src/cli/style/cli_theme.c",
+            "src/style/color_math.c",
+            "src/style/design_tokens.c",
+        },
+        .flags = &base_flags,
+    });
+    const gen_cli_theme_run = b.addRunArtifact(gen_cli_theme);
+    const cli_theme_table_dir = gen_cli_theme_run.addOutputFileArg("cli_theme_table.h").dirname();
+    c_flags.append(b.allocator, "-DAPP_HAVE_CLI_THEME_TABLE=1") catch |err| oom(err);
+
+    // Build-time Unicode display width table for src/ui/text_layout.c, derived
+    // from the vendored UCD extract (tools/unicode/ucd_width.txt). Passing the
+    // data file as a file argument makes edits to it rerun the generator.
+    const gen_unicode_width = b.addExecutable(.{
+        .name = "gen-unicode-width",
+        .root_module = b.createModule(.{
+            .root_source_file = null,
+            .target = b.graph.host,
+            .optimize = .ReleaseFast,
+            .link_libc = true,
+        }),
+    });
+    gen_unicode_width.root_module.addCSourceFiles(.{
+        .files = &.{"tools/gen_unicode_width.c"},
+        .flags = &base_flags,
+    });
+    const gen_unicode_width_run = b.addRunArtifact(gen_unicode_width);
+    gen_unicode_width_run.addFileArg(b.path("tools/unicode/ucd_width.txt"));
+    const unicode_width_dir = gen_unicode_width_run.addOutputFileArg("unicode_width_table.h").dirname();
+    c_flags.append(b.allocator, "-DAPP_HAVE_UNICODE_WIDTH_TABLE=1") catch |err| oom(err);
+
+    // Grapheme cluster break classes for the UAX #29 segmenter in
+    // text_layout.c, from tools/unicode/ucd_grapheme.txt.
+    const gen_unicode_grapheme = b.addExecutable(.{
+        .name = "gen-unicode-grapheme",
+        .root_module = b.createModule(.{
+            .root_source_file = null,
+            .target = b.graph.host,
+            .optimize = .ReleaseFast,
+            .link_libc = true,
+        }),
+    });
+    gen_unicode_grapheme.root_module.addCSourceFiles(.{
+        .files = &.{"tools/gen_unicode_grapheme.c"},
+        .flags = &base_flags,
+    });
+    const gen_unicode_grapheme_run = b.addRunArtifact(gen_unicode_grapheme);
+    gen_unicode_grapheme_run.addFileArg(b.path("tools/unicode/ucd_grapheme.txt"));
+    const grapheme_table_dir = gen_unicode_grapheme_run.addOutputFileArg("grapheme_break_table.h").dirname();
+    c_flags.append(b.allocator, "-DAPP_HAVE_GRAPHEME_TABLE=1") catch |err| oom(err);
+
     // CLI styling sources (shared tokens + cli/style renderers). The terminal
     // backend is chosen at build time: terminfo when available, else ANSI.
     const cli_style_sources = [_][]const u8{
@@ -396,10 +487,15 @@ pub fn build(b: *std.Build) void {
         "src/cli/style/cli_sgr.c",
         "src/cli/style/cli_layout.c",
         "src/cli/style/cli_help_render.c",
+        "src/cli/style/cli_help_cache.c",
         "src/cli/style/cli_error_render.c",
         "src/cli/style/cli_version_render.c",
     };
 
+    exe.root_module.addIncludePath(color_lut_dir);
+    exe.root_module.addIncludePath(cli_theme_table_dir);
+    exe.root_module.addIncludePath(unicode_width_dir);
+    exe.root_module.addIncludePath(grapheme_table_dir);
     exe.root_module.addCSourceFiles(.{
         .files = &base_sources,
         .flags = c_flags.items,
@@ -432,11 +528,17 @@ pub fn build(b: *std.Build) void {
         // TUI sources
         const tui_sources = [_][]const u8{
             "src/tui/tui.c",
+            "src/tui/tui_debug.c",
             "src/tui/tui_app.c",
+            "src/tui/tui_logview.c",
+            "src/tui/tui_logview_model.c",
             "src/tui/tui_menu.c",
             "src/tui/tui_menu_adapter.c",
+            "src/tui/tui_menu_feed.c",
             "src/tui/tui_menu_model.c",
             "src/tui/tui_progress.c",
+            "src/tui/tui_table.c",
+            "src/tui/tui_table_model.c",
         };
 
         exe.root_module.addCSourceFiles(.{
@@ -470,6 +572,12 @@ pub fn build(b: *std.Build) void {
     defer tui_menu_lib_flags.deinit(b.allocator);
     tui_menu_lib_flags.appendSlice(b.allocator, &base_flags) catch |err| oom(err);
     tui_menu_lib_flags.append(b.allocator, "-DENABLE_TUI=1") catch |err| oom(err);
+    // The menu measures and truncates labels with src/ui/text_layout.c, which
+    // needs the generated Unicode tables.
+    tui_menu_lib_flags.appendSlice(b.allocator, &.{
+        "-DAPP_HAVE_UNICODE_WIDTH_TABLE=1",
+        "-DAPP_HAVE_GRAPHEME_TABLE=1",
+    }) catch |err| oom(err);
 
     const tui_menu_lib = b.addLibrary(.{
         .name = "tui-menu",
@@ -482,19 +590,29 @@ pub fn build(b: *std.Build) void {
         }),
     });
     tui_menu_lib.root_module.addIncludePath(b.path("src"));
+    tui_menu_lib.root_module.addIncludePath(unicode_width_dir);
+    tui_menu_lib.root_module.addIncludePath(grapheme_table_dir);
     tui_menu_lib.root_module.addCSourceFiles(.{
         .files = &.{
             "src/core/error.c",
             "src/utils/logging.c",
+            "src/utils/log_binary.c",
             "src/io/terminal.c",
             // Shared design palette: tui.c seeds its truecolor entries from
             // APP_DESIGN_PALETTE, so the token definition must be linked in.
             "src/style/design_tokens.c",
+            "src/ui/text_layout.c",
             "src/tui/tui.c",
+            "src/tui/tui_debug.c",
+            "src/tui/tui_logview.c",
+            "src/tui/tui_logview_model.c",
             "src/tui/tui_menu.c",
             "src/tui/tui_menu_adapter.c",
+            "src/tui/tui_menu_feed.c",
             "src/tui/tui_menu_model.c",
             "src/tui/tui_progress.c",
+            "src/tui/tui_table.c",
+            "src/tui/tui_table_model.c",
         },
         .flags = tui_menu_lib_flags.items,
     });
@@ -505,8 +623,10 @@ pub fn build(b: *std.Build) void {
         b.addInstallFile(b.path("src/core/error.h"), "include/c23-cli-template/core/error.h"),
         b.addInstallFile(b.path("src/core/types.h"), "include/c23-cli-template/core/types.h"),
         b.addInstallFile(b.path("src/tui/tui.h"), "include/c23-cli-template/tui/tui.h"),
+        b.addInstallFile(b.path("src/tui/tui_logview.h"), "include/c23-cli-template/tui/tui_logview.h"),
         b.addInstallFile(b.path("src/tui/tui_menu.h"), "include/c23-cli-template/tui/tui_menu.h"),
         b.addInstallFile(b.path("src/tui/tui_progress.h"), "include/c23-cli-template/tui/tui_progress.h"),
+        b.addInstallFile(b.path("src/tui/tui_table.h"), "include/c23-cli-template/tui/tui_table.h"),
     };
     const tui_menu_lib_step = b.step("tui-menu-lib", "Build and install the reusable TUI menu static library");
     tui_menu_lib_step.dependOn(&install_tui_menu_lib.step);
@@ -514,6 +634,43 @@ pub fn build(b: *std.Build) void {
         tui_menu_lib_step.dependOn(&install_header.step);
     }
 
+    // Headless render benchmark: the menu and progress code from the library
+    // above, driven over a PTY with per-frame timings and byte counts (JSON on
+    // stdout). Needs openpty(), so it is POSIX-only and not part of `test`;
+    // the default build still compiles it so it cannot rot.
+    if (target.result.os.tag != .windows) {
+        const bench_exe = b.addExecutable(.{
+            .name = "tui-render-bench",
+            .root_module = b.createModule(.{
+                .root_source_file = null,
+                .target = target,
+                .optimize = optimize,
+                .link_libc = true,
+            }),
+        });
+        bench_exe.root_module.addIncludePath(b.path("src"));
+        bench_exe.root_module.addIncludePath(b.path("test"));
+        bench_exe.root_module.addCSourceFiles(.{
+            .files = &.{
+                "test/tui_render_bench.c",
+                "test/terminal_vt_common.c",
+            },
+            .flags = tui_menu_lib_flags.items,
+        });
+        bench_exe.root_module.linkLibrary(tui_menu_lib);
+        linkCurses(bench_exe.root_module, target, curses_prefix, b, null);
+        if (target.result.os.tag == .linux) {
+            bench_exe.root_module.linkSystemLibrary("util", .{});
+        }
+        b.getInstallStep().dependOn(&bench_exe.step);
+        const bench_cmd = b.addRunArtifact(bench_exe);
+        if (b.args) |args| {
+            bench_cmd.addArgs(args);
+        }
+        const bench_step = b.step("bench-tui", "Benchmark TUI menu and progress rendering on a PTY (JSON)");
+        bench_step.dependOn(&bench_cmd.step);
+    }
+
     // Run command
     const run_cmd = b.addRunArtifact(exe);
     run_cmd.step.dependOn(b.getInstallStep());
@@ -565,12 +722,19 @@ pub fn build(b: *std.Build) void {
         }),
     });
     unit_exe.root_module.addIncludePath(b.path("src"));
+    unit_exe.root_module.addIncludePath(color_lut_dir);
+    unit_exe.root_module.addIncludePath(cli_theme_table_dir);
+    unit_exe.root_module.addIncludePath(unicode_width_dir);
+    unit_exe.root_module.addIncludePath(grapheme_table_dir);
     unit_exe.root_module.addCSourceFiles(.{
         .files = &.{
             "test/unit_runner.c",
             "test/unit_config_tests.c",
             "test/unit_input_tests.c",
             "test/unit_tui_menu_tests.c",
+            "test/unit_tui_table_tests.c",
+            "test/unit_tui_logview_tests.c",
+            "test/unit_logging_tests.c",
             "test/unit_cli_style_tests.c",
             "test/unit_cli_osc11_tests.c",
             "test/unit_shared_primitives_tests.c",
@@ -585,10 +749,14 @@ pub fn build(b: *std.Build) void {
             "src/io/terminal.c",
             "src/cli/option_meta.c",
             "src/tui/tui_menu_adapter.c",
+            "src/tui/tui_menu_feed.c",
             "src/tui/tui_menu_model.c",
+            "src/tui/tui_table_model.c",
+            "src/tui/tui_logview_model.c",
             "src/utils/colors.c",
             "src/utils/memory.c",
             "src/utils/logging.c",
+            "src/utils/log_binary.c",
             // CLI styling layer (ANSI backend: no ncurses link needed).
             "src/ui/text_layout.c",
             "src/style/color_math.c",
@@ -599,6 +767,7 @@ pub fn build(b: *std.Build) void {
             "src/cli/style/cli_theme.c",
             "src/cli/style/cli_sgr.c",
             "src/cli/style/cli_layout.c",
+            "src/cli/style/cli_help_cache.c",
             "src/cli/style/cli_error_render.c",
         },
         .flags = c_flags.items,
@@ -608,6 +777,38 @@ pub fn build(b: *std.Build) void {
     unit_step.dependOn(&unit_cmd.step);
     test_step.dependOn(&unit_cmd.step);
 
+    // TUI runtime tests: tui_wait_event(), tui_wake() and hangup handling
+    // against a real PTY, linked with the TUI library. POSIX only (openpty).
+    const tui_runtime_sources = [_][]const u8{
+        "test/tui_runtime_tests.c",
+    };
+    if (target.result.os.tag != .windows) {
+        const tui_runtime_exe = b.addExecutable(.{
+            .name = "tui-runtime-tests",
+            .root_module = b.createModule(.{
+                .root_source_file = null,
+                .target = target,
+                .optimize = optimize,
+                .link_libc = true,
+            }),
+        });
+        tui_runtime_exe.root_module.addIncludePath(b.path("src"));
+        tui_runtime_exe.root_module.addIncludePath(b.path("test"));
+        tui_runtime_exe.root_module.addCSourceFiles(.{
+            .files = &tui_runtime_sources,
+            .flags = tui_menu_lib_flags.items,
+        });
+        tui_runtime_exe.root_module.linkLibrary(tui_menu_lib);
+        linkCurses(tui_runtime_exe.root_module, target, curses_prefix, b, null);
+        if (target.result.os.tag == .linux) {
+            tui_runtime_exe.root_module.linkSystemLibrary("util", .{});
+        }
+        const tui_runtime_cmd = b.addRunArtifact(tui_runtime_exe);
+        const tui_runtime_step = b.step("tui-runtime-test", "Run TUI event-loop tests on a PTY");
+        tui_runtime_step.dependOn(&tui_runtime_cmd.step);
+        test_step.dependOn(&tui_runtime_cmd.step);
+    }
+
     const terminal_test_plan = resolveTerminalTestPlan(b, enable_tui, terminal_backend, target, ghostty_vt_prefix);
     if (terminal_test_plan == .fail) {
         std.log.err("{s}", .{terminal_test_plan.fail});
@@ -24,6 +24,8 @@ app_error app_cmd_menu(const app_config_t *config, int argc,
                        char *const argv[]);
 app_error app_cmd_opencli(const app_config_t *config, int argc,
                           char *const argv[]);
+app_error app_cmd_log_decode(const app_config_t *config, int argc,
+                             char *const argv[]);
 
 static const app_command_arg_t hello_args[] = {
     {.name = "name",
@@ -84,6 +86,19 @@ static const char *const opencli_examples[] = {
     APP_NAME " opencli",
 };
 
+static const app_command_arg_t log_decode_args[] = {
+    {.name = "path",
+     .required = true,
+     .arity_minimum = 1,
+     .arity_maximum = 1,
+     .description = "Binary log written with APP_LOG_BINARY (- for stdin)"},
+};
+
+static const char *const log_decode_examples[] = {
+    APP_NAME " log-decode app.log.bin",
+    APP_NAME " --json log-decode app.log.bin",
+};
+
 static const app_builtin_option_t g_app_builtin_options[] = {
     {.id = APP_BUILTIN_OPTION_HELP,
      .name = "help",
@@ -149,6 +164,15 @@ static const app_command_t g_app_commands[] = {
      .examples = opencli_examples,
      .example_count = sizeof(opencli_examples) / sizeof(opencli_examples[0]),
      .requires_terminal = false},
+    {.name = "log-decode",
+     .summary = "Render a binary log as text.",
+     .handler = app_cmd_log_decode,
+     .arguments = log_decode_args,
+     .argument_count = sizeof(log_decode_args) / sizeof(log_decode_args[0]),
+     .examples = log_decode_examples,
+     .example_count =
+         sizeof(log_decode_examples) / sizeof(log_decode_examples[0]),
+     .requires_terminal = false},
 };
 
 #define G_APP_COMMANDS_COUNT \
@@ -0,0 +1,143 @@
+/*
+ * "log-decode" command - renders a binary log written in APP_LOG_BINARY mode
+ * as the text lines synchronous logging would have printed.
+ */
+
+#include <errno.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#endif
+
+#include "../core/config.h"
+#include "../core/error.h"
+#include "../core/types.h"
+#include "../io/output.h"
+#include "../utils/log_binary.h"
+#include "../utils/logging.h"
+#include "commands.h"
+
+app_error app_cmd_log_decode(const app_config_t *config, int argc,
+                             char *const argv[]);
+
+// Local time with milliseconds, matching the synchronous log prefix.
+static void log_decode_format_time(uint64_t micros, char *buf, size_t size) {
+  const time_t seconds = (time_t)(micros / 1000000u);
+  struct tm tm_info;
+  bool have_time;
+#ifdef _WIN32
+  have_time = localtime_s(&tm_info, &seconds) == 0;
+#else
+  have_time = localtime_r(&seconds, &tm_info) != NULL;
+#endif
+  char stamp[32] = "0000-00-00 00:00:00";
+  if (have_time) {
+    strftime(stamp, sizeof(stamp), "%Y-%m-%d %H:%M:%S", &tm_info);
+  }
+  snprintf(buf, size, "%s.%03u", stamp,
+           (unsigned)((micros / 1000u) % 1000u));
+}
+
+// Exit status for a log that cannot be opened or read, from its errno.
+static app_error log_decode_open_error(int reason) {
+  switch (reason) {
+  case ENOENT:
+  case ENOTDIR:
+    return APP_ERROR_NOT_FOUND;
+  case EACCES:
+  case EPERM:
+    return APP_ERROR_PERMISSION;
+  default:
+    return APP_ERROR_IO;
+  }
+}
+
+static void log_decode_print(const app_config_t *config,
+                             const app_log_entry_t *entry) {
+  char stamp[48];
+  log_decode_format_time(entry->micros, stamp, sizeof(stamp));
+  if (!app_config_is_json_output(config)) {
+    fprintf(stdout, "[%s] [%s] %s:%d: %s\n", stamp,
+            app_log_level_name(entry->level), entry->file, entry->line,
+            entry->message);
+    return;
+  }
+
+  // One object per record (JSON lines), so a long log streams instead of
+  // being held until the end.
+  char number[24];
+  bool comma = false;
+  app_json_begin_object(stdout);
+  app_json_write_string_field(stdout, "format_version", "1.0", &comma);
+  app_json_write_string_field(stdout, "time", stamp, &comma);
+  snprintf(number, sizeof(number), "%" PRIu64, entry->micros);
+  app_json_write_raw_field(stdout, "micros", number, &comma);
+  app_json_write_string_field(stdout, "level",
+                              app_log_level_name(entry->level), &comma);
+  app_json_write_string_field(stdout, "file", entry->file, &comma);
+  snprintf(number, sizeof(number), "%d", entry->line);
+  app_json_write_raw_field(stdout, "line", number, &comma);
+  app_json_write_string_field(stdout, "message", entry->message, &comma);
+  app_json_end_object(stdout);
+  app_json_end_line(stdout);
+}
+
+app_error app_cmd_log_decode(const app_config_t *config, int argc,
+                             char *const argv[]) {
+  (void)argc;
+  // `path` is a required argument, so dispatch guarantees argv[0].
+  const char *path = argv[0];
+  const bool from_stdin = strcmp(path, "-") == 0;
+#ifdef _WIN32
+  if (from_stdin) {
+    // Text-mode stdin would turn CR LF inside records into LF.
+    (void)_setmode(_fileno(stdin), _O_BINARY);
+  }
+#endif
+  FILE *in = from_stdin ? stdin : fopen(path, "rb");
+  if (in == NULL) {
+    const int reason = errno;
+    app_output_format(config, true, "Cannot open binary log %s: %s", path,
+                      strerror(reason));
+    return log_decode_open_error(reason);
+  }
+
+  app_log_reader_t *reader = NULL;
+  app_error err = app_log_reader_open(in, &reader);
+  if (err != APP_SUCCESS && ferror(in)) {
+    // A directory opens on POSIX and only fails here, with EISDIR.
+    const int reason = errno;
+    app_output_format(config, true, "Cannot read binary log %s: %s", path,
+                      strerror(reason));
+    err = log_decode_open_error(reason);
+  } else if (err != APP_SUCCESS) {
+    app_output_format(config, true, "Not a binary log: %s", path);
+  }
+  size_t records = 0;
+  while (err == APP_SUCCESS) {
+    app_log_entry_t entry;
+    bool done = false;
+    err = app_log_reader_next(reader, &entry, &done);
+    if (err != APP_SUCCESS) {
+      fflush(stdout);
+      app_output_format(config, true,
+                        "Binary log %s is damaged after %zu records", path,
+                        records);
+    } else if (done) {
+      break;
+    } else {
+      log_decode_print(config, &entry);
+      records++;
+    }
+  }
+
+  app_log_reader_close(reader);
+  if (!from_stdin) {
+    fclose(in);
+  }
+  return err;
+}
@@ -169,6 +169,10 @@ void app_print_verbose_usage_ex(const char *program_name,
   printf("%sENVIRONMENT%s\n", bold, reset);
   printf(
       "  APP_LOG_LEVEL       Set logging level: ERROR, WARNING, INFO, DEBUG\n");
+  printf(
+      "  APP_LOG_ASYNC       Set 1 to write logs from a background thread.\n");
+  printf(
+      "  APP_LOG_BINARY      Write logs as binary records to this file.\n");
   printf("  APP_CONFIG_PATH     Override the default config file lookup.\n");
   printf("  NO_COLOR            Disable colored output when set.\n\n");
 
@@ -21,6 +21,11 @@ static const app_opencli_metadata_field_t environment_fields[] = {
     {.name = "APP_LOG_LEVEL",
      .description =
          "Set logging verbosity: ERROR, WARNING, INFO, DEBUG (default: ERROR)"},
+    {.name = "APP_LOG_ASYNC",
+     .description = "Set 1 to write logs from a background thread"},
+    {.name = "APP_LOG_BINARY",
+     .description =
+         "Write logs as binary records to this file (read with log-decode)"},
     {.name = "NO_COLOR", .description = "Disable colored output when set"},
     {.name = "APP_CLI_THEME",
      .description = "CLI theme: auto (detect), dark, or light"},
@@ -30,6 +35,8 @@ static const app_opencli_metadata_field_t environment_fields[] = {
      .description = "Set 0 to disable terminal background detection"},
     {.name = "APP_CLI_ACCENT",
      .description = "Override accent color (#rrggbb or palette index)"},
+    {.name = "APP_CLI_HELP_CACHE",
+     .description = "Set 0 to disable the rendered help cache"},
 };
 
 static const app_opencli_metadata_field_t configuration_fields[] = {
@@ -39,18 +39,21 @@ void app_cli_render_error(const app_config_t *config, FILE *err,
 
   if (!ctx.styled) {
     // Plain fallback.
-    fprintf(ctx.term.stream, "Error: %s\n", titled);
+    app_cli_write(&ctx, "Error: ");
+    app_cli_write(&ctx, titled);
+    app_cli_newline(&ctx);
     if (kind == APP_CLI_ERROR_KIND_USAGE) {
-      fprintf(ctx.term.stream, "Try %s --help for usage.\n", ctx.program_name);
+      app_cli_write(&ctx, "Try ");
+      app_cli_write(&ctx, ctx.program_name);
+      app_cli_write(&ctx, " --help for usage.");
+      app_cli_newline(&ctx);
     }
     app_cli_render_ctx_deinit(&ctx);
     return;
   }
 
   // Header block.
-  app_cli_style_begin(&ctx.term, &ctx.styles.error_header);
-  app_cli_write(&ctx, APP_CLI_ERROR_HEADER);
-  app_cli_style_end(&ctx.term);
+  app_cli_write_style(&ctx, &ctx.styles.error_header, APP_CLI_ERROR_HEADER);
 
   const size_t header_w = app_cli_text_width(APP_CLI_ERROR_HEADER);
   const size_t indent = header_w + 1;
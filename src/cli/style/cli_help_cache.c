@@ -0,0 +1,338 @@
+/*
+ * On-disk help document cache. See cli_help_cache.h.
+ */
+
+#include "cli_help_cache.h"
+
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "cli_layout.h"
+
+#ifdef __linux__
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifndef APP_GIT_COMMIT
+#define APP_GIT_COMMIT "unknown"
+#endif
+#ifndef APP_BUILD_DATE
+#define APP_BUILD_DATE "unknown"
+#endif
+
+#ifdef __linux__
+
+// Largest document replayed from disk; anything bigger is treated as corrupt.
+#define APP_CLI_HELP_CACHE_DOC_MAX (256u * 1024u)
+
+// Entry names are "<build hash>-<key hash>.txt", both 16 hex digits, so every
+// entry written by one build shares a prefix of this length.
+#define APP_CLI_HELP_CACHE_BUILD_PREFIX 17
+
+static uint64_t help_cache_hash(const char *data, size_t len) {
+  uint64_t hash = 0xcbf29ce484222325ull;
+  for (size_t i = 0; i < len; i++) {
+    hash ^= (unsigned char)data[i];
+    hash *= 0x100000001b3ull;
+  }
+  return hash;
+}
+
+// Append a formatted field to the key. Returns false once the key would be
+// truncated, which disables the cache rather than risking a collision.
+static bool help_cache_key_add(app_cli_help_cache_t *cache, size_t *len,
+                               const char *fmt, ...) {
+  va_list ap;
+  va_start(ap, fmt);
+  const int n =
+      vsnprintf(cache->key + *len, sizeof(cache->key) - *len, fmt, ap);
+  va_end(ap);
+  if (n < 0 || (size_t)n >= sizeof(cache->key) - *len) {
+    return false;
+  }
+  *len += (size_t)n;
+  return true;
+}
+
+static const char *help_cache_env(const char *name) {
+  const char *value = getenv(name);
+  return value ? value : "";
+}
+
+// Theme mode as app_cli_render_ctx_init() would resolve it, or NULL when it
+// would come from OSC 11 detection (unknowable without a terminal round-trip).
+static const char *help_cache_theme(void) {
+  const char *theme = getenv("APP_CLI_TEST_THEME");
+  if (!theme) {
+    theme = getenv("APP_CLI_THEME");
+  }
+  if (theme && (strcmp(theme, "dark") == 0 || strcmp(theme, "light") == 0)) {
+    return theme;
+  }
+  const char *osc = getenv("APP_CLI_OSC11");
+  if (osc && strcmp(osc, "0") == 0) {
+    return "dark";
+  }
+  return NULL;
+}
+
+static bool help_cache_dir(char *out, size_t out_size) {
+  const char *base = getenv("XDG_CACHE_HOME");
+  int n;
+  if (base && base[0] == '/') {
+    n = snprintf(out, out_size, "%s/%s/help", base, APP_NAME);
+  } else {
+    const char *home = getenv("HOME");
+    if (!home || !home[0]) {
+      return false;
+    }
+    n = snprintf(out, out_size, "%s/.cache/%s/help", home, APP_NAME);
+  }
+  return n > 0 && (size_t)n < out_size;
+}
+
+// Create every missing component of `dir` (owner-only, like the config dir).
+static bool help_cache_mkdirs(const char *dir) {
+  char path[APP_CLI_HELP_CACHE_PATH_MAX];
+  const int n = snprintf(path, sizeof(path), "%s", dir);
+  if (n <= 0 || (size_t)n >= sizeof(path)) {
+    return false;
+  }
+  for (char *p = path + 1; *p; p++) {
+    if (*p != '/') {
+      continue;
+    }
+    *p = '\0';
+    if (mkdir(path, 0700) != 0 && errno != EEXIST) {
+      return false;
+    }
+    *p = '/';
+  }
+  return mkdir(path, 0700) == 0 || errno == EEXIST;
+}
+
+bool app_cli_help_cache_prepare(app_cli_help_cache_t *cache,
+                                const app_config_t *config, FILE *out,
+                                const char *program_name,
+                                const app_cli_term_opts_t *opts,
+                                const char *document) {
+  if (!cache) {
+    return false;
+  }
+  *cache = (app_cli_help_cache_t){0};
+  const char *toggle = getenv("APP_CLI_HELP_CACHE");
+  if (!document || (toggle && strcmp(toggle, "0") == 0)) {
+    return false;
+  }
+
+  // Build id: app metadata alone misses rebuilds of a dirty tree, so also key
+  // on the executable file itself.
+  struct stat exe;
+  if (stat("/proc/self/exe", &exe) != 0) {
+    return false;
+  }
+
+  out = out ? out : stdout;
+  const char *program =
+      (program_name && program_name[0]) ? program_name : APP_NAME;
+  const size_t width =
+      app_cli_layout_width(app_cli_term_columns(out, opts));
+
+  size_t len = 0;
+  bool ok = help_cache_key_add(
+      cache, &len, "v1|%s|%s|%s|%s|%ju:%ju:%jd:%jd.%09ld", APP_NAME,
+      APP_VERSION, APP_GIT_COMMIT, APP_BUILD_DATE, (uintmax_t)exe.st_dev,
+      (uintmax_t)exe.st_ino, (intmax_t)exe.st_size,
+      (intmax_t)exe.st_mtim.tv_sec, (long)exe.st_mtim.tv_nsec);
+  const uint64_t build = help_cache_hash(cache->key, len);
+  ok = ok &&
+       help_cache_key_add(cache, &len, "|%s|%s|%zu", document, program, width);
+  if (!app_cli_term_style_wanted(out, config, opts)) {
+    ok = ok && help_cache_key_add(cache, &len, "|plain");
+  } else {
+    const char *theme = help_cache_theme();
+    if (!theme) {
+      return false;
+    }
+    // The profile is a function of the forced profile, or of the terminfo
+    // entry / environment heuristics behind TERM, COLORTERM and FORCE_COLOR.
+    const char *forced = app_cli_term_forced_profile(opts);
+    ok = ok && help_cache_key_add(
+                   cache, &len, "|styled|%s|%s|%s|%d|%s|%s",
+                   forced ? forced : "auto", help_cache_env("TERM"),
+                   help_cache_env("COLORTERM"), getenv("FORCE_COLOR") != NULL,
+                   theme, help_cache_env("APP_CLI_ACCENT"));
+  }
+  if (!ok) {
+    return false;
+  }
+
+  // FNV-1a over the build id and over the whole key names the entry; the
+  // full key stored in the entry's first line settles any hash collision.
+  char dir[APP_CLI_HELP_CACHE_PATH_MAX];
+  if (!help_cache_dir(dir, sizeof(dir))) {
+    return false;
+  }
+  const int n = snprintf(cache->path, sizeof(cache->path),
+                         "%s/%016llx-%016llx.txt", dir,
+                         (unsigned long long)build,
+                         (unsigned long long)help_cache_hash(cache->key, len));
+  if (n <= 0 || (size_t)n >= sizeof(cache->path)) {
+    return false;
+  }
+  cache->enabled = true;
+  return true;
+}
+
+bool app_cli_help_cache_replay(const app_cli_help_cache_t *cache, FILE *out) {
+  if (!cache || !cache->enabled) {
+    return false;
+  }
+  const int fd = open(cache->path, O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return false;
+  }
+  struct stat st;
+  const size_t key_len = strlen(cache->key);
+  if (fstat(fd, &st) != 0 || st.st_size <= (off_t)key_len ||
+      (uintmax_t)st.st_size > APP_CLI_HELP_CACHE_DOC_MAX + key_len + 1) {
+    close(fd);
+    return false;
+  }
+  const size_t size = (size_t)st.st_size;
+  char *data = malloc(size);
+  size_t got = 0;
+  while (data && got < size) {
+    const ssize_t r = read(fd, data + got, size - got);
+    if (r < 0 && errno == EINTR) {
+      continue;
+    }
+    if (r <= 0) {
+      break;
+    }
+    got += (size_t)r;
+  }
+  close(fd);
+
+  const bool hit = data && got == size &&
+                   memcmp(data, cache->key, key_len) == 0 &&
+                   data[key_len] == '\n';
+  if (hit) {
+    fwrite(data + key_len + 1, 1, size - key_len - 1, out ? out : stdout);
+  }
+  free(data);
+  return hit;
+}
+
+static bool help_cache_is_hex(const char *text, size_t len) {
+  for (size_t i = 0; i < len; i++) {
+    const char c = text[i];
+    if (!((c >= '0' && c <= '9') || (c >= 'a' && c <= 'f'))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Remove entries (and abandoned temporaries) written by other builds, so the
+// directory holds one build's documents however often the binary changes.
+// Names that do not look like cache entries are left alone.
+static void help_cache_prune(const char *dir, const char *current) {
+  DIR *handle = opendir(dir);
+  if (!handle) {
+    return;
+  }
+  const int dir_fd = dirfd(handle);
+  const struct dirent *entry;
+  while ((entry = readdir(handle)) != NULL) {
+    const char *name = entry->d_name;
+    if (strlen(name) < 16 + strlen(".txt") || !help_cache_is_hex(name, 16) ||
+        strncmp(name, current, APP_CLI_HELP_CACHE_BUILD_PREFIX) == 0) {
+      continue;
+    }
+    // "<hash>.txt" is the layout before entries carried a build prefix.
+    const char *rest = name + 16;
+    if (rest[0] == '-' && help_cache_is_hex(rest + 1, 16)) {
+      rest += 17;
+    }
+    if (strncmp(rest, ".txt", 4) == 0 && (rest[4] == '\0' || rest[4] == '.')) {
+      (void)unlinkat(dir_fd, name, 0);
+    }
+  }
+  closedir(handle);
+}
+
+void app_cli_help_cache_store(const app_cli_help_cache_t *cache,
+                              const char *data, size_t len) {
+  if (!cache || !cache->enabled || !data || len == 0 ||
+      len > APP_CLI_HELP_CACHE_DOC_MAX) {
+    return;
+  }
+  char dir[APP_CLI_HELP_CACHE_PATH_MAX];
+  if (!help_cache_dir(dir, sizeof(dir)) || !help_cache_mkdirs(dir)) {
+    return;
+  }
+  char tmp[APP_CLI_HELP_CACHE_PATH_MAX];
+  const int n = snprintf(tmp, sizeof(tmp), "%s.XXXXXX", cache->path);
+  if (n <= 0 || (size_t)n >= sizeof(tmp)) {
+    return;
+  }
+  const int fd = mkstemp(tmp);
+  if (fd < 0) {
+    return;
+  }
+  FILE *file = fdopen(fd, "wb");
+  if (!file) {
+    close(fd);
+    (void)unlink(tmp);
+    return;
+  }
+  const size_t key_len = strlen(cache->key);
+  bool ok = fwrite(cache->key, 1, key_len, file) == key_len &&
+            fputc('\n', file) != EOF && fwrite(data, 1, len, file) == len;
+  ok = fclose(file) == 0 && ok;
+  if (!ok || rename(tmp, cache->path) != 0) {
+    (void)unlink(tmp);
+    return;
+  }
+  help_cache_prune(dir, strrchr(cache->path, '/') + 1);
+}
+
+#else /* !__linux__ : no executable identity to key on, so never cache */
+
+bool app_cli_help_cache_prepare(app_cli_help_cache_t *cache,
+                                const app_config_t *config, FILE *out,
+                                const char *program_name,
+                                const app_cli_term_opts_t *opts,
+                                const char *document) {
+  (void)config;
+  (void)out;
+  (void)program_name;
+  (void)opts;
+  (void)document;
+  if (cache) {
+    *cache = (app_cli_help_cache_t){0};
+  }
+  return false;
+}
+
+bool app_cli_help_cache_replay(const app_cli_help_cache_t *cache, FILE *out) {
+  (void)cache;
+  (void)out;
+  return false;
+}
+
+void app_cli_help_cache_store(const app_cli_help_cache_t *cache,
+                              const char *data, size_t len) {
+  (void)cache;
+  (void)data;
+  (void)len;
+}
+
+#endif
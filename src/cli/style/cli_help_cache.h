@@ -0,0 +1,55 @@
+/*
+ * On-disk cache of rendered help documents.
+ *
+ * Root and command help are produced from static tables, so for one binary the
+ * bytes depend only on the program name, the layout width and the styling
+ * inputs (color profile, theme mode, accent). The cache keys a document on
+ * exactly those inputs plus a build id (app metadata and the executable's
+ * identity), all derived without probing terminfo, so a hit skips term
+ * probing, theme compilation and layout entirely.
+ *
+ * Documents live under $XDG_CACHE_HOME/<app>/help (default ~/.cache). The
+ * cache is bypassed when APP_CLI_HELP_CACHE=0, when the executable cannot be
+ * identified (it is keyed on /proc/self/exe, so only Linux caches), and when a
+ * styled document's theme would come from OSC 11 background detection, which
+ * cannot be known without querying the terminal. Storing an entry removes the
+ * ones left by other builds, so the directory only ever holds the documents of
+ * the binary that last wrote to it.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+
+#include "../../core/config.h"
+#include "cli_term.h"
+
+#define APP_CLI_HELP_CACHE_KEY_MAX 1024
+#define APP_CLI_HELP_CACHE_PATH_MAX 1024
+
+typedef struct app_cli_help_cache {
+  bool enabled;
+  char key[APP_CLI_HELP_CACHE_KEY_MAX];
+  char path[APP_CLI_HELP_CACHE_PATH_MAX];
+} app_cli_help_cache_t;
+
+// Derive the cache key and path for `document` (e.g. "root", "command:hello")
+// rendered to `out` with `opts`. Returns cache->enabled; false means the
+// caller should render normally and store/replay are no-ops.
+bool app_cli_help_cache_prepare(app_cli_help_cache_t *cache,
+                                const app_config_t *config, FILE *out,
+                                const char *program_name,
+                                const app_cli_term_opts_t *opts,
+                                const char *document);
+
+// Write the cached document to `out`. Returns false on a miss (no entry, or an
+// entry recorded under a different key), leaving `out` untouched.
+bool app_cli_help_cache_replay(const app_cli_help_cache_t *cache, FILE *out);
+
+// Record a freshly rendered document and prune entries from other builds.
+// Best effort: the entry is written to a temporary file and renamed into
+// place, and any failure is silently ignored.
+void app_cli_help_cache_store(const app_cli_help_cache_t *cache,
+                              const char *data, size_t len);
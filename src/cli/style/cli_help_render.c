@@ -12,6 +12,7 @@
 
 #include "../../core/error.h"
 #include "../option_meta.h"
+#include "cli_help_cache.h"
 #include "cli_layout.h"
 
 #define APP_HELP_MAX_ROWS 64
@@ -33,14 +34,15 @@ static void help_row_set(help_row_t *row, const char *label, const char *desc,
 }
 
 // Render an aligned two-column row: styled label, padding, wrapped description.
+// `labw` is the label's display width, measured by the caller.
 static void help_render_row(app_cli_render_ctx_t *ctx,
                             app_cli_color_token_id label_token,
-                            const help_row_t *row, size_t label_col) {
+                            const help_row_t *row, size_t labw,
+                            size_t label_col) {
   const size_t left = 2;
   app_cli_repeat(ctx, ' ', left);
   app_cli_write_token(ctx, label_token, row->label);
 
-  size_t labw = app_cli_text_width(row->label);
   size_t desc_start;
   if (labw + 1 > label_col) {
     app_cli_newline(ctx);
@@ -57,13 +59,17 @@ static void help_render_row(app_cli_render_ctx_t *ctx,
 
 static void help_render_rows(app_cli_render_ctx_t *ctx, const help_row_t *rows,
                              size_t count) {
-  size_t maxw = 0;
+  // Measure every label once; the widths serve both the column choice and
+  // each row's padding.
+  const char *labels[APP_HELP_MAX_ROWS];
+  size_t widths[APP_HELP_MAX_ROWS];
+  if (count > APP_HELP_MAX_ROWS) {
+    count = APP_HELP_MAX_ROWS;
+  }
   for (size_t i = 0; i < count; i++) {
-    size_t w = app_cli_text_width(rows[i].label);
-    if (w > maxw) {
-      maxw = w;
-    }
+    labels[i] = rows[i].label;
   }
+  size_t maxw = app_cli_text_widths(labels, count, widths);
   size_t label_col = maxw + 2;
   if (label_col < 18) {
     label_col = 18;
@@ -76,7 +82,8 @@ static void help_render_rows(app_cli_render_ctx_t *ctx, const help_row_t *rows,
     label_col = cap;
   }
   for (size_t i = 0; i < count; i++) {
-    help_render_row(ctx, APP_CLI_COLOR_TOKEN_FLAG, &rows[i], label_col);
+    help_render_row(ctx, APP_CLI_COLOR_TOKEN_FLAG, &rows[i], widths[i],
+                    label_col);
   }
 }
 
@@ -159,7 +166,8 @@ static void help_render_commands(app_cli_render_ctx_t *ctx) {
   app_cli_section_title(ctx, "COMMANDS");
   for (size_t i = 0; i < n; i++) {
     // command name column uses the Command token.
-    help_render_row(ctx, APP_CLI_COLOR_TOKEN_COMMAND, &rows[i], 18);
+    help_render_row(ctx, APP_CLI_COLOR_TOKEN_COMMAND, &rows[i],
+                    app_cli_text_width(rows[i].label), 18);
   }
   app_cli_newline(ctx);
 }
@@ -223,12 +231,15 @@ static void help_render_verbose(app_cli_render_ctx_t *ctx) {
   app_cli_section_title(ctx, "ENVIRONMENT");
   static const char *const env_lines[] = {
       "  APP_LOG_LEVEL       Logging level: ERROR, WARNING, INFO, DEBUG.",
+      "  APP_LOG_ASYNC       Set 1 to write logs from a background thread.",
+      "  APP_LOG_BINARY      Write logs as binary records to this file.",
       "  APP_CONFIG_PATH     Override the default config file lookup.",
       "  NO_COLOR            Disable colored output when set.",
       "  APP_CLI_THEME       CLI theme: auto (detect), dark, or light.",
       "  APP_CLI_COLOR       Color profile: auto, never, 16, 256, truecolor.",
       "  APP_CLI_OSC11       Set 0 to disable terminal background detection.",
       "  APP_CLI_ACCENT      Override accent (#rrggbb or palette idx).",
+      "  APP_CLI_HELP_CACHE  Set 0 to disable the rendered help cache.",
   };
   help_render_plain_block(ctx, env_lines,
                           sizeof(env_lines) / sizeof(env_lines[0]));
@@ -265,14 +276,33 @@ static void help_render_verbose(app_cli_render_ctx_t *ctx) {
     snprintf(code, sizeof(code), "%d", (int)errors[i].code);
     help_row_t row;
     help_row_set(&row, code, errors[i].description, NULL);
-    help_render_row(ctx, APP_CLI_COLOR_TOKEN_FLAG_DEFAULT, &row, 6);
+    help_render_row(ctx, APP_CLI_COLOR_TOKEN_FLAG_DEFAULT, &row,
+                    app_cli_text_width(row.label), 6);
   }
 }
 
+// Close the document, record it in the help cache (unless an allocation
+// failure already spilled part of it to the stream), then flush it.
+static void help_render_finish(app_cli_render_ctx_t *ctx,
+                               const app_cli_help_cache_t *cache) {
+  app_cli_sgr_reset(&ctx->term, &ctx->sgr);
+  if (ctx->term.out == &ctx->out) {
+    app_cli_help_cache_store(cache, ctx->out.data, ctx->out.len);
+  }
+  app_cli_render_ctx_deinit(ctx);
+}
+
 void app_cli_render_root_help(const app_config_t *config, FILE *out,
                               const char *program_name, bool verbose) {
-  app_cli_render_ctx_t ctx;
   app_cli_term_opts_t opts = {.is_error = !verbose};
+  app_cli_help_cache_t cache;
+  if (app_cli_help_cache_prepare(&cache, config, out, program_name, &opts,
+                                 verbose ? "root-verbose" : "root") &&
+      app_cli_help_cache_replay(&cache, out)) {
+    return;
+  }
+
+  app_cli_render_ctx_t ctx;
   app_cli_render_ctx_init(&ctx, config, out, program_name, &opts);
 
   if (verbose) {
@@ -281,7 +311,7 @@ void app_cli_render_root_help(const app_config_t *config, FILE *out,
     help_render_concise(&ctx);
   }
 
-  app_cli_render_ctx_deinit(&ctx);
+  help_render_finish(&ctx, &cache);
 }
 
 void app_cli_render_command_help(const app_config_t *config, FILE *out,
@@ -292,6 +322,15 @@ void app_cli_render_command_help(const app_config_t *config, FILE *out,
     return;
   }
 
+  char document[128];
+  snprintf(document, sizeof(document), "command:%s", command->name);
+  app_cli_help_cache_t cache;
+  if (app_cli_help_cache_prepare(&cache, config, out, program_name, NULL,
+                                 document) &&
+      app_cli_help_cache_replay(&cache, out)) {
+    return;
+  }
+
   app_cli_render_ctx_t ctx;
   app_cli_render_ctx_init(&ctx, config, out, program_name, NULL);
 
@@ -361,5 +400,5 @@ void app_cli_render_command_help(const app_config_t *config, FILE *out,
     }
   }
 
-  app_cli_render_ctx_deinit(&ctx);
+  help_render_finish(&ctx, &cache);
 }
@@ -50,31 +50,37 @@ bool app_cli_render_ctx_init(app_cli_render_ctx_t *ctx,
 
   app_cli_term_opts_t local = opts ? *opts : (app_cli_term_opts_t){0};
   ctx->styled = app_cli_term_init(&ctx->term, stream, config, &local);
+  ctx->term.out = &ctx->out;
 
-  size_t width = ctx->term.width ? ctx->term.width : 80;
+  ctx->width = app_cli_layout_width(ctx->term.width);
+
+  if (ctx->styled) {
+    app_cli_styles_compile_default(&ctx->styles,
+                                   app_cli_resolve_mode(&ctx->term, config),
+                                   ctx->term.profile, ctx->term.color_count);
+  }
+  return ctx->styled;
+}
+
+size_t app_cli_layout_width(size_t columns) {
+  size_t width = columns ? columns : 80;
   if (width < APP_CLI_WIDTH_MIN) {
     width = APP_CLI_WIDTH_MIN;
   }
   if (width > APP_CLI_WIDTH_MAX) {
     width = APP_CLI_WIDTH_MAX;
   }
-  ctx->width = width;
-
-  if (ctx->styled) {
-    app_cli_color_scheme_t scheme = *app_cli_theme_default_scheme();
-    app_cli_theme_apply_env_overrides(&scheme);
-    app_cli_styles_compile(&ctx->styles, &scheme,
-                           app_cli_resolve_mode(&ctx->term, config),
-                           ctx->term.profile, ctx->term.color_count);
-  }
-  return ctx->styled;
+  return width;
 }
 
 void app_cli_render_ctx_deinit(app_cli_render_ctx_t *ctx) {
   if (!ctx) {
     return;
   }
+  app_cli_sgr_reset(&ctx->term, &ctx->sgr);
+  app_cli_term_flush(&ctx->term);
   app_cli_term_deinit(&ctx->term);
+  app_cli_out_buf_free(&ctx->out);
   *ctx = (app_cli_render_ctx_t){0};
 }
 
@@ -88,15 +94,43 @@ size_t app_cli_text_width_n(const char *s, size_t n) {
   return width > 0 ? (size_t)width : 0;
 }
 
+size_t app_cli_text_widths(const char *const *texts, size_t count,
+                           size_t *out_widths) {
+  size_t widest = 0;
+  for (size_t i = 0; i < count; i++) {
+    const size_t width = app_cli_text_width(texts[i]);
+    if (out_widths) {
+      out_widths[i] = width;
+    }
+    if (width > widest) {
+      widest = width;
+    }
+  }
+  return widest;
+}
+
+static bool app_cli_is_blank(const char *s, size_t n) {
+  for (size_t i = 0; i < n; i++) {
+    if (s[i] != ' ') {
+      return false;
+    }
+  }
+  return true;
+}
+
 void app_cli_write_n(app_cli_render_ctx_t *ctx, const char *s, size_t n) {
-  if (ctx) {
-    app_cli_term_write(&ctx->term, s, n);
+  if (!ctx || !s || n == 0) {
+    return;
+  }
+  if (!app_cli_sgr_blank_safe(&ctx->sgr) || !app_cli_is_blank(s, n)) {
+    app_cli_sgr_reset(&ctx->term, &ctx->sgr);
   }
+  app_cli_term_write(&ctx->term, s, n);
 }
 
 void app_cli_write(app_cli_render_ctx_t *ctx, const char *s) {
   if (ctx && s) {
-    app_cli_term_puts(&ctx->term, s);
+    app_cli_write_n(ctx, s, strlen(s));
   }
 }
 
@@ -114,12 +148,21 @@ void app_cli_repeat(app_cli_render_ctx_t *ctx, char ch, size_t count) {
   }
 }
 
+void app_cli_write_style(app_cli_render_ctx_t *ctx,
+                         const app_cli_style_t *style, const char *text) {
+  if (!ctx || !text || !text[0]) {
+    return;
+  }
+  app_cli_sgr_transition(&ctx->term, &ctx->sgr, style);
+  app_cli_term_puts(&ctx->term, text);
+}
+
 void app_cli_write_token(app_cli_render_ctx_t *ctx,
                          app_cli_color_token_id token, const char *text) {
   if (!ctx || !text) {
     return;
   }
-  app_cli_write_styled(&ctx->term, app_cli_style(&ctx->styles, token), text);
+  app_cli_write_style(ctx, app_cli_style(&ctx->styles, token), text);
 }
 
 void app_cli_section_title(app_cli_render_ctx_t *ctx, const char *title) {
@@ -142,7 +185,6 @@ void app_cli_wrap_from(app_cli_render_ctx_t *ctx, const app_cli_style_t *style,
   size_t width = ctx->width;
   size_t col = start_col;
   bool first_on_line = true;
-  bool style_open = false;  // a style run is open on the current line
 
   const char *word = text;
   while (*word) {
@@ -157,30 +199,21 @@ void app_cli_wrap_from(app_cli_render_ctx_t *ctx, const app_cli_style_t *style,
     size_t wcols = app_cli_text_width_n(word, (size_t)(end - word));
 
     if (!first_on_line && col + 1 + wcols > width) {
-      if (style_open) {
-        app_cli_style_end(&ctx->term);
-        style_open = false;
-      }
-      app_cli_newline(ctx);
+      app_cli_newline(ctx);                   // closes the open style run
       app_cli_repeat(ctx, ' ', cont_indent);  // indent stays unstyled
       col = cont_indent;
       first_on_line = true;
     }
-    if (!style_open) {
-      app_cli_style_begin(&ctx->term, style);
-      style_open = true;
-    }
+    app_cli_sgr_transition(&ctx->term, &ctx->sgr, style);
     if (!first_on_line) {
-      app_cli_write_n(ctx, " ", 1);  // interior space inherits the open style
+      // Interior space inherits the open style.
+      app_cli_term_write(&ctx->term, " ", 1);
       col += 1;
     }
-    app_cli_write_n(ctx, word, (size_t)(end - word));
+    app_cli_term_write(&ctx->term, word, (size_t)(end - word));
     col += wcols;
     first_on_line = false;
     word = end;
   }
-  if (style_open) {
-    app_cli_style_end(&ctx->term);
-  }
   app_cli_newline(ctx);
 }
@@ -1,8 +1,9 @@
 /*
- * CLI layout: a render context (terminal + compiled styles + clamped width) and
- * text-layout primitives (display width, repeats, indentation, word-wrap with
- * hanging indent, section titles). The help/error/version renderers build on
- * these.
+ * CLI layout: a render context (terminal + compiled styles + clamped width +
+ * output buffer) and text-layout primitives (display width, repeats,
+ * indentation, word-wrap with hanging indent, section titles). The
+ * help/error/version renderers build on these. Each document renders into the
+ * context's buffer and reaches the stream with one write at deinit.
  */
 
 #pragma once
@@ -25,6 +26,8 @@ typedef struct app_cli_render_ctx {
   size_t width;  // clamped to [APP_CLI_WIDTH_MIN, APP_CLI_WIDTH_MAX]
   const char *program_name;
   bool styled;
+  app_cli_sgr_state_t sgr;  // rendition the terminal is in; reset at line end
+  app_cli_out_buf_t out;    // whole document; term.out points here
 } app_cli_render_ctx_t;
 
 // Initialize a render context for `stream`. Resolves terminal capabilities,
@@ -36,24 +39,41 @@ bool app_cli_render_ctx_init(app_cli_render_ctx_t *ctx,
                              const char *program_name,
                              const app_cli_term_opts_t *opts);
 
+// Closes any open style run, flushes the buffered document, then releases the
+// terminal and the buffer.
 void app_cli_render_ctx_deinit(app_cli_render_ctx_t *ctx);
 
-// Display width of a UTF-8 string in columns. (Counts codepoints; wide-char
-// handling is a later refinement.)
+// The layout width for `columns` detected terminal columns: 80 when unknown,
+// then clamped to [APP_CLI_WIDTH_MIN, APP_CLI_WIDTH_MAX].
+size_t app_cli_layout_width(size_t columns);
+
+// Display width of a UTF-8 string in columns, measured by the shared
+// app_text_* engine (grapheme clusters, East Asian wide, zero-width marks) so
+// CLI and TUI layout always agree.
 size_t app_cli_text_width(const char *s);
 
 // Display width of the first `n` bytes of a UTF-8 string.
 size_t app_cli_text_width_n(const char *s, size_t n);
 
-// Plain writers.
+// Measures `count` strings in one pass: stores each width in `out_widths`
+// (may be NULL) and returns the widest, for aligning a column of labels.
+size_t app_cli_text_widths(const char *const *texts, size_t count,
+                           size_t *out_widths);
+
+// Plain writers. Padding made only of spaces keeps the current style run open
+// when that is invisible (see app_cli_sgr_blank_safe); any other plain text
+// returns the terminal to its default rendition first. A newline always closes
+// the open run, so each styled line ends with exactly one reset.
 void app_cli_write(app_cli_render_ctx_t *ctx, const char *s);
 void app_cli_write_n(app_cli_render_ctx_t *ctx, const char *s, size_t n);
 void app_cli_newline(app_cli_render_ctx_t *ctx);
 void app_cli_repeat(app_cli_render_ctx_t *ctx, char ch, size_t count);
 
-// Styled writers keyed by token.
+// Styled writers. Consecutive runs only emit the SGR delta between styles.
 void app_cli_write_token(app_cli_render_ctx_t *ctx,
                          app_cli_color_token_id token, const char *text);
+void app_cli_write_style(app_cli_render_ctx_t *ctx,
+                         const app_cli_style_t *style, const char *text);
 
 // Emit an uppercase section title (e.g. "USAGE") in the Title style.
 void app_cli_section_title(app_cli_render_ctx_t *ctx, const char *title);
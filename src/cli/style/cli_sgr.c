@@ -45,12 +45,85 @@ void app_cli_style_end(app_cli_term_t *term) {
   app_cli_term_emit_reset(term);
 }
 
-void app_cli_write_styled(app_cli_term_t *term, const app_cli_style_t *style,
-                          const char *text) {
-  if (!text) {
+// NONE and DEFAULT both leave the terminal's default color in place (neither is
+// emitted by app_cli_emit_color), so they compare equal.
+static bool app_cli_color_is_default(const app_cli_resolved_color_t *color) {
+  return color->kind == APP_CLI_RESOLVED_COLOR_NONE ||
+         color->kind == APP_CLI_RESOLVED_COLOR_DEFAULT;
+}
+
+static bool app_cli_color_equal(const app_cli_resolved_color_t *a,
+                                const app_cli_resolved_color_t *b) {
+  if (app_cli_color_is_default(a) || app_cli_color_is_default(b)) {
+    return app_cli_color_is_default(a) && app_cli_color_is_default(b);
+  }
+  if (a->kind != b->kind) {
+    return false;
+  }
+  if (a->kind == APP_CLI_RESOLVED_COLOR_INDEXED) {
+    return a->index == b->index;
+  }
+  return a->rgb.r == b->rgb.r && a->rgb.g == b->rgb.g && a->rgb.b == b->rgb.b;
+}
+
+static bool app_cli_style_is_plain(const app_cli_style_t *style) {
+  return style->attrs == APP_CLI_ATTR_NONE &&
+         app_cli_color_is_default(&style->fg) &&
+         app_cli_color_is_default(&style->bg);
+}
+
+void app_cli_sgr_transition(app_cli_term_t *term, app_cli_sgr_state_t *state,
+                            const app_cli_style_t *style) {
+  if (!term || !state || !term->style_enabled) {
+    return;
+  }
+  const app_cli_style_t target = style ? *style : (app_cli_style_t){0};
+
+  if (state->active) {
+    const app_cli_style_t *pen = &state->pen;
+    const bool drops_attr = (pen->attrs & ~target.attrs) != 0;
+    const bool drops_fg = !app_cli_color_is_default(&pen->fg) &&
+                          app_cli_color_is_default(&target.fg);
+    const bool drops_bg = !app_cli_color_is_default(&pen->bg) &&
+                          app_cli_color_is_default(&target.bg);
+    if (drops_attr || drops_fg || drops_bg) {
+      app_cli_sgr_reset(term, state);
+    }
+  }
+
+  if (!state->active) {
+    if (!app_cli_style_is_plain(&target)) {
+      app_cli_style_begin(term, &target);
+      state->pen = target;
+      state->active = true;
+    }
+    return;
+  }
+
+  // Only additions remain: new attributes and recolored fg/bg.
+  const app_cli_attr_mask_t added = target.attrs & ~state->pen.attrs;
+  if (added) {
+    app_cli_style_begin(term, &(app_cli_style_t){.attrs = added});
+  }
+  if (!app_cli_color_equal(&state->pen.fg, &target.fg)) {
+    app_cli_emit_color(term, false, &target.fg);
+  }
+  if (!app_cli_color_equal(&state->pen.bg, &target.bg)) {
+    app_cli_emit_color(term, true, &target.bg);
+  }
+  state->pen = target;
+}
+
+void app_cli_sgr_reset(app_cli_term_t *term, app_cli_sgr_state_t *state) {
+  if (!state || !state->active) {
     return;
   }
-  app_cli_style_begin(term, style);
-  app_cli_term_puts(term, text);
   app_cli_style_end(term);
+  *state = (app_cli_sgr_state_t){0};
+}
+
+bool app_cli_sgr_blank_safe(const app_cli_sgr_state_t *state) {
+  return !state || !state->active ||
+         (app_cli_color_is_default(&state->pen.bg) &&
+          !(state->pen.attrs & APP_CLI_ATTR_UNDERLINE));
 }
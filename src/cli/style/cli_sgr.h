@@ -1,6 +1,7 @@
 /*
- * Applies a compiled style to a terminal: emit attributes + colors, write text,
- * reset. All functions degrade to plain writes when styling is disabled.
+ * Applies a compiled style to a terminal: emit attributes + colors, move
+ * between renditions with only the delta, reset. All functions are no-ops when
+ * styling is disabled.
  */
 
 #pragma once
@@ -14,6 +15,24 @@ void app_cli_style_begin(app_cli_term_t *term, const app_cli_style_t *style);
 // Emit a full reset.
 void app_cli_style_end(app_cli_term_t *term);
 
-// begin(style) + write(text) + end(). When styling is off, just writes text.
-void app_cli_write_styled(app_cli_term_t *term, const app_cli_style_t *style,
-                          const char *text);
+// The rendition the terminal is currently in. `active` is false while the
+// terminal is at its default rendition (nothing emitted since the last reset).
+typedef struct app_cli_sgr_state {
+  app_cli_style_t pen;
+  bool active;
+} app_cli_sgr_state_t;
+
+// Move the terminal from `state` to `style` (NULL = default rendition),
+// emitting only the delta: added attributes and changed colors. SGR cannot
+// portably clear a single attribute or color, so dropping either costs one
+// reset followed by the full target style. No-op when styling is off.
+void app_cli_sgr_transition(app_cli_term_t *term, app_cli_sgr_state_t *state,
+                            const app_cli_style_t *style);
+
+// Return to the default rendition, emitting a reset only if a style is active.
+void app_cli_sgr_reset(app_cli_term_t *term, app_cli_sgr_state_t *state);
+
+// True when text made only of spaces renders identically under `state` and
+// under the default rendition (no background, no underline), so plain padding
+// can be written without closing the current run.
+bool app_cli_sgr_blank_safe(const app_cli_sgr_state_t *state);
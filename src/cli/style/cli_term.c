@@ -5,6 +5,7 @@
 
 #include "cli_term.h"
 
+#include <errno.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -106,33 +107,25 @@ static bool app_cli_hard_disabled(const app_config_t *config) {
   return false;
 }
 
-bool app_cli_term_init(app_cli_term_t *term, FILE *stream,
-                       const app_config_t *config,
-                       const app_cli_term_opts_t *opts) {
-  if (!term) {
-    return false;
-  }
-  *term = (app_cli_term_t){0};
-  term->stream = stream ? stream : stdout;
-  term->fd = app_cli_stream_fd(term->stream);
-  term->is_tty = app_cli_fd_is_tty(term->fd);
-  term->profile = APP_CLI_COLOR_PROFILE_NONE;
-
+const char *app_cli_term_forced_profile(const app_cli_term_opts_t *opts) {
   // Forced profile precedence: explicit opts (tests) > APP_CLI_TEST_PROFILE
   // (tests) > APP_CLI_COLOR (public). APP_CLI_COLOR=auto means "no force".
   const char *force_profile = opts && opts->force_profile
                                   ? opts->force_profile
                                   : getenv("APP_CLI_TEST_PROFILE");
   if (!force_profile) {
-    // "never" is handled as a hard disable above; here only 16/256/truecolor
-    // force a specific profile ("auto"/unset leaves detection to decide).
+    // "never" is a hard disable (app_cli_hard_disabled); here only
+    // 16/256/truecolor force a specific profile ("auto"/unset leaves detection to decide).
     const char *color = getenv("APP_CLI_COLOR");
     if (color && color[0] != '\0' && strcmp(color, "auto") != 0 &&
         strcmp(color, "never") != 0) {
       force_profile = color;
     }
   }
+  return force_profile;
+}
 
+size_t app_cli_term_columns(FILE *stream, const app_cli_term_opts_t *opts) {
   // Width: explicit override, then env test hooks, then live detection.
   size_t width = opts ? opts->force_width : 0;
   if (width == 0) {
@@ -148,23 +141,41 @@ bool app_cli_term_init(app_cli_term_t *term, FILE *stream,
     }
   }
   if (width == 0) {
-    width = app_cli_detect_width(term->fd);
+    width = app_cli_detect_width(app_cli_stream_fd(stream ? stream : stdout));
   }
-  term->width = width;
+  return width;
+}
 
-  bool style;
+bool app_cli_term_style_wanted(FILE *stream, const app_config_t *config,
+                               const app_cli_term_opts_t *opts) {
   if (app_cli_hard_disabled(config)) {
     // NO_COLOR / --plain / --no-color / --json / TERM=dumb always win.
-    style = false;
-  } else if (force_profile) {
+    return false;
+  }
+  const char *force_profile = app_cli_term_forced_profile(opts);
+  if (force_profile) {
     // A forced profile of "none" disables styling; any other forced profile
     // enables emission even off a TTY so golden tests can exercise it.
-    style = app_cli_parse_profile(force_profile) != APP_CLI_COLOR_PROFILE_NONE;
-  } else {
-    style = getenv("FORCE_COLOR") != NULL || app_cli_fd_is_tty(term->fd);
+    return app_cli_parse_profile(force_profile) != APP_CLI_COLOR_PROFILE_NONE;
   }
+  return getenv("FORCE_COLOR") != NULL ||
+         app_cli_fd_is_tty(app_cli_stream_fd(stream ? stream : stdout));
+}
+
+bool app_cli_term_init(app_cli_term_t *term, FILE *stream,
+                       const app_config_t *config,
+                       const app_cli_term_opts_t *opts) {
+  if (!term) {
+    return false;
+  }
+  *term = (app_cli_term_t){0};
+  term->stream = stream ? stream : stdout;
+  term->fd = app_cli_stream_fd(term->stream);
+  term->is_tty = app_cli_fd_is_tty(term->fd);
+  term->profile = APP_CLI_COLOR_PROFILE_NONE;
+  term->width = app_cli_term_columns(term->stream, opts);
 
-  if (!style) {
+  if (!app_cli_term_style_wanted(term->stream, config, opts)) {
     term->style_enabled = false;
     return false;
   }
@@ -172,6 +183,7 @@ bool app_cli_term_init(app_cli_term_t *term, FILE *stream,
   app_cli_backend_probe(term);
 
   // Resolve the color profile.
+  const char *force_profile = app_cli_term_forced_profile(opts);
   app_cli_color_profile_id profile;
   if (force_profile) {
     profile = app_cli_parse_profile(force_profile);
@@ -201,10 +213,76 @@ void app_cli_term_deinit(app_cli_term_t *term) {
   *term = (app_cli_term_t){0};
 }
 
+static bool app_cli_out_buf_append(app_cli_out_buf_t *buf, const char *s,
+                                   size_t n) {
+  if (n > buf->cap - buf->len) {
+    size_t cap = buf->cap ? buf->cap : 4096;
+    while (n > cap - buf->len) {
+      if (cap > SIZE_MAX / 2) {
+        return false;
+      }
+      cap *= 2;
+    }
+    char *data = realloc(buf->data, cap);
+    if (!data) {
+      return false;
+    }
+    buf->data = data;
+    buf->cap = cap;
+  }
+  memcpy(buf->data + buf->len, s, n);
+  buf->len += n;
+  return true;
+}
+
+void app_cli_out_buf_free(app_cli_out_buf_t *buf) {
+  if (!buf) {
+    return;
+  }
+  free(buf->data);
+  *buf = (app_cli_out_buf_t){0};
+}
+
+void app_cli_term_flush(app_cli_term_t *term) {
+  if (!term || !term->out || term->out->len == 0) {
+    return;
+  }
+  app_cli_out_buf_t *buf = term->out;
+  size_t off = 0;
+  if (term->stream) {
+    fflush(term->stream);
+#ifndef _WIN32
+    while (term->fd >= 0 && off < buf->len) {
+      const ssize_t n = write(term->fd, buf->data + off, buf->len - off);
+      if (n < 0 && errno == EINTR) {
+        continue;
+      }
+      if (n <= 0) {
+        break;
+      }
+      off += (size_t)n;
+    }
+#endif
+    if (off < buf->len) {
+      fwrite(buf->data + off, 1, buf->len - off, term->stream);
+    }
+  }
+  buf->len = 0;
+}
+
 void app_cli_term_raw(app_cli_term_t *term, const char *s, size_t n) {
   if (!term || !term->stream || !s || n == 0) {
     return;
   }
+  if (term->out) {
+    if (app_cli_out_buf_append(term->out, s, n)) {
+      return;
+    }
+    // Out of memory: emit what is queued, then detach and write through
+    // unbuffered for the rest of the document.
+    app_cli_term_flush(term);
+    term->out = nullptr;
+  }
   fwrite(s, 1, n, term->stream);
 }
 
@@ -7,7 +7,7 @@
  * SGR sequences.
  *
  * Capability detection and indexed-color emission go through ncurses *terminfo*
- * (setupterm/tigetnum/tigetstr/tparm/tputs) when the terminfo backend is
+ * (setupterm/tigetnum/tigetstr/tparm) when the terminfo backend is
  * compiled in (APP_HAVE_TERMINFO=1); otherwise a small env-based ANSI fallback
  * backend is used. Either way this code never enters curses screen mode.
  *
@@ -44,9 +44,20 @@ typedef struct app_cli_term_opts {
   size_t force_width;         // 0 = auto-detect
 } app_cli_term_opts_t;
 
+// Growable in-memory sink for a whole rendered document. While one is attached
+// to a term, every write (plain text, SGR sequences, terminfo capability
+// strings) appends here and nothing reaches the stream until
+// app_cli_term_flush().
+typedef struct app_cli_out_buf {
+  char *data;
+  size_t len;
+  size_t cap;
+} app_cli_out_buf_t;
+
 typedef struct app_cli_term {
   FILE *stream;
   int fd;
+  app_cli_out_buf_t *out;  // optional; NULL writes straight to `stream`
 
   bool is_tty;
   bool style_enabled;  // false => emit_* are no-ops, callers print plain
@@ -82,10 +93,29 @@ bool app_cli_term_init(app_cli_term_t *term, FILE *stream,
 
 void app_cli_term_deinit(app_cli_term_t *term);
 
+// Probe-free pieces of app_cli_term_init(), exposed so callers (the help
+// cache) can key on the same decisions without touching terminfo:
+//   forced_profile - the profile forced by opts/env, or NULL to detect;
+//   columns        - detected terminal columns (unclamped), 0 if unknown;
+//   style_wanted   - whether init would attempt styling (before probing).
+const char *app_cli_term_forced_profile(const app_cli_term_opts_t *opts);
+size_t app_cli_term_columns(FILE *stream, const app_cli_term_opts_t *opts);
+bool app_cli_term_style_wanted(FILE *stream, const app_config_t *config,
+                               const app_cli_term_opts_t *opts);
+
 // Raw passthrough writes (never styled). Safe with NULL term.
 void app_cli_term_write(app_cli_term_t *term, const char *s, size_t n);
 void app_cli_term_puts(app_cli_term_t *term, const char *s);
 
+// Write everything buffered in term->out to the stream's fd with a single
+// write(2) (looping only on short writes) and empty the buffer. Pending stdio
+// output on the stream is flushed first so ordering is preserved. Falls back
+// to fwrite for streams without an fd. No-op when nothing is buffered.
+void app_cli_term_flush(app_cli_term_t *term);
+
+// Release a buffer's storage. The struct itself is caller-owned.
+void app_cli_out_buf_free(app_cli_out_buf_t *buf);
+
 // Style emission. No-ops when !style_enabled.
 void app_cli_term_emit_attr(app_cli_term_t *term, app_cli_attr_bit attr);
 void app_cli_term_emit_indexed(app_cli_term_t *term, bool background,
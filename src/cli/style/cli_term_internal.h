@@ -29,5 +29,6 @@ void app_cli_backend_emit_indexed(app_cli_term_t *term, bool background,
 // Emit the "reset all attributes" sequence.
 void app_cli_backend_emit_reset(app_cli_term_t *term);
 
-// Raw write helper backends use so they share stdout/stderr routing.
+// Raw write helper backends use so they share stdout/stderr routing (and the
+// term's output buffer, when one is attached).
 void app_cli_term_raw(app_cli_term_t *term, const char *s, size_t n);
@@ -3,39 +3,46 @@
  * the low-level terminfo API. Compiled only when APP_HAVE_TERMINFO=1.
  *
  * Uses setupterm() (which initializes terminfo WITHOUT entering curses screen
- * mode), tigetnum/tigetstr to read capabilities, tparm to instantiate
- * parameterized strings, and tputs to emit them with correct padding. It never
- * calls initscr()/start_color()/init_pair().
+ * mode), tigetnum/tigetstr to read capabilities, and tparm to instantiate
+ * parameterized strings, which are appended to the term's output like any
+ * other write. It never calls initscr()/start_color()/init_pair().
+ *
+ * Not thread-safe: setupterm() and set_curterm() switch the process-global
+ * cur_term, and tparm() returns a static buffer. The CLI renders from one
+ * thread, so terms must not be probed or emitted to concurrently.
  */
 
 #include <curses.h>
 #include <stddef.h>
+#include <string.h>
 #include <term.h>
 
 #include "cli_term_internal.h"
 
-// tputs() emits through a callback that takes no context, so route it through a
-// per-call static. CLI rendering is single-threaded and emits one stream at a
-// time, so this is safe.
-static FILE *g_tputs_stream = nullptr;
-
-static int app_cli_tputs_putc(int ch) {
-  if (g_tputs_stream) {
-    return fputc(ch, g_tputs_stream);
-  }
-  return ch;
-}
-
+// Append a capability string to the term's output, dropping terminfo padding
+// specs ("$<5>", "$<2*/>"). tputs() would only add delays for those, and it
+// emits through a context-free putc callback that forces a process-global
+// output stream. Rendering into the term's buffer instead keeps the output
+// per-term; the delays were already meaningless once output was batched.
 static void app_cli_emit_cap(app_cli_term_t *term, const char *cap) {
   if (!term || !cap) {
     return;
   }
-  if (term->backend_term) {
-    set_curterm((TERMINAL *)term->backend_term);
+  const char *run = cap;
+  const char *p = cap;
+  while (*p) {
+    if (p[0] == '$' && p[1] == '<') {
+      const char *close = strchr(p + 2, '>');
+      if (close) {
+        app_cli_term_raw(term, run, (size_t)(p - run));
+        p = close + 1;
+        run = p;
+        continue;
+      }
+    }
+    p++;
   }
-  g_tputs_stream = term->stream;
-  tputs(cap, 1, app_cli_tputs_putc);
-  g_tputs_stream = nullptr;
+  app_cli_term_raw(term, run, (size_t)(p - run));
 }
 
 // tigetstr returns (char *)-1 for an absent/cancelled capability and (char *)0
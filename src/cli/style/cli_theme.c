@@ -13,6 +13,12 @@
 
 #include "../../style/design_tokens.h"
 
+#if APP_HAVE_CLI_THEME_TABLE
+// Generated at build time by tools/gen_cli_theme.c: the default scheme
+// compiled for every profile, bright-fold and mode combination.
+#include "cli_theme_table.h"
+#endif
+
 // RGB token with a semantic ANSI-16 fallback hint.
 #define RGBH(rr, gg, bb, hint)                  \
   ((app_cli_color_t){.kind = APP_CLI_COLOR_RGB, \
@@ -267,16 +273,18 @@ bool app_cli_color_parse(const char *spec, app_cli_color_t *out) {
   return false;
 }
 
+// The APP_CLI_ACCENT color, when set to a valid color spec.
+static bool app_cli_theme_env_accent(app_cli_color_t *out) {
+  const char *accent = getenv("APP_CLI_ACCENT");
+  return accent && accent[0] && app_cli_color_parse(accent, out);
+}
+
 void app_cli_theme_apply_env_overrides(app_cli_color_scheme_t *scheme) {
   if (!scheme) {
     return;
   }
-  const char *accent = getenv("APP_CLI_ACCENT");
-  if (!accent || !accent[0]) {
-    return;
-  }
   app_cli_color_t color;
-  if (!app_cli_color_parse(accent, &color)) {
+  if (!app_cli_theme_env_accent(&color)) {
     return;
   }
   static const app_cli_color_token_id accent_tokens[] = {
@@ -290,3 +298,29 @@ void app_cli_theme_apply_env_overrides(app_cli_color_scheme_t *scheme) {
     scheme->tokens[accent_tokens[i]].light = color;
   }
 }
+
+void app_cli_styles_compile_default(app_cli_styles_t *out,
+                                    app_cli_theme_mode_id mode,
+                                    app_cli_color_profile_id profile,
+                                    int color_count) {
+  if (!out) {
+    return;
+  }
+  app_cli_color_t accent;
+  const bool overridden = app_cli_theme_env_accent(&accent);
+#if APP_HAVE_CLI_THEME_TABLE
+  if (!overridden && profile >= APP_CLI_COLOR_PROFILE_NONE &&
+      profile <= APP_CLI_COLOR_PROFILE_TRUECOLOR &&
+      (mode == APP_CLI_THEME_MODE_DARK || mode == APP_CLI_THEME_MODE_LIGHT)) {
+    // Same bright-fold test as app_cli_color_resolve().
+    const bool folded = color_count > 0 && color_count < 16;
+    *out = APP_CLI_DEFAULT_STYLES[profile][folded][mode];
+    return;
+  }
+#endif
+  app_cli_color_scheme_t scheme = *app_cli_theme_default_scheme();
+  if (overridden) {
+    app_cli_theme_apply_env_overrides(&scheme);
+  }
+  app_cli_styles_compile(out, &scheme, mode, profile, color_count);
+}
@@ -13,7 +13,8 @@
  * TUI from a single source of truth - no hand-maintained duplicate literals.
  * The scheme degrades to ANSI-256/ANSI-16 per the detected profile (each token
  * carries a semantic ANSI-16 fallback hint), and callers may apply per-token
- * overrides.
+ * overrides. Builds also precompile the default scheme for every profile and
+ * mode (tools/gen_cli_theme.c), so only overridden themes compile at runtime.
  */
 
 #pragma once
@@ -128,6 +129,14 @@ void app_cli_styles_compile(app_cli_styles_t *out,
                             app_cli_theme_mode_id mode,
                             app_cli_color_profile_id profile, int color_count);
 
+// Compile the built-in scheme with environment overrides applied, as a styled
+// render context needs it. Without overrides this copies a table generated at
+// build time (APP_HAVE_CLI_THEME_TABLE) instead of compiling at startup.
+void app_cli_styles_compile_default(app_cli_styles_t *out,
+                                    app_cli_theme_mode_id mode,
+                                    app_cli_color_profile_id profile,
+                                    int color_count);
+
 // Accessor for a token style.
 const app_cli_style_t *app_cli_style(const app_cli_styles_t *styles,
                                      app_cli_color_token_id token);
@@ -259,11 +259,11 @@ static app_error app_run_headless_json(app_config_t *config, int64_t start_ms) {
 }
 
 int main(int argc, char *argv[]) {
-  /* Initialize the locale from the environment once at startup so multibyte
-   * (UTF-8) text layout works on both the pure-CLI and TUI paths. mbrtowc and
-   * wcwidth in src/ui/text_layout.c require this; without it the default "C"
-   * locale silently degrades to byte counting. The TUI path re-applies the
-   * same call in tui_init(), which is an idempotent no-op. */
+  /* Initialize the locale from the environment once at startup. Display width
+   * (src/ui/text_layout.c) is locale-independent, but the TUI converts labels
+   * with mbstowcs/wcrtomb and ncurses needs a UTF-8 locale for wide output;
+   * without it the default "C" locale degrades to bytes. The TUI path
+   * re-applies the same call in tui_init(), which is an idempotent no-op. */
   setlocale(LC_ALL, "");
 
   const int64_t start_ms = app_now_millis();
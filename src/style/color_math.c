@@ -4,10 +4,29 @@
 
 #include "color_math.h"
 
+#if APP_HAVE_COLOR_LUT
+// Generated at build time by tools/gen_color_lut.c: for every 5-bit-per-channel
+// cell, the mask of ANSI-16 entries that are nearest for some color in it.
+#include "color_lut.h"
+#endif
+
+static const app_rgb_t APP_COLOR_ANSI16[16] = {
+    {0x00, 0x00, 0x00}, {0x80, 0x00, 0x00}, {0x00, 0x80, 0x00},
+    {0x80, 0x80, 0x00}, {0x00, 0x00, 0x80}, {0x80, 0x00, 0x80},
+    {0x00, 0x80, 0x80}, {0xc0, 0xc0, 0xc0}, {0x80, 0x80, 0x80},
+    {0xff, 0x00, 0x00}, {0x00, 0xff, 0x00}, {0xff, 0xff, 0x00},
+    {0x00, 0x00, 0xff}, {0xff, 0x00, 0xff}, {0x00, 0xff, 0xff},
+    {0xff, 0xff, 0xff},
+};
+
+const app_rgb_t *app_color_ansi16_palette(void) {
+  return APP_COLOR_ANSI16;
+}
+
 // Weighted squared distance between two colors (Rec. 601 channel weights).
 // Weighting green most and blue least matches human sensitivity, which keeps
 // downsampled hues recognizable.
-static uint32_t app_color_dist2(app_rgb_t a, app_rgb_t b) {
+uint32_t app_color_dist2(app_rgb_t a, app_rgb_t b) {
   int dr = (int)a.r - (int)b.r;
   int dg = (int)a.g - (int)b.g;
   int db = (int)a.b - (int)b.b;
@@ -59,20 +78,17 @@ uint8_t app_color_rgb_to_xterm256(app_rgb_t rgb) {
   return gray_dist < cube_dist ? gray_index : cube_index;
 }
 
-uint8_t app_color_rgb_to_ansi16(app_rgb_t rgb) {
-  static const app_rgb_t ansi16[16] = {
-      {0x00, 0x00, 0x00}, {0x80, 0x00, 0x00}, {0x00, 0x80, 0x00},
-      {0x80, 0x80, 0x00}, {0x00, 0x00, 0x80}, {0x80, 0x00, 0x80},
-      {0x00, 0x80, 0x80}, {0xc0, 0xc0, 0xc0}, {0x80, 0x80, 0x80},
-      {0xff, 0x00, 0x00}, {0x00, 0xff, 0x00}, {0xff, 0xff, 0x00},
-      {0x00, 0x00, 0xff}, {0xff, 0x00, 0xff}, {0x00, 0xff, 0xff},
-      {0xff, 0xff, 0xff},
-  };
-
+// Nearest palette entry among `candidates` (a bitmask over APP_COLOR_ANSI16).
+// Scanning in index order with a strict comparison keeps the lowest index on
+// ties, so any candidate superset of the true winner gives the same answer.
+static uint8_t app_color_nearest_ansi16(app_rgb_t rgb, uint16_t candidates) {
   uint8_t best = 0;
   uint32_t best_dist = UINT32_MAX;
   for (uint8_t i = 0; i < 16; i++) {
-    uint32_t d = app_color_dist2(rgb, ansi16[i]);
+    if (!(candidates & (1u << i))) {
+      continue;
+    }
+    uint32_t d = app_color_dist2(rgb, APP_COLOR_ANSI16[i]);
     if (d < best_dist) {
       best = i;
       best_dist = d;
@@ -81,6 +97,36 @@ uint8_t app_color_rgb_to_ansi16(app_rgb_t rgb) {
   return best;
 }
 
+uint8_t app_color_rgb_to_ansi16(app_rgb_t rgb) {
+#if APP_HAVE_COLOR_LUT
+  const size_t cell = ((size_t)(rgb.r >> 3) << 10) |
+                      ((size_t)(rgb.g >> 3) << 5) | (size_t)(rgb.b >> 3);
+  return app_color_nearest_ansi16(rgb, APP_COLOR_ANSI16_CANDIDATES[cell]);
+#else
+  return app_color_nearest_ansi16(rgb, 0xffff);
+#endif
+}
+
+void app_color_rgb_to_xterm256_n(const app_rgb_t *in, uint8_t *out,
+                                 size_t count) {
+  if (!in || !out) {
+    return;
+  }
+  for (size_t i = 0; i < count; i++) {
+    out[i] = app_color_rgb_to_xterm256(in[i]);
+  }
+}
+
+void app_color_rgb_to_ansi16_n(const app_rgb_t *in, uint8_t *out,
+                               size_t count) {
+  if (!in || !out) {
+    return;
+  }
+  for (size_t i = 0; i < count; i++) {
+    out[i] = app_color_rgb_to_ansi16(in[i]);
+  }
+}
+
 uint8_t app_color_channel_to_u8(unsigned value, unsigned max) {
   if (max == 0) {
     return 0;
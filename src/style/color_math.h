@@ -10,6 +10,7 @@
 #pragma once
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
 typedef struct app_rgb {
@@ -38,9 +39,23 @@ bool app_color_is_light(app_rgb_t rgb);
 uint8_t app_color_rgb_to_xterm256(app_rgb_t rgb);
 
 // Nearest standard ANSI-16 index (0..15). Theme tokens should prefer their own
-// semantic hint; this is the fallback for arbitrary user-supplied RGB.
+// semantic hint; this is the fallback for arbitrary user-supplied RGB. With
+// the generated quantization table (APP_HAVE_COLOR_LUT) this is one lookup
+// plus an exact check of the few palette entries that can win in that cell.
 uint8_t app_color_rgb_to_ansi16(app_rgb_t rgb);
 
+// Batch forms for whole palettes or image rows: out[i] = convert(in[i]).
+void app_color_rgb_to_xterm256_n(const app_rgb_t *in, uint8_t *out,
+                                 size_t count);
+void app_color_rgb_to_ansi16_n(const app_rgb_t *in, uint8_t *out,
+                               size_t count);
+
+// The standard ANSI-16 palette (16 entries) and the weighted squared distance
+// used to match against it. Exposed for the quantization table generator
+// (tools/gen_color_lut.c) so the table cannot drift from the scalar metric.
+const app_rgb_t *app_color_ansi16_palette(void);
+uint32_t app_color_dist2(app_rgb_t a, app_rgb_t b);
+
 // Convert an OSC 11 channel (value/max, e.g. 0xffff/0xffff) to 8-bit.
 uint8_t app_color_channel_to_u8(unsigned value, unsigned max);
 
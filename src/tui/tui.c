@@ -16,6 +16,14 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <poll.h>
+#include <stdatomic.h>
+#include <unistd.h>
+#endif
 
 #include "../io/terminal.h"
 #include "../style/design_tokens.h"
@@ -86,15 +94,61 @@ static struct sigaction tui_previous_sigint;
 static struct sigaction tui_previous_sigterm;
 static bool tui_signal_handlers_installed = false;
 
+/* Self-pipe: signal handlers and tui_wake() write a byte to the write end so
+ * a tui_wait_event() blocked in poll() on the read end returns at once. Both
+ * ends are non-blocking; a full pipe already guarantees a wake-up. The pipe is
+ * opened by the first tui_init() and kept for the life of the process:
+ * background threads may call tui_wake() after tui_cleanup(), and closing it
+ * under them would let a late write land in whatever reuses the fd number.
+ * Only the UI thread touches the read end. */
+static int tui_wake_read_fd = -1;
+static _Atomic int tui_wake_write_fd = -1;
+
+static void tui_wake_pipe_write(void) {
+  const int fd = atomic_load_explicit(&tui_wake_write_fd, memory_order_acquire);
+  if (fd >= 0) {
+    const char byte = 0;
+    ssize_t written = write(fd, &byte, 1);
+    (void)written;
+  }
+}
+
+static void tui_wake_pipe_drain(void) {
+  char sink[64];
+  while (read(tui_wake_read_fd, sink, sizeof(sink)) > 0) {
+  }
+}
+
 static void tui_signal_handler(int signum) {
   const int saved_errno = errno;
   tui_interrupted_signal = signum;
+  tui_wake_pipe_write();
   errno = saved_errno;
 }
+
+static void tui_wake_pipe_open(void) {
+  if (tui_wake_read_fd >= 0) {
+    tui_wake_pipe_drain(); /* wake-ups aimed at an earlier session */
+    return;
+  }
+  int fds[2];
+  if (pipe(fds) != 0) {
+    /* Still correct without it: signals interrupt poll() with EINTR. */
+    LOG_WARNING("TUI wake pipe unavailable: %s", strerror(errno));
+    return;
+  }
+  for (int i = 0; i < 2; i++) {
+    (void)fcntl(fds[i], F_SETFL, fcntl(fds[i], F_GETFL) | O_NONBLOCK);
+    (void)fcntl(fds[i], F_SETFD, FD_CLOEXEC);
+  }
+  tui_wake_read_fd = fds[0];
+  atomic_store_explicit(&tui_wake_write_fd, fds[1], memory_order_release);
+}
 #endif
 
 static app_error tui_install_signal_handlers(void) {
 #ifndef _WIN32
+  tui_wake_pipe_open();
   struct sigaction sa_int = {.sa_handler = tui_signal_handler};
   sigemptyset(&sa_int.sa_mask);
   /* Clear SA_RESTART so wgetch returns ERR and the menu loop can react. */
@@ -263,6 +317,7 @@ void tui_cleanup(void) {
   }
 
   tui_discard_curses_input();
+  tui_debug_shutdown();
   clear();
   refresh();
   endwin();
@@ -284,9 +339,291 @@ bool tui_interrupted(void) {
   return tui_interrupted_signal != 0;
 }
 
+void tui_wake(void) {
+#ifndef _WIN32
+  tui_wake_pipe_write();
+#endif
+}
+
+bool tui_wake_supported(void) {
+#ifndef _WIN32
+  return tui_wake_read_fd >= 0;
+#else
+  return false;
+#endif
+}
+
+static tui_event_t tui_key_event(int ch) {
+  tui_debug_note_event();
+  return (tui_event_t){
+      .kind = ch == KEY_RESIZE ? TUI_EVENT_RESIZE : TUI_EVENT_KEY, .key = ch};
+}
+
+/* The HUD closed over the screen. Queue stdscr and the background again so
+ * the next frame flush restores them; the loop repaints its own windows. */
+static tui_event_t tui_repaint_event(void) {
+  touchwin(stdscr);
+  wnoutrefresh(stdscr);
+  tui_window_t *bg = tui_get_background_window();
+  if (bg && bg->win) {
+    touchwin(bg->win);
+    wnoutrefresh(bg->win);
+  }
+  tui_debug_note_event();
+  return (tui_event_t){.kind = TUI_EVENT_REPAINT, .key = ERR};
+}
+
+/* F12 belongs to the frame statistics overlay while it is enabled. Returns
+ * true when the key was consumed; *repaint asks the caller to redraw. */
+static bool tui_debug_key(int ch, bool *repaint) {
+  if (ch != KEY_F(12) || !tui_debug_enabled()) {
+    return false;
+  }
+  *repaint = tui_debug_toggle();
+  return true;
+}
+
+#ifndef _WIN32
+/* The terminal is gone. Latched like a signal, so every loop unwinds the
+ * way it does for SIGTERM and tui_take_interrupt_error() reports an I/O
+ * error. */
+static tui_event_t tui_hangup_event(void) {
+  tui_interrupted_signal = SIGHUP;
+  return (tui_event_t){.kind = TUI_EVENT_SIGNAL, .key = ERR};
+}
+#endif
+
+tui_event_t tui_wait_event(WINDOW *win, int timeout_ms) {
+#ifndef _WIN32
+  for (;;) {
+    if (tui_interrupted()) {
+      return (tui_event_t){.kind = TUI_EVENT_SIGNAL, .key = ERR};
+    }
+    /* Typeahead and the tail of escape sequences sit in ncurses' buffer,
+     * not on the fd, so drain that before sleeping. A pending SIGWINCH also
+     * surfaces here as KEY_RESIZE. */
+    wtimeout(win, 0);
+    const int ch = wgetch(win);
+    wtimeout(win, -1); /* leave the window blocking for other readers */
+    bool repaint = false;
+    if (tui_debug_key(ch, &repaint)) {
+      if (repaint) {
+        return tui_repaint_event();
+      }
+      continue;
+    }
+    if (ch != ERR) {
+      return tui_key_event(ch);
+    }
+    struct pollfd fds[2] = {
+        {.fd = STDIN_FILENO, .events = POLLIN},
+        {.fd = tui_wake_read_fd, .events = POLLIN},
+    };
+    const int rc = poll(fds, tui_wake_read_fd >= 0 ? 2 : 1, timeout_ms);
+    if (rc < 0) {
+      if (errno == EINTR) {
+        continue; /* signal or SIGWINCH: re-check both above */
+      }
+      LOG_ERROR("poll() on the terminal failed: %s", strerror(errno));
+      return tui_hangup_event();
+    }
+    if (rc == 0) {
+      return (tui_event_t){.kind = TUI_EVENT_TIMER, .key = ERR};
+    }
+    /* A hung-up terminal polls readable forever while wgetch() keeps
+     * returning ERR; report it once instead of spinning. */
+    if (fds[0].revents & (POLLHUP | POLLERR | POLLNVAL)) {
+      LOG_WARNING("Terminal hung up; leaving the TUI");
+      return tui_hangup_event();
+    }
+    if (fds[1].revents & POLLIN) {
+      tui_wake_pipe_drain();
+      if (!tui_interrupted()) {
+        tui_debug_note_event();
+        return (tui_event_t){.kind = TUI_EVENT_WAKE, .key = ERR};
+      }
+    }
+  }
+#else
+  wtimeout(win, timeout_ms);
+  const int ch = wgetch(win);
+  wtimeout(win, -1);
+  if (tui_interrupted()) {
+    return (tui_event_t){.kind = TUI_EVENT_SIGNAL, .key = ERR};
+  }
+  if (ch == ERR) {
+    return (tui_event_t){.kind = TUI_EVENT_TIMER, .key = ERR};
+  }
+  bool repaint = false;
+  if (tui_debug_key(ch, &repaint)) {
+    return repaint ? tui_repaint_event()
+                   : (tui_event_t){.kind = TUI_EVENT_TIMER, .key = ERR};
+  }
+  return tui_key_event(ch);
+#endif
+}
+
+uint64_t tui_clock_us(void) {
+  struct timespec ts;
+#ifdef CLOCK_MONOTONIC
+  if (clock_gettime(CLOCK_MONOTONIC, &ts) == 0) {
+    return (uint64_t)ts.tv_sec * 1000000u + (uint64_t)ts.tv_nsec / 1000u;
+  }
+#endif
+  if (timespec_get(&ts, TIME_UTC) != TIME_UTC) {
+    return 0;
+  }
+  return (uint64_t)ts.tv_sec * 1000000u + (uint64_t)ts.tv_nsec / 1000u;
+}
+
+uint64_t tui_clock_ms(void) {
+  return tui_clock_us() / 1000u;
+}
+
+/* ---- frame instrumentation ---------------------------------------------- */
+
+static tui_frame_observer_fn tui_frame_observer = NULL;
+static void *tui_frame_observer_user = NULL;
+
+void tui_set_frame_observer(tui_frame_observer_fn observer, void *user) {
+  tui_frame_observer = observer;
+  tui_frame_observer_user = user;
+}
+
+tui_frame_t tui_frame_begin(void) {
+  const uint64_t now = tui_clock_us();
+  return (tui_frame_t){.start_us = now, .layout_end_us = now};
+}
+
+void tui_frame_layout_done(tui_frame_t *frame) {
+  frame->layout_end_us = tui_clock_us();
+}
+
+void tui_frame_flush(const tui_frame_t *frame) {
+  const bool debug = tui_debug_enabled();
+  if (debug) {
+    tui_debug_compose();
+  }
+  const uint64_t render_end_us = tui_clock_us();
+  const uint64_t output_mark =
+      debug ? tui_debug_output_mark() : TUI_FRAME_OUTPUT_UNKNOWN;
+  doupdate();
+  const uint64_t update_end_us = tui_clock_us();
+  if (tui_frame_observer || debug) {
+    const tui_frame_stats_t stats = {
+        .layout_us = frame->layout_end_us - frame->start_us,
+        .render_us = render_end_us - frame->layout_end_us,
+        .update_us = update_end_us - render_end_us,
+        .output_bytes = debug ? tui_debug_output_since(output_mark)
+                              : TUI_FRAME_OUTPUT_UNKNOWN,
+    };
+    if (debug) {
+      tui_debug_record_frame(&stats);
+    }
+    if (tui_frame_observer) {
+      tui_frame_observer(&stats, tui_frame_observer_user);
+    }
+  }
+}
+
+tui_frame_loop_status_t tui_run_frame_loop(const tui_frame_loop_t *loop) {
+  void *view = loop->view;
+  const int max_fps = loop->max_fps > 0 ? loop->max_fps : 60;
+  const uint64_t frame_ms = 1000u / (unsigned)max_fps;
+  uint64_t painted_at = 0;
+  bool painted = false;
+  bool resize_pending = false;
+  for (;;) {
+    if (tui_interrupted()) {
+      return TUI_FRAME_LOOP_INTERRUPTED;
+    }
+    tui_frame_t frame = tui_frame_begin();
+    const uint64_t now = frame.start_us / 1000u;
+    const bool frame_due = !painted || now - painted_at >= frame_ms;
+    int timeout_ms = -1;
+    const bool resize = resize_pending && frame_due;
+    if (resize) {
+      resize_pending = false;
+    }
+    WINDOW *win = loop->layout(view, resize);
+    if (!win) {
+      return TUI_FRAME_LOOP_TOO_SMALL;
+    }
+    tui_frame_layout_done(&frame);
+    if (resize_pending || loop->has_damage(view)) {
+      if (frame_due) {
+        loop->paint(view, &frame);
+        painted = true;
+        painted_at = now;
+      } else {
+        timeout_ms = (int)(frame_ms - (now - painted_at));
+      }
+    }
+
+    /* Sleep until input, a signal, the next frame, or - while background
+     * work (a feed, a sort, an index) is running - a wake-up from it.
+     * Platforms without tui_wake() poll every 15 ms while work is pending. */
+    if (loop->pending(view) && !tui_wake_supported() &&
+        (timeout_ms < 0 || timeout_ms > 15)) {
+      timeout_ms = 15;
+    }
+    tui_event_t event = tui_wait_event(win, timeout_ms);
+
+    /* Then apply everything already queued behind that event before
+     * painting again: held arrow keys and pasted input cost one frame, not
+     * one frame per key, and consecutive resizes rebuild the frame once. A
+     * steady stream still paints once per frame. */
+    for (;;) {
+      if (event.kind == TUI_EVENT_SIGNAL) {
+        return TUI_FRAME_LOOP_INTERRUPTED;
+      }
+      if (event.kind == TUI_EVENT_RESIZE) {
+        resize_pending = true;
+      } else if (event.kind == TUI_EVENT_REPAINT) {
+        loop->invalidate(view);
+      } else if (event.kind == TUI_EVENT_WAKE ||
+                 event.kind == TUI_EVENT_TIMER) {
+        loop->poll(view);
+        if (event.kind == TUI_EVENT_TIMER) {
+          break; /* queue empty or frame due */
+        }
+      } else {
+        if (resize_pending) {
+          /* Keys after a resize act on the new geometry. */
+          resize_pending = false;
+          win = loop->layout(view, true);
+          if (!win) {
+            return TUI_FRAME_LOOP_TOO_SMALL;
+          }
+        }
+        const tui_frame_loop_action_t action = loop->dispatch(view, event.key);
+        if (action == TUI_FRAME_LOOP_EXIT) {
+          return TUI_FRAME_LOOP_DONE;
+        }
+        if (action == TUI_FRAME_LOOP_REFRAME) {
+          /* The dialog consumed any resize that arrived while it was up. */
+          resize_pending = true;
+          loop->poll(view);
+          break;
+        }
+      }
+      if (painted && (resize_pending || loop->has_damage(view)) &&
+          tui_clock_ms() - painted_at >= frame_ms) {
+        break;
+      }
+      event = tui_wait_event(win, 0);
+    }
+  }
+}
+
 app_error tui_take_interrupt_error(void) {
   const int signum = (int)tui_interrupted_signal;
   tui_interrupted_signal = 0;
+#ifndef _WIN32
+  if (signum == SIGHUP) {
+    return APP_ERROR_IO;
+  }
+#endif
   return signum == SIGTERM ? APP_ERROR_TERMINATED : APP_ERROR_INTERRUPTED;
 }
 
@@ -779,11 +1116,11 @@ bool tui_modal_run(int height, int width, const char *title,
   tui_refresh_window(window);
 
   while (1) {
-    if (tui_interrupted()) {
+    const tui_event_t ev = tui_wait_event(window->win, -1);
+    if (ev.kind == TUI_EVENT_SIGNAL) {
       break;
     }
-    const int ch = wgetch(window->win);
-    if (ch == KEY_RESIZE) {
+    if (ev.kind == TUI_EVENT_RESIZE) {
       tui_modal_redraw_background();
       tui_destroy_window(window);
       window = tui_modal_open(height, width, title);
@@ -794,11 +1131,15 @@ bool tui_modal_run(int height, int width, const char *title,
       tui_refresh_window(window);
       continue;
     }
-    if (ch == ERR) {
-      napms(10);
+    if (ev.kind == TUI_EVENT_REPAINT) {
+      touchwin(window->win);
+      tui_refresh_window(window);
+      continue;
+    }
+    if (ev.kind != TUI_EVENT_KEY) {
       continue;
     }
-    if (handle(window, ch, userdata) == TUI_MODAL_DONE) {
+    if (handle(window, ev.key, userdata) == TUI_MODAL_DONE) {
       break;
     }
   }
@@ -51,6 +51,8 @@ struct tui_window {
 APP_NODISCARD app_error tui_init(void);
 void tui_cleanup(void);
 bool tui_is_initialized(void);
+// True after SIGINT/SIGTERM or a terminal hangup until the error is taken:
+// APP_ERROR_INTERRUPTED, APP_ERROR_TERMINATED or APP_ERROR_IO respectively.
 bool tui_interrupted(void);
 APP_NODISCARD app_error tui_take_interrupt_error(void);
 
@@ -94,5 +96,7 @@ int tui_get_max_y(void);
 bool tui_terminal_meets_minimum(void);
 
 // Menu and progress APIs are declared in dedicated headers to keep tui.h lean.
+#include "tui_logview.h"
 #include "tui_menu.h"
 #include "tui_progress.h"
+#include "tui_table.h"
@@ -13,7 +13,9 @@
  * (message dialog, confirm, input dialog, progress bar, custom layout,
  * sub-menu). Treat them as documentation you can delete or copy from.
  */
+#include <errno.h>
 #include <stdio.h>
+#include <string.h>
 
 #include "../core/app_info.h"
 #include "../ui/action_item.h"
@@ -22,9 +24,9 @@
 #include "tui_menu_adapter.h"
 
 enum {
-  /* Tall enough to show the full main menu - now ten entries plus two
+  /* Tall enough to show the full main menu - ten entries plus two
    * separators - without scrolling at the documented 80x24 baseline. */
-  MAIN_MENU_FRAME_HEIGHT = 20,
+  MAIN_MENU_FRAME_HEIGHT = 21,
   MAIN_MENU_FRAME_WIDTH = 72,
 };
 
@@ -106,6 +108,8 @@ typedef enum {
   APP_MENU_INPUT,
   APP_MENU_PROGRESS,
   APP_MENU_LAYOUT,
+  APP_MENU_TABLE,
+  APP_MENU_LOG_VIEWER,
   APP_MENU_CONFIGURATION,
   APP_MENU_COMMANDS,
   APP_MENU_EXIT,
@@ -312,6 +316,7 @@ static void app_show_commands(void) {
  * without leaving the main showcase. */
 typedef enum {
   APP_OVERLAY_KEYS = 1,
+  APP_OVERLAY_FRAME_TIMINGS,
   APP_OVERLAY_ABOUT,
   APP_OVERLAY_EXIT,
 } app_overlay_menu_id_t;
@@ -325,9 +330,18 @@ static void app_show_keybindings(void) {
                    "/                    Incremental search\n"
                    "Enter                Select\n"
                    "Esc                  Open this menu\n"
+                   "F12                  Frame statistics overlay\n"
                    "q                    Quit");
 }
 
+/* Rolling histogram behind the F12 overlay: where recent frames spent their
+ * time (our layout and drawing, ncurses' doupdate, bytes to the terminal). */
+static void app_show_frame_timings(void) {
+  char text[1024];
+  tui_debug_format_histogram(text, sizeof(text));
+  tui_show_message("Frame Timings", text);
+}
+
 static void app_show_about(void) {
   const app_build_info_t *build = app_build_info();
   char about[384];
@@ -347,6 +361,9 @@ static bool app_show_menu_overlay(void) {
       {.label = "&Key Bindings",
        .description = "Show all keyboard shortcuts",
        .id = APP_OVERLAY_KEYS},
+      {.label = "Frame &Timings",
+       .description = "Histogram of recent frame render times",
+       .id = APP_OVERLAY_FRAME_TIMINGS},
       {.label = "&About",
        .description = "Version and template details",
        .id = APP_OVERLAY_ABOUT},
@@ -378,6 +395,9 @@ static bool app_show_menu_overlay(void) {
     case APP_OVERLAY_KEYS:
       app_show_keybindings();
       break;
+    case APP_OVERLAY_FRAME_TIMINGS:
+      app_show_frame_timings();
+      break;
     case APP_OVERLAY_ABOUT:
       app_show_about();
       break;
@@ -392,6 +412,94 @@ static bool app_show_menu_overlay(void) {
   return want_exit;
 }
 
+/* A million synthetic rows, produced on demand: the table only ever asks
+ * for the rows on screen, a few hundred width samples and, when sorting, one
+ * pass over the sort column. Values derive from the row number alone, so the
+ * cursor is safe to call from the sort thread. */
+enum { APP_TABLE_ROWS = 1000000 };
+
+static bool app_table_cursor(void *user, int row, tui_table_row_t *out) {
+  (void)user;
+  static const char *const regions[] = {"eu-west", "us-east", "ap-south",
+                                        "sa-east", "eu-central"};
+  static const char *const states[] = {"ok", "ok", "ok", "degraded",
+                                       "draining"};
+  uint32_t h = (uint32_t)row * 2654435761u;
+  h ^= h >> 15;
+  const char *region = regions[(h >> 8) % 5];
+  /* Three formatted cells side by side in the scratch buffer. */
+  const size_t third = out->scratch_size / 3;
+  char *id = out->scratch;
+  char *host = id + third;
+  char *latency = host + third;
+  snprintf(id, third, "%d", row + 1);
+  snprintf(host, third, "node-%05u.%s", h % 100000u, region);
+  snprintf(latency, third, "%u.%u", 1u + (h >> 4) % 400u, (h >> 12) % 10u);
+  out->cells[0] = id;
+  out->cells[1] = host;
+  out->cells[2] = region;
+  out->cells[3] = latency;
+  out->cells[4] = states[(h >> 20) % 5];
+  return true;
+}
+
+static void app_show_table(void) {
+  static const tui_table_column_t columns[] = {
+      {.title = "#", .align = TUI_TABLE_ALIGN_RIGHT,
+       .sort = TUI_TABLE_SORT_NUMBER},
+      {.title = "Host", .max_width = 24},
+      {.title = "Region"},
+      {.title = "Latency ms", .align = TUI_TABLE_ALIGN_RIGHT,
+       .sort = TUI_TABLE_SORT_NUMBER},
+      {.title = "Status"},
+  };
+  tui_table_result_t r = tui_show_table(
+      NULL, &(tui_table_config_t){
+                .title = "Data Table",
+                .subtitle = "1,000,000 rows fetched on demand",
+                .columns = columns,
+                .column_count = 5,
+                .row_count = APP_TABLE_ROWS,
+                .cursor = app_table_cursor,
+                .sort_column = -1,
+                .frame_height = 22,
+                .frame_width = 76,
+            });
+  if (r.status == TUI_TABLE_TOO_SMALL) {
+    tui_show_message("Data Table",
+                     "The terminal is too small for the table example.");
+  } else if (r.status == TUI_TABLE_OK) {
+    char msg[128];
+    snprintf(msg, sizeof(msg), "Row %d selected.", r.selected_row + 1);
+    tui_show_message("Data Table", msg);
+  }
+}
+
+static void app_show_log_viewer(void) {
+  char path[512];
+  if (tui_input_dialog("Log Viewer", "Path of a log file:", path,
+                       sizeof(path)) != APP_SUCCESS ||
+      path[0] == '\0') {
+    return;
+  }
+  const tui_logview_status_t st =
+      tui_show_logview(NULL, &(tui_logview_config_t){
+                                 .path = path,
+                                 .follow = true,
+                             });
+  if (st == TUI_LOGVIEW_IO_ERROR) {
+    char msg[640];
+    snprintf(msg, sizeof(msg), "Cannot open %s:\n%s", path, strerror(errno));
+    tui_show_message("Log Viewer", msg);
+  } else if (st == TUI_LOGVIEW_UNSUPPORTED) {
+    tui_show_message("Log Viewer",
+                     "The log viewer is not available on this platform.");
+  } else if (st == TUI_LOGVIEW_TOO_SMALL) {
+    tui_show_message("Log Viewer",
+                     "The terminal is too small for the log viewer.");
+  }
+}
+
 /* ============================================================
  * Section 2: Menu definition - your items + dispatch table.
  * ============================================================ */
@@ -416,6 +524,12 @@ static const tui_menu_item_t main_menu[] = {
     {.label = "&Layout Pattern",
      .description = "Open a reusable bordered panel with a status line",
      .id = APP_MENU_LAYOUT},
+    {.label = "&Data Table",
+     .description = "Scroll and sort a million rows drawn one screen at a time",
+     .id = APP_MENU_TABLE},
+    {.label = "Log &Viewer",
+     .description = "Page through and follow a log file of any size",
+     .id = APP_MENU_LOG_VIEWER},
     {.label = "&Configuration",
      .description = "Adjust output mode, log level, and terminal settings",
      .id = APP_MENU_CONFIGURATION},
@@ -446,6 +560,12 @@ static void app_dispatch(int id) {
   case APP_MENU_LAYOUT:
     app_show_layout();
     break;
+  case APP_MENU_TABLE:
+    app_show_table();
+    break;
+  case APP_MENU_LOG_VIEWER:
+    app_show_log_viewer();
+    break;
   case APP_MENU_CONFIGURATION:
     app_show_config_menu();
     break;
@@ -470,6 +590,7 @@ app_error tui_run_app(void) {
   app_error err = tui_init();
   if (err != APP_SUCCESS)
     return err;
+  tui_debug_set_enabled(true); /* F12: frame statistics overlay */
 
   /* Own the menu frame here so it remains visible behind dialog modals
    * that handlers may open. tui_show_menu restores this caller-owned frame
@@ -478,6 +599,7 @@ app_error tui_run_app(void) {
   tui_window_t *menu_frame =
       tui_create_centered_window(MAIN_MENU_FRAME_HEIGHT, MAIN_MENU_FRAME_WIDTH);
   if (!menu_frame) {
+    tui_debug_set_enabled(false);
     tui_cleanup();
     return APP_ERROR_OUT_OF_RANGE;
   }
@@ -535,6 +657,7 @@ app_error tui_run_app(void) {
 
   tui_pop_background();
   tui_destroy_window(menu_frame);
+  tui_debug_set_enabled(false);
   tui_cleanup();
   return err;
 }
@@ -0,0 +1,399 @@
+/*
+ * tui_debug.c - frame statistics overlay and history.
+ *
+ * Answers "where does the time go on this host": every instrumented frame
+ * (tui_frame_flush) is recorded with its layout, render and doupdate() time
+ * and, on Linux, the bytes doupdate() wrote. An app opts in with
+ * tui_debug_set_enabled(); F12 then toggles a corner HUD in any
+ * tui_wait_event() loop and tui_debug_format_histogram() summarizes the
+ * recent history as text.
+ *
+ * Output bytes come from the UI thread's own write counter in
+ * /proc/thread-self/io, sampled around doupdate(): ncurses writes straight
+ * to the terminal fd, so there is no stream to wrap, and the only writes
+ * this thread makes inside doupdate() are terminal output. Other threads'
+ * writes (logging, workers) are not counted. Heap figures use glibc's
+ * mallinfo2(); elsewhere both fields read "n/a".
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || __GLIBC_MINOR__ >= 33)
+#include <malloc.h>
+#define TUI_DEBUG_HAVE_MALLINFO2 1
+#endif
+
+#include "tui_internal.h"
+
+#define TUI_DEBUG_HISTORY 256
+
+enum {
+  TUI_DEBUG_HUD_HEIGHT = 6,
+  TUI_DEBUG_HUD_WIDTH = 38,
+  TUI_DEBUG_CELL = 16, /* "label    value" */
+};
+
+static struct {
+  bool enabled;
+  bool visible;
+  WINDOW *hud;
+  /* /proc/thread-self/io of the thread that draws; opened by the first
+   * output mark, -1 until then or when unavailable. */
+  int io_fd;
+  bool io_tried;
+  tui_frame_stats_t history[TUI_DEBUG_HISTORY];
+  size_t frame_count; /* total recorded; history is a ring over it */
+  uint64_t event_count;
+  /* Per-second rates, recomputed when the HUD is drawn. */
+  uint64_t rate_start_us;
+  uint64_t rate_events;
+  uint64_t rate_frames;
+  double events_per_s;
+  double frames_per_s;
+  long long heap_bytes; /* -1 when unavailable */
+  long long heap_delta;
+} tui_debug = {.io_fd = -1, .heap_bytes = -1};
+
+static void tui_debug_close_io(void) {
+#ifndef _WIN32
+  if (tui_debug.io_fd >= 0) {
+    close(tui_debug.io_fd);
+  }
+#endif
+  tui_debug.io_fd = -1;
+  tui_debug.io_tried = false;
+}
+
+void tui_debug_set_enabled(bool enabled) {
+  if (enabled == tui_debug.enabled) {
+    return;
+  }
+  tui_debug.enabled = enabled;
+  if (!enabled) {
+    tui_debug_shutdown();
+    tui_debug_close_io();
+    return;
+  }
+  tui_debug.frame_count = 0;
+  tui_debug.event_count = 0;
+  tui_debug.rate_start_us = 0;
+  tui_debug.events_per_s = 0.0;
+  tui_debug.frames_per_s = 0.0;
+  tui_debug.heap_bytes = -1;
+}
+
+bool tui_debug_enabled(void) {
+  return tui_debug.enabled;
+}
+
+void tui_debug_shutdown(void) {
+  if (tui_debug.hud) {
+    delwin(tui_debug.hud);
+    tui_debug.hud = NULL;
+  }
+  tui_debug.visible = false;
+}
+
+bool tui_debug_toggle(void) {
+  if (!tui_debug.enabled) {
+    return false;
+  }
+  if (tui_debug.visible) {
+    tui_debug_shutdown();
+    return true; /* the loop must repaint what the HUD covered */
+  }
+  tui_debug.visible = true;
+  tui_debug.rate_start_us = 0;
+  tui_debug_compose();
+  doupdate();
+  return false;
+}
+
+void tui_debug_note_event(void) {
+  tui_debug.event_count++;
+}
+
+uint64_t tui_debug_output_mark(void) {
+#if defined(__linux__)
+  if (!tui_debug.io_tried) {
+    /* Marks are taken in tui_frame_flush(), so this is the UI thread. */
+    tui_debug.io_tried = true;
+    tui_debug.io_fd = open("/proc/thread-self/io", O_RDONLY | O_CLOEXEC);
+  }
+  if (tui_debug.io_fd < 0) {
+    return TUI_FRAME_OUTPUT_UNKNOWN;
+  }
+  char buf[512];
+  const ssize_t n = pread(tui_debug.io_fd, buf, sizeof(buf) - 1, 0);
+  if (n <= 0) {
+    return TUI_FRAME_OUTPUT_UNKNOWN;
+  }
+  buf[n] = '\0';
+  const char *field = strstr(buf, "wchar:");
+  if (!field) {
+    return TUI_FRAME_OUTPUT_UNKNOWN;
+  }
+  return strtoull(field + 6, NULL, 10);
+#else
+  return TUI_FRAME_OUTPUT_UNKNOWN;
+#endif
+}
+
+uint64_t tui_debug_output_since(uint64_t mark) {
+  if (mark == TUI_FRAME_OUTPUT_UNKNOWN) {
+    return TUI_FRAME_OUTPUT_UNKNOWN;
+  }
+  const uint64_t now = tui_debug_output_mark();
+  return now != TUI_FRAME_OUTPUT_UNKNOWN && now >= mark
+             ? now - mark
+             : TUI_FRAME_OUTPUT_UNKNOWN;
+}
+
+void tui_debug_record_frame(const tui_frame_stats_t *stats) {
+  if (!tui_debug.enabled) {
+    return;
+  }
+  tui_debug.history[tui_debug.frame_count % TUI_DEBUG_HISTORY] = *stats;
+  tui_debug.frame_count++;
+}
+
+/* ---- HUD ---------------------------------------------------------------- */
+
+static void tui_debug_format_ms(char *buf, size_t size, uint64_t us) {
+  snprintf(buf, size, "%.2fms", (double)us / 1000.0);
+}
+
+static void tui_debug_format_bytes(char *buf, size_t size, long long bytes,
+                                   bool sign) {
+  const char *prefix = sign && bytes >= 0 ? "+" : "";
+  const long long mag = bytes < 0 ? -bytes : bytes;
+  if (mag >= 10ll * 1024 * 1024) {
+    snprintf(buf, size, "%s%.1fMiB", prefix, (double)bytes / 1048576.0);
+  } else if (mag >= 10ll * 1024) {
+    snprintf(buf, size, "%s%.1fKiB", prefix, (double)bytes / 1024.0);
+  } else {
+    snprintf(buf, size, "%s%lldB", prefix, bytes);
+  }
+}
+
+static void tui_debug_update_rates(void) {
+  const uint64_t now = tui_clock_us();
+  if (tui_debug.rate_start_us == 0) {
+    tui_debug.rate_start_us = now;
+    tui_debug.rate_events = tui_debug.event_count;
+    tui_debug.rate_frames = tui_debug.frame_count;
+  } else if (now - tui_debug.rate_start_us >= 1000000u) {
+    const double secs = (double)(now - tui_debug.rate_start_us) / 1e6;
+    tui_debug.events_per_s =
+        (double)(tui_debug.event_count - tui_debug.rate_events) / secs;
+    tui_debug.frames_per_s =
+        (double)(tui_debug.frame_count - tui_debug.rate_frames) / secs;
+    tui_debug.rate_start_us = now;
+    tui_debug.rate_events = tui_debug.event_count;
+    tui_debug.rate_frames = tui_debug.frame_count;
+  }
+#ifdef TUI_DEBUG_HAVE_MALLINFO2
+  const struct mallinfo2 mi = mallinfo2();
+  const long long heap = (long long)(mi.uordblks + mi.hblkhd);
+  tui_debug.heap_delta =
+      tui_debug.heap_bytes < 0 ? 0 : heap - tui_debug.heap_bytes;
+  tui_debug.heap_bytes = heap;
+#endif
+}
+
+static void tui_debug_cell(int y, int x, const char *label,
+                           const char *value) {
+  mvwprintw(tui_debug.hud, y, x, "%-7s%*s", label, TUI_DEBUG_CELL - 7,
+            value);
+}
+
+void tui_debug_compose(void) {
+  if (!tui_debug.visible) {
+    return;
+  }
+  const int y = 0;
+  const int x = COLS - TUI_DEBUG_HUD_WIDTH;
+  if (x < 0 || LINES < TUI_DEBUG_HUD_HEIGHT) {
+    return;
+  }
+  if (tui_debug.hud && (getbegx(tui_debug.hud) != x)) {
+    delwin(tui_debug.hud);
+    tui_debug.hud = NULL;
+  }
+  if (!tui_debug.hud) {
+    tui_debug.hud = newwin(TUI_DEBUG_HUD_HEIGHT, TUI_DEBUG_HUD_WIDTH, y, x);
+    if (!tui_debug.hud) {
+      return;
+    }
+  }
+  tui_debug_update_rates();
+
+  WINDOW *w = tui_debug.hud;
+  werase(w);
+  tui_set_color(w, TUI_COLOR_BORDER);
+  box(w, 0, 0);
+  tui_unset_color(w, TUI_COLOR_BORDER);
+  tui_set_color(w, TUI_COLOR_TITLE);
+  mvwaddstr(w, 0, 2, " Frame stats (F12) ");
+  tui_unset_color(w, TUI_COLOR_TITLE);
+
+  const size_t count = tui_debug.frame_count;
+  const tui_frame_stats_t *last =
+      count ? &tui_debug.history[(count - 1) % TUI_DEBUG_HISTORY] : NULL;
+  char a[24];
+  char b[24];
+  const int left = 2;
+  const int right = left + TUI_DEBUG_CELL + 2;
+
+  tui_set_color(w, TUI_COLOR_INFO);
+  tui_debug_format_ms(a, sizeof(a), last ? last->layout_us : 0);
+  tui_debug_format_ms(b, sizeof(b), last ? last->render_us : 0);
+  tui_debug_cell(1, left, "layout", a);
+  tui_debug_cell(1, right, "render", b);
+
+  tui_debug_format_ms(a, sizeof(a), last ? last->update_us : 0);
+  if (last && last->output_bytes != TUI_FRAME_OUTPUT_UNKNOWN) {
+    tui_debug_format_bytes(b, sizeof(b), (long long)last->output_bytes,
+                           false);
+  } else {
+    snprintf(b, sizeof(b), "n/a");
+  }
+  tui_debug_cell(2, left, "update", a);
+  tui_debug_cell(2, right, "output", b);
+
+  snprintf(a, sizeof(a), "%.0f/s", tui_debug.events_per_s);
+  snprintf(b, sizeof(b), "%.0f/s", tui_debug.frames_per_s);
+  tui_debug_cell(3, left, "events", a);
+  tui_debug_cell(3, right, "frames", b);
+
+  if (tui_debug.heap_bytes >= 0) {
+    tui_debug_format_bytes(a, sizeof(a), tui_debug.heap_bytes, false);
+    tui_debug_format_bytes(b, sizeof(b), tui_debug.heap_delta, true);
+  } else {
+    snprintf(a, sizeof(a), "n/a");
+    snprintf(b, sizeof(b), "n/a");
+  }
+  tui_debug_cell(4, left, "heap", a);
+  tui_debug_cell(4, right, "change", b);
+  tui_unset_color(w, TUI_COLOR_INFO);
+
+  touchwin(w); /* win over whatever the frame just drew beneath it */
+  wnoutrefresh(w);
+}
+
+/* ---- history ------------------------------------------------------------ */
+
+static int tui_debug_cmp_u64(const void *a, const void *b) {
+  const uint64_t x = *(const uint64_t *)a;
+  const uint64_t y = *(const uint64_t *)b;
+  return (x > y) - (x < y);
+}
+
+/* p50/p95/max of `values` (sorted in place) as "%7s%7s%7s" cells. */
+static int tui_debug_quantiles(char *buf, size_t size, uint64_t *values,
+                               size_t n, bool ms) {
+  if (n == 0) {
+    return snprintf(buf, size, "%7s%7s%7s", "-", "-", "-");
+  }
+  qsort(values, n, sizeof(values[0]), tui_debug_cmp_u64);
+  const uint64_t q[3] = {values[(n - 1) * 50 / 100],
+                         values[(n - 1) * 95 / 100], values[n - 1]};
+  int len = 0;
+  for (int i = 0; i < 3; i++) {
+    char cell[16];
+    if (ms) {
+      snprintf(cell, sizeof(cell), "%.2f", (double)q[i] / 1000.0);
+    } else {
+      snprintf(cell, sizeof(cell), "%llu", (unsigned long long)q[i]);
+    }
+    const int w = snprintf(buf + len, size > (size_t)len ? size - len : 0,
+                           "%7s", cell);
+    len += w > 0 ? w : 0;
+  }
+  return len;
+}
+
+size_t tui_debug_format_histogram(char *buf, size_t size) {
+  if (!buf || size == 0) {
+    return 0;
+  }
+  const size_t n = tui_debug.frame_count < TUI_DEBUG_HISTORY
+                       ? tui_debug.frame_count
+                       : TUI_DEBUG_HISTORY;
+  if (n == 0) {
+    return (size_t)snprintf(buf, size,
+                            "No frames recorded yet. Move around the menu "
+                            "and open this again.");
+  }
+
+  /* Buckets by whole-frame time; the upper bounds double from 0.5 ms so a
+   * 60 Hz frame budget (16.7 ms) falls in the last bounded bucket. */
+  static const uint64_t bounds_us[] = {500, 1000, 2000, 4000, 8000, 16700};
+  static const char *const names[] = {"<0.5", "<1",  "<2",   "<4",
+                                      "<8",   "<17", ">=17"};
+  enum { BUCKETS = sizeof(names) / sizeof(names[0]), BAR = 30 };
+  size_t counts[BUCKETS] = {0};
+  uint64_t layout[TUI_DEBUG_HISTORY];
+  uint64_t render[TUI_DEBUG_HISTORY];
+  uint64_t update[TUI_DEBUG_HISTORY];
+  uint64_t bytes[TUI_DEBUG_HISTORY];
+  size_t byte_count = 0;
+  for (size_t i = 0; i < n; i++) {
+    const tui_frame_stats_t *f = &tui_debug.history[i];
+    layout[i] = f->layout_us;
+    render[i] = f->render_us;
+    update[i] = f->update_us;
+    if (f->output_bytes != TUI_FRAME_OUTPUT_UNKNOWN) {
+      bytes[byte_count++] = f->output_bytes;
+    }
+    const uint64_t total = layout[i] + render[i] + update[i];
+    size_t b = 0;
+    while (b < BUCKETS - 1 && total >= bounds_us[b]) {
+      b++;
+    }
+    counts[b]++;
+  }
+  size_t peak = 1;
+  for (size_t b = 0; b < BUCKETS; b++) {
+    peak = counts[b] > peak ? counts[b] : peak;
+  }
+
+  size_t len = 0;
+#define TUI_DEBUG_APPEND(...)                                                \
+  do {                                                                       \
+    const int w_ = snprintf(buf + len, len < size ? size - len : 0,          \
+                            __VA_ARGS__);                                    \
+    len += w_ > 0 ? (size_t)w_ : 0;                                          \
+  } while (0)
+
+  TUI_DEBUG_APPEND("Last %zu frames, total ms:\n", n);
+  for (size_t b = 0; b < BUCKETS; b++) {
+    char bar[BAR + 1];
+    const size_t fill = (counts[b] * BAR + peak - 1) / peak;
+    memset(bar, '#', fill);
+    bar[fill] = '\0';
+    TUI_DEBUG_APPEND("%-5s %-*s %4zu\n", names[b], BAR, bar, counts[b]);
+  }
+  char row[40];
+  TUI_DEBUG_APPEND("\n%-8s%7s%7s%7s\n", "", "p50", "p95", "max");
+  tui_debug_quantiles(row, sizeof(row), layout, n, true);
+  TUI_DEBUG_APPEND("%-8s%s ms\n", "layout", row);
+  tui_debug_quantiles(row, sizeof(row), render, n, true);
+  TUI_DEBUG_APPEND("%-8s%s ms\n", "render", row);
+  tui_debug_quantiles(row, sizeof(row), update, n, true);
+  TUI_DEBUG_APPEND("%-8s%s ms\n", "update", row);
+  if (byte_count > 0) {
+    tui_debug_quantiles(row, sizeof(row), bytes, byte_count, false);
+    TUI_DEBUG_APPEND("%-8s%s B", "output", row);
+  } else {
+    TUI_DEBUG_APPEND("%-8s%7s", "output", "n/a");
+  }
+#undef TUI_DEBUG_APPEND
+  return len < size ? len : size - 1;
+}
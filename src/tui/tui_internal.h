@@ -7,14 +7,16 @@
 #pragma once
 
 #include <stddef.h>
+#include <stdint.h>
 #include <wchar.h>
 
+#include "../ui/text_layout.h"
 #include "tui.h"
 
-/* Display width of a wide character. POSIX wcwidth() is unavailable in the
- * Windows CRT, so approximate there: control chars are -1, the common East
- * Asian wide range (>= U+1100) is 2 columns, everything else is 1. */
-#ifdef _WIN32
+/* Display width of a wide character, from the same locale-independent
+ * tables as src/ui/text_layout.c so per-glyph placement in the menu agrees
+ * with CLI and truncation measurements. C0/C1 controls are -1 (callers draw
+ * them as one column); combining marks are 0. */
 static inline int tui_wcwidth(wchar_t wc) {
   if (wc == 0) {
     return 0;
@@ -22,49 +24,14 @@ static inline int tui_wcwidth(wchar_t wc) {
   if (wc < 32 || (wc >= 0x7f && wc < 0xa0)) {
     return -1;
   }
-  return wc >= 0x1100 ? 2 : 1;
+  return app_text_codepoint_columns((uint32_t)wc);
 }
-#else
-static inline int tui_wcwidth(wchar_t wc) {
-  return wcwidth(wc);
-}
-#endif
 
-/* Display columns of a NUL-terminated UTF-8 string, decoding multibyte
- * sequences and summing tui_wcwidth() (non-printable / undecodable bytes count
- * as one column). Use this to centre/align text instead of byte strlen,
+/* Display columns of a NUL-terminated UTF-8 string (grapheme-aware; see
+ * app_text_width_utf8). Use this to centre/align text instead of byte strlen,
  * which mis-measures multibyte glyphs. */
 static inline int tui_display_cols(const char *s) {
-  if (s == nullptr) {
-    return 0;
-  }
-  int cols = 0;
-  mbstate_t state = {0};
-  const char *p = s;
-  size_t remaining = 0;
-  for (remaining = 0; p[remaining] != '\0'; remaining++) {
-    /* count remaining bytes */
-  }
-  while (remaining > 0) {
-    wchar_t wc = 0;
-    size_t len = mbrtowc(&wc, p, remaining, &state);
-    if (len == (size_t)-1 || len == (size_t)-2) {
-      /* invalid/incomplete: treat one byte as one column and resync. */
-      cols += 1;
-      p += 1;
-      remaining -= 1;
-      state = (mbstate_t){0};
-      continue;
-    }
-    if (len == 0) {
-      break;
-    }
-    int w = tui_wcwidth(wc);
-    cols += w < 0 ? 1 : w;
-    p += len;
-    remaining -= len;
-  }
-  return cols;
+  return app_text_width_utf8(s);
 }
 
 /* ASCII-safe uppercase: uppercases only bytes in 'a'..'z' and leaves every
@@ -104,6 +71,141 @@ void tui_push_background(tui_window_t *window);
 void tui_pop_background(void);
 void tui_replace_background(tui_window_t *old_window, tui_window_t *new_window);
 
+/* Central event wait for TUI loops. Blocks in poll() on the terminal and a
+ * self-pipe, so an idle TUI costs no CPU and no input latency. */
+typedef enum {
+  TUI_EVENT_KEY,    /* `key` holds the wgetch() code */
+  TUI_EVENT_RESIZE, /* KEY_RESIZE */
+  TUI_EVENT_SIGNAL, /* SIGINT/SIGTERM or terminal hangup; latched, see
+                       tui_take_interrupt_error() */
+  TUI_EVENT_TIMER,  /* timeout_ms elapsed */
+  TUI_EVENT_WAKE,   /* tui_wake() from a background task */
+  TUI_EVENT_REPAINT, /* something drew over the loop's windows (the F12 HUD
+                        closed); stdscr and the background are already
+                        queued again, the loop repaints its own windows */
+} tui_event_kind_t;
+
+typedef struct {
+  tui_event_kind_t kind;
+  int key;
+} tui_event_t;
+
+/* Wait up to `timeout_ms` (-1 = forever) for the next event on `win`. Keys
+ * ncurses has already buffered are returned without blocking. Without
+ * poll() (Windows) this is wgetch() with a timeout and never reports WAKE,
+ * so callers with background work must pass a finite timeout there. */
+tui_event_t tui_wait_event(WINDOW *win, int timeout_ms);
+
+/* Wake tui_wait_event() with TUI_EVENT_WAKE. Safe from any thread and from
+ * signal handlers; coalesces while the waiter has not run yet. */
+void tui_wake(void);
+
+/* Whether tui_wake() can interrupt tui_wait_event() on this platform. */
+bool tui_wake_supported(void);
+
+/* Monotonic clock for frame pacing and instrumentation; the epoch is
+ * unspecified. */
+uint64_t tui_clock_us(void);
+uint64_t tui_clock_ms(void);
+
+/* Frame instrumentation. A painting loop brackets each frame it draws:
+ *
+ *   tui_frame_t frame = tui_frame_begin();  before computing layout
+ *   tui_frame_layout_done(&frame);          before drawing into windows
+ *   ...wnoutrefresh()...
+ *   tui_frame_flush(&frame);                instead of doupdate()
+ *
+ * and the installed observer, if any, receives the phase timings. */
+typedef struct {
+  uint64_t start_us;
+  uint64_t layout_end_us;
+} tui_frame_t;
+
+#define TUI_FRAME_OUTPUT_UNKNOWN UINT64_MAX
+
+typedef struct {
+  uint64_t layout_us; /* geometry, selection and scroll bookkeeping */
+  uint64_t render_us; /* drawing into ncurses windows */
+  uint64_t update_us; /* doupdate(): screen diff and terminal write */
+  /* Bytes doupdate() wrote to the terminal. Measured only while the frame
+   * statistics overlay is enabled, otherwise TUI_FRAME_OUTPUT_UNKNOWN. */
+  uint64_t output_bytes;
+} tui_frame_stats_t;
+
+typedef void (*tui_frame_observer_fn)(const tui_frame_stats_t *frame,
+                                      void *user);
+
+/* Called on the UI thread after every instrumented frame; NULL detaches. */
+void tui_set_frame_observer(tui_frame_observer_fn observer, void *user);
+tui_frame_t tui_frame_begin(void);
+void tui_frame_layout_done(tui_frame_t *frame);
+void tui_frame_flush(const tui_frame_t *frame);
+
+/* Paced event loop shared by the menu, table and log viewer. Paints at
+ * most once per 1000/max_fps ms: damage accumulates in the view's model,
+ * so a burst of keys landing inside one frame is drawn once, from the final
+ * state, and a pending resize waits for the frame too, so a dragged
+ * terminal edge rebuilds the window once. */
+typedef enum {
+  TUI_FRAME_LOOP_CONTINUE,
+  TUI_FRAME_LOOP_EXIT,    /* the view is done */
+  TUI_FRAME_LOOP_REFRAME, /* a dialog covered the frame: rebuild it */
+} tui_frame_loop_action_t;
+
+typedef enum {
+  TUI_FRAME_LOOP_DONE,        /* dispatch returned TUI_FRAME_LOOP_EXIT */
+  TUI_FRAME_LOOP_INTERRUPTED, /* see tui_take_interrupt_error() */
+  TUI_FRAME_LOOP_TOO_SMALL,   /* layout no longer fits the terminal */
+} tui_frame_loop_status_t;
+
+typedef struct {
+  void *view;
+  int max_fps; /* 0 = 60 */
+  /* Rebuild the frame for the terminal size when `resize`, recompute the
+   * layout and settle selection and scroll. Returns the window keys are
+   * read from, or NULL when the view no longer fits. */
+  WINDOW *(*layout)(void *view, bool resize);
+  bool (*has_damage)(void *view);
+  /* Draw the damage and end with tui_frame_flush(frame). */
+  void (*paint)(void *view, const tui_frame_t *frame);
+  /* Apply one key, leaving selection and scroll settled. */
+  tui_frame_loop_action_t (*dispatch)(void *view, int key);
+  /* Take in background work that finished (TUI_EVENT_WAKE/TIMER). */
+  void (*poll)(void *view);
+  /* Whether background work is in flight; without tui_wake() the loop
+   * then polls every 15 ms. */
+  bool (*pending)(void *view);
+  /* Full damage after TUI_EVENT_REPAINT. */
+  void (*invalidate)(void *view);
+} tui_frame_loop_t;
+
+tui_frame_loop_status_t tui_run_frame_loop(const tui_frame_loop_t *loop);
+
+/* Frame statistics overlay (tui_debug.c), off unless an app opts in. Once
+ * enabled, every instrumented frame is kept in a rolling history and F12 in
+ * any tui_wait_event() loop shows or hides a corner HUD with the last
+ * frame's layout, render and doupdate() time, its output bytes, events and
+ * frames per second, and heap usage. Hiding the HUD is reported as
+ * TUI_EVENT_REPAINT so the loop repaints what it covered. Enabling starts a
+ * fresh history. */
+void tui_debug_set_enabled(bool enabled);
+bool tui_debug_enabled(void);
+/* Returns true when the screen beneath must be repainted. */
+bool tui_debug_toggle(void);
+void tui_debug_note_event(void);
+/* Used by tui_frame_flush(): compose the HUD over the frame, bracket
+ * doupdate() with an output mark (TUI_FRAME_OUTPUT_UNKNOWN where the count
+ * is unavailable) and the bytes written since it, and record the result. */
+void tui_debug_compose(void);
+uint64_t tui_debug_output_mark(void);
+uint64_t tui_debug_output_since(uint64_t mark);
+void tui_debug_record_frame(const tui_frame_stats_t *stats);
+/* Text histogram of recent frame times plus per-phase p50/p95/max, sized
+ * for tui_show_message(). Returns the length written. */
+size_t tui_debug_format_histogram(char *buf, size_t size);
+/* Drops the HUD window; called by tui_cleanup(). */
+void tui_debug_shutdown(void);
+
 bool tui_modal_run(int height, int width, const char *title,
                    tui_modal_redraw_fn redraw, tui_modal_key_fn handle,
                    void *userdata);
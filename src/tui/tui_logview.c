@@ -0,0 +1,505 @@
+/*
+ * tui_logview.c - view + controller + orchestrator for the tui_logview
+ * module.
+ *
+ * The model lives in tui_logview_model.c (no ncurses). This file lays out
+ * the frame, formats and draws only the lines in the viewport (wrapped with
+ * the same text_layout spans as tui_print_wrapped when wrapping is on) and
+ * runs tui_show_logview on tui_run_frame_loop(), with the frame pacing,
+ * resize and wake-up handling of tui_show_menu.
+ */
+#ifdef _WIN32
+#include <curses.h>
+#else
+#include <ncurses.h>
+#endif
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "../ui/text_layout.h"
+#include "tui.h"
+#include "tui_internal.h"
+#include "tui_logview.h"
+#include "tui_logview_internal.h"
+
+#define LOGVIEW_PAD 3 /* left/right content padding, as in the menu */
+#define LOGVIEW_MIN_ROWS 3
+#define LOGVIEW_LINE_BUF (TUI_LOGVIEW_LINE_MAX + 16)
+
+typedef struct {
+  tui_window_t *frame;
+  bool owns_frame;
+  int content_left;
+  int content_width;
+  int title_y;
+  int meta_y; /* -1 when compact */
+  int rule_y;
+  int row_area_y;
+  int row_area_h;
+  int footer_y;
+  int desired_h; /* 0 fills the terminal */
+  int desired_w;
+} tui_logview_layout_t;
+
+/* Title, meta line, rule, the lines, and a key-hint footer; the compact
+ * variant for short terminals drops the padding and the meta line. */
+static bool tui_logview_layout_compute(tui_logview_layout_t *L) {
+  const int H = L->frame->height;
+  const int W = L->frame->width;
+  if (W < 24)
+    return false;
+  L->content_left = LOGVIEW_PAD;
+  L->content_width = W - 2 * LOGVIEW_PAD;
+  if (H >= 12) {
+    L->title_y = 1;
+    L->meta_y = 3;
+    L->rule_y = 4;
+    L->footer_y = H - 2;
+  } else {
+    L->title_y = 0;
+    L->meta_y = -1;
+    L->rule_y = 1;
+    L->footer_y = H - 1;
+  }
+  L->row_area_y = L->rule_y + 1;
+  L->row_area_h = (L->footer_y - 1) - L->row_area_y;
+  return L->row_area_h >= LOGVIEW_MIN_ROWS;
+}
+
+static void tui_logview_frame_size(const tui_logview_layout_t *L, int *height,
+                                   int *width) {
+  *height = L->desired_h > 0 ? L->desired_h : getmaxy(stdscr);
+  *width = L->desired_w > 0 ? L->desired_w : getmaxx(stdscr);
+}
+
+static bool tui_logview_recenter_frame(tui_logview_layout_t *L) {
+  if (!L->frame || !L->frame->win)
+    return false;
+  const int max_y = getmaxy(stdscr);
+  const int max_x = getmaxx(stdscr);
+  int height = L->desired_h > 0 ? L->desired_h : L->frame->height;
+  int width = L->desired_w > 0 ? L->desired_w : L->frame->width;
+  if (height > max_y)
+    height = max_y;
+  if (width > max_x)
+    width = max_x;
+  if (height < 8 || width < 24)
+    return false;
+  const int y = (max_y - height) / 2;
+  const int x = (max_x - width) / 2;
+  if (wresize(L->frame->win, height, width) == ERR ||
+      mvwin(L->frame->win, y, x) == ERR)
+    return false;
+  L->frame->height = height;
+  L->frame->width = width;
+  L->frame->y = y;
+  L->frame->x = x;
+  touchwin(stdscr);
+  return true;
+}
+
+/* Writes `len` bytes of display text at (y, x) and re-draws each occurrence
+ * of the search needle in reverse video. */
+static void tui_logview_write_span(WINDOW *win, int y, int x, const char *text,
+                                   size_t len, const char *needle) {
+  mvwaddnstr(win, y, x, text, (int)len);
+  if (!needle)
+    return;
+  const size_t nlen = strlen(needle);
+  for (size_t from = 0; from < len;) {
+    const size_t at = tui_logview_find(text + from, len - from, needle, nlen);
+    if (at == SIZE_MAX)
+      break;
+    const int col = app_text_width_utf8_n(text, from + at);
+    wattron(win, A_REVERSE);
+    mvwaddnstr(win, y, x + col, text + from + at, (int)nlen);
+    wattroff(win, A_REVERSE);
+    from += at + nlen;
+  }
+}
+
+typedef struct {
+  WINDOW *win;
+  int y;
+  int x;
+  int width;
+  int end_y;
+  const char *needle;
+} tui_logview_wrap_ctx_t;
+
+/* Words wider than the row arrive as one span and are cut into row-sized
+ * pieces; tui_logview_state_line_rows() counts them the same way. */
+static bool tui_logview_wrap_emit(void *user, const char *bytes,
+                                  size_t byte_count, int columns) {
+  tui_logview_wrap_ctx_t *ctx = user;
+  do {
+    if (ctx->y >= ctx->end_y)
+      return false;
+    size_t take = byte_count;
+    if (columns > ctx->width) {
+      int cols = 0;
+      take = app_text_truncate_utf8_columns(bytes, ctx->width, &cols);
+      if (take == 0 || take > byte_count)
+        take = byte_count;
+    }
+    tui_logview_write_span(ctx->win, ctx->y, ctx->x, bytes, take,
+                           ctx->needle);
+    ctx->y++;
+    bytes += take;
+    byte_count -= take;
+  } while (byte_count > 0);
+  return true;
+}
+
+/* Meta line: path and state on the left, "line N of M" on the right. */
+static void tui_logview_render_meta(const tui_logview_layout_t *L,
+                                    const tui_logview_state_t *s,
+                                    const tui_logview_config_t *cfg) {
+  if (L->meta_y < 0)
+    return;
+  WINDOW *win = L->frame->win;
+  mvwhline(win, L->meta_y, L->content_left, ' ', L->content_width);
+  const tui_logview_progress_t p = tui_logview_state_progress(s);
+
+  char right[64];
+  snprintf(right, sizeof(right), "line %" PRId64 " of %" PRId64 "%s",
+           p.lines > 0 ? tui_logview_state_top(s) + 1 : 0, p.lines,
+           p.indexing ? "+" : "");
+  const int rcols = tui_display_cols(right);
+  tui_set_color(win, TUI_COLOR_DIM);
+  mvwaddstr(win, L->meta_y, L->content_left + L->content_width - rcols,
+            right);
+
+  char state[160] = "";
+  const char *needle = tui_logview_state_needle(s);
+  switch (tui_logview_state_search_status(s)) {
+  case TUI_LOGVIEW_SEARCH_RUNNING:
+    snprintf(state, sizeof(state), "/%s: searching…", needle);
+    break;
+  case TUI_LOGVIEW_SEARCH_NOT_FOUND:
+    snprintf(state, sizeof(state), "/%s: not found", needle);
+    break;
+  case TUI_LOGVIEW_SEARCH_FOUND:
+    snprintf(state, sizeof(state), "/%s", needle);
+    break;
+  default:
+    if (p.indexing && p.size > 0)
+      snprintf(state, sizeof(state), "indexing… %d%%",
+               (int)(p.indexed * 100 / p.size));
+    else if (p.limited)
+      snprintf(state, sizeof(state), "end of mapping reached");
+    else if (tui_logview_state_following(s))
+      snprintf(state, sizeof(state), "following");
+    break;
+  }
+  char left[512];
+  snprintf(left, sizeof(left), "%s%s%s", cfg->path, state[0] ? "  ·  " : "",
+           state);
+  int cols = 0;
+  const size_t bytes = app_text_truncate_utf8_columns(
+      left, L->content_width - rcols - 2, &cols);
+  mvwaddnstr(win, L->meta_y, L->content_left, left, (int)bytes);
+  tui_unset_color(win, TUI_COLOR_DIM);
+}
+
+static void tui_logview_render_header(const tui_logview_layout_t *L,
+                                      const tui_logview_state_t *s,
+                                      const tui_logview_config_t *cfg) {
+  WINDOW *win = L->frame->win;
+  const char *title = cfg->title;
+  if (!title) {
+    const char *slash = strrchr(cfg->path, '/');
+    title = slash && slash[1] ? slash + 1 : cfg->path;
+  }
+  char up[64];
+  tui_ascii_upper_copy(up, sizeof(up), title);
+  int tcols = 0;
+  const size_t tbytes =
+      app_text_truncate_utf8_columns(up, L->content_width, &tcols);
+  tui_set_color(win, TUI_COLOR_TITLE);
+  wattron(win, A_BOLD);
+  mvwaddnstr(win, L->title_y, (L->frame->width - tcols) / 2, up, (int)tbytes);
+  wattroff(win, A_BOLD);
+  tui_unset_color(win, TUI_COLOR_TITLE);
+
+  tui_logview_render_meta(L, s, cfg);
+
+  tui_set_color(win, TUI_COLOR_BORDER);
+  mvwhline(win, L->rule_y, L->content_left, ACS_HLINE, L->content_width);
+  tui_unset_color(win, TUI_COLOR_BORDER);
+}
+
+/* Formats and draws lines from the top until the row area is full. This
+ * is the only place line bytes are read on the UI thread. */
+static void tui_logview_render_rows(const tui_logview_layout_t *L,
+                                    const tui_logview_state_t *s) {
+  WINDOW *win = L->frame->win;
+  const char *needle = tui_logview_state_needle(s);
+  const int64_t match = tui_logview_state_match_line(s);
+  const int end_y = L->row_area_y + L->row_area_h;
+  char line[LOGVIEW_LINE_BUF];
+  int y = L->row_area_y;
+  for (int64_t n = tui_logview_state_top(s);
+       y < end_y &&
+       tui_logview_state_format_line(s, n, line, sizeof(line));
+       n++) {
+    if (n == match) {
+      tui_set_color(win, TUI_COLOR_ACCENT);
+      mvwaddstr(win, y, L->content_left - 2, "▸");
+      tui_unset_color(win, TUI_COLOR_ACCENT);
+    }
+    if (!tui_logview_state_wrap(s)) {
+      int cols = 0;
+      const size_t bytes =
+          app_text_truncate_utf8_columns(line, L->content_width, &cols);
+      tui_logview_write_span(win, y, L->content_left, line, bytes, needle);
+      y++;
+      continue;
+    }
+    tui_logview_wrap_ctx_t ctx = {.win = win,
+                                  .y = y,
+                                  .x = L->content_left,
+                                  .width = L->content_width,
+                                  .end_y = end_y,
+                                  .needle = needle};
+    app_text_wrap_utf8(line, L->content_width, 0, 0, tui_logview_wrap_emit,
+                       &ctx);
+    y = ctx.y > y ? ctx.y : y + 1; /* an empty line still takes a row */
+  }
+}
+
+static void tui_logview_render_footer(const tui_logview_layout_t *L) {
+  WINDOW *win = L->frame->win;
+  static const char hint[] =
+      "↑↓:scroll  /:find  n/N:next/prev  g/G:top/end  w:wrap  q:close";
+  int cols = 0;
+  const size_t bytes =
+      app_text_truncate_utf8_columns(hint, L->content_width, &cols);
+  tui_set_color(win, TUI_COLOR_DIM);
+  mvwaddnstr(win, L->footer_y, L->content_left, hint, (int)bytes);
+  tui_unset_color(win, TUI_COLOR_DIM);
+}
+
+static void tui_logview_paint(const tui_logview_layout_t *L,
+                              tui_logview_state_t *s,
+                              const tui_logview_config_t *cfg,
+                              const tui_frame_t *frame) {
+  const tui_logview_damage_t damage = tui_logview_state_take_damage(s);
+  if (damage.full) {
+    werase(L->frame->win);
+    tui_logview_render_header(L, s, cfg);
+    tui_logview_render_rows(L, s);
+    tui_logview_render_footer(L);
+  } else if (damage.meta) {
+    tui_logview_render_meta(L, s, cfg);
+  }
+  wnoutrefresh(L->frame->win);
+  tui_frame_flush(frame);
+}
+
+/* Rebuilds (owned) or recenters (caller's) the frame, as in
+ * tui_show_menu. Returns false when the viewer no longer fits; an owned
+ * frame is then gone. */
+static bool tui_logview_apply_resize(tui_logview_layout_t *L,
+                                     tui_logview_state_t *s) {
+  if (L->owns_frame) {
+    int height = 0;
+    int width = 0;
+    tui_logview_frame_size(L, &height, &width);
+    tui_window_t *old_frame = L->frame;
+    L->frame = tui_create_centered_window(height, width);
+    tui_replace_background(old_frame, L->frame);
+    tui_destroy_window(old_frame);
+    if (!L->frame)
+      return false;
+  } else if (!tui_logview_recenter_frame(L)) {
+    return false;
+  }
+  tui_logview_state_invalidate(s);
+  clear();
+  wnoutrefresh(stdscr);
+  return tui_logview_layout_compute(L);
+}
+
+static void tui_logview_prompt_search(tui_logview_state_t *s) {
+  char query[128];
+  if (tui_input_dialog("Search", "Find text:", query, sizeof(query)) !=
+          APP_SUCCESS ||
+      !query[0])
+    return;
+  if (!tui_logview_state_search(s, query, 1))
+    tui_beep();
+}
+
+/* Applies one key. A search prompt is a dialog over the frame, so it asks
+ * for TUI_FRAME_LOOP_REFRAME. */
+static tui_frame_loop_action_t tui_logview_dispatch(tui_logview_state_t *s,
+                                                 const tui_logview_layout_t *L,
+                                                 int ch) {
+  const int rows = L->row_area_h;
+  const int width = L->content_width;
+  switch (ch) {
+  case KEY_UP:
+  case 'k':
+    tui_logview_state_scroll(s, -1, rows, width);
+    return TUI_FRAME_LOOP_CONTINUE;
+  case KEY_DOWN:
+  case 'j':
+    tui_logview_state_scroll(s, 1, rows, width);
+    return TUI_FRAME_LOOP_CONTINUE;
+  case KEY_PPAGE:
+  case 'b':
+    tui_logview_state_page(s, -1, rows, width);
+    return TUI_FRAME_LOOP_CONTINUE;
+  case KEY_NPAGE:
+  case ' ':
+    tui_logview_state_page(s, 1, rows, width);
+    return TUI_FRAME_LOOP_CONTINUE;
+  case KEY_HOME:
+  case 'g':
+    tui_logview_state_home(s);
+    return TUI_FRAME_LOOP_CONTINUE;
+  case KEY_END:
+  case 'G':
+    tui_logview_state_end(s, rows, width);
+    return TUI_FRAME_LOOP_CONTINUE;
+  case 'w':
+  case 'W':
+    tui_logview_state_toggle_wrap(s);
+    return TUI_FRAME_LOOP_CONTINUE;
+  case '/':
+    tui_logview_prompt_search(s);
+    return TUI_FRAME_LOOP_REFRAME;
+  case 'n':
+  case 'N':
+    if (!tui_logview_state_search_again(s, ch == 'n' ? 1 : -1))
+      tui_beep();
+    return TUI_FRAME_LOOP_CONTINUE;
+  case 27: /* Esc */
+  case 'q':
+  case 'Q':
+    return TUI_FRAME_LOOP_EXIT;
+  default:
+    return TUI_FRAME_LOOP_CONTINUE;
+  }
+}
+
+/* The viewer as a tui_run_frame_loop() view. */
+typedef struct {
+  tui_logview_layout_t *L;
+  tui_logview_state_t *state;
+  const tui_logview_config_t *config;
+} tui_logview_view_t;
+
+static WINDOW *tui_logview_view_layout(void *view, bool resize) {
+  tui_logview_view_t *v = view;
+  const bool fits = resize ? tui_logview_apply_resize(v->L, v->state)
+                           : tui_logview_layout_compute(v->L);
+  if (!fits)
+    return NULL;
+  tui_logview_state_settle(v->state, v->L->row_area_h, v->L->content_width);
+  return v->L->frame->win;
+}
+
+static bool tui_logview_view_has_damage(void *view) {
+  const tui_logview_view_t *v = view;
+  return tui_logview_state_has_damage(v->state);
+}
+
+static void tui_logview_view_paint(void *view, const tui_frame_t *frame) {
+  tui_logview_view_t *v = view;
+  tui_logview_paint(v->L, v->state, v->config, frame);
+}
+
+static tui_frame_loop_action_t tui_logview_view_dispatch(void *view,
+                                                         int key) {
+  tui_logview_view_t *v = view;
+  const tui_frame_loop_action_t action =
+      tui_logview_dispatch(v->state, v->L, key);
+  if (action == TUI_FRAME_LOOP_CONTINUE)
+    tui_logview_state_settle(v->state, v->L->row_area_h,
+                             v->L->content_width);
+  return action;
+}
+
+static void tui_logview_view_poll(void *view) {
+  tui_logview_view_t *v = view;
+  tui_logview_state_poll(v->state);
+}
+
+static bool tui_logview_view_pending(void *view) {
+  const tui_logview_view_t *v = view;
+  return tui_logview_state_pending(v->state);
+}
+
+static void tui_logview_view_invalidate(void *view) {
+  tui_logview_view_t *v = view;
+  tui_logview_state_invalidate(v->state);
+}
+
+tui_logview_status_t tui_show_logview(tui_window_t *window,
+                                      const tui_logview_config_t *config) {
+  if (!config || !config->path)
+    return TUI_LOGVIEW_INVALID_ARG;
+  tui_logview_state_t *state = NULL;
+  tui_logview_status_t status =
+      tui_logview_state_open(config->path, config->follow, &state);
+  if (status != TUI_LOGVIEW_OK)
+    return status;
+  tui_logview_state_set_notify(state, tui_wake);
+
+  tui_logview_layout_t L = {0};
+  L.frame = window;
+  L.owns_frame = window == NULL;
+  L.desired_h = config->frame_height;
+  L.desired_w = config->frame_width;
+  if (L.owns_frame) {
+    int height = 0;
+    int width = 0;
+    tui_logview_frame_size(&L, &height, &width);
+    L.frame = tui_create_centered_window(height, width);
+    if (!L.frame) {
+      tui_logview_state_close(state);
+      return TUI_LOGVIEW_TOO_SMALL;
+    }
+  } else if ((config->frame_height > 0 || config->frame_width > 0) &&
+             !tui_logview_recenter_frame(&L)) {
+    tui_logview_state_close(state);
+    return TUI_LOGVIEW_TOO_SMALL;
+  }
+  const bool pushed_background = tui_get_background_window() != L.frame;
+  if (pushed_background)
+    tui_push_background(L.frame);
+
+  tui_logview_view_t view = {.L = &L, .state = state, .config = config};
+  const tui_frame_loop_t loop = {
+      .view = &view,
+      .max_fps = config->max_fps,
+      .layout = tui_logview_view_layout,
+      .has_damage = tui_logview_view_has_damage,
+      .paint = tui_logview_view_paint,
+      .dispatch = tui_logview_view_dispatch,
+      .poll = tui_logview_view_poll,
+      .pending = tui_logview_view_pending,
+      .invalidate = tui_logview_view_invalidate,
+  };
+  switch (tui_run_frame_loop(&loop)) {
+  case TUI_FRAME_LOOP_INTERRUPTED:
+    status = TUI_LOGVIEW_INTERRUPTED;
+    break;
+  case TUI_FRAME_LOOP_TOO_SMALL:
+    status = TUI_LOGVIEW_TOO_SMALL;
+    break;
+  case TUI_FRAME_LOOP_DONE:
+    break;
+  }
+
+  if (pushed_background)
+    tui_pop_background();
+  if (L.owns_frame && L.frame)
+    tui_destroy_window(L.frame);
+  tui_logview_state_close(state);
+  return status;
+}
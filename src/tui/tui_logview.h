@@ -0,0 +1,62 @@
+/*
+ * tui_logview.h - pager for large, growing log files.
+ *
+ * The file is mapped read-only instead of read: opening a multi-GB log costs
+ * one mmap() and the first screen is drawn before the rest of the file has
+ * been looked at. A background thread indexes line starts as it scans, so
+ * the line count and the reachable end of the file grow while the user is
+ * already paging; with `follow`, inotify (a 500 ms stat poll elsewhere)
+ * extends the index as the file grows, and `tail -f` style follow mode keeps
+ * the newest lines on screen.
+ *
+ * Same shape as tui_show_menu and tui_show_table: one entry point, one
+ * config struct in. The implementation is split into a pure model layer
+ * (tui_logview_model.c, no ncurses) and a view+controller layer
+ * (tui_logview.c).
+ *
+ * Not available on Windows, where tui_show_logview() returns
+ * TUI_LOGVIEW_UNSUPPORTED.
+ */
+#pragma once
+
+#include <stdbool.h>
+
+#include "../core/error.h"
+#include "../core/types.h"
+
+typedef struct tui_window tui_window_t; /* defined in tui.h */
+
+typedef struct {
+  const char *path;  /* file to page through */
+  const char *title; /* optional; defaults to the file's base name */
+  bool follow;       /* keep indexing as the file grows; start at the end */
+  int frame_height;  /* requested frame height; 0 uses the current/default */
+  int frame_width;   /* requested frame width; 0 uses the current/default */
+  int max_fps;       /* repaint cap for key bursts and growth; 0 uses 60 */
+} tui_logview_config_t;
+
+typedef enum {
+  TUI_LOGVIEW_OK = 0, /* closed with Esc/q */
+  TUI_LOGVIEW_INTERRUPTED,
+  TUI_LOGVIEW_TOO_SMALL,
+  TUI_LOGVIEW_INVALID_ARG,
+  TUI_LOGVIEW_IO_ERROR, /* open, stat or mmap failed; see errno */
+  TUI_LOGVIEW_NO_MEMORY,
+  TUI_LOGVIEW_UNSUPPORTED,
+} tui_logview_status_t;
+
+/* Page through config->path until Esc/q.
+ *
+ * Keys: Up/Down/j/k scroll a line, PgUp/PgDn/Space a page, g/G jump to the
+ * start/end (G also resumes follow mode), `/` searches forward for a byte
+ * string and n/N repeat it forward/backward, w toggles line wrapping.
+ *
+ * If window == NULL, the viewer owns its frame and recreates it on
+ * KEY_RESIZE; otherwise it draws into the caller's window, restored to
+ * frame_height/frame_width when those are set.
+ *
+ * The mapping is shared with the file: a log truncated in place (copytruncate
+ * rotation) is reloaded when the viewer notices, but a read racing the
+ * truncation itself can still fault, as with any mmap-based reader. */
+APP_NODISCARD tui_logview_status_t
+tui_show_logview(tui_window_t *window, const tui_logview_config_t *config);
@@ -0,0 +1,121 @@
+/*
+ * tui_logview_internal.h - exposed for unit tests and for the view/controller
+ * layer in tui_logview.c. Not part of the public API.
+ *
+ * Lines are numbered from 0 in file order. Everything the UI thread reads
+ * comes from a snapshot refreshed by tui_logview_state_poll(), so the line
+ * count and the bytes behind it only change between frames.
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "tui_logview.h"
+
+typedef struct tui_logview_state tui_logview_state_t;
+
+/* One checkpoint (line start offset) is kept per this many lines; any other
+ * line is found by scanning forward from its checkpoint. */
+#define TUI_LOGVIEW_INDEX_STRIDE 64
+
+/* Bytes of one line that are formatted for display (and searched within a
+ * displayed row); longer lines are cut. */
+#define TUI_LOGVIEW_LINE_MAX 4096
+
+/* Lifecycle. Opening maps the file and starts the indexer; nothing is read
+ * on the calling thread. */
+APP_NODISCARD tui_logview_status_t tui_logview_state_open(
+    const char *path, bool follow, tui_logview_state_t **out);
+void tui_logview_state_close(tui_logview_state_t *s);
+/* Called from worker threads when the index grows or a search ends;
+ * tui_show_logview passes tui_wake. */
+typedef void (*tui_logview_notify_fn)(void);
+void tui_logview_state_set_notify(tui_logview_state_t *s,
+                                  tui_logview_notify_fn notify);
+
+/* Takes a new snapshot of the indexer's progress and publishes a finished
+ * search. Reloads the file from scratch when it was truncated. */
+void tui_logview_state_poll(tui_logview_state_t *s);
+
+typedef struct {
+  int64_t lines;    /* complete lines plus a trailing partial one */
+  uint64_t indexed; /* bytes scanned so far */
+  uint64_t size;    /* file size at the last scan */
+  bool indexing;    /* the indexer has not caught up with the file */
+  bool limited;     /* the file outgrew the mapping; the rest is not shown */
+} tui_logview_progress_t;
+tui_logview_progress_t tui_logview_state_progress(const tui_logview_state_t *s);
+
+/* Copies up to `size` bytes of line `n`, without its newline (or a trailing
+ * CR), into buf and sets *len to the count copied. Returns false past the
+ * last line, or when the file shrank beneath the mapping. */
+bool tui_logview_state_line(const tui_logview_state_t *s, int64_t n,
+                            char *buf, size_t size, size_t *len);
+/* Line `n` prepared for display into buf: cut at TUI_LOGVIEW_LINE_MAX bytes,
+ * tabs expanded to 8-column stops and other control bytes shown as spaces.
+ * Returns false past the last line. */
+bool tui_logview_state_format_line(const tui_logview_state_t *s, int64_t n,
+                                   char *buf, size_t size);
+/* Screen rows line `n` takes at `width` columns (1 unless wrapping). */
+int tui_logview_state_line_rows(const tui_logview_state_t *s, int64_t n,
+                                int width);
+
+/* Navigation - viewport geometry comes from the view on each call. */
+int64_t tui_logview_state_top(const tui_logview_state_t *s);
+void tui_logview_state_scroll(tui_logview_state_t *s, int64_t delta, int rows,
+                              int width);
+void tui_logview_state_page(tui_logview_state_t *s, int direction, int rows,
+                            int width);
+void tui_logview_state_home(tui_logview_state_t *s);
+void tui_logview_state_end(tui_logview_state_t *s, int rows, int width);
+/* Clamps the top line to the content and, in follow mode, pins the last
+ * line to the bottom of the viewport. Call once per frame before painting. */
+void tui_logview_state_settle(tui_logview_state_t *s, int rows, int width);
+bool tui_logview_state_following(const tui_logview_state_t *s);
+bool tui_logview_state_wrap(const tui_logview_state_t *s);
+void tui_logview_state_toggle_wrap(tui_logview_state_t *s);
+
+/* Search for `needle` (exact bytes, at most 255) on a background thread.
+ * tui_logview_state_search() looks forward from the top line itself, since a
+ * new pattern may match it; tui_logview_state_search_again() looks forward
+ * from the line after it, past the match it is showing. Both look backward
+ * (direction < 0) from the line before the top one. A new search cancels the
+ * one in flight. A match scrolls its line to the top;
+ * tui_logview_state_match_line() reports it. */
+typedef enum {
+  TUI_LOGVIEW_SEARCH_IDLE = 0,
+  TUI_LOGVIEW_SEARCH_RUNNING,
+  TUI_LOGVIEW_SEARCH_FOUND,
+  TUI_LOGVIEW_SEARCH_NOT_FOUND,
+} tui_logview_search_t;
+
+bool tui_logview_state_search(tui_logview_state_t *s, const char *needle,
+                              int direction);
+/* Repeats the last search; false when there is none. */
+bool tui_logview_state_search_again(tui_logview_state_t *s, int direction);
+tui_logview_search_t tui_logview_state_search_status(
+    const tui_logview_state_t *s);
+const char *tui_logview_state_needle(const tui_logview_state_t *s);
+int64_t tui_logview_state_match_line(const tui_logview_state_t *s);
+/* Work is in flight (indexing or a search); poll when notified. */
+bool tui_logview_state_pending(const tui_logview_state_t *s);
+
+/* Offset of the first (last) occurrence of needle in hay, or SIZE_MAX.
+ * Scans 16 candidate positions per step with SSE2 or NEON. */
+size_t tui_logview_find(const char *hay, size_t hay_len, const char *needle,
+                        size_t needle_len);
+size_t tui_logview_find_last(const char *hay, size_t hay_len,
+                             const char *needle, size_t needle_len);
+
+/* Damage since the view last painted: `full` repaints everything, `meta`
+ * only the line count / progress line. */
+typedef struct {
+  bool full;
+  bool meta;
+} tui_logview_damage_t;
+
+tui_logview_damage_t tui_logview_state_take_damage(tui_logview_state_t *s);
+void tui_logview_state_invalidate(tui_logview_state_t *s);
+bool tui_logview_state_has_damage(const tui_logview_state_t *s);
@@ -0,0 +1,1134 @@
+/*
+ * tui_logview_model.c - pure-data model for tui_logview.
+ *
+ * No ncurses; unit-testable. The file is mapped read-only, with room to
+ * grow: on 64-bit hosts the mapping reserves address space well past the
+ * current size, so a growing file is followed without remapping. Only bytes
+ * below the size last seen by fstat() are touched.
+ *
+ * The mapping is shared, so a file cut short by another process turns reads
+ * past its new end into SIGBUS. Every read of the mapping runs under a
+ * per-thread guard that turns that fault into a failed read: the indexer
+ * reports it as a truncation (the view reloads), a search as no match, and
+ * a line read as a missing line. Lines leave the model as copies, never as
+ * pointers into the mapping.
+ *
+ * An indexer thread scans the mapping in batches, keeping one checkpoint
+ * (line start) per TUI_LOGVIEW_INDEX_STRIDE lines in fixed-size chunks that
+ * never move once written, and publishes its progress under a mutex. The
+ * UI thread copies that progress into a snapshot in tui_logview_state_poll()
+ * and reads checkpoints below the snapshot's count without locking. With
+ * `follow`, the indexer then sleeps on inotify (a stat poll elsewhere) and
+ * extends the index as the file grows.
+ *
+ * Searches run on their own thread over the indexed bytes, 16 candidate
+ * offsets per step (tui_logview_find), and turn the match offset into a line
+ * number through the checkpoints.
+ */
+#include <errno.h>
+#include <limits.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <setjmp.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define LOG_POSIX 1
+#else
+#define LOG_POSIX 0
+#endif
+#if defined(__linux__)
+#include <sys/inotify.h>
+#define LOG_INOTIFY 1
+#else
+#define LOG_INOTIFY 0
+#endif
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+#include "../ui/text_layout.h"
+#include "tui_logview_internal.h"
+
+#define LOG_CHUNK_ENTRIES 65536 /* checkpoints per index chunk */
+#define LOG_CHUNKS 16384        /* 2^30 checkpoints, 2^36 lines */
+#define LOG_INDEX_BATCH (4u << 20)
+#define LOG_SEARCH_BLOCK (1u << 20)
+#define LOG_STAT_POLL_MS 500 /* follow interval without inotify */
+#define LOG_NEEDLE_MAX 256
+#define LOG_TAB_STOP 8
+
+/* Indexer progress, published under `lock` and copied into `snap`. */
+typedef struct {
+  uint64_t indexed;    /* bytes scanned */
+  uint64_t size;       /* file size at the last scan */
+  int64_t newlines;    /* complete lines in [0, indexed) */
+  uint64_t last_start; /* start of the line after the last newline */
+  int64_t checkpoints; /* valid index entries */
+  bool caught_up;
+  bool limited;
+  bool truncated;
+} log_progress_t;
+
+typedef struct {
+  const char *map;
+  uint64_t *const *chunks;
+  int64_t checkpoints;
+  uint64_t lo; /* first byte a match may start at */
+  uint64_t hi; /* end of the bytes a match must fit in */
+  char needle[LOG_NEEDLE_MAX];
+  size_t needle_len;
+  int direction;
+  tui_logview_notify_fn notify;
+  int64_t line; /* result; -1 = not found */
+  atomic_bool cancel;
+  atomic_bool done;
+#if LOG_POSIX
+  pthread_t thread;
+  bool started;
+#endif
+} log_search_job_t;
+
+struct tui_logview_state {
+  char *path;
+  bool follow;
+  int fd;
+  const char *map;
+  size_t reserve; /* mapped length */
+  _Atomic(tui_logview_notify_fn) notify;
+
+  /* Indexer. scan_* are private to the indexer thread. */
+  uint64_t *chunks[LOG_CHUNKS];
+  atomic_bool stop;
+  uint64_t scan_end;
+  int64_t scan_newlines;
+  uint64_t scan_last_start;
+  log_progress_t published;
+#if LOG_POSIX
+  pthread_mutex_t lock;
+  pthread_t indexer;
+  bool indexer_started;
+  int stop_pipe[2];
+  int inotify_fd;
+#endif
+
+  /* UI thread. */
+  log_progress_t snap;
+  int64_t top;
+  int viewport_rows;
+  bool following;
+  bool wrap;
+  char needle[LOG_NEEDLE_MAX];
+  size_t needle_len;
+  tui_logview_search_t search;
+  int64_t match_line;
+  log_search_job_t *job;
+  bool damage_full;
+  bool damage_meta;
+  int64_t painted_top;
+};
+
+/* ---- substring search ---------------------------------------------------- */
+
+size_t tui_logview_find(const char *hay, size_t hay_len, const char *needle,
+                        size_t needle_len) {
+  if (!hay || !needle || needle_len == 0 || needle_len > hay_len)
+    return SIZE_MAX;
+  const size_t last = hay_len - needle_len; /* last candidate start */
+  size_t i = 0;
+  if (needle_len > 1) {
+    /* Candidates must match the needle's first and last byte; one compare
+     * of each across 16 offsets rejects almost every position, and only the
+     * survivors get a full memcmp. */
+#if defined(__SSE2__)
+    const __m128i first = _mm_set1_epi8(needle[0]);
+    const __m128i final = _mm_set1_epi8(needle[needle_len - 1]);
+    for (; i + 15 <= last; i += 16) {
+      const __m128i a = _mm_loadu_si128((const __m128i *)(hay + i));
+      const __m128i b =
+          _mm_loadu_si128((const __m128i *)(hay + i + needle_len - 1));
+      unsigned mask = (unsigned)_mm_movemask_epi8(
+          _mm_and_si128(_mm_cmpeq_epi8(a, first), _mm_cmpeq_epi8(b, final)));
+      while (mask) {
+        const unsigned bit = (unsigned)__builtin_ctz(mask);
+        if (memcmp(hay + i + bit + 1, needle + 1, needle_len - 2) == 0)
+          return i + bit;
+        mask &= mask - 1;
+      }
+    }
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+    const uint8x16_t first = vdupq_n_u8((uint8_t)needle[0]);
+    const uint8x16_t final = vdupq_n_u8((uint8_t)needle[needle_len - 1]);
+    for (; i + 15 <= last; i += 16) {
+      const uint8x16_t a = vld1q_u8((const uint8_t *)hay + i);
+      const uint8x16_t b = vld1q_u8((const uint8_t *)hay + i + needle_len - 1);
+      if (vmaxvq_u8(vandq_u8(vceqq_u8(a, first), vceqq_u8(b, final))) == 0)
+        continue;
+      for (size_t k = i; k < i + 16; k++) {
+        if (hay[k] == needle[0] && memcmp(hay + k, needle, needle_len) == 0)
+          return k;
+      }
+    }
+#endif
+  }
+  /* Tail, or the whole scan without SIMD: memchr for the first byte. */
+  while (i <= last) {
+    const char *p = memchr(hay + i, needle[0], last - i + 1);
+    if (!p)
+      return SIZE_MAX;
+    i = (size_t)(p - hay);
+    if (memcmp(p, needle, needle_len) == 0)
+      return i;
+    i++;
+  }
+  return SIZE_MAX;
+}
+
+size_t tui_logview_find_last(const char *hay, size_t hay_len,
+                             const char *needle, size_t needle_len) {
+  size_t found = SIZE_MAX;
+  size_t i = 0;
+  for (;;) {
+    const size_t at = tui_logview_find(hay + i, hay_len - i, needle,
+                                       needle_len);
+    if (at == SIZE_MAX)
+      return found;
+    found = i + at;
+    i = found + 1;
+  }
+}
+
+/* ---- SIGBUS guard -------------------------------------------------------- */
+
+#if LOG_POSIX
+/* Set while this thread reads the mapping; the handler jumps back to it. */
+static thread_local sigjmp_buf *log_bus_jmp;
+static struct sigaction log_bus_previous;
+static pthread_once_t log_bus_once = PTHREAD_ONCE_INIT;
+
+static void log_bus_handler(int sig, siginfo_t *info, void *context) {
+  sigjmp_buf *const bus = log_bus_jmp;
+  if (bus)
+    siglongjmp(*bus, 1);
+  /* Not a guarded read: hand the signal to whoever had it before. */
+  if (log_bus_previous.sa_flags & SA_SIGINFO) {
+    log_bus_previous.sa_sigaction(sig, info, context);
+  } else if (log_bus_previous.sa_handler != SIG_DFL &&
+             log_bus_previous.sa_handler != SIG_IGN) {
+    log_bus_previous.sa_handler(sig);
+  } else {
+    struct sigaction dfl = {.sa_handler = SIG_DFL};
+    sigemptyset(&dfl.sa_mask);
+    (void)sigaction(SIGBUS, &dfl, NULL);
+    raise(sig);
+  }
+}
+
+/* Installed once, before the first mapping, and left in place. */
+static void log_bus_install(void) {
+  struct sigaction sa = {.sa_sigaction = log_bus_handler,
+                         .sa_flags = SA_SIGINFO};
+  sigemptyset(&sa.sa_mask);
+  (void)sigaction(SIGBUS, &sa, &log_bus_previous);
+}
+
+/* Runs fn(arg), turning a SIGBUS it takes into a false return. The mask
+ * is not saved on every call; the jump out of the handler leaves SIGBUS
+ * blocked, so only the fault path unblocks it again. */
+static bool log_guarded(void (*fn)(void *), void *arg) {
+  sigjmp_buf bus;
+  if (sigsetjmp(bus, 0) != 0) {
+    log_bus_jmp = NULL;
+    sigset_t set;
+    sigemptyset(&set);
+    sigaddset(&set, SIGBUS);
+    pthread_sigmask(SIG_UNBLOCK, &set, NULL);
+    return false;
+  }
+  log_bus_jmp = &bus;
+  fn(arg);
+  log_bus_jmp = NULL;
+  return true;
+}
+#else
+static bool log_guarded(void (*fn)(void *), void *arg) {
+  fn(arg);
+  return true;
+}
+#endif
+
+/* ---- line index ---------------------------------------------------------- */
+
+static uint64_t log_checkpoint(uint64_t *const *chunks, int64_t k) {
+  return chunks[k / LOG_CHUNK_ENTRIES][k % LOG_CHUNK_ENTRIES];
+}
+
+static int64_t log_line_count(const log_progress_t *p) {
+  return p->newlines + (p->indexed > p->last_start ? 1 : 0);
+}
+
+/* Start offset of line n (0 <= n <= line count) in the snapshot. */
+static uint64_t log_line_start(const struct tui_logview_state *s, int64_t n) {
+  if (n >= log_line_count(&s->snap))
+    return s->snap.indexed;
+  const int64_t k = n / TUI_LOGVIEW_INDEX_STRIDE;
+  const char *p = s->map + log_checkpoint(s->chunks, k);
+  const char *end = s->map + s->snap.indexed;
+  for (int64_t skip = n % TUI_LOGVIEW_INDEX_STRIDE; skip > 0; skip--) {
+    const char *nl = memchr(p, '\n', (size_t)(end - p));
+    if (!nl)
+      return s->snap.indexed;
+    p = nl + 1;
+  }
+  return (uint64_t)(p - s->map);
+}
+
+/* ---- file, indexer and search threads (POSIX) ---------------------------- */
+
+#if LOG_POSIX
+
+static bool log_store_checkpoint(struct tui_logview_state *s, int64_t k,
+                                 uint64_t offset) {
+  const int64_t chunk = k / LOG_CHUNK_ENTRIES;
+  if (chunk >= LOG_CHUNKS)
+    return false;
+  if (!s->chunks[chunk]) {
+    s->chunks[chunk] = malloc(LOG_CHUNK_ENTRIES * sizeof(uint64_t));
+    if (!s->chunks[chunk])
+      return false;
+  }
+  s->chunks[chunk][k % LOG_CHUNK_ENTRIES] = offset;
+  return true;
+}
+
+/* Scans [scan_end, end) for newlines. False when the index is full or out
+ * of memory; scanning stops at the line it could not record. */
+static bool log_index_scan(struct tui_logview_state *s, uint64_t end) {
+  const char *p = s->map + s->scan_end;
+  const char *stop = s->map + end;
+  while (p < stop) {
+    const char *nl = memchr(p, '\n', (size_t)(stop - p));
+    if (!nl)
+      break;
+    const uint64_t next = (uint64_t)(nl + 1 - s->map);
+    const int64_t line = s->scan_newlines + 1;
+    if (line % TUI_LOGVIEW_INDEX_STRIDE == 0 &&
+        !log_store_checkpoint(s, line / TUI_LOGVIEW_INDEX_STRIDE, next)) {
+      s->scan_end = (uint64_t)(nl - s->map);
+      return false;
+    }
+    s->scan_newlines = line;
+    s->scan_last_start = next;
+    p = nl + 1;
+  }
+  s->scan_end = end;
+  return true;
+}
+
+typedef struct {
+  struct tui_logview_state *s;
+  uint64_t end;
+  bool scanned;
+} log_scan_call_t;
+
+static void log_index_scan_call(void *arg) {
+  log_scan_call_t *call = arg;
+  call->scanned = log_index_scan(call->s, call->end);
+}
+
+/* Line containing byte `offset`: the last checkpoint at or before it, then
+ * the newlines in between. */
+static int64_t log_line_of(const char *map, uint64_t *const *chunks,
+                           int64_t checkpoints, uint64_t offset) {
+  int64_t lo = 0;
+  int64_t hi = checkpoints - 1;
+  while (lo < hi) {
+    const int64_t mid = lo + (hi - lo + 1) / 2;
+    if (log_checkpoint(chunks, mid) <= offset)
+      lo = mid;
+    else
+      hi = mid - 1;
+  }
+  int64_t line = lo * TUI_LOGVIEW_INDEX_STRIDE;
+  const char *p = map + log_checkpoint(chunks, lo);
+  const char *end = map + offset;
+  while (p < end) {
+    const char *nl = memchr(p, '\n', (size_t)(end - p));
+    if (!nl)
+      break;
+    line++;
+    p = nl + 1;
+  }
+  return line;
+}
+
+static void log_notify(struct tui_logview_state *s) {
+  const tui_logview_notify_fn notify = atomic_load(&s->notify);
+  if (notify)
+    notify();
+}
+
+static void log_publish(struct tui_logview_state *s, uint64_t size,
+                        bool limited, bool truncated) {
+  pthread_mutex_lock(&s->lock);
+  s->published = (log_progress_t){
+      .indexed = s->scan_end,
+      .size = size,
+      .newlines = s->scan_newlines,
+      .last_start = s->scan_last_start,
+      .checkpoints = s->scan_newlines / TUI_LOGVIEW_INDEX_STRIDE + 1,
+      .caught_up = s->scan_end >= size || limited,
+      .limited = limited,
+      .truncated = truncated,
+  };
+  pthread_mutex_unlock(&s->lock);
+  log_notify(s);
+}
+
+/* Sleeps until the file may have changed. False when asked to stop. */
+static bool log_index_wait(struct tui_logview_state *s) {
+  struct pollfd fds[2] = {{.fd = s->stop_pipe[0], .events = POLLIN},
+                          {.fd = s->inotify_fd, .events = POLLIN}};
+  const nfds_t count = s->inotify_fd >= 0 ? 2 : 1;
+  const int rc = poll(fds, count, s->inotify_fd >= 0 ? -1 : LOG_STAT_POLL_MS);
+  if (atomic_load(&s->stop) || (rc > 0 && fds[0].revents))
+    return false;
+  if (count == 2 && rc > 0 && fds[1].revents) {
+    char events[4096];
+    while (read(s->inotify_fd, events, sizeof(events)) > 0)
+      ;
+  }
+  return true;
+}
+
+static void *log_index_thread(void *arg) {
+  struct tui_logview_state *s = arg;
+  bool limited = false;
+  uint64_t published_size = UINT64_MAX;
+  for (;;) {
+    struct stat st;
+    if (fstat(s->fd, &st) != 0)
+      break;
+    uint64_t size = (uint64_t)st.st_size;
+    if (size < s->scan_end) {
+      log_publish(s, size, limited, true);
+      break;
+    }
+    if (size > s->reserve) {
+      size = s->reserve;
+      limited = true;
+    }
+    while (s->scan_end < size && !atomic_load(&s->stop)) {
+      const uint64_t end = size - s->scan_end > LOG_INDEX_BATCH
+                               ? s->scan_end + LOG_INDEX_BATCH
+                               : size;
+      log_scan_call_t call = {.s = s, .end = end};
+      if (!log_guarded(log_index_scan_call, &call)) {
+        /* The file was cut short beneath the mapping mid-scan. */
+        log_publish(s, s->scan_end, limited, true);
+        return NULL;
+      }
+      if (!call.scanned) {
+        limited = true;
+        size = s->scan_end;
+      }
+      log_publish(s, size, limited, false);
+      published_size = size;
+    }
+    if (atomic_load(&s->stop))
+      break;
+    if (published_size != size) {
+      log_publish(s, size, limited, false);
+      published_size = size;
+    }
+    if (!s->follow || limited || !log_index_wait(s))
+      break;
+  }
+  return NULL;
+}
+
+static void log_file_close(struct tui_logview_state *s) {
+  if (s->map && s->reserve)
+    munmap((void *)s->map, s->reserve);
+  s->map = NULL;
+  s->reserve = 0;
+  if (s->inotify_fd >= 0)
+    close(s->inotify_fd);
+  s->inotify_fd = -1;
+  if (s->fd >= 0)
+    close(s->fd);
+  s->fd = -1;
+}
+
+/* Room to grow without remapping: the larger of twice the file and 64 GiB
+ * on 64-bit hosts, 256 MiB past the end on 32-bit ones. A file that is not
+ * followed is mapped as it is. */
+static size_t log_reserve_for(uint64_t size, bool follow) {
+#if SIZE_MAX > 0xffffffffu
+  const uint64_t floor = UINT64_C(1) << 36;
+  uint64_t want = follow ? (size > floor / 2 ? size * 2 : floor) : size;
+  if (want > SIZE_MAX / 2)
+    want = SIZE_MAX / 2;
+  return (size_t)want;
+#else
+  const uint64_t cap = SIZE_MAX / 4;
+  const uint64_t want = follow ? size + (UINT64_C(256) << 20) : size;
+  return (size_t)(want < cap ? want : cap);
+#endif
+}
+
+static tui_logview_status_t log_file_open(struct tui_logview_state *s) {
+  s->fd = open(s->path, O_RDONLY | O_CLOEXEC);
+  if (s->fd < 0)
+    return TUI_LOGVIEW_IO_ERROR;
+  struct stat st;
+  if (fstat(s->fd, &st) != 0) {
+    const int saved = errno;
+    log_file_close(s);
+    errno = saved;
+    return TUI_LOGVIEW_IO_ERROR;
+  }
+  if (!S_ISREG(st.st_mode)) {
+    /* Pipes and devices cannot be mapped. */
+    const int reason = S_ISDIR(st.st_mode) ? EISDIR : EINVAL;
+    log_file_close(s);
+    errno = reason;
+    return TUI_LOGVIEW_IO_ERROR;
+  }
+  s->reserve = log_reserve_for((uint64_t)st.st_size, s->follow);
+  if (s->reserve > 0) {
+    (void)pthread_once(&log_bus_once, log_bus_install);
+    void *map =
+        mmap(NULL, s->reserve, PROT_READ, MAP_SHARED, s->fd, 0);
+    if (map == MAP_FAILED) {
+      const int saved = errno;
+      s->reserve = 0;
+      log_file_close(s);
+      errno = saved;
+      return TUI_LOGVIEW_IO_ERROR;
+    }
+    s->map = map;
+  }
+#if LOG_INOTIFY
+  if (s->follow) {
+    s->inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (s->inotify_fd >= 0 &&
+        inotify_add_watch(s->inotify_fd, s->path,
+                          IN_MODIFY | IN_ATTRIB | IN_CLOSE_WRITE) < 0) {
+      close(s->inotify_fd);
+      s->inotify_fd = -1; /* fall back to polling */
+    }
+  }
+#endif
+  return TUI_LOGVIEW_OK;
+}
+
+static bool log_indexer_start(struct tui_logview_state *s) {
+  atomic_store(&s->stop, false);
+  s->indexer_started =
+      pthread_create(&s->indexer, NULL, log_index_thread, s) == 0;
+  return s->indexer_started;
+}
+
+static void log_indexer_stop(struct tui_logview_state *s) {
+  if (!s->indexer_started)
+    return;
+  atomic_store(&s->stop, true);
+  const char byte = 1;
+  if (write(s->stop_pipe[1], &byte, 1) < 0) {
+    /* the stop flag is still checked between batches */
+  }
+  pthread_join(s->indexer, NULL);
+  s->indexer_started = false;
+  char drain[16];
+  while (read(s->stop_pipe[0], drain, sizeof(drain)) > 0)
+    ;
+}
+
+/* Offset of the match nearest the search start, or UINT64_MAX. */
+static uint64_t log_search_scan(const log_search_job_t *job) {
+  const size_t n = job->needle_len;
+  uint64_t found = UINT64_MAX;
+  if (job->direction > 0) {
+    for (uint64_t b = job->lo; b + n <= job->hi && found == UINT64_MAX;
+         b += LOG_SEARCH_BLOCK) {
+      if (atomic_load_explicit(&job->cancel, memory_order_relaxed))
+        break;
+      uint64_t end = b + LOG_SEARCH_BLOCK + n - 1;
+      if (end > job->hi)
+        end = job->hi;
+      const size_t at = tui_logview_find(job->map + b, (size_t)(end - b),
+                                         job->needle, n);
+      if (at != SIZE_MAX)
+        found = b + at;
+    }
+  } else {
+    /* Blocks walk backwards; each covers match starts in [b, e). */
+    for (uint64_t e = job->hi; e > job->lo && found == UINT64_MAX;) {
+      if (atomic_load_explicit(&job->cancel, memory_order_relaxed))
+        break;
+      const uint64_t b =
+          e - job->lo > LOG_SEARCH_BLOCK ? e - LOG_SEARCH_BLOCK : job->lo;
+      uint64_t end = e + n - 1;
+      if (end > job->hi)
+        end = job->hi;
+      const size_t at = tui_logview_find_last(job->map + b, (size_t)(end - b),
+                                              job->needle, n);
+      if (at != SIZE_MAX)
+        found = b + at;
+      e = b;
+    }
+  }
+  return found;
+}
+
+static void log_search_find(void *arg) {
+  log_search_job_t *job = arg;
+  const uint64_t found = log_search_scan(job);
+  if (found != UINT64_MAX)
+    job->line = log_line_of(job->map, job->chunks, job->checkpoints, found);
+}
+
+static void log_search_run(log_search_job_t *job) {
+  /* A file cut short beneath the mapping leaves job->line at -1. */
+  (void)log_guarded(log_search_find, job);
+  atomic_store_explicit(&job->done, true, memory_order_release);
+  if (job->notify)
+    job->notify();
+}
+
+static void *log_search_thread(void *arg) {
+  log_search_run(arg);
+  return NULL;
+}
+
+static bool log_search_start(log_search_job_t *job) {
+  job->started = pthread_create(&job->thread, NULL, log_search_thread, job) ==
+                 0;
+  if (!job->started)
+    log_search_run(job);
+  return true;
+}
+
+static void log_search_join(log_search_job_t *job) {
+  if (job->started)
+    pthread_join(job->thread, NULL);
+  job->started = false;
+}
+
+#else /* !LOG_POSIX */
+
+static void log_file_close(struct tui_logview_state *s) { (void)s; }
+static void log_indexer_stop(struct tui_logview_state *s) { (void)s; }
+static bool log_search_start(log_search_job_t *job) {
+  (void)job;
+  return false;
+}
+static void log_search_join(log_search_job_t *job) { (void)job; }
+
+#endif
+
+/* ---- lifecycle ----------------------------------------------------------- */
+
+static void log_search_stop(struct tui_logview_state *s) {
+  if (!s->job)
+    return;
+  atomic_store(&s->job->cancel, true);
+  log_search_join(s->job);
+  free(s->job);
+  s->job = NULL;
+}
+
+static void log_index_reset(struct tui_logview_state *s) {
+  for (int i = 0; i < LOG_CHUNKS && s->chunks[i]; i++) {
+    free(s->chunks[i]);
+    s->chunks[i] = NULL;
+  }
+  s->scan_end = 0;
+  s->scan_newlines = 0;
+  s->scan_last_start = 0;
+  s->published = (log_progress_t){.checkpoints = 1};
+  s->snap = s->published;
+}
+
+#if LOG_POSIX
+/* Maps the file and starts indexing it from scratch. */
+static tui_logview_status_t log_load(struct tui_logview_state *s) {
+  log_index_reset(s);
+  if (!log_store_checkpoint(s, 0, 0))
+    return TUI_LOGVIEW_NO_MEMORY;
+  const tui_logview_status_t st = log_file_open(s);
+  if (st != TUI_LOGVIEW_OK)
+    return st;
+  return log_indexer_start(s) ? TUI_LOGVIEW_OK : TUI_LOGVIEW_NO_MEMORY;
+}
+#endif
+
+tui_logview_status_t tui_logview_state_open(const char *path, bool follow,
+                                            tui_logview_state_t **out) {
+  if (!out)
+    return TUI_LOGVIEW_INVALID_ARG;
+  *out = NULL;
+  if (!path || !*path)
+    return TUI_LOGVIEW_INVALID_ARG;
+#if LOG_POSIX
+  struct tui_logview_state *s = calloc(1, sizeof(*s));
+  if (!s)
+    return TUI_LOGVIEW_NO_MEMORY;
+  s->path = strdup(path);
+  s->follow = follow;
+  s->following = follow;
+  s->fd = -1;
+  s->inotify_fd = -1;
+  s->stop_pipe[0] = s->stop_pipe[1] = -1;
+  s->match_line = -1;
+  s->damage_full = true;
+  s->painted_top = -1;
+  atomic_init(&s->notify, NULL);
+  atomic_init(&s->stop, false);
+  pthread_mutex_init(&s->lock, NULL);
+  if (!s->path || pipe(s->stop_pipe) != 0) {
+    const tui_logview_status_t st =
+        s->path ? TUI_LOGVIEW_IO_ERROR : TUI_LOGVIEW_NO_MEMORY;
+    tui_logview_state_close(s);
+    return st;
+  }
+  (void)fcntl(s->stop_pipe[0], F_SETFL, O_NONBLOCK);
+  (void)fcntl(s->stop_pipe[0], F_SETFD, FD_CLOEXEC);
+  (void)fcntl(s->stop_pipe[1], F_SETFD, FD_CLOEXEC);
+  const tui_logview_status_t st = log_load(s);
+  if (st != TUI_LOGVIEW_OK) {
+    const int saved = errno;
+    tui_logview_state_close(s);
+    errno = saved;
+    return st;
+  }
+  *out = s;
+  return TUI_LOGVIEW_OK;
+#else
+  (void)follow;
+  return TUI_LOGVIEW_UNSUPPORTED;
+#endif
+}
+
+void tui_logview_state_close(tui_logview_state_t *s) {
+  if (!s)
+    return;
+  log_search_stop(s);
+  log_indexer_stop(s);
+  log_file_close(s);
+  log_index_reset(s);
+#if LOG_POSIX
+  for (int i = 0; i < 2; i++) {
+    if (s->stop_pipe[i] >= 0)
+      close(s->stop_pipe[i]);
+  }
+  pthread_mutex_destroy(&s->lock);
+#endif
+  free(s->path);
+  free(s);
+}
+
+void tui_logview_state_set_notify(tui_logview_state_t *s,
+                                  tui_logview_notify_fn notify) {
+  if (s)
+    atomic_store(&s->notify, notify);
+}
+
+/* ---- snapshot ------------------------------------------------------------ */
+
+static void log_search_publish(struct tui_logview_state *s) {
+  log_search_job_t *job = s->job;
+  if (!job || !atomic_load_explicit(&job->done, memory_order_acquire))
+    return;
+  log_search_join(job);
+  if (job->line >= 0) {
+    s->search = TUI_LOGVIEW_SEARCH_FOUND;
+    s->match_line = job->line;
+    s->top = job->line;
+    s->following = false;
+    s->damage_full = true;
+  } else {
+    s->search = TUI_LOGVIEW_SEARCH_NOT_FOUND;
+    s->damage_meta = true;
+  }
+  free(job);
+  s->job = NULL;
+}
+
+void tui_logview_state_poll(tui_logview_state_t *s) {
+  if (!s)
+    return;
+#if LOG_POSIX
+  const log_progress_t old = s->snap;
+  pthread_mutex_lock(&s->lock);
+  s->snap = s->published;
+  pthread_mutex_unlock(&s->lock);
+  if (s->snap.truncated) {
+    /* Rotated in place: start over on whatever the file holds now. */
+    log_search_stop(s);
+    log_indexer_stop(s);
+    log_file_close(s);
+    s->search = TUI_LOGVIEW_SEARCH_IDLE;
+    s->match_line = -1;
+    s->top = 0;
+    s->damage_full = true;
+    if (log_load(s) != TUI_LOGVIEW_OK)
+      log_index_reset(s);
+    return;
+  }
+  const int64_t old_lines = log_line_count(&old);
+  if (log_line_count(&s->snap) != old_lines ||
+      s->snap.caught_up != old.caught_up || s->snap.limited != old.limited)
+    s->damage_meta = true;
+  /* New bytes reach the screen when the old end was visible: the last line
+   * may have grown, and new lines fill the space below it. */
+  if (s->snap.indexed != old.indexed &&
+      s->top + s->viewport_rows >= old_lines)
+    s->damage_full = true;
+#endif
+  log_search_publish(s);
+}
+
+tui_logview_progress_t tui_logview_state_progress(
+    const tui_logview_state_t *s) {
+  tui_logview_progress_t p = {0};
+  if (!s)
+    return p;
+  p.lines = log_line_count(&s->snap);
+  p.indexed = s->snap.indexed;
+  p.size = s->snap.size;
+  p.indexing = !s->snap.caught_up;
+  p.limited = s->snap.limited;
+  return p;
+}
+
+bool tui_logview_state_pending(const tui_logview_state_t *s) {
+  return s && (!s->snap.caught_up || s->job);
+}
+
+/* ---- lines --------------------------------------------------------------- */
+
+typedef struct {
+  const struct tui_logview_state *s;
+  int64_t n;
+  char *buf; /* NULL for just the start */
+  size_t size;
+  uint64_t start;
+  size_t len;
+} log_line_read_t;
+
+/* Start of line n and up to `size` of its bytes, without the newline or a
+ * trailing CR. Reads the mapping, so it runs under log_guarded(). */
+static void log_read_line(void *arg) {
+  log_line_read_t *req = arg;
+  const struct tui_logview_state *s = req->s;
+  req->start = log_line_start(s, req->n);
+  if (!req->buf)
+    return;
+  const char *p = s->map + req->start;
+  const size_t avail = (size_t)(s->snap.indexed - req->start);
+  const char *nl = memchr(p, '\n', avail);
+  size_t length = nl ? (size_t)(nl - p) : avail;
+  if (length > 0 && p[length - 1] == '\r')
+    length--;
+  req->len = length < req->size ? length : req->size;
+  memcpy(req->buf, p, req->len);
+}
+
+bool tui_logview_state_line(const tui_logview_state_t *s, int64_t n,
+                            char *buf, size_t size, size_t *len) {
+  if (!s || !buf || !len || n < 0 || n >= log_line_count(&s->snap))
+    return false;
+  log_line_read_t req = {.s = s, .n = n, .buf = buf, .size = size};
+  if (!log_guarded(log_read_line, &req))
+    return false;
+  *len = req.len;
+  return true;
+}
+
+bool tui_logview_state_format_line(const tui_logview_state_t *s, int64_t n,
+                                   char *buf, size_t size) {
+  char bytes[TUI_LOGVIEW_LINE_MAX];
+  size_t len = 0;
+  if (!buf || size == 0 ||
+      !tui_logview_state_line(s, n, bytes, sizeof(bytes), &len))
+    return false;
+  size_t out = 0;
+  for (size_t i = 0; i < len && out + 1 < size; i++) {
+    const unsigned char c = (unsigned char)bytes[i];
+    if (c == '\t') {
+      do
+        buf[out++] = ' ';
+      while (out % LOG_TAB_STOP && out + 1 < size);
+    } else {
+      buf[out++] = c < 0x20 || c == 0x7f ? ' ' : (char)c;
+    }
+  }
+  buf[out] = '\0';
+  return true;
+}
+
+typedef struct {
+  int width;
+  int rows;
+} log_row_count_t;
+
+/* Words wider than the row come back from the wrapper as one span; the view
+ * cuts them into row-sized pieces, so count those pieces here too. */
+static bool log_count_row(void *user, const char *bytes, size_t byte_count,
+                          int columns) {
+  log_row_count_t *count = user;
+  if (columns <= count->width) {
+    count->rows++;
+    return true;
+  }
+  while (byte_count > 0) {
+    int cols = 0;
+    size_t take = app_text_truncate_utf8_columns(bytes, count->width, &cols);
+    if (take == 0 || take > byte_count)
+      take = byte_count;
+    count->rows++;
+    bytes += take;
+    byte_count -= take;
+  }
+  return true;
+}
+
+int tui_logview_state_line_rows(const tui_logview_state_t *s, int64_t n,
+                                int width) {
+  if (!s || !s->wrap || width <= 0)
+    return 1;
+  char buf[TUI_LOGVIEW_LINE_MAX + LOG_TAB_STOP + 1];
+  if (!tui_logview_state_format_line(s, n, buf, sizeof(buf)))
+    return 1;
+  log_row_count_t count = {.width = width, .rows = 0};
+  app_text_wrap_utf8(buf, width, 0, 0, log_count_row, &count);
+  return count.rows > 0 ? count.rows : 1;
+}
+
+/* ---- navigation ---------------------------------------------------------- */
+
+int64_t tui_logview_state_top(const tui_logview_state_t *s) {
+  return s ? s->top : 0;
+}
+
+/* Topmost line that still leaves the last line at the bottom. */
+static int64_t log_last_top(const struct tui_logview_state *s, int rows,
+                            int width) {
+  const int64_t lines = log_line_count(&s->snap);
+  if (lines == 0)
+    return 0;
+  if (!s->wrap)
+    return lines > rows ? lines - rows : 0;
+  int used = 0;
+  int64_t n = lines - 1;
+  for (; n >= 0; n--) {
+    used += tui_logview_state_line_rows(s, n, width);
+    if (used > rows)
+      break;
+  }
+  return n + 1 < lines ? n + 1 : lines - 1;
+}
+
+static void log_set_top(struct tui_logview_state *s, int64_t top, int rows,
+                        int width) {
+  const int64_t max_top = log_last_top(s, rows, width);
+  s->top = top < 0 ? 0 : top > max_top ? max_top : top;
+}
+
+void tui_logview_state_scroll(tui_logview_state_t *s, int64_t delta, int rows,
+                              int width) {
+  if (!s)
+    return;
+  if (delta < 0)
+    s->following = false;
+  log_set_top(s, s->top + delta, rows, width);
+}
+
+void tui_logview_state_page(tui_logview_state_t *s, int direction, int rows,
+                            int width) {
+  if (!s)
+    return;
+  const int64_t lines = log_line_count(&s->snap);
+  int used = 0;
+  int64_t n = s->top;
+  if (direction > 0) {
+    /* Past every line that was fully on screen. */
+    while (n < lines) {
+      used += tui_logview_state_line_rows(s, n, width);
+      if (used > rows)
+        break;
+      n++;
+    }
+    log_set_top(s, n > s->top ? n : s->top + 1, rows, width);
+  } else {
+    s->following = false;
+    while (n > 0) {
+      used += tui_logview_state_line_rows(s, n - 1, width);
+      if (used > rows)
+        break;
+      n--;
+    }
+    log_set_top(s, n < s->top ? n : s->top - 1, rows, width);
+  }
+}
+
+void tui_logview_state_home(tui_logview_state_t *s) {
+  if (!s)
+    return;
+  s->top = 0;
+  s->following = false;
+}
+
+void tui_logview_state_end(tui_logview_state_t *s, int rows, int width) {
+  if (!s)
+    return;
+  s->top = log_last_top(s, rows, width);
+  s->following = s->follow;
+}
+
+void tui_logview_state_settle(tui_logview_state_t *s, int rows, int width) {
+  if (!s)
+    return;
+  s->viewport_rows = rows;
+  if (s->following)
+    s->top = log_last_top(s, rows, width);
+  else
+    log_set_top(s, s->top, rows, width);
+}
+
+bool tui_logview_state_following(const tui_logview_state_t *s) {
+  return s && s->following;
+}
+
+bool tui_logview_state_wrap(const tui_logview_state_t *s) {
+  return s && s->wrap;
+}
+
+void tui_logview_state_toggle_wrap(tui_logview_state_t *s) {
+  if (!s)
+    return;
+  s->wrap = !s->wrap;
+  s->damage_full = true;
+}
+
+/* ---- search -------------------------------------------------------------- */
+
+/* Searches [lo, hi) of the indexed bytes. */
+static bool log_search_begin(struct tui_logview_state *s, uint64_t lo,
+                             uint64_t hi, int direction) {
+  log_search_stop(s);
+  s->search = TUI_LOGVIEW_SEARCH_RUNNING;
+  s->damage_meta = true;
+  log_search_job_t *job = calloc(1, sizeof(*job));
+  if (!job) {
+    s->search = TUI_LOGVIEW_SEARCH_IDLE;
+    return false;
+  }
+  job->map = s->map;
+  job->chunks = s->chunks;
+  job->checkpoints = s->snap.checkpoints;
+  job->lo = lo;
+  job->hi = hi;
+  memcpy(job->needle, s->needle, s->needle_len);
+  job->needle_len = s->needle_len;
+  job->direction = direction;
+  job->notify = atomic_load(&s->notify);
+  job->line = -1;
+  atomic_init(&job->cancel, false);
+  atomic_init(&job->done, false);
+  s->job = job;
+  if (!s->map) {
+    atomic_store(&job->done, true); /* empty file */
+  } else if (!log_search_start(job)) {
+    free(job);
+    s->job = NULL;
+    s->search = TUI_LOGVIEW_SEARCH_IDLE;
+    return false;
+  }
+  log_search_publish(s); /* inline runs finish here */
+  return true;
+}
+
+static bool log_search_from(struct tui_logview_state *s, int64_t line,
+                            int direction) {
+  const int64_t lines = log_line_count(&s->snap);
+  if (line < 0)
+    line = 0;
+  if (line > lines)
+    line = lines;
+  log_line_read_t req = {.s = s, .n = line};
+  if (!log_guarded(log_read_line, &req))
+    return false;
+  return direction > 0
+             ? log_search_begin(s, req.start, s->snap.indexed, direction)
+             : log_search_begin(s, 0, req.start, direction);
+}
+
+bool tui_logview_state_search(tui_logview_state_t *s, const char *needle,
+                              int direction) {
+  if (!s || !needle || !*needle)
+    return false;
+  const size_t len = strlen(needle);
+  if (len >= LOG_NEEDLE_MAX)
+    return false;
+  memcpy(s->needle, needle, len + 1);
+  s->needle_len = len;
+  s->match_line = -1;
+  /* A new pattern may match the top line itself. */
+  return log_search_from(s, s->top, direction);
+}
+
+bool tui_logview_state_search_again(tui_logview_state_t *s, int direction) {
+  if (!s || s->needle_len == 0)
+    return false;
+  return log_search_from(s, direction > 0 ? s->top + 1 : s->top, direction);
+}
+
+tui_logview_search_t tui_logview_state_search_status(
+    const tui_logview_state_t *s) {
+  return s ? s->search : TUI_LOGVIEW_SEARCH_IDLE;
+}
+
+const char *tui_logview_state_needle(const tui_logview_state_t *s) {
+  return s && s->needle_len ? s->needle : NULL;
+}
+
+int64_t tui_logview_state_match_line(const tui_logview_state_t *s) {
+  return s ? s->match_line : -1;
+}
+
+/* ---- damage -------------------------------------------------------------- */
+
+tui_logview_damage_t tui_logview_state_take_damage(tui_logview_state_t *s) {
+  tui_logview_damage_t damage = {0};
+  if (!s)
+    return damage;
+  damage.full = s->damage_full || s->top != s->painted_top;
+  damage.meta = !damage.full && s->damage_meta;
+  s->damage_full = false;
+  s->damage_meta = false;
+  s->painted_top = s->top;
+  return damage;
+}
+
+void tui_logview_state_invalidate(tui_logview_state_t *s) {
+  if (s)
+    s->damage_full = true;
+}
+
+bool tui_logview_state_has_damage(const tui_logview_state_t *s) {
+  return s && (s->damage_full || s->damage_meta || s->top != s->painted_top);
+}
@@ -163,15 +163,77 @@ static bool tui_menu_recenter_frame(tui_menu_layout_t *L) {
   return true;
 }
 
-/* Count selectable choices (everything that is not a separator) for the
- * "N items" status cell. */
-static int tui_menu_listable_count(const tui_menu_config_t *cfg) {
-  int n = 0;
-  for (int i = 0; i < cfg->item_count; i++) {
-    if (cfg->items[i].kind != TUI_MENU_ITEM_SEPARATOR)
-      n++;
-  }
-  return n;
+/* Meta line: left label (breadcrumb, selected item's description or live
+ * search) and a right-aligned count. Clears its row first so it can be
+ * repainted on its own when only the selection changed. */
+static void tui_menu_render_meta(const tui_menu_layout_t *L,
+                                 const tui_menu_state_t *s) {
+  const tui_menu_config_t *cfg = tui_menu_state_config(s);
+  if (L->meta_y < 0 || !cfg->title)
+    return;
+  WINDOW *win = L->frame->win;
+  const bool searching = tui_menu_state_search_active(s);
+  mvwhline(win, L->meta_y, L->content_left, ' ', L->content_width);
+
+  char right[32];
+  if (searching) {
+    snprintf(right, sizeof(right), "%d matches",
+             tui_menu_state_match_count(s));
+  } else if (tui_menu_state_loading(s)) {
+    snprintf(right, sizeof(right), "loading %d…",
+             tui_menu_state_item_count(s));
+  } else {
+    snprintf(right, sizeof(right), "%d items",
+             tui_menu_state_listable_count(s));
+  }
+  const int rlen = tui_display_cols(right);
+  tui_set_color(win, TUI_COLOR_DIM);
+  mvwaddnstr(win, L->meta_y, L->content_left + L->content_width - rlen, right,
+             (int)strlen(right));
+  tui_unset_color(win, TUI_COLOR_DIM);
+
+  /* Left cell shares the row with the right-aligned count: budget the
+   * columns that remain after the count and a one-column gap. */
+  const int left_max = L->content_width - rlen - 1;
+
+  if (searching) {
+    static const char kFindPrefix[] = "find: ";
+    const int prefix_cols = (int)sizeof(kFindPrefix) - 1; /* 6 */
+    char mb[64];
+    const wchar_t *q = tui_menu_state_search_query(s);
+    size_t n = wcstombs(mb, q, sizeof(mb) - 1);
+    if (n == (size_t)-1)
+      n = 0;
+    mb[n] = 0;
+    tui_set_color(win, TUI_COLOR_DIM);
+    mvwaddnstr(win, L->meta_y, L->content_left, kFindPrefix, prefix_cols);
+    tui_unset_color(win, TUI_COLOR_DIM);
+    /* Bound the query so it cannot overrun the count or the cursor block:
+     * reserve the prefix and one column for the reverse-video cursor. */
+    int query_max = left_max - prefix_cols - 1;
+    if (query_max < 0)
+      query_max = 0;
+    tui_set_color(win, TUI_COLOR_ACCENT);
+    mvwaddnstr(win, L->meta_y, L->content_left + prefix_cols, mb, query_max);
+    const int query_cols = tui_display_cols(mb);
+    const int cursor_x = L->content_left + prefix_cols +
+                         (query_cols < query_max ? query_cols : query_max);
+    mvwaddch(win, L->meta_y, cursor_x, ' ' | A_REVERSE); /* cursor block */
+    tui_unset_color(win, TUI_COLOR_ACCENT);
+  } else {
+    /* Surface the selected item's description on the meta row; fall back to
+     * the breadcrumb subtitle when the item has none. */
+    const tui_menu_item_t sel =
+        tui_menu_state_item(s, tui_menu_state_selected_index(s));
+    const char *meta = (sel.description && sel.description[0])
+                           ? sel.description
+                           : cfg->subtitle;
+    if (meta && meta[0] && left_max > 0) {
+      tui_set_color(win, TUI_COLOR_DIM);
+      mvwaddnstr(win, L->meta_y, L->content_left, meta, left_max);
+      tui_unset_color(win, TUI_COLOR_DIM);
+    }
+  }
 }
 
 /* Centered title (bold), a meta line (left: breadcrumb or live search; right:
@@ -183,7 +245,6 @@ static void tui_menu_render_header(const tui_menu_layout_t *L,
     return;
   WINDOW *win = L->frame->win;
   const int W = L->frame->width;
-  const bool searching = tui_menu_state_search_active(s);
 
   /* Centered, bold, UPPERCASE title (dawn-style section header). ASCII-safe
    * upper preserves multibyte UTF-8; titles longer than the stack buffer
@@ -213,64 +274,7 @@ static void tui_menu_render_header(const tui_menu_layout_t *L,
   wattroff(win, A_BOLD);
   tui_unset_color(win, TUI_COLOR_TITLE);
 
-  /* Meta line: left label + right-aligned count. */
-  if (L->meta_y >= 0) {
-    char right[32];
-    if (searching) {
-      snprintf(right, sizeof(right), "%d matches",
-               tui_menu_state_visible_count(s));
-    } else {
-      snprintf(right, sizeof(right), "%d items", tui_menu_listable_count(cfg));
-    }
-    const int rlen = (int)strlen(right);
-    tui_set_color(win, TUI_COLOR_DIM);
-    mvwaddnstr(win, L->meta_y, L->content_left + L->content_width - rlen, right,
-               rlen);
-    tui_unset_color(win, TUI_COLOR_DIM);
-
-    /* Left cell shares the row with the right-aligned count: budget the
-     * columns that remain after the count and a one-column gap. */
-    const int left_max = L->content_width - rlen - 1;
-
-    if (searching) {
-      static const char kFindPrefix[] = "find: ";
-      const int prefix_cols = (int)sizeof(kFindPrefix) - 1; /* 6 */
-      char mb[64];
-      const wchar_t *q = tui_menu_state_search_query(s);
-      size_t n = wcstombs(mb, q, sizeof(mb) - 1);
-      if (n == (size_t)-1)
-        n = 0;
-      mb[n] = 0;
-      tui_set_color(win, TUI_COLOR_DIM);
-      mvwaddnstr(win, L->meta_y, L->content_left, kFindPrefix, prefix_cols);
-      tui_unset_color(win, TUI_COLOR_DIM);
-      /* Bound the query so it cannot overrun the count or the cursor block:
-       * reserve the prefix and one column for the reverse-video cursor. */
-      int query_max = left_max - prefix_cols - 1;
-      if (query_max < 0)
-        query_max = 0;
-      tui_set_color(win, TUI_COLOR_ACCENT);
-      mvwaddnstr(win, L->meta_y, L->content_left + prefix_cols, mb, query_max);
-      const int query_cols = tui_display_cols(mb);
-      const int cursor_x = L->content_left + prefix_cols +
-                           (query_cols < query_max ? query_cols : query_max);
-      mvwaddch(win, L->meta_y, cursor_x, ' ' | A_REVERSE); /* cursor block */
-      tui_unset_color(win, TUI_COLOR_ACCENT);
-    } else {
-      /* Surface the selected item's description on the meta row; fall back to
-       * the breadcrumb subtitle when the item has none. */
-      const int sel = tui_menu_state_selected_index(s);
-      const char *meta = (sel >= 0 && cfg->items[sel].description &&
-                          cfg->items[sel].description[0])
-                             ? cfg->items[sel].description
-                             : cfg->subtitle;
-      if (meta && meta[0] && left_max > 0) {
-        tui_set_color(win, TUI_COLOR_DIM);
-        mvwaddnstr(win, L->meta_y, L->content_left, meta, left_max);
-        tui_unset_color(win, TUI_COLOR_DIM);
-      }
-    }
-  }
+  tui_menu_render_meta(L, s);
 
   /* Full-width rule. */
   tui_set_color(win, TUI_COLOR_BORDER);
@@ -280,98 +284,106 @@ static void tui_menu_render_header(const tui_menu_layout_t *L,
 
 /* Single-column, borderless list (dawn style): the selected row gets a "▸ "
  * marker in the accent colour and a bold label; every other row is dim. No
- * highlight bar - the marker and weight carry the selection. */
-static void tui_menu_render_items(const tui_menu_layout_t *L,
-                                  const tui_menu_state_t *s) {
+ * highlight bar - the marker and weight carry the selection.
+ *
+ * Paints visible row `v` after clearing it, so a selection move repaints just
+ * the rows it left and entered. Rows outside the viewport are ignored. */
+static void tui_menu_render_row(const tui_menu_layout_t *L,
+                                const tui_menu_state_t *s, int v) {
+  const int row = v - tui_menu_state_top_visible(s);
+  if (row < 0 || row >= L->item_area_h ||
+      v >= tui_menu_state_visible_count(s))
+    return;
   WINDOW *win = L->frame->win;
   const tui_menu_config_t *cfg = tui_menu_state_config(s);
-  const int visible = tui_menu_state_visible_count(s);
-  const int top = tui_menu_state_top_visible(s);
-  const int sel_v = tui_menu_state_selected_visible(s);
-  const int rows = L->item_area_h;
   const int marker_x = L->content_left;
   const int num_x = marker_x + 2; /* aligns under the "▸ " marker */
   const int content_right = L->content_left + L->content_width - 1;
 
-  for (int row = 0; row < rows; row++) {
-    const int v = top + row;
-    if (v >= visible)
-      break;
-    const int idx = tui_menu_state_visible_at(s, v);
-    const tui_menu_item_t *it = &cfg->items[idx];
-    const int y = L->item_area_y + row;
-    const bool is_selected = (v == sel_v);
-
-    if (it->kind == TUI_MENU_ITEM_SEPARATOR) {
-      tui_set_color(win, TUI_COLOR_BORDER);
-      mvwhline(win, y, num_x, ACS_HLINE, L->content_width / 3);
-      tui_unset_color(win, TUI_COLOR_BORDER);
-      continue;
-    }
+  const int idx = tui_menu_state_visible_at(s, v);
+  const tui_menu_item_t item = tui_menu_state_item(s, idx);
+  const tui_menu_item_t *it = &item;
+  const int y = L->item_area_y + row;
+  const bool is_selected = (v == tui_menu_state_selected_visible(s));
 
-    const int row_number =
-        cfg->show_numeric_keys ? tui_menu_state_number_for_row(s, v) : 0;
-    const bool has_number = row_number >= 1 && row_number <= 9;
-    const int label_x = num_x + (has_number ? 3 : 0);
-    const int disabled_suffix_cols = it->disabled ? 12 : 0;
-    const int label_max_w = content_right - label_x + 1 - disabled_suffix_cols;
-
-    /* Selection cue: an accent marker plus a bold label - no highlight bar. */
-    if (is_selected) {
-      tui_set_color(win, TUI_COLOR_ACCENT);
-      tui_menu_write_wcs(win, y, marker_x, 2, L"▸ "); /* ▸ */
-      tui_unset_color(win, TUI_COLOR_ACCENT);
-    }
+  mvwhline(win, y, L->content_left, ' ', L->content_width);
 
-    if (has_number) {
-      char num[4];
-      snprintf(num, sizeof(num), "%d.", row_number);
-      tui_set_color(win, TUI_COLOR_DIM);
-      mvwaddnstr(win, y, num_x, num, 3);
-      tui_unset_color(win, TUI_COLOR_DIM);
-    }
+  if (it->kind == TUI_MENU_ITEM_SEPARATOR) {
+    tui_set_color(win, TUI_COLOR_BORDER);
+    mvwhline(win, y, num_x, ACS_HLINE, L->content_width / 3);
+    tui_unset_color(win, TUI_COLOR_BORDER);
+    return;
+  }
 
-    const tui_color_pair_t label_color =
-        is_selected ? TUI_COLOR_MENU_NORMAL : TUI_COLOR_DIM;
-    tui_set_color(win, label_color);
-    if (is_selected)
-      wattron(win, A_BOLD);
-    const wchar_t *lab = tui_menu_state_label_wcs(s, idx);
-    const wchar_t mn = tui_menu_state_mnemonic(s, idx);
-    /* Render the label, applying A_UNDERLINE to the first wchar matching
-     * mn (case-insensitive) - single pass. */
-    int cur_x = label_x;
-    int budget = label_max_w;
-    bool underlined = (mn == 0);
-    for (size_t k = 0; lab[k] && budget > 0; k++) {
-      int cw = tui_wcwidth(lab[k]);
-      if (cw < 0)
-        cw = 1;
-      if (cw > budget)
-        break;
-      const bool here = !underlined && (wchar_t)towlower(lab[k]) == mn;
-      if (here)
-        wattron(win, A_UNDERLINE);
-      tui_menu_write_wchar(win, y, cur_x, lab[k]);
-      if (here) {
-        wattroff(win, A_UNDERLINE);
-        underlined = true;
-      }
-      cur_x += cw;
-      budget -= cw;
-    }
-    if (is_selected)
-      wattroff(win, A_BOLD);
-    tui_unset_color(win, label_color);
+  const int row_number =
+      cfg->show_numeric_keys ? tui_menu_state_number_for_row(s, v) : 0;
+  const bool has_number = row_number >= 1 && row_number <= 9;
+  const int label_x = num_x + (has_number ? 3 : 0);
+  const int disabled_suffix_cols = it->disabled ? 12 : 0;
+  const int label_max_w = content_right - label_x + 1 - disabled_suffix_cols;
+
+  /* Selection cue: an accent marker plus a bold label - no highlight bar. */
+  if (is_selected) {
+    tui_set_color(win, TUI_COLOR_ACCENT);
+    tui_menu_write_wcs(win, y, marker_x, 2, L"▸ "); /* ▸ */
+    tui_unset_color(win, TUI_COLOR_ACCENT);
+  }
 
-    if (it->disabled) {
-      tui_set_color(win, TUI_COLOR_DIM);
-      tui_menu_write_wcs(win, y, content_right - 9, 10, L"(disabled)");
-      tui_unset_color(win, TUI_COLOR_DIM);
+  if (has_number) {
+    char num[4];
+    snprintf(num, sizeof(num), "%d.", row_number);
+    tui_set_color(win, TUI_COLOR_DIM);
+    mvwaddnstr(win, y, num_x, num, 3);
+    tui_unset_color(win, TUI_COLOR_DIM);
+  }
+
+  const tui_color_pair_t label_color =
+      is_selected ? TUI_COLOR_MENU_NORMAL : TUI_COLOR_DIM;
+  tui_set_color(win, label_color);
+  if (is_selected)
+    wattron(win, A_BOLD);
+  const wchar_t *lab = tui_menu_state_label_wcs(s, idx);
+  const wchar_t mn = tui_menu_state_mnemonic(s, idx);
+  /* Render the label, applying A_UNDERLINE to the first wchar matching
+   * mn (case-insensitive) - single pass. */
+  int cur_x = label_x;
+  int budget = label_max_w;
+  bool underlined = (mn == 0);
+  for (size_t k = 0; lab[k] && budget > 0; k++) {
+    int cw = tui_wcwidth(lab[k]);
+    if (cw < 0)
+      cw = 1;
+    if (cw > budget)
+      break;
+    const bool here = !underlined && (wchar_t)towlower(lab[k]) == mn;
+    if (here)
+      wattron(win, A_UNDERLINE);
+    tui_menu_write_wchar(win, y, cur_x, lab[k]);
+    if (here) {
+      wattroff(win, A_UNDERLINE);
+      underlined = true;
     }
+    cur_x += cw;
+    budget -= cw;
+  }
+  if (is_selected)
+    wattroff(win, A_BOLD);
+  tui_unset_color(win, label_color);
+
+  if (it->disabled) {
+    tui_set_color(win, TUI_COLOR_DIM);
+    tui_menu_write_wcs(win, y, content_right - 9, 10, L"(disabled)");
+    tui_unset_color(win, TUI_COLOR_DIM);
   }
 }
 
+static void tui_menu_render_items(const tui_menu_layout_t *L,
+                                  const tui_menu_state_t *s) {
+  const int top = tui_menu_state_top_visible(s);
+  for (int row = 0; row < L->item_area_h; row++)
+    tui_menu_render_row(L, s, top + row);
+}
+
 /* Scroll affordance: a dim arrow in the right-most content column of the footer
  * row. Painted AFTER the footer (which reserves that column) so the footer's
  * row clear cannot erase it. */
@@ -522,9 +534,9 @@ static tui_menu_event_t menu_handle_key(tui_menu_state_t *s, int ch,
   default:
     if (cfg->show_numeric_keys && ch >= '1' && ch <= '9') {
       const int row = tui_menu_state_row_for_number(s, ch - '0');
-      const int idx = tui_menu_state_visible_at(s, row);
-      if (idx < 0 || cfg->items[idx].disabled ||
-          cfg->items[idx].kind == TUI_MENU_ITEM_SEPARATOR) {
+      const tui_menu_item_t it =
+          tui_menu_state_item(s, tui_menu_state_visible_at(s, row));
+      if (it.disabled || it.kind == TUI_MENU_ITEM_SEPARATOR) {
         tui_beep();
       } else {
         tui_menu_state_numeric_jump(s, row);
@@ -566,9 +578,9 @@ static tui_menu_event_t menu_handle_mouse(tui_menu_state_t *s,
   const int v = tui_menu_state_top_visible(s) + row;
   if (v < 0 || v >= tui_menu_state_visible_count(s))
     return TUI_MENU_EV_NONE;
-  const tui_menu_config_t *cfg = tui_menu_state_config(s);
   const int idx = tui_menu_state_visible_at(s, v);
-  const tui_menu_item_t *it = &cfg->items[idx];
+  const tui_menu_item_t item = tui_menu_state_item(s, idx);
+  const tui_menu_item_t *it = &item;
 
   if (it->kind == TUI_MENU_ITEM_SEPARATOR || it->disabled) {
     tui_beep();
@@ -589,6 +601,156 @@ static tui_menu_event_t menu_handle_mouse(tui_menu_state_t *s,
 }
 #endif
 
+/* Repaint only what the model reports as changed: a cursor move within the
+ * viewport touches the two rows involved plus the meta line. */
+static void tui_menu_paint(const tui_menu_layout_t *L, tui_menu_state_t *s,
+                           const tui_frame_t *frame) {
+  const tui_menu_damage_t damage = tui_menu_state_take_damage(s);
+  if (damage.full) {
+    werase(L->frame->win);
+    tui_menu_render_header(L, s);
+    tui_menu_render_items(L, s);
+    /* Footer clears its whole row (it reserves the last content column),
+     * then the scroll affordance paints into that reserved column on top -
+     * so the indicator survives the footer's row clear. Order matters. */
+    tui_menu_render_footer(L, s);
+    tui_menu_render_scroll(L, s);
+  } else {
+    if (damage.meta)
+      tui_menu_render_meta(L, s);
+    for (int i = 0; i < damage.row_count; i++)
+      tui_menu_render_row(L, s, damage.rows[i]);
+  }
+  wnoutrefresh(L->frame->win);
+  tui_frame_flush(frame);
+}
+
+/* Rebuilds (owned) or recenters (caller's) the frame for the new terminal
+ * size and recomputes the layout. The screen clear is queued rather than
+ * flushed, so it reaches the terminal together with the next paint. Returns
+ * false when the menu no longer fits; an owned frame is then gone. */
+static bool tui_menu_apply_resize(tui_menu_layout_t *L, tui_menu_state_t *s,
+                                  const tui_menu_config_t *cfg) {
+  if (L->owns_frame) {
+    tui_window_t *old_frame = L->frame;
+    tui_window_t *new_frame =
+        tui_create_centered_window(L->desired_h, L->desired_w);
+    if (!new_frame) {
+      tui_replace_background(old_frame, NULL);
+      tui_destroy_window(old_frame);
+      L->frame = NULL;
+      return false;
+    }
+    L->frame = new_frame;
+    tui_replace_background(old_frame, L->frame);
+    tui_destroy_window(old_frame);
+  } else if (!tui_menu_recenter_frame(L)) {
+    return false;
+  }
+  tui_menu_state_invalidate(s);
+  clear();
+  wnoutrefresh(stdscr);
+  return tui_menu_layout_compute(L, L->frame, cfg);
+}
+
+/* Applies one key or mouse event. Returns true when it ends the menu, with
+ * *result filled in. */
+static bool tui_menu_dispatch(tui_menu_state_t *state,
+                              const tui_menu_layout_t *L, int ch,
+                              tui_menu_result_t *result) {
+  int confirm_index = -1;
+  tui_menu_event_t ev = TUI_MENU_EV_NONE;
+#ifdef NCURSES_MOUSE_VERSION
+  if (ch == KEY_MOUSE) {
+    ev = menu_handle_mouse(state, L, &confirm_index);
+  } else
+#endif
+  {
+    ev = menu_handle_key(state, ch, L->item_area_h, &confirm_index);
+  }
+
+  switch (ev) {
+  case TUI_MENU_EV_CONFIRM: {
+    const int idx = confirm_index >= 0 ? confirm_index
+                                       : tui_menu_state_selected_index(state);
+    if (idx < 0) {
+      tui_beep();
+      return false;
+    }
+    const tui_menu_item_t item = tui_menu_state_item(state, idx);
+    if (item.disabled || item.kind == TUI_MENU_ITEM_SEPARATOR) {
+      tui_beep();
+      return false;
+    }
+    result->status = TUI_MENU_OK;
+    result->selected_id = item.id;
+    result->selected_index = idx;
+    return true;
+  }
+  case TUI_MENU_EV_CANCEL:
+    result->status = TUI_MENU_CANCELLED;
+    return true;
+  case TUI_MENU_EV_MENU:
+    result->status = TUI_MENU_MENU;
+    return true;
+  case TUI_MENU_EV_NONE:
+    break;
+  }
+  return false;
+}
+
+/* The menu as a tui_run_frame_loop() view. */
+typedef struct {
+  tui_menu_layout_t *L;
+  tui_menu_state_t *state;
+  const tui_menu_config_t *config;
+  tui_menu_result_t *result;
+} tui_menu_view_t;
+
+static WINDOW *tui_menu_view_layout(void *view, bool resize) {
+  tui_menu_view_t *v = view;
+  const bool fits =
+      resize ? tui_menu_apply_resize(v->L, v->state, v->config)
+             : tui_menu_layout_compute(v->L, v->L->frame, v->config);
+  if (!fits)
+    return NULL;
+  tui_menu_state_ensure_selection_visible(v->state, v->L->item_area_h);
+  return v->L->frame->win;
+}
+
+static bool tui_menu_view_has_damage(void *view) {
+  const tui_menu_view_t *v = view;
+  return tui_menu_state_has_damage(v->state);
+}
+
+static void tui_menu_view_paint(void *view, const tui_frame_t *frame) {
+  tui_menu_view_t *v = view;
+  tui_menu_paint(v->L, v->state, frame);
+}
+
+static tui_frame_loop_action_t tui_menu_view_dispatch(void *view, int key) {
+  tui_menu_view_t *v = view;
+  if (tui_menu_dispatch(v->state, v->L, key, v->result))
+    return TUI_FRAME_LOOP_EXIT;
+  tui_menu_state_ensure_selection_visible(v->state, v->L->item_area_h);
+  return TUI_FRAME_LOOP_CONTINUE;
+}
+
+static void tui_menu_view_poll(void *view) {
+  tui_menu_view_t *v = view;
+  tui_menu_state_poll(v->state);
+}
+
+static bool tui_menu_view_pending(void *view) {
+  const tui_menu_view_t *v = view;
+  return tui_menu_state_pending(v->state);
+}
+
+static void tui_menu_view_invalidate(void *view) {
+  tui_menu_view_t *v = view;
+  tui_menu_state_invalidate(v->state);
+}
+
 tui_menu_result_t tui_show_menu(tui_window_t *window,
                                 const tui_menu_config_t *config) {
   tui_menu_result_t result = {.status = TUI_MENU_INVALID_ARG,
@@ -603,6 +765,7 @@ tui_menu_result_t tui_show_menu(tui_window_t *window,
     result.status = st;
     return result;
   }
+  tui_menu_state_set_notify(state, tui_wake);
 
   tui_menu_layout_t L = {0};
   L.frame = window;
@@ -639,106 +802,29 @@ tui_menu_result_t tui_show_menu(tui_window_t *window,
   }
 #endif
 
-  bool exit_loop = false;
-  while (!exit_loop) {
-    if (tui_interrupted()) {
-      result.status = TUI_MENU_INTERRUPTED;
-      break;
-    }
-    if (!tui_menu_layout_compute(&L, L.frame, config)) {
-      result.status = TUI_MENU_TOO_SMALL;
-      break;
-    }
-    werase(L.frame->win);
-
-    tui_menu_state_ensure_selection_visible(state, L.item_area_h);
-
-    tui_menu_render_header(&L, state);
-    tui_menu_render_items(&L, state);
-    /* Footer clears its whole row (it reserves the last content column), then
-     * the scroll affordance paints into that reserved column on top - so the
-     * indicator survives the footer's row clear. Order matters here. */
-    tui_menu_render_footer(&L, state);
-    tui_menu_render_scroll(&L, state);
-
-    wnoutrefresh(L.frame->win);
-    doupdate();
-
-    const int ch = wgetch(L.frame->win);
-    int confirm_index = -1;
-    tui_menu_event_t ev = TUI_MENU_EV_NONE;
-
-    if (ch == ERR) {
-      if (tui_interrupted()) {
-        result.status = TUI_MENU_INTERRUPTED;
-        exit_loop = true;
-      } else {
-        napms(10);
-      }
-      continue;
-    }
-    if (ch == KEY_RESIZE) {
-      if (L.owns_frame) {
-        tui_window_t *old_frame = L.frame;
-        tui_window_t *new_frame =
-            tui_create_centered_window(L.desired_h, L.desired_w);
-        if (!new_frame) {
-          tui_replace_background(old_frame, NULL);
-          tui_destroy_window(old_frame);
-          L.frame = NULL;
-          result.status = TUI_MENU_TOO_SMALL;
-          break;
-        }
-        L.frame = new_frame;
-        tui_replace_background(old_frame, L.frame);
-        tui_destroy_window(old_frame);
-      } else if (!tui_menu_recenter_frame(&L)) {
-        result.status = TUI_MENU_TOO_SMALL;
-        break;
-      }
-      clear();
-      refresh();
-      continue;
-    }
-#ifdef NCURSES_MOUSE_VERSION
-    if (ch == KEY_MOUSE) {
-      ev = menu_handle_mouse(state, &L, &confirm_index);
-    } else
-#endif
-    {
-      ev = menu_handle_key(state, ch, L.item_area_h, &confirm_index);
-    }
-
-    switch (ev) {
-    case TUI_MENU_EV_CONFIRM: {
-      const int idx = confirm_index >= 0 ? confirm_index
-                                         : tui_menu_state_selected_index(state);
-      if (idx < 0) {
-        tui_beep();
-        continue;
-      }
-      const tui_menu_item_t *it = &config->items[idx];
-      if (it->disabled || it->kind == TUI_MENU_ITEM_SEPARATOR) {
-        tui_beep();
-        continue;
-      }
-      result.status = TUI_MENU_OK;
-      result.selected_id = it->id;
-      result.selected_index = idx;
-      exit_loop = true;
-      break;
-    }
-    case TUI_MENU_EV_CANCEL:
-      result.status = TUI_MENU_CANCELLED;
-      exit_loop = true;
-      break;
-    case TUI_MENU_EV_MENU:
-      result.status = TUI_MENU_MENU;
-      exit_loop = true;
-      break;
-    case TUI_MENU_EV_NONE:
-      break;
-    }
+  tui_menu_view_t view = {
+      .L = &L, .state = state, .config = config, .result = &result};
+  const tui_frame_loop_t loop = {
+      .view = &view,
+      .max_fps = config->max_fps > 0 ? config->max_fps
+                                     : TUI_MENU_DEFAULT_MAX_FPS,
+      .layout = tui_menu_view_layout,
+      .has_damage = tui_menu_view_has_damage,
+      .paint = tui_menu_view_paint,
+      .dispatch = tui_menu_view_dispatch,
+      .poll = tui_menu_view_poll,
+      .pending = tui_menu_view_pending,
+      .invalidate = tui_menu_view_invalidate,
+  };
+  switch (tui_run_frame_loop(&loop)) {
+  case TUI_FRAME_LOOP_INTERRUPTED:
+    result.status = TUI_MENU_INTERRUPTED;
+    break;
+  case TUI_FRAME_LOOP_TOO_SMALL:
+    result.status = TUI_MENU_TOO_SMALL;
+    break;
+  case TUI_FRAME_LOOP_DONE:
+    break; /* tui_menu_dispatch filled in the result */
   }
 
 #ifdef NCURSES_MOUSE_VERSION
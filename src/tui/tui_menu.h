@@ -14,6 +14,9 @@
  * Ownership contract: all pointers reachable from `config` (including
  * config->title, items[i].label, items[i].description) must remain valid
  * until tui_show_menu returns. The menu makes no copies of caller data.
+ * Items served by config->item_source follow the same rule: the strings an
+ * accessor hands out must stay valid until tui_show_menu returns, since a
+ * row may be redrawn from them without asking again.
  */
 #pragma once
 
@@ -29,6 +32,9 @@ typedef struct tui_window tui_window_t; /* defined in tui.h */
  * titles longer than this (in bytes) are truncated with a trailing '~'. */
 #define TUI_MENU_TITLE_MAX 64
 
+/* Repaint rate cap used when tui_menu_config_t.max_fps is 0. */
+#define TUI_MENU_DEFAULT_MAX_FPS 60
+
 typedef enum {
   TUI_MENU_ITEM_NORMAL = 0,
   TUI_MENU_ITEM_SEPARATOR, /* visual rule; navigation skips silently */
@@ -49,17 +55,54 @@ enum {
   TUI_MENU_ID_NONE = 0,
 };
 
+/* Virtualized item access: fill *out with item `index` (0..item_count-1) and
+ * return true, or return false to show a blank disabled row. Called only for
+ * rows being drawn, navigated over or searched, so a menu over a large
+ * collection opens without materializing it. Must not call back into the
+ * menu. */
+typedef bool (*tui_menu_item_source_fn)(void *user, int index,
+                                        tui_menu_item_t *out);
+
+/* Streaming item feed: lets a menu open before its items are known. Any
+ * number of producer threads may push while tui_show_menu runs; the menu
+ * appends what has arrived on each tick and shows "loading N…" until
+ * tui_menu_feed_finish. Pushed items are copied (label and description
+ * included). A feed serves one menu and must outlive it. */
+typedef struct tui_menu_feed tui_menu_feed_t;
+
+APP_NODISCARD tui_menu_feed_t *tui_menu_feed_create(void);
+/* Call only once producers have stopped and no menu is using the feed. */
+void tui_menu_feed_destroy(tui_menu_feed_t *feed);
+/* Thread-safe and lock-free. Returns false when out of memory or after
+ * tui_menu_feed_finish. */
+bool tui_menu_feed_push(tui_menu_feed_t *feed, const tui_menu_item_t *item);
+/* Marks the end of the stream; call after the last push from any thread. */
+void tui_menu_feed_finish(tui_menu_feed_t *feed);
+
 typedef struct {
   const char *title;
   const char *subtitle; /* optional breadcrumb shown on the meta line under
                            the title when the selected item has no
                            description (e.g. "myapp · v0.1.0") */
-  const tui_menu_item_t *items;
+  const tui_menu_item_t *items; /* NULL when item_source is set */
   int item_count;
+  /* Optional alternative to items: fetch each item on demand. Mnemonics are
+   * not offered for virtualized menus, and the "N items" count includes any
+   * separators the source returns. */
+  tui_menu_item_source_fn item_source;
+  void *item_source_user;
+  /* Optional: items streamed in while the menu is open, appended after
+   * items[0..item_count), which may then be empty. Not combinable with
+   * item_source. */
+  tui_menu_feed_t *feed;
   int default_index; /* -1 picks first enabled */
   int frame_height;  /* requested frame height; 0 uses the current/default */
   int frame_width;   /* requested frame width; 0 uses the current/default */
+  int max_fps; /* repaints per second at most while keys or resizes arrive
+                  in bursts; 0 uses TUI_MENU_DEFAULT_MAX_FPS */
   bool enable_search;
+  bool fuzzy_search; /* rank items by fzf-style subsequence score instead of
+                        filtering by substring in source order */
   bool enable_mouse;
   bool enable_menu_key; /* Esc opens an overlay instead of cancelling; the
                            caller handles TUI_MENU_MENU. q still cancels. */
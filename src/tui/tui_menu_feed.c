@@ -0,0 +1,140 @@
+/*
+ * tui_menu_feed.c - streaming item queue for tui_show_menu.
+ *
+ * Producers push onto a lock-free stack (one compare-and-swap per item);
+ * the menu thread takes the whole stack with a single exchange and reverses
+ * it, which restores push order without ever popping nodes one at a time,
+ * so there is no ABA hazard. Drained nodes are kept on a consumer-only list
+ * because the menu keeps pointing at their strings until the feed is
+ * destroyed.
+ *
+ * No ncurses; unit-testable alongside tui_menu_model.c.
+ */
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "tui_menu_internal.h"
+
+typedef struct tui_menu_feed_node {
+  struct tui_menu_feed_node *next;
+  tui_menu_item_t item; /* label/description point into text[] */
+  char text[];
+} tui_menu_feed_node_t;
+
+struct tui_menu_feed {
+  _Atomic(tui_menu_feed_node_t *) head; /* pushed, newest first */
+  atomic_bool finished;
+  _Atomic(tui_menu_notify_fn) notify;
+  tui_menu_feed_node_t *consumed; /* drained; menu thread only */
+};
+
+tui_menu_feed_t *tui_menu_feed_create(void) {
+  tui_menu_feed_t *feed = calloc(1, sizeof(*feed));
+  if (!feed)
+    return NULL;
+  atomic_init(&feed->head, NULL);
+  atomic_init(&feed->finished, false);
+  atomic_init(&feed->notify, NULL);
+  return feed;
+}
+
+static void feed_free_list(tui_menu_feed_node_t *node) {
+  while (node) {
+    tui_menu_feed_node_t *next = node->next;
+    free(node);
+    node = next;
+  }
+}
+
+void tui_menu_feed_destroy(tui_menu_feed_t *feed) {
+  if (!feed)
+    return;
+  feed_free_list(atomic_load(&feed->head));
+  feed_free_list(feed->consumed);
+  free(feed);
+}
+
+static void feed_notify(tui_menu_feed_t *feed) {
+  const tui_menu_notify_fn notify = atomic_load(&feed->notify);
+  if (notify)
+    notify();
+}
+
+bool tui_menu_feed_push(tui_menu_feed_t *feed, const tui_menu_item_t *item) {
+  if (!feed || !item ||
+      atomic_load_explicit(&feed->finished, memory_order_relaxed))
+    return false;
+  const size_t label_len = item->label ? strlen(item->label) + 1 : 0;
+  const size_t desc_len =
+      item->description ? strlen(item->description) + 1 : 0;
+  tui_menu_feed_node_t *node =
+      malloc(sizeof(*node) + label_len + desc_len);
+  if (!node)
+    return false;
+  node->item = *item;
+  if (label_len) {
+    memcpy(node->text, item->label, label_len);
+    node->item.label = node->text;
+  }
+  if (desc_len) {
+    memcpy(node->text + label_len, item->description, desc_len);
+    node->item.description = node->text + label_len;
+  }
+
+  /* Once published the node belongs to the consumer, so the previous head
+   * is tracked in a local rather than read back from node->next. */
+  tui_menu_feed_node_t *head =
+      atomic_load_explicit(&feed->head, memory_order_relaxed);
+  do {
+    node->next = head;
+  } while (!atomic_compare_exchange_weak_explicit(
+      &feed->head, &head, node, memory_order_release, memory_order_relaxed));
+  /* Only the push onto an empty stack needs to wake the menu: until it
+   * drains, later pushes are picked up by the same drain. */
+  if (!head)
+    feed_notify(feed);
+  return true;
+}
+
+void tui_menu_feed_finish(tui_menu_feed_t *feed) {
+  if (!feed)
+    return;
+  atomic_store_explicit(&feed->finished, true, memory_order_release);
+  feed_notify(feed);
+}
+
+void tui_menu_feed_set_notify(tui_menu_feed_t *feed,
+                              tui_menu_notify_fn notify) {
+  if (feed)
+    atomic_store(&feed->notify, notify);
+}
+
+bool tui_menu_feed_drain(tui_menu_feed_t *feed,
+                         void (*visit)(void *user, const tui_menu_item_t *item),
+                         void *user) {
+  if (!feed)
+    return true;
+  /* Read `finished` first: every push that happened before it is then
+   * guaranteed to be in the stack taken below. */
+  const bool finished =
+      atomic_load_explicit(&feed->finished, memory_order_acquire);
+  tui_menu_feed_node_t *node =
+      atomic_exchange_explicit(&feed->head, NULL, memory_order_acquire);
+
+  tui_menu_feed_node_t *fifo = NULL;
+  while (node) {
+    tui_menu_feed_node_t *next = node->next;
+    node->next = fifo;
+    fifo = node;
+    node = next;
+  }
+  while (fifo) {
+    tui_menu_feed_node_t *next = fifo->next;
+    visit(user, &fifo->item);
+    fifo->next = feed->consumed;
+    feed->consumed = fifo;
+    fifo = next;
+  }
+  return finished;
+}
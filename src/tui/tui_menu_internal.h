@@ -33,8 +33,18 @@ bool tui_menu_state_select_visible(tui_menu_state_t *s, int visible_row);
 const wchar_t *tui_menu_state_label_wcs(const tui_menu_state_t *s,
                                         int items_index);
 wchar_t tui_menu_state_mnemonic(const tui_menu_state_t *s, int items_index);
+/* Item `items_index` by value, fetched from cfg->item_source when the menu is
+ * virtualized; out-of-range indices and failed fetches give a blank disabled
+ * item. */
+tui_menu_item_t tui_menu_state_item(const tui_menu_state_t *s, int items_index);
+/* Non-separator items, for the "N items" cell. Virtualized menus report
+ * item_count without scanning the source. */
+int tui_menu_state_listable_count(const tui_menu_state_t *s);
 bool tui_menu_state_search_active(const tui_menu_state_t *s);
 const wchar_t *tui_menu_state_search_query(const tui_menu_state_t *s);
+/* Matches for the "N matches" cell. Fuzzy search lists only the best
+ * matches, so this can exceed tui_menu_state_visible_count(). */
+int tui_menu_state_match_count(const tui_menu_state_t *s);
 
 /* Mutation - pure data ops, no ncurses. */
 void tui_menu_state_step(
@@ -48,6 +58,24 @@ void tui_menu_state_search_close(tui_menu_state_t *s);
 void tui_menu_state_search_append(tui_menu_state_t *s, wchar_t ch);
 void tui_menu_state_search_backspace(tui_menu_state_t *s);
 
+/* Work that completes after the call that started it: fuzzy search on large
+ * menus scores in background threads, and a feed delivers items while the
+ * menu is open. While pending is true the caller should call poll
+ * periodically: it appends items that arrived and merges whatever workers
+ * have finished into the visible list (reporting full damage when either
+ * changed it). */
+bool tui_menu_state_pending(const tui_menu_state_t *s);
+void tui_menu_state_poll(tui_menu_state_t *s);
+/* `notify` is called, from any thread, when background work has something
+ * for poll to pick up (a worker finished, items arrived on an empty feed).
+ * It must be async-safe and cheap; tui_show_menu passes tui_wake. */
+typedef void (*tui_menu_notify_fn)(void);
+void tui_menu_state_set_notify(tui_menu_state_t *s, tui_menu_notify_fn notify);
+/* True until the config's feed has been finished and fully drained. */
+bool tui_menu_state_loading(const tui_menu_state_t *s);
+/* Items the menu holds now, including those received from the feed. */
+int tui_menu_state_item_count(const tui_menu_state_t *s);
+
 /* Mnemonic dispatch. Returns the items[] index that should auto-confirm
  * (>= 0), or -1 if no unique match (selection may have advanced to cycle
  * among candidates). out_beep is set to true when the caller should beep
@@ -66,6 +94,38 @@ void tui_menu_state_numeric_jump(tui_menu_state_t *s, int visible_row);
 int tui_menu_state_number_for_row(const tui_menu_state_t *s, int visible_row);
 int tui_menu_state_row_for_number(const tui_menu_state_t *s, int number);
 
+/* Damage since the view last painted. `full` means the visible list, scroll
+ * offset or search line changed and the whole frame must be redrawn.
+ * Otherwise only `rows` (visible[] indices: the rows the selection left and
+ * entered) and, when `meta` is set, the meta line showing the selected item's
+ * description need repainting. An empty damage means nothing changed. */
+typedef struct {
+  bool full;
+  bool meta;
+  int row_count;
+  int rows[2];
+} tui_menu_damage_t;
+
+/* Returns the damage accumulated since the previous call and marks the
+ * current state as painted. A new state reports full damage, as does one
+ * after tui_menu_state_invalidate() (resize, external overdraw). */
+tui_menu_damage_t tui_menu_state_take_damage(tui_menu_state_t *s);
+void tui_menu_state_invalidate(tui_menu_state_t *s);
+/* Whether tui_menu_state_take_damage() would report anything, without
+ * marking the state painted. */
+bool tui_menu_state_has_damage(const tui_menu_state_t *s);
+
+/* Consumer side of tui_menu_feed_t, called on the menu thread only. Calls
+ * `visit` for every item pushed so far, in push order; the item's strings
+ * stay valid until the feed is destroyed. Returns true once the producer
+ * has finished and everything it pushed has been visited. */
+bool tui_menu_feed_drain(tui_menu_feed_t *feed,
+                         void (*visit)(void *user, const tui_menu_item_t *item),
+                         void *user);
+/* Called after a push that made the queue non-empty, and on finish; NULL
+ * detaches. */
+void tui_menu_feed_set_notify(tui_menu_feed_t *feed, tui_menu_notify_fn notify);
+
 /* Return the items[] index at the given visible row, or -1. */
 int tui_menu_state_visible_at(const tui_menu_state_t *s, int visible_row);
 const tui_menu_config_t *tui_menu_state_config(const tui_menu_state_t *s);
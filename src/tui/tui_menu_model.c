@@ -2,135 +2,876 @@
  * tui_menu_model.c - pure-data model for tui_menu.
  *
  * No ncurses; everything is wchar_t / int / pointer math. Unit-testable.
+ *
+ * Items come from cfg->items, whose labels are decoded once at create into a
+ * pair of contiguous arenas (labels and their lower-cased copies, sharing
+ * one offsets array) with per-item metadata in parallel arrays, or in
+ * virtualized mode from cfg->item_source: items are fetched on demand and
+ * only labels of rows actually drawn are decoded, into a small direct-mapped
+ * cache, so memory and open latency do not grow with item_count. A
+ * cfg->feed appends items to a model-owned copy of cfg->items while the
+ * menu is open.
+ *
+ * Fuzzy search (cfg->fuzzy_search) ranks items instead of filtering them in
+ * source order. Large array-backed menus are scored on a small pool of
+ * POSIX threads, each keeping its own top-K heap; the view polls for
+ * results, so the list shows the best matches found so far and a new key
+ * cancels the query still being scored.
  */
+#include <limits.h>
+#include <stdatomic.h>
 #include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 #include <wchar.h>
 #include <wctype.h>
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+#if !defined(_WIN32)
+#include <pthread.h>
+#include <unistd.h>
+#define MENU_FUZZY_THREADS 1
+#else
+#define MENU_FUZZY_THREADS 0
+#endif
+
 #include "tui_menu_internal.h"
 
+/* Decoded labels kept in virtualized mode. Slots are indexed by item index
+ * modulo this size, so any viewport up to this many rows stays resident. */
+#define MENU_LABEL_CACHE_ROWS 128
+
+#define MENU_SEARCH_MAX 64 /* query buffer, including the terminator */
+
+/* Per-item flags, cached from items[] when labels are parsed so navigation
+ * and filtering never touch the item structs. */
+enum {
+  MENU_ITEM_SELECTABLE = 1u << 0,
+  MENU_ITEM_SEPARATOR = 1u << 1,
+};
+
+/* Fuzzy search keeps the best MENU_FUZZY_TOP_K matches. Menus with at least
+ * MENU_FUZZY_PARALLEL_MIN items are split across up to MENU_FUZZY_WORKERS
+ * threads; smaller ones are scored inline, which is faster than a thread
+ * start-up. Workers check for cancellation every MENU_FUZZY_STRIDE items. */
+#define MENU_FUZZY_TOP_K 512
+#define MENU_FUZZY_PARALLEL_MIN 8192
+#define MENU_FUZZY_WORKERS 8
+#define MENU_FUZZY_STRIDE 1024
+
+typedef struct {
+  int index;
+  int score;
+  int length; /* label length, the first tie-break */
+} menu_rank_t;
+
+struct tui_menu_state;
+
+typedef struct {
+  struct tui_menu_state *state;
+  int begin, end;   /* items[] slice this worker scores */
+  menu_rank_t *heap; /* min-heap of MENU_FUZZY_TOP_K: worst match on top */
+  int heap_count;
+  int matched; /* all matches in the slice, not just the kept ones */
+  atomic_bool done;
+#if MENU_FUZZY_THREADS
+  pthread_t thread;
+  bool started;
+#endif
+} menu_fuzzy_worker_t;
+
+typedef struct {
+  int index;       /* item index held in this slot, -1 = empty */
+  wchar_t *label;  /* ampersand-stripped */
+  size_t capacity; /* wchar_t slots allocated for label */
+} menu_label_slot_t;
+
 struct tui_menu_state {
   const tui_menu_config_t *cfg;
-  wchar_t **label_w;  /* size = cfg->item_count; ampersand-stripped */
-  wchar_t *mnemonics; /* size = cfg->item_count; lower-cased; 0 = none */
-  int *visible;       /* size = cfg->item_count; visible items[] indices */
+  const tui_menu_item_t *items; /* cfg->items, or owned_items with a feed */
+  int item_count;
+  tui_menu_item_t *owned_items; /* feed mode: cfg->items + arrivals */
+  int item_capacity;            /* slots in the per-item arrays below */
+  bool loading;                 /* feed not yet finished and drained */
+  /* Array mode: ampersand-stripped labels packed NUL-separated in
+   * label_text, their lower-cased copies at the same offsets in fold_text,
+   * so a filter pass reads folded text front to back. */
+  wchar_t *label_text;
+  wchar_t *fold_text;
+  size_t text_len;      /* wide chars used in each arena */
+  size_t text_capacity; /* wide chars allocated in each arena */
+  /* Array mode, size = item_capacity each. */
+  size_t *label_off;         /* item's label in label_text/fold_text */
+  int *label_len;            /* wide chars, excluding the terminator */
+  wchar_t *mnemonics;        /* lower-cased; 0 = none */
+  unsigned char *item_flags; /* MENU_ITEM_* */
+  menu_label_slot_t *label_cache; /* item_source mode, instead of arenas */
+  wchar_t *scratch; /* item_source mode: folded label being searched */
+  size_t scratch_capacity;
+  int *visible; /* visible items[] indices; allocated on first filter */
+  bool visible_all; /* unfiltered: visible row v is item v */
   int visible_count;
+  /* Undo stack for incremental search. Typing narrows visible[] in place
+   * and pushes the rows it removed onto dropped[] (in items[] order);
+   * drop_mark[n] is the stack depth before the query grew to n characters,
+   * so backspace merges that segment back instead of re-filtering. Each item
+   * is dropped at most once along a query, so item_count slots suffice. */
+  int *dropped;
+  int drop_count;
+  int drop_mark[MENU_SEARCH_MAX];
+  /* Fuzzy query in flight: workers own their heaps until `done`, then the
+   * UI thread merges every finished heap into visible[]. */
+  menu_fuzzy_worker_t fuzzy[MENU_FUZZY_WORKERS];
+  int fuzzy_workers;   /* workers of the current query, 0 = none */
+  int fuzzy_published; /* finished workers already merged into visible[] */
+  atomic_bool fuzzy_cancel;
+  menu_rank_t *fuzzy_merge; /* MENU_FUZZY_WORKERS * MENU_FUZZY_TOP_K */
+  _Atomic(tui_menu_notify_fn) notify; /* workers call it when done */
+  int match_count;          /* matches so far; may exceed visible_count */
+  int listable_count; /* non-separator items, for the "N items" cell */
   int selected_visible; /* index into visible[] */
   int top_visible;
-  wchar_t search_buf[64];
+  wchar_t search_buf[MENU_SEARCH_MAX];
+  wchar_t search_fold[MENU_SEARCH_MAX]; /* search_buf, lower-cased */
   size_t search_len;
   bool search_active;
+  /* Damage tracking: what the view last painted, and whether anything beyond
+   * a selection move (filter, search line) changed since. */
+  bool damage_full;
+  int painted_selected;
+  int painted_top;
 };
 
 static bool menu_item_selectable(const tui_menu_item_t *it) {
   return it && it->kind == TUI_MENU_ITEM_NORMAL && !it->disabled;
 }
 
-static int menu_first_enabled(const tui_menu_config_t *cfg) {
-  for (int i = 0; i < cfg->item_count; i++) {
-    if (menu_item_selectable(&cfg->items[i]))
+/* Item `idx`: a pointer into cfg->items, or *tmp filled from the item source
+ * (a blank disabled row when the source has nothing for idx). */
+static const tui_menu_item_t *menu_item(const struct tui_menu_state *s,
+                                        int idx, tui_menu_item_t *tmp) {
+  if (!s->cfg->item_source)
+    return &s->items[idx];
+  *tmp = (tui_menu_item_t){0};
+  if (!s->cfg->item_source(s->cfg->item_source_user, idx, tmp))
+    *tmp = (tui_menu_item_t){.disabled = true};
+  return tmp;
+}
+
+static bool menu_selectable_at(const struct tui_menu_state *s, int idx) {
+  if (s->item_flags)
+    return s->item_flags[idx] & MENU_ITEM_SELECTABLE;
+  tui_menu_item_t tmp;
+  return menu_item_selectable(menu_item(s, idx, &tmp));
+}
+
+static bool menu_separator_at(const struct tui_menu_state *s, int idx) {
+  if (s->item_flags)
+    return s->item_flags[idx] & MENU_ITEM_SEPARATOR;
+  tui_menu_item_t tmp;
+  return menu_item(s, idx, &tmp)->kind == TUI_MENU_ITEM_SEPARATOR;
+}
+
+static int menu_visible_item(const struct tui_menu_state *s, int v) {
+  return s->visible_all ? v : s->visible[v];
+}
+
+static int menu_first_enabled(const struct tui_menu_state *s) {
+  for (int i = 0; i < s->item_count; i++) {
+    if (menu_selectable_at(s, i))
       return i;
   }
   return -1;
 }
 
-static void menu_state_parse_labels(struct tui_menu_state *s) {
-  for (int i = 0; i < s->cfg->item_count; i++) {
-    const char *src = s->cfg->items[i].label;
-    if (!src) {
-      s->label_w[i] = calloc(1, sizeof(wchar_t));
-      s->mnemonics[i] = 0;
-      continue;
-    }
-    const size_t src_bytes = strlen(src);
-    wchar_t *dst = calloc(src_bytes + 1, sizeof(wchar_t));
-    if (!dst) {
-      s->label_w[i] = NULL;
-      s->mnemonics[i] = 0;
+/* Case folding shared by labels and the query; ASCII skips towlower, the
+ * bulk of the work when a large menu is created. */
+static wchar_t menu_fold_char(wchar_t wc) {
+  if (wc < 0x80)
+    return wc >= L'A' && wc <= L'Z' ? wc + (L'a' - L'A') : wc;
+  return (wchar_t)towlower(wc);
+}
+
+/* Lower-case `src` into `dst` (which may alias it); returns dst. Search
+ * compares these folded copies, so matching needs no per-character fold. */
+static wchar_t *menu_fold(const wchar_t *src, wchar_t *dst) {
+  size_t i = 0;
+  for (; src[i]; i++)
+    dst[i] = menu_fold_char(src[i]);
+  dst[i] = 0;
+  return dst;
+}
+
+/* Strip '&' markup from UTF-8 `src` (NULL reads as "") into `dst`, which
+ * holds at least strlen(src) + 1 wide chars; *out_len, when given, receives
+ * the decoded length. Returns the lower-cased mnemonic, or 0 when the label
+ * has none. */
+static wchar_t menu_parse_label(const char *src, wchar_t *dst,
+                                size_t *out_len) {
+  size_t out = 0;
+  wchar_t mnemonic = 0;
+  const char *p = src ? src : "";
+  while (*p) {
+    if (p[0] == '&' && p[1] == '&') {
+      dst[out++] = L'&';
+      p += 2;
       continue;
     }
-
-    size_t out = 0;
-    wchar_t mnemonic = 0;
-    const char *p = src;
-    while (*p) {
-      if (p[0] == '&' && p[1] == '&') {
-        dst[out++] = L'&';
-        p += 2;
-        continue;
-      }
-      if (p[0] == '&' && p[1] != '\0' && mnemonic == 0) {
-        wchar_t wc = 0;
-        const int n = mbtowc(&wc, p + 1, MB_CUR_MAX);
-        if (n > 0 && iswalnum(wc)) {
-          mnemonic = (wchar_t)towlower(wc);
-          dst[out++] = wc;
-          p += 1 + (size_t)n;
-          continue;
-        }
-      }
+    if (p[0] == '&' && p[1] != '\0' && mnemonic == 0) {
       wchar_t wc = 0;
-      const int n = mbtowc(&wc, p, MB_CUR_MAX);
-      if (n <= 0) {
-        p++;
+      const int n = mbtowc(&wc, p + 1, MB_CUR_MAX);
+      if (n > 0 && iswalnum(wc)) {
+        mnemonic = (wchar_t)towlower(wc);
+        dst[out++] = wc;
+        p += 1 + (size_t)n;
         continue;
       }
-      dst[out++] = wc;
-      p += n;
     }
-    dst[out] = 0;
-    s->label_w[i] = dst;
-    s->mnemonics[i] = mnemonic;
+    if ((unsigned char)*p < 0x80) {
+      /* ASCII never starts a multibyte sequence in a supported locale. */
+      dst[out++] = (wchar_t)*p++;
+      continue;
+    }
+    wchar_t wc = 0;
+    const int n = mbtowc(&wc, p, MB_CUR_MAX);
+    if (n <= 0) {
+      p++;
+      continue;
+    }
+    dst[out++] = wc;
+    p += n;
   }
+  dst[out] = 0;
+  if (out_len)
+    *out_len = out;
+  return mnemonic;
 }
-static bool wcs_contains_icase(const wchar_t *hay, const wchar_t *needle) {
-  if (!needle || needle[0] == 0)
+
+/* Grow both label arenas to hold `need` wide chars. */
+static bool menu_state_reserve_text(struct tui_menu_state *s, size_t need) {
+  if (need <= s->text_capacity)
+    return true;
+  size_t cap = s->text_capacity > need / 2 ? 2 * s->text_capacity : need;
+  if (cap > SIZE_MAX / sizeof(wchar_t))
+    return false;
+  wchar_t *label_text = realloc(s->label_text, cap * sizeof(wchar_t));
+  if (label_text)
+    s->label_text = label_text;
+  wchar_t *fold_text = realloc(s->fold_text, cap * sizeof(wchar_t));
+  if (fold_text)
+    s->fold_text = fold_text;
+  if (!label_text || !fold_text)
+    return false;
+  s->text_capacity = cap;
+  return true;
+}
+
+/* Decode item i's label onto the end of the arenas and cache its flags. */
+static bool menu_state_parse_label_at(struct tui_menu_state *s, int i) {
+  const tui_menu_item_t *item = &s->items[i];
+  const size_t cap = (item->label ? strlen(item->label) : 0) + 1;
+  if (!menu_state_reserve_text(s, s->text_len + cap))
+    return false;
+  const size_t off = s->text_len;
+  size_t len = 0;
+  s->mnemonics[i] = menu_parse_label(item->label, s->label_text + off, &len);
+  (void)menu_fold(s->label_text + off, s->fold_text + off);
+  s->label_off[i] = off;
+  s->label_len[i] = (int)len;
+  s->item_flags[i] =
+      (unsigned char)((menu_item_selectable(item) ? MENU_ITEM_SELECTABLE : 0) |
+                      (item->kind == TUI_MENU_ITEM_SEPARATOR
+                           ? MENU_ITEM_SEPARATOR
+                           : 0));
+  s->text_len = off + len + 1;
+  return true;
+}
+
+/* Decode every label at create: the arenas are sized from the UTF-8 lengths
+ * up front (an upper bound on wide chars), so this allocates once. */
+static bool menu_state_parse_labels(struct tui_menu_state *s) {
+  size_t total = 0;
+  for (int i = 0; i < s->item_count; i++)
+    total += (s->items[i].label ? strlen(s->items[i].label) : 0) + 1;
+  if (!menu_state_reserve_text(s, total > 0 ? total : 1))
+    return false;
+  for (int i = 0; i < s->item_count; i++) {
+    if (!menu_state_parse_label_at(s, i))
+      return false;
+  }
+  return true;
+}
+
+/* Grow *buf to hold `need` wide chars. */
+static bool menu_reserve(wchar_t **buf, size_t *capacity, size_t need) {
+  if (need <= *capacity)
     return true;
-  const size_t nlen = wcslen(needle);
-  for (const wchar_t *p = hay; *p; p++) {
-    size_t k = 0;
-    while (k < nlen && p[k] != 0 && towlower(p[k]) == towlower(needle[k]))
-      k++;
-    if (k == nlen)
+  wchar_t *grown = realloc(*buf, need * sizeof(wchar_t));
+  if (!grown)
+    return false;
+  *buf = grown;
+  *capacity = need;
+  return true;
+}
+
+/* Decoded label of item `idx` in item_source mode, from the row cache. */
+static const wchar_t *menu_cached_label(const struct tui_menu_state *s,
+                                        int idx) {
+  menu_label_slot_t *slot = &s->label_cache[idx % MENU_LABEL_CACHE_ROWS];
+  if (slot->index == idx)
+    return slot->label;
+  tui_menu_item_t tmp;
+  const char *src = menu_item(s, idx, &tmp)->label;
+  slot->index = -1;
+  if (!menu_reserve(&slot->label, &slot->capacity,
+                    (src ? strlen(src) : 0) + 1))
+    return NULL;
+  (void)menu_parse_label(src, slot->label, NULL);
+  slot->index = idx;
+  return slot->label;
+}
+
+/* Folded label of item `idx` for matching, with its length in *out_len;
+ * NULL for separators, which never match. Array mode returns the arena
+ * copy and only reads the state, so fuzzy workers may call it concurrently;
+ * item_source mode fetches the item and decodes it transiently without
+ * disturbing the row cache. *out_label, when given, receives the unfolded
+ * label. */
+static const wchar_t *menu_search_label(struct tui_menu_state *s, int idx,
+                                        const wchar_t **out_label,
+                                        size_t *out_len) {
+  if (s->item_flags) {
+    if (s->item_flags[idx] & MENU_ITEM_SEPARATOR)
+      return NULL;
+    const size_t off = s->label_off[idx];
+    if (out_label)
+      *out_label = s->label_text + off;
+    *out_len = (size_t)s->label_len[idx];
+    return s->fold_text + off;
+  }
+  tui_menu_item_t tmp;
+  const tui_menu_item_t *item = menu_item(s, idx, &tmp);
+  if (item->kind == TUI_MENU_ITEM_SEPARATOR)
+    return NULL;
+  const size_t cap = (item->label ? strlen(item->label) : 0) + 1;
+  if (!menu_reserve(&s->scratch, &s->scratch_capacity, 2 * cap))
+    return NULL;
+  (void)menu_parse_label(item->label, s->scratch, out_len);
+  if (out_label)
+    *out_label = s->scratch;
+  return menu_fold(s->scratch, s->scratch + cap);
+}
+
+/* Whether `needle` (nlen >= 1 chars) occurs in `hay` (hlen chars). Only
+ * offsets where both the first and the last needle character line up are
+ * compared in full; with 32-bit wchar_t, SSE2 or NEON test four offsets per
+ * step, which rejects almost every offset without a byte compare. */
+static bool menu_wcs_find(const wchar_t *hay, size_t hlen,
+                          const wchar_t *needle, size_t nlen) {
+  if (hlen < nlen)
+    return false;
+  const size_t offsets = hlen - nlen + 1;
+  const wchar_t first = needle[0];
+  const wchar_t last = needle[nlen - 1];
+  size_t i = 0;
+#if WCHAR_MAX > 0xffff && defined(__SSE2__)
+  const __m128i vfirst = _mm_set1_epi32((int)first);
+  const __m128i vlast = _mm_set1_epi32((int)last);
+  for (; offsets - i >= 4; i += 4) {
+    const __m128i a = _mm_loadu_si128((const __m128i *)(hay + i));
+    const __m128i b = _mm_loadu_si128((const __m128i *)(hay + i + nlen - 1));
+    unsigned mask = (unsigned)_mm_movemask_ps(_mm_castsi128_ps(
+        _mm_and_si128(_mm_cmpeq_epi32(a, vfirst), _mm_cmpeq_epi32(b, vlast))));
+    while (mask) {
+      const unsigned bit = (unsigned)__builtin_ctz(mask);
+      if (wmemcmp(hay + i + bit, needle, nlen) == 0)
+        return true;
+      mask &= mask - 1;
+    }
+  }
+#elif WCHAR_MAX > 0xffff && defined(__aarch64__) && defined(__ARM_NEON)
+  const uint32x4_t vfirst = vdupq_n_u32((uint32_t)first);
+  const uint32x4_t vlast = vdupq_n_u32((uint32_t)last);
+  for (; offsets - i >= 4; i += 4) {
+    const uint32x4_t a = vld1q_u32((const uint32_t *)(hay + i));
+    const uint32x4_t b = vld1q_u32((const uint32_t *)(hay + i + nlen - 1));
+    if (vmaxvq_u32(vandq_u32(vceqq_u32(a, vfirst), vceqq_u32(b, vlast))) == 0)
+      continue;
+    for (size_t k = i; k < i + 4; k++) {
+      if (hay[k] == first && wmemcmp(hay + k, needle, nlen) == 0)
+        return true;
+    }
+  }
+#endif
+  for (; i < offsets; i++) {
+    if (hay[i] == first && hay[i + nlen - 1] == last &&
+        wmemcmp(hay + i, needle, nlen) == 0)
       return true;
   }
   return false;
 }
 
-static void menu_state_apply_filter(struct tui_menu_state *s) {
-  s->visible_count = 0;
-  if (!s->search_active || s->search_len == 0) {
-    for (int i = 0; i < s->cfg->item_count; i++)
-      s->visible[s->visible_count++] = i;
+static bool menu_item_matches(struct tui_menu_state *s, int idx) {
+  size_t len = 0;
+  const wchar_t *lab = menu_search_label(s, idx, NULL, &len);
+  return lab && menu_wcs_find(lab, len, s->search_fold, s->search_len);
+}
+
+/* Snap selection to first selectable visible. */
+static void menu_state_snap_selection(struct tui_menu_state *s) {
+  s->selected_visible = 0;
+  for (int v = 0; v < s->visible_count; v++) {
+    if (menu_selectable_at(s, menu_visible_item(s, v))) {
+      s->selected_visible = v;
+      return;
+    }
+  }
+}
+
+static void menu_fuzzy_stop(struct tui_menu_state *s);
+
+/* Back to the unfiltered list (empty or closed search). */
+static void menu_state_clear_filter(struct tui_menu_state *s) {
+  menu_fuzzy_stop(s);
+  s->damage_full = true;
+  s->visible_all = true;
+  s->visible_count = s->item_count;
+  s->drop_count = 0;
+}
+
+/* The query just grew to search_len characters: keep the visible rows that
+ * still match, pushing the rest onto the undo stack. Only rows that matched
+ * the shorter query are tested. */
+static void menu_state_narrow(struct tui_menu_state *s) {
+  s->damage_full = true;
+  if (!s->visible)
+    s->visible = calloc((size_t)s->item_capacity, sizeof(int));
+  if (!s->dropped)
+    s->dropped = calloc((size_t)s->item_capacity, sizeof(int));
+  if (!s->visible || !s->dropped)
+    return; /* keep showing everything rather than nothing */
+  s->drop_mark[s->search_len] = s->drop_count;
+  const int scan = s->visible_count;
+  int kept = 0;
+  for (int v = 0; v < scan; v++) {
+    const int idx = menu_visible_item(s, v);
+    if (menu_item_matches(s, idx))
+      s->visible[kept++] = idx; /* kept <= v: safe in place */
+    else
+      s->dropped[s->drop_count++] = idx;
+  }
+  s->visible_all = false;
+  s->visible_count = kept;
+  menu_state_snap_selection(s);
+}
+
+/* The query just shrank to search_len (> 0) characters: merge the rows the
+ * removed character dropped back into visible[], preserving items[] order. */
+static void menu_state_widen(struct tui_menu_state *s) {
+  s->damage_full = true;
+  if (s->visible_all)
+    return; /* narrowing never happened (allocation failure) */
+  const int start = s->drop_mark[s->search_len + 1];
+  int a = s->visible_count - 1;
+  int b = s->drop_count - 1;
+  int out = s->visible_count + (s->drop_count - start);
+  s->visible_count = out;
+  while (b >= start) {
+    if (a >= 0 && s->visible[a] > s->dropped[b])
+      s->visible[--out] = s->visible[a--];
+    else
+      s->visible[--out] = s->dropped[b--];
+  }
+  s->drop_count = start;
+  menu_state_snap_selection(s);
+}
+
+/* fzf-style scoring constants: each matched character earns
+ * MENU_SCORE_MATCH plus a bonus for where it lands, gaps cost
+ * MENU_SCORE_GAP_START then MENU_SCORE_GAP_EXTEND per skipped character,
+ * and the first query character's bonus counts double. */
+enum {
+  MENU_SCORE_MATCH = 16,
+  MENU_SCORE_GAP_START = -3,
+  MENU_SCORE_GAP_EXTEND = -1,
+  MENU_BONUS_BOUNDARY = 8,    /* label start, or after a non-alphanumeric */
+  MENU_BONUS_CAMEL = 7,       /* lower-to-upper or letter-to-digit step */
+  MENU_BONUS_CONSECUTIVE = 4, /* follows the previous matched character */
+};
+
+static int menu_fuzzy_bonus(const wchar_t *label, size_t i) {
+  if (i == 0 || !iswalnum(label[i - 1]))
+    return MENU_BONUS_BOUNDARY;
+  if ((iswlower(label[i - 1]) && iswupper(label[i])) ||
+      (!iswdigit(label[i - 1]) && iswdigit(label[i])))
+    return MENU_BONUS_CAMEL;
+  return 0;
+}
+
+/* Score `q` (m >= 1 folded chars) as a subsequence of `fold`, the folded
+ * copy of `label`; INT_MIN when it is not one. Like fzf's v1 algorithm, the
+ * first forward match fixes the end, a backward pass from there finds the
+ * shortest window ending at it, and only that window is scored. */
+static int menu_fuzzy_score(const wchar_t *fold, const wchar_t *label,
+                            const wchar_t *q, size_t m) {
+  size_t qi = 0;
+  size_t end = 0;
+  for (size_t i = 0; fold[i]; i++) {
+    if (fold[i] == q[qi] && ++qi == m) {
+      end = i;
+      break;
+    }
+  }
+  if (qi < m)
+    return INT_MIN;
+  size_t start = end;
+  for (size_t i = end + 1; i-- > 0;) {
+    if (fold[i] == q[qi - 1] && --qi == 0) {
+      start = i;
+      break;
+    }
+  }
+
+  int score = 0;
+  int prev_bonus = 0;
+  bool in_gap = false;
+  bool consecutive = false;
+  qi = 0;
+  for (size_t i = start; i <= end && qi < m; i++) {
+    if (fold[i] != q[qi]) {
+      score += in_gap ? MENU_SCORE_GAP_EXTEND : MENU_SCORE_GAP_START;
+      in_gap = true;
+      consecutive = false;
+      continue;
+    }
+    int bonus = menu_fuzzy_bonus(label, i);
+    if (consecutive) {
+      /* A run keeps the bonus of the boundary it started on. */
+      if (prev_bonus > bonus)
+        bonus = prev_bonus;
+      if (bonus < MENU_BONUS_CONSECUTIVE)
+        bonus = MENU_BONUS_CONSECUTIVE;
+    }
+    score += MENU_SCORE_MATCH + (qi == 0 ? 2 * bonus : bonus);
+    prev_bonus = bonus;
+    in_gap = false;
+    consecutive = true;
+    qi++;
+  }
+  return score;
+}
+
+/* Higher score first, then the shorter label, then source order. */
+static bool menu_rank_better(const menu_rank_t *a, const menu_rank_t *b) {
+  if (a->score != b->score)
+    return a->score > b->score;
+  if (a->length != b->length)
+    return a->length < b->length;
+  return a->index < b->index;
+}
+
+static int menu_rank_cmp(const void *a, const void *b) {
+  return menu_rank_better(a, b) ? -1 : menu_rank_better(b, a) ? 1 : 0;
+}
+
+/* Offer `r` to a bounded min-heap whose root is the worst kept match. */
+static void menu_heap_offer(menu_rank_t *heap, int *count, menu_rank_t r) {
+  int i;
+  if (*count < MENU_FUZZY_TOP_K) {
+    i = (*count)++;
+    while (i > 0) {
+      const int parent = (i - 1) / 2;
+      if (!menu_rank_better(&heap[parent], &r))
+        break;
+      heap[i] = heap[parent];
+      i = parent;
+    }
+    heap[i] = r;
     return;
   }
-  s->search_buf[s->search_len] = 0;
-  for (int i = 0; i < s->cfg->item_count; i++) {
-    if (s->cfg->items[i].kind == TUI_MENU_ITEM_SEPARATOR)
+  if (!menu_rank_better(&r, &heap[0]))
+    return;
+  i = 0;
+  for (;;) {
+    int worst = i;
+    const menu_rank_t *w = &r;
+    for (int c = 2 * i + 1; c <= 2 * i + 2 && c < *count; c++) {
+      if (menu_rank_better(w, &heap[c])) {
+        worst = c;
+        w = &heap[c];
+      }
+    }
+    if (worst == i)
+      break;
+    heap[i] = heap[worst];
+    i = worst;
+  }
+  heap[i] = r;
+}
+
+static void menu_fuzzy_run(menu_fuzzy_worker_t *w) {
+  struct tui_menu_state *s = w->state;
+  for (int i = w->begin; i < w->end; i++) {
+    if ((i - w->begin) % MENU_FUZZY_STRIDE == 0 &&
+        atomic_load_explicit(&s->fuzzy_cancel, memory_order_relaxed))
+      break;
+    const wchar_t *label = NULL;
+    size_t len = 0;
+    const wchar_t *fold = menu_search_label(s, i, &label, &len);
+    if (!fold)
+      continue;
+    const int score =
+        menu_fuzzy_score(fold, label, s->search_fold, s->search_len);
+    if (score == INT_MIN)
       continue;
-    const wchar_t *lab = s->label_w[i] ? s->label_w[i] : L"";
-    if (wcs_contains_icase(lab, s->search_buf)) {
-      s->visible[s->visible_count++] = i;
+    w->matched++;
+    menu_heap_offer(w->heap, &w->heap_count,
+                    (menu_rank_t){.index = i,
+                                  .score = score,
+                                  .length = (int)len});
+  }
+  atomic_store_explicit(&w->done, true, memory_order_release);
+  const tui_menu_notify_fn notify = atomic_load(&s->notify);
+  if (notify)
+    notify();
+}
+
+#if MENU_FUZZY_THREADS
+static void *menu_fuzzy_thread(void *arg) {
+  menu_fuzzy_run(arg);
+  return NULL;
+}
+#endif
+
+/* Merge the heaps of every finished worker into a ranked visible[]. */
+static void menu_fuzzy_publish(struct tui_menu_state *s) {
+  int n = 0;
+  int matched = 0;
+  int finished = 0;
+  for (int k = 0; k < s->fuzzy_workers; k++) {
+    menu_fuzzy_worker_t *w = &s->fuzzy[k];
+    if (!atomic_load_explicit(&w->done, memory_order_acquire))
+      continue;
+    if (w->heap_count > 0)
+      memcpy(s->fuzzy_merge + n, w->heap,
+             (size_t)w->heap_count * sizeof(*w->heap));
+    n += w->heap_count;
+    matched += w->matched;
+    finished++;
+  }
+  if (finished == s->fuzzy_published)
+    return;
+  s->fuzzy_published = finished;
+  qsort(s->fuzzy_merge, (size_t)n, sizeof(*s->fuzzy_merge), menu_rank_cmp);
+  if (n > MENU_FUZZY_TOP_K)
+    n = MENU_FUZZY_TOP_K;
+  for (int v = 0; v < n; v++)
+    s->visible[v] = s->fuzzy_merge[v].index;
+  s->visible_all = false;
+  s->visible_count = n;
+  s->match_count = matched;
+  s->damage_full = true;
+  menu_state_snap_selection(s);
+}
+
+/* Cancel the query being scored, wait for its workers and drop their
+ * results. */
+static void menu_fuzzy_stop(struct tui_menu_state *s) {
+  atomic_store(&s->fuzzy_cancel, true);
+  for (int k = 0; k < s->fuzzy_workers; k++) {
+#if MENU_FUZZY_THREADS
+    if (s->fuzzy[k].started)
+      pthread_join(s->fuzzy[k].thread, NULL);
+    s->fuzzy[k].started = false;
+#endif
+    free(s->fuzzy[k].heap);
+    s->fuzzy[k].heap = NULL;
+  }
+  s->fuzzy_workers = 0;
+  s->fuzzy_published = 0;
+  atomic_store(&s->fuzzy_cancel, false);
+}
+
+/* Whether the current query is scored off the UI thread. Item sources are
+ * not required to be thread-safe, so they are always scored inline. */
+static bool menu_fuzzy_background(const struct tui_menu_state *s) {
+  return MENU_FUZZY_THREADS && !s->cfg->item_source &&
+         s->item_count >= MENU_FUZZY_PARALLEL_MIN;
+}
+
+static int menu_fuzzy_worker_count(const struct tui_menu_state *s) {
+  if (!menu_fuzzy_background(s))
+    return 1;
+  long cpus = 4;
+#if MENU_FUZZY_THREADS && defined(_SC_NPROCESSORS_ONLN)
+  cpus = sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+  if (cpus < 1)
+    cpus = 1;
+  return cpus < MENU_FUZZY_WORKERS ? (int)cpus : MENU_FUZZY_WORKERS;
+}
+
+/* Rank every item against the current query. Small menus are scored inline
+ * and published before returning; large ones are scored by background
+ * workers (even on one CPU, so typing never waits for a scan) and published
+ * as tui_menu_state_poll() observes them finishing. */
+static void menu_state_rank(struct tui_menu_state *s) {
+  menu_fuzzy_stop(s);
+  s->damage_full = true;
+  /* The previous results stay on screen until the first worker reports. */
+  const int n = s->item_count;
+  if (!s->visible)
+    s->visible = calloc((size_t)s->item_capacity, sizeof(int));
+  if (!s->fuzzy_merge)
+    s->fuzzy_merge = calloc(MENU_FUZZY_WORKERS * MENU_FUZZY_TOP_K,
+                            sizeof(*s->fuzzy_merge));
+  if (!s->visible || !s->fuzzy_merge) {
+    s->visible_all = true; /* keep showing everything rather than nothing */
+    s->visible_count = n;
+    return;
+  }
+  const bool background = menu_fuzzy_background(s);
+  const int workers = menu_fuzzy_worker_count(s);
+  for (int k = 0; k < workers; k++) {
+    menu_fuzzy_worker_t *w = &s->fuzzy[k];
+    w->state = s;
+    w->begin = (int)((long long)n * k / workers);
+    w->end = (int)((long long)n * (k + 1) / workers);
+    w->heap = calloc(MENU_FUZZY_TOP_K, sizeof(*w->heap));
+    w->heap_count = 0;
+    w->matched = 0;
+    atomic_store(&w->done, w->heap == NULL);
+    s->fuzzy_workers = k + 1;
+  }
+  for (int k = 0; k < workers; k++) {
+    menu_fuzzy_worker_t *w = &s->fuzzy[k];
+    if (!w->heap)
+      continue;
+#if MENU_FUZZY_THREADS
+    if (background) {
+      w->started = pthread_create(&w->thread, NULL, menu_fuzzy_thread, w) == 0;
+      if (w->started)
+        continue;
     }
+#endif
+    menu_fuzzy_run(w); /* inline, or the thread could not start */
+  }
+  menu_fuzzy_publish(s);
+}
+
+/* Grow every per-item array to hold `need` items. */
+static bool menu_state_reserve(struct tui_menu_state *s, int need) {
+  if (need <= s->item_capacity)
+    return true;
+  int cap = s->item_capacity;
+  while (cap < need)
+    cap = cap > INT_MAX / 2 ? INT_MAX : cap * 2;
+  const size_t n = (size_t)cap;
+  tui_menu_item_t *items = realloc(s->owned_items, n * sizeof(*items));
+  if (items)
+    s->items = s->owned_items = items;
+  size_t *label_off = realloc(s->label_off, n * sizeof(*label_off));
+  if (label_off)
+    s->label_off = label_off;
+  int *label_len = realloc(s->label_len, n * sizeof(*label_len));
+  if (label_len)
+    s->label_len = label_len;
+  wchar_t *mnemonics = realloc(s->mnemonics, n * sizeof(*mnemonics));
+  if (mnemonics)
+    s->mnemonics = mnemonics;
+  unsigned char *item_flags = realloc(s->item_flags, n * sizeof(*item_flags));
+  if (item_flags)
+    s->item_flags = item_flags;
+  bool ok = items && label_off && label_len && mnemonics && item_flags;
+  /* The filter arrays exist once a search has run; keep them item-sized. */
+  if (ok && s->visible) {
+    int *visible = realloc(s->visible, n * sizeof(*visible));
+    ok = visible != NULL;
+    if (visible)
+      s->visible = visible;
+  }
+  if (ok && s->dropped) {
+    int *dropped = realloc(s->dropped, n * sizeof(*dropped));
+    ok = dropped != NULL;
+    if (dropped)
+      s->dropped = dropped;
+  }
+  if (ok)
+    s->item_capacity = cap;
+  return ok;
+}
+
+static void menu_state_feed_item(void *user, const tui_menu_item_t *item) {
+  struct tui_menu_state *s = user;
+  /* Fuzzy workers read the arrays that may be reallocated below; the query
+   * is re-ranked once the batch is in. */
+  menu_fuzzy_stop(s);
+  if (s->item_count == INT_MAX || !menu_state_reserve(s, s->item_count + 1))
+    return; /* out of memory: the item is dropped */
+  const int i = s->item_count;
+  s->owned_items[i] = *item;
+  if (!menu_state_parse_label_at(s, i))
+    return;
+  if (item->kind != TUI_MENU_ITEM_SEPARATOR)
+    s->listable_count++;
+  s->item_count++;
+}
+
+/* Re-apply the current query after items arrived, keeping the selected item
+ * selected when it still matches. */
+static void menu_state_refilter(struct tui_menu_state *s, int selected) {
+  const size_t len = s->search_len;
+  s->drop_count = 0;
+  s->visible_all = true;
+  s->visible_count = s->item_count;
+  for (size_t k = 1; k <= len; k++) {
+    s->search_len = k;
+    menu_state_narrow(s);
   }
-  /* Snap selection to first selectable visible. */
-  s->selected_visible = 0;
   for (int v = 0; v < s->visible_count; v++) {
-    if (menu_item_selectable(&s->cfg->items[s->visible[v]])) {
+    if (menu_visible_item(s, v) == selected) {
       s->selected_visible = v;
-      return;
+      break;
     }
   }
 }
 
+/* Append whatever the feed delivered since the last tick. */
+static void menu_state_feed(struct tui_menu_state *s) {
+  const int before = s->item_count;
+  const int selected = tui_menu_state_selected_index(s);
+  const bool had_selection =
+      selected >= 0 && menu_selectable_at(s, selected);
+  s->loading = !tui_menu_feed_drain(s->cfg->feed, menu_state_feed_item, s);
+  if (s->item_count == before) {
+    if (!s->loading)
+      s->damage_full = true; /* the meta line drops "loading" */
+    return;
+  }
+  s->damage_full = true;
+  if (!s->search_active || s->search_len == 0)
+    s->visible_count = s->item_count;
+  else if (s->cfg->fuzzy_search)
+    menu_state_rank(s);
+  else
+    menu_state_refilter(s, selected);
+  if (!had_selection)
+    menu_state_snap_selection(s);
+}
+
 tui_menu_status_t tui_menu_state_create(const tui_menu_config_t *cfg,
                                         tui_menu_state_t **out) {
   if (!cfg || !out)
     return TUI_MENU_INVALID_ARG;
   *out = NULL;
-  if (!cfg->items || cfg->item_count <= 0)
+  if (cfg->feed ? (cfg->item_source || cfg->item_count < 0 ||
+                   (cfg->item_count > 0 && !cfg->items))
+                : ((!cfg->items && !cfg->item_source) || cfg->item_count <= 0))
     return TUI_MENU_INVALID_ARG;
   if ((size_t)cfg->item_count > SIZE_MAX / sizeof(int)) {
     return TUI_MENU_INVALID_ARG;
@@ -140,36 +881,62 @@ tui_menu_status_t tui_menu_state_create(const tui_menu_config_t *cfg,
   if (!s)
     return TUI_MENU_NO_MEMORY;
   s->cfg = cfg;
+  s->items = cfg->items;
+  s->item_count = cfg->item_count;
+  s->item_capacity = cfg->item_count;
 
-  s->visible = calloc((size_t)cfg->item_count, sizeof(int));
-  s->label_w = calloc((size_t)cfg->item_count, sizeof(wchar_t *));
-  s->mnemonics = calloc((size_t)cfg->item_count, sizeof(wchar_t));
-  if (!s->visible || !s->label_w || !s->mnemonics) {
-    tui_menu_state_destroy(s);
-    return TUI_MENU_NO_MEMORY;
+  if (cfg->item_source) {
+    /* Virtualized: nothing is fetched or decoded until it is drawn. */
+    s->label_cache = calloc(MENU_LABEL_CACHE_ROWS, sizeof(*s->label_cache));
+    if (!s->label_cache) {
+      tui_menu_state_destroy(s);
+      return TUI_MENU_NO_MEMORY;
+    }
+    for (int i = 0; i < MENU_LABEL_CACHE_ROWS; i++)
+      s->label_cache[i].index = -1;
+    s->listable_count = cfg->item_count;
+  } else {
+    if (cfg->feed) {
+      /* Arrivals are appended to a copy of the initial items. */
+      s->loading = true;
+      s->item_capacity = cfg->item_count > 16 ? cfg->item_count : 16;
+      s->owned_items = calloc((size_t)s->item_capacity, sizeof(*s->items));
+      if (s->owned_items && cfg->item_count > 0)
+        memcpy(s->owned_items, cfg->items,
+               (size_t)cfg->item_count * sizeof(*s->items));
+      s->items = s->owned_items;
+    }
+    const size_t n = (size_t)s->item_capacity;
+    s->label_off = malloc(n * sizeof(*s->label_off));
+    s->label_len = malloc(n * sizeof(*s->label_len));
+    s->mnemonics = malloc(n * sizeof(*s->mnemonics));
+    s->item_flags = malloc(n * sizeof(*s->item_flags));
+    if ((cfg->feed && !s->owned_items) || !s->label_off || !s->label_len ||
+        !s->mnemonics || !s->item_flags || !menu_state_parse_labels(s)) {
+      tui_menu_state_destroy(s);
+      return TUI_MENU_NO_MEMORY;
+    }
+    for (int i = 0; i < cfg->item_count; i++) {
+      if (cfg->items[i].kind != TUI_MENU_ITEM_SEPARATOR)
+        s->listable_count++;
+    }
   }
-
-  menu_state_parse_labels(s);
-  menu_state_apply_filter(s);
+  menu_state_clear_filter(s);
 
   int initial = -1;
   if (cfg->default_index >= 0 && cfg->default_index < cfg->item_count &&
-      menu_item_selectable(&cfg->items[cfg->default_index])) {
+      menu_selectable_at(s, cfg->default_index)) {
     initial = cfg->default_index;
   } else {
-    initial = menu_first_enabled(cfg);
+    initial = menu_first_enabled(s);
   }
-  if (initial < 0) {
+  if (initial < 0 && !cfg->feed) {
     tui_menu_state_destroy(s);
     return TUI_MENU_INVALID_ARG;
   }
-  /* Find initial in visible[]. */
-  for (int v = 0; v < s->visible_count; v++) {
-    if (s->visible[v] == initial) {
-      s->selected_visible = v;
-      break;
-    }
-  }
+  if (initial < 0)
+    initial = 0; /* the feed may still deliver something selectable */
+  s->selected_visible = initial; /* unfiltered: visible row == item index */
   *out = s;
   return TUI_MENU_OK;
 }
@@ -177,13 +944,25 @@ tui_menu_status_t tui_menu_state_create(const tui_menu_config_t *cfg,
 void tui_menu_state_destroy(tui_menu_state_t *s) {
   if (!s)
     return;
-  if (s->label_w) {
-    for (int i = 0; i < s->cfg->item_count; i++)
-      free(s->label_w[i]);
-    free(s->label_w);
+  menu_fuzzy_stop(s);
+  if (s->cfg->feed)
+    tui_menu_feed_set_notify(s->cfg->feed, NULL);
+  if (s->label_cache) {
+    for (int i = 0; i < MENU_LABEL_CACHE_ROWS; i++)
+      free(s->label_cache[i].label);
+    free(s->label_cache);
   }
+  free(s->label_text);
+  free(s->fold_text);
+  free(s->scratch);
+  free(s->label_off);
+  free(s->label_len);
   free(s->mnemonics);
+  free(s->item_flags);
   free(s->visible);
+  free(s->dropped);
+  free(s->fuzzy_merge);
+  free(s->owned_items);
   free(s);
 }
 
@@ -191,10 +970,47 @@ int tui_menu_state_visible_count(const tui_menu_state_t *s) {
   return s ? s->visible_count : 0;
 }
 
+int tui_menu_state_match_count(const tui_menu_state_t *s) {
+  if (!s)
+    return 0;
+  return s->cfg->fuzzy_search && !s->visible_all ? s->match_count
+                                                 : s->visible_count;
+}
+
+bool tui_menu_state_pending(const tui_menu_state_t *s) {
+  return s && (s->loading || s->fuzzy_published < s->fuzzy_workers);
+}
+
+void tui_menu_state_poll(tui_menu_state_t *s) {
+  if (!s)
+    return;
+  if (s->loading)
+    menu_state_feed(s);
+  if (s->fuzzy_published < s->fuzzy_workers)
+    menu_fuzzy_publish(s);
+}
+
+void tui_menu_state_set_notify(tui_menu_state_t *s,
+                               tui_menu_notify_fn notify) {
+  if (!s)
+    return;
+  atomic_store(&s->notify, notify);
+  if (s->cfg->feed)
+    tui_menu_feed_set_notify(s->cfg->feed, notify);
+}
+
+bool tui_menu_state_loading(const tui_menu_state_t *s) {
+  return s && s->loading;
+}
+
+int tui_menu_state_item_count(const tui_menu_state_t *s) {
+  return s ? s->item_count : 0;
+}
+
 int tui_menu_state_selected_index(const tui_menu_state_t *s) {
   if (!s || s->visible_count == 0)
     return -1;
-  return s->visible[s->selected_visible];
+  return menu_visible_item(s, s->selected_visible);
 }
 
 int tui_menu_state_selected_visible(const tui_menu_state_t *s) {
@@ -221,8 +1037,7 @@ void tui_menu_state_ensure_selection_visible(tui_menu_state_t *s,
 bool tui_menu_state_select_visible(tui_menu_state_t *s, int visible_row) {
   if (!s || visible_row < 0 || visible_row >= s->visible_count)
     return false;
-  const int item_idx = s->visible[visible_row];
-  if (!menu_item_selectable(&s->cfg->items[item_idx]))
+  if (!menu_selectable_at(s, menu_visible_item(s, visible_row)))
     return false;
   s->selected_visible = visible_row;
   return true;
@@ -237,17 +1052,31 @@ const wchar_t *tui_menu_state_search_query(const tui_menu_state_t *s) {
 }
 
 const wchar_t *tui_menu_state_label_wcs(const tui_menu_state_t *s, int idx) {
-  if (!s || idx < 0 || idx >= s->cfg->item_count)
+  if (!s || idx < 0 || idx >= s->item_count)
     return L"";
-  return s->label_w[idx] ? s->label_w[idx] : L"";
+  const wchar_t *label =
+      s->label_cache ? menu_cached_label(s, idx)
+                     : s->label_text + s->label_off[idx];
+  return label ? label : L"";
 }
 
 wchar_t tui_menu_state_mnemonic(const tui_menu_state_t *s, int idx) {
-  if (!s || idx < 0 || idx >= s->cfg->item_count)
+  if (!s || !s->mnemonics || idx < 0 || idx >= s->item_count)
     return 0;
   return s->mnemonics[idx];
 }
 
+tui_menu_item_t tui_menu_state_item(const tui_menu_state_t *s, int idx) {
+  if (!s || idx < 0 || idx >= s->item_count)
+    return (tui_menu_item_t){.disabled = true};
+  tui_menu_item_t tmp;
+  return *menu_item(s, idx, &tmp);
+}
+
+int tui_menu_state_listable_count(const tui_menu_state_t *s) {
+  return s ? s->listable_count : 0;
+}
+
 void tui_menu_state_step(tui_menu_state_t *s, int direction) {
   if (!s || s->visible_count == 0 || direction == 0)
     return;
@@ -258,8 +1087,7 @@ void tui_menu_state_step(tui_menu_state_t *s, int direction) {
       next = s->visible_count - 1;
     else if (next >= s->visible_count)
       next = 0;
-    const int item_idx = s->visible[next];
-    if (menu_item_selectable(&s->cfg->items[item_idx])) {
+    if (menu_selectable_at(s, menu_visible_item(s, next))) {
       s->selected_visible = next;
       return;
     }
@@ -270,7 +1098,7 @@ void tui_menu_state_home(tui_menu_state_t *s) {
   if (!s || s->visible_count == 0)
     return;
   for (int v = 0; v < s->visible_count; v++) {
-    if (menu_item_selectable(&s->cfg->items[s->visible[v]])) {
+    if (menu_selectable_at(s, menu_visible_item(s, v))) {
       s->selected_visible = v;
       return;
     }
@@ -280,7 +1108,7 @@ void tui_menu_state_end(tui_menu_state_t *s) {
   if (!s || s->visible_count == 0)
     return;
   for (int v = s->visible_count - 1; v >= 0; v--) {
-    if (menu_item_selectable(&s->cfg->items[s->visible[v]])) {
+    if (menu_selectable_at(s, menu_visible_item(s, v))) {
       s->selected_visible = v;
       return;
     }
@@ -312,7 +1140,7 @@ void tui_menu_state_search_open(tui_menu_state_t *s) {
   s->search_active = true;
   s->search_len = 0;
   s->search_buf[0] = 0;
-  menu_state_apply_filter(s);
+  menu_state_clear_filter(s);
 }
 
 void tui_menu_state_search_close(tui_menu_state_t *s) {
@@ -321,7 +1149,7 @@ void tui_menu_state_search_close(tui_menu_state_t *s) {
   s->search_active = false;
   s->search_len = 0;
   s->search_buf[0] = 0;
-  menu_state_apply_filter(s);
+  menu_state_clear_filter(s);
 }
 
 void tui_menu_state_search_append(tui_menu_state_t *s, wchar_t ch) {
@@ -330,32 +1158,45 @@ void tui_menu_state_search_append(tui_menu_state_t *s, wchar_t ch) {
   const size_t cap = (sizeof(s->search_buf) / sizeof(s->search_buf[0])) - 1;
   if (s->search_len >= cap)
     return;
+  menu_fuzzy_stop(s); /* workers read the query being edited */
+  s->search_fold[s->search_len] = menu_fold_char(ch);
   s->search_buf[s->search_len++] = ch;
   s->search_buf[s->search_len] = 0;
-  menu_state_apply_filter(s);
+  s->search_fold[s->search_len] = 0;
+  if (s->cfg->fuzzy_search)
+    menu_state_rank(s);
+  else
+    menu_state_narrow(s);
 }
 
 void tui_menu_state_search_backspace(tui_menu_state_t *s) {
   if (!s || !s->search_active || s->search_len == 0)
     return;
+  menu_fuzzy_stop(s);
   s->search_len--;
   s->search_buf[s->search_len] = 0;
-  menu_state_apply_filter(s);
+  s->search_fold[s->search_len] = 0;
+  if (s->search_len == 0)
+    menu_state_clear_filter(s);
+  else if (s->cfg->fuzzy_search)
+    menu_state_rank(s);
+  else
+    menu_state_widen(s);
 }
 int tui_menu_state_mnemonic_jump(tui_menu_state_t *s, wchar_t key,
                                  bool *out_beep) {
   if (out_beep)
     *out_beep = false;
-  if (!s || key == 0)
-    return -1;
+  if (!s || !s->mnemonics || key == 0)
+    return -1; /* item_source menus have no mnemonics */
   const wchar_t target = (wchar_t)towlower(key);
 
   int matches[2] = {-1, -1};
   int match_count = 0;
-  for (int i = 0; i < s->cfg->item_count; i++) {
+  for (int i = 0; i < s->item_count; i++) {
     if (s->mnemonics[i] != target)
       continue;
-    const tui_menu_item_t *it = &s->cfg->items[i];
+    const tui_menu_item_t *it = &s->items[i];
     if (it->disabled || it->kind == TUI_MENU_ITEM_SEPARATOR) {
       continue;
     }
@@ -376,7 +1217,7 @@ int tui_menu_state_mnemonic_jump(tui_menu_state_t *s, wchar_t key,
   int target_visible = -1;
   bool past_current = false;
   for (int v = 0; v < s->visible_count; v++) {
-    const int idx = s->visible[v];
+    const int idx = menu_visible_item(s, v);
     if (idx == current) {
       past_current = true;
       continue;
@@ -384,7 +1225,7 @@ int tui_menu_state_mnemonic_jump(tui_menu_state_t *s, wchar_t key,
     if (!past_current)
       continue;
     if (s->mnemonics[idx] == target &&
-        menu_item_selectable(&s->cfg->items[idx])) {
+        menu_item_selectable(&s->items[idx])) {
       target_visible = v;
       break;
     }
@@ -392,9 +1233,9 @@ int tui_menu_state_mnemonic_jump(tui_menu_state_t *s, wchar_t key,
   if (target_visible < 0) {
     /* wrap to first match before current */
     for (int v = 0; v < s->visible_count; v++) {
-      const int idx = s->visible[v];
+      const int idx = menu_visible_item(s, v);
       if (s->mnemonics[idx] == target &&
-          menu_item_selectable(&s->cfg->items[idx])) {
+          menu_item_selectable(&s->items[idx])) {
         target_visible = v;
         break;
       }
@@ -409,7 +1250,7 @@ int tui_menu_state_mnemonic_jump(tui_menu_state_t *s, wchar_t key,
 void tui_menu_state_numeric_jump(tui_menu_state_t *s, int visible_row) {
   if (!s || visible_row < 0 || visible_row >= s->visible_count)
     return;
-  if (menu_item_selectable(&s->cfg->items[s->visible[visible_row]])) {
+  if (menu_selectable_at(s, menu_visible_item(s, visible_row))) {
     s->selected_visible = visible_row;
   }
 }
@@ -417,11 +1258,13 @@ void tui_menu_state_numeric_jump(tui_menu_state_t *s, int visible_row) {
 int tui_menu_state_number_for_row(const tui_menu_state_t *s, int visible_row) {
   if (!s || visible_row < 0 || visible_row >= s->visible_count)
     return 0;
-  if (s->cfg->items[s->visible[visible_row]].kind == TUI_MENU_ITEM_SEPARATOR)
+  if (menu_separator_at(s, menu_visible_item(s, visible_row)))
     return 0;
+  /* Only 1-9 are shown, so stop counting once past them: rows deep in a
+   * large list cost a handful of lookups, not one per preceding row. */
   int number = 0;
-  for (int v = 0; v <= visible_row; v++) {
-    if (s->cfg->items[s->visible[v]].kind != TUI_MENU_ITEM_SEPARATOR)
+  for (int v = 0; v <= visible_row && number <= 9; v++) {
+    if (!menu_separator_at(s, menu_visible_item(s, v)))
       number++;
   }
   return number;
@@ -432,7 +1275,7 @@ int tui_menu_state_row_for_number(const tui_menu_state_t *s, int number) {
     return -1;
   int seen = 0;
   for (int v = 0; v < s->visible_count; v++) {
-    if (s->cfg->items[s->visible[v]].kind == TUI_MENU_ITEM_SEPARATOR)
+    if (menu_separator_at(s, menu_visible_item(s, v)))
       continue;
     if (++seen == number)
       return v;
@@ -443,7 +1286,34 @@ int tui_menu_state_row_for_number(const tui_menu_state_t *s, int number) {
 int tui_menu_state_visible_at(const tui_menu_state_t *s, int v) {
   if (!s || v < 0 || v >= s->visible_count)
     return -1;
-  return s->visible[v];
+  return menu_visible_item(s, v);
+}
+
+tui_menu_damage_t tui_menu_state_take_damage(tui_menu_state_t *s) {
+  tui_menu_damage_t damage = {0};
+  if (!s)
+    return damage;
+  if (s->damage_full || s->top_visible != s->painted_top) {
+    damage.full = true;
+  } else if (s->selected_visible != s->painted_selected) {
+    damage.meta = true;
+    damage.rows[damage.row_count++] = s->painted_selected;
+    damage.rows[damage.row_count++] = s->selected_visible;
+  }
+  s->damage_full = false;
+  s->painted_selected = s->selected_visible;
+  s->painted_top = s->top_visible;
+  return damage;
+}
+
+bool tui_menu_state_has_damage(const tui_menu_state_t *s) {
+  return s && (s->damage_full || s->top_visible != s->painted_top ||
+               s->selected_visible != s->painted_selected);
+}
+
+void tui_menu_state_invalidate(tui_menu_state_t *s) {
+  if (s)
+    s->damage_full = true;
 }
 
 const tui_menu_config_t *tui_menu_state_config(const tui_menu_state_t *s) {
@@ -1,73 +1,257 @@
 /*
  * tui_progress.c - progress bar implementation using ncurses windows.
+ *
+ * Reporting and drawing are split: tui_progress_add/set/set_status only
+ * touch atomics (and a short spin lock around the status text), so worker
+ * threads can report millions of increments for the price of one atomic
+ * add each. The UI thread samples them in tui_progress_tick, which paints
+ * only the bar cells and text lines that changed since the previous tick.
  */
 
 #include "tui_progress.h"
 
-#include <assert.h>
+#include <stdatomic.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
 #include "tui.h"
+#include "tui_internal.h"
+#include "tui_progress_internal.h"
+
+#define TUI_PROGRESS_STATUS_MAX 128
+#define TUI_PROGRESS_RATE_WINDOW_MS 500 /* throughput sampling interval */
 
 struct tui_progress {
   tui_window_t *window;
   int max_value;
-  int current_value;
   char *title;
+
+  /* Written by any thread. */
+  atomic_int current_value;
+  atomic_bool finished;
+  atomic_flag status_lock;
+  unsigned status_gen; /* bumped per status change; guarded by status_lock */
+  char status[TUI_PROGRESS_STATUS_MAX];
+
+  /* UI thread only: what is on screen and the throughput estimate. */
+  bool drawn;
+  int drawn_fill;
+  int drawn_percent;
+  unsigned drawn_status_gen;
+  char drawn_rate[48];
+  int sample_value;
+  uint64_t sample_ms;
+  double rate; /* units per second, smoothed */
 };
 
-static void tui_progress_draw(tui_progress_t *progress, const char *status) {
-  if (!progress || !progress->window) {
+static void tui_progress_status_lock(tui_progress_t *progress) {
+  while (atomic_flag_test_and_set_explicit(&progress->status_lock,
+                                           memory_order_acquire)) {
+  }
+}
+
+static void tui_progress_status_unlock(tui_progress_t *progress) {
+  atomic_flag_clear_explicit(&progress->status_lock, memory_order_release);
+}
+
+/* Blank the window interior of row `y`, leaving the border intact. */
+static void tui_progress_clear_row(WINDOW *win, int y, int width) {
+  if (width > 2) {
+    mvwhline(win, y, 1, ' ', width - 2);
+  }
+}
+
+/* "950", "12.3k", "4.56M" - keeps the rate line short at any magnitude. */
+void tui_progress_format_count(char *buf, size_t size, double value) {
+  if (value >= 1e9) {
+    snprintf(buf, size, "%.2fG", value / 1e9);
+  } else if (value >= 1e6) {
+    snprintf(buf, size, "%.2fM", value / 1e6);
+  } else if (value >= 1e4) {
+    snprintf(buf, size, "%.1fk", value / 1e3);
+  } else {
+    snprintf(buf, size, "%.0f", value);
+  }
+}
+
+void tui_progress_format_duration(char *buf, size_t size, double seconds) {
+  /* Clamped to 99:59:59 in int arithmetic, so the fields have known widths
+   * and always fit TUI_PROGRESS_DURATION_MAX. */
+  int total = 0;
+  if (seconds >= 359999.0) {
+    total = 359999;
+  } else if (seconds > 0.0) {
+    total = (int)(seconds + 0.5);
+  }
+  const int hours = total / 3600;
+  const int minutes = total / 60 % 60;
+  const int secs = total % 60;
+  if (hours > 0) {
+    snprintf(buf, size, "%d:%02d:%02d", hours, minutes, secs);
+  } else {
+    snprintf(buf, size, "%d:%02d", minutes, secs);
+  }
+}
+
+/* Folds the value sampled at `now` into the smoothed throughput. */
+static void tui_progress_sample_rate(tui_progress_t *progress, int value,
+                                     uint64_t now) {
+  if (progress->sample_ms == 0 || value < progress->sample_value) {
+    progress->sample_ms = now;
+    progress->sample_value = value;
+    return;
+  }
+  const uint64_t elapsed = now - progress->sample_ms;
+  if (elapsed < TUI_PROGRESS_RATE_WINDOW_MS) {
+    return;
+  }
+  const double instant =
+      (double)(value - progress->sample_value) * 1000.0 / (double)elapsed;
+  progress->rate =
+      progress->rate > 0.0 ? 0.7 * progress->rate + 0.3 * instant : instant;
+  progress->sample_ms = now;
+  progress->sample_value = value;
+}
+
+void tui_progress_format_rate(char *buf, size_t size, double rate, int value,
+                              int max_value) {
+  buf[0] = '\0';
+  if (rate <= 0.0) {
+    return;
+  }
+  char count[16];
+  tui_progress_format_count(count, sizeof(count), rate);
+  if (value >= max_value) {
+    snprintf(buf, size, "%s/s", count);
     return;
   }
+  char eta[TUI_PROGRESS_DURATION_MAX];
+  tui_progress_format_duration(eta, sizeof(eta),
+                               (double)(max_value - value) / rate);
+  snprintf(buf, size, "%s/s  ETA %s", count, eta);
+}
 
+int tui_progress_value(const tui_progress_t *progress) {
+  return progress ? atomic_load_explicit(&progress->current_value,
+                                         memory_order_relaxed)
+                  : 0;
+}
+
+/* Paint the differences between the sampled state and what is on screen;
+ * returns whether anything was drawn. */
+static bool tui_progress_draw(tui_progress_t *progress) {
+  tui_frame_t frame = tui_frame_begin();
+  tui_frame_layout_done(&frame);
   tui_window_t *window = progress->window;
   WINDOW *win = window->win;
-  tui_clear_window(window);
-
-  if (progress->title) {
-    tui_set_color(win, TUI_COLOR_TITLE);
-    tui_print_centered(win, 1, progress->title);
-    tui_unset_color(win, TUI_COLOR_TITLE);
+  const bool full = !progress->drawn;
+  if (full) {
+    tui_clear_window(window);
+    if (progress->title) {
+      tui_set_color(win, TUI_COLOR_TITLE);
+      tui_print_centered(win, 1, progress->title);
+      tui_unset_color(win, TUI_COLOR_TITLE);
+    }
+    progress->drawn = true;
+    progress->drawn_fill = -1;
+    progress->drawn_percent = -1;
+    progress->drawn_rate[0] = '\x01'; /* never a real rate line */
   }
 
   const int bar_width = window->width - 6;
   const int bar_y = window->height / 2;
   const int bar_x = 3;
   if (bar_width <= 0) {
-    tui_refresh_window(window);
-    return;
+    if (full) {
+      wnoutrefresh(win);
+      tui_frame_flush(&frame);
+    }
+    return full;
   }
+  bool changed = full;
 
-  int current_value = progress->current_value;
-  if (current_value < 0) {
-    current_value = 0;
+  int value = atomic_load_explicit(&progress->current_value,
+                                   memory_order_relaxed);
+  if (value < 0) {
+    value = 0;
   }
-  if (current_value > progress->max_value) {
-    current_value = progress->max_value;
+  if (value > progress->max_value) {
+    value = progress->max_value;
   }
+  const double ratio = (double)value / (double)progress->max_value;
+  const int fill = (int)(ratio * bar_width);
+  const int percent = (int)(ratio * 100.0);
 
-  assert(progress->max_value > 0);
-  double ratio = (double)current_value / (double)progress->max_value;
+  char label[16];
+  snprintf(label, sizeof(label), "%3d%%", percent);
+  const int label_len = (int)strlen(label);
+  const int label_x = (window->width - label_len) / 2;
 
-  const int fill_width = (int)(ratio * bar_width);
-
-  mvwhline(win, bar_y, bar_x, ' ', bar_width);
-
-  tui_set_color(win, TUI_COLOR_HIGHLIGHT);
-  mvwhline(win, bar_y, bar_x, ' ', fill_width);
-  tui_unset_color(win, TUI_COLOR_HIGHLIGHT);
+  /* Only the cells between the old and new fill change colour. */
+  bool label_damaged = percent != progress->drawn_percent;
+  if (progress->drawn_fill < 0) {
+    mvwhline(win, bar_y, bar_x, ' ', bar_width);
+    tui_set_color(win, TUI_COLOR_HIGHLIGHT);
+    mvwhline(win, bar_y, bar_x, ' ', fill);
+    tui_unset_color(win, TUI_COLOR_HIGHLIGHT);
+    label_damaged = true;
+  } else if (fill != progress->drawn_fill) {
+    const int lo = fill < progress->drawn_fill ? fill : progress->drawn_fill;
+    const int hi = fill < progress->drawn_fill ? progress->drawn_fill : fill;
+    if (fill > progress->drawn_fill) {
+      tui_set_color(win, TUI_COLOR_HIGHLIGHT);
+    }
+    mvwhline(win, bar_y, bar_x + lo, ' ', hi - lo);
+    if (fill > progress->drawn_fill) {
+      tui_unset_color(win, TUI_COLOR_HIGHLIGHT);
+    }
+    changed = true;
+    label_damaged = label_damaged ||
+                    (bar_x + lo < label_x + label_len && bar_x + hi > label_x);
+  }
+  if (label_damaged) {
+    tui_print_centered(win, bar_y, label);
+    changed = true;
+  }
+  progress->drawn_fill = fill;
+  progress->drawn_percent = percent;
 
-  char percent[16];
-  snprintf(percent, sizeof(percent), "%3d%%", (int)(ratio * 100.0));
-  tui_print_centered(win, bar_y, percent);
+  char rate[sizeof(progress->drawn_rate)];
+  tui_progress_format_rate(rate, sizeof(rate), progress->rate, value,
+                           progress->max_value);
+  if (strcmp(rate, progress->drawn_rate) != 0) {
+    tui_progress_clear_row(win, bar_y + 1, window->width);
+    tui_set_color(win, TUI_COLOR_INFO);
+    tui_print_centered(win, bar_y + 1, rate);
+    tui_unset_color(win, TUI_COLOR_INFO);
+    memcpy(progress->drawn_rate, rate, sizeof(rate));
+    changed = true;
+  }
 
-  if (status) {
+  /* Copy the status out under the lock; draw outside it. */
+  char status[TUI_PROGRESS_STATUS_MAX];
+  bool status_changed = false;
+  tui_progress_status_lock(progress);
+  if (full || progress->status_gen != progress->drawn_status_gen) {
+    memcpy(status, progress->status, sizeof(status));
+    progress->drawn_status_gen = progress->status_gen;
+    status_changed = true;
+  }
+  tui_progress_status_unlock(progress);
+  if (status_changed) {
+    if (!full) {
+      tui_progress_clear_row(win, bar_y + 2, window->width);
+    }
     tui_print_centered(win, bar_y + 2, status);
+    changed = true;
   }
 
-  tui_refresh_window(window);
+  if (changed) {
+    wnoutrefresh(win);
+    tui_frame_flush(&frame);
+  }
+  return changed;
 }
 
 APP_NODISCARD tui_progress_t *tui_progress_create(const char *title, int max) {
@@ -99,19 +283,106 @@ APP_NODISCARD tui_progress_t *tui_progress_create(const char *title, int max) {
   }
   progress->window = w;
   progress->max_value = max;
-  progress->current_value = 0;
   progress->title = title ? strdup(title) : NULL;
+  atomic_init(&progress->current_value, 0);
+  atomic_init(&progress->finished, false);
+  atomic_flag_clear(&progress->status_lock);
 
-  tui_progress_draw(progress, NULL);
+  (void)tui_progress_draw(progress);
   return progress;
 }
 
+void tui_progress_add(tui_progress_t *progress, int delta) {
+  if (progress) {
+    atomic_fetch_add_explicit(&progress->current_value, delta,
+                              memory_order_relaxed);
+  }
+}
+
+void tui_progress_set(tui_progress_t *progress, int current) {
+  if (progress) {
+    atomic_store_explicit(&progress->current_value, current,
+                          memory_order_relaxed);
+  }
+}
+
+void tui_progress_set_status(tui_progress_t *progress, const char *status) {
+  if (!progress) {
+    return;
+  }
+  tui_progress_status_lock(progress);
+  if (strncmp(progress->status, status ? status : "",
+              sizeof(progress->status)) != 0) {
+    snprintf(progress->status, sizeof(progress->status), "%s",
+             status ? status : "");
+    progress->status_gen++;
+  }
+  tui_progress_status_unlock(progress);
+}
+
+void tui_progress_finish(tui_progress_t *progress) {
+  if (progress) {
+    atomic_store_explicit(&progress->finished, true, memory_order_release);
+    tui_wake();
+  }
+}
+
+bool tui_progress_tick(tui_progress_t *progress) {
+  if (!progress || !progress->window) {
+    return true;
+  }
+  const int value =
+      atomic_load_explicit(&progress->current_value, memory_order_relaxed);
+  tui_progress_sample_rate(progress, value, tui_clock_ms());
+  (void)tui_progress_draw(progress);
+  return atomic_load_explicit(&progress->finished, memory_order_acquire) ||
+         value >= progress->max_value;
+}
+
+app_error tui_progress_run(tui_progress_t *progress, int hz) {
+  if (!progress || !progress->window) {
+    return APP_ERROR_INVALID_ARG;
+  }
+  if (hz <= 0) {
+    hz = TUI_PROGRESS_DEFAULT_HZ;
+  }
+  const int tick_ms = hz >= 1000 ? 1 : 1000 / hz;
+  uint64_t next_tick = tui_clock_ms();
+  for (;;) {
+    const uint64_t now = tui_clock_ms();
+    if (now >= next_tick) {
+      if (tui_progress_tick(progress)) {
+        return APP_SUCCESS;
+      }
+      next_tick = now + (uint64_t)tick_ms;
+    }
+    /* Keys are ignored; a resize or repaint redraws in full and finish()
+     * wakes the wait so the last tick is not a whole period late. */
+    const uint64_t waited_from = tui_clock_ms();
+    const tui_event_t event = tui_wait_event(
+        progress->window->win,
+        next_tick > waited_from ? (int)(next_tick - waited_from) : 0);
+    if (event.kind == TUI_EVENT_SIGNAL) {
+      return APP_ERROR_INTERRUPTED;
+    }
+    if (event.kind == TUI_EVENT_RESIZE || event.kind == TUI_EVENT_REPAINT) {
+      progress->drawn = false;
+      next_tick = 0;
+    } else if (event.kind == TUI_EVENT_WAKE &&
+               atomic_load_explicit(&progress->finished,
+                                    memory_order_acquire)) {
+      next_tick = 0;
+    }
+  }
+}
+
 void tui_progress_update(tui_progress_t *progress, int current,
                          const char *status) {
   if (!progress)
     return;
-  progress->current_value = current;
-  tui_progress_draw(progress, status);
+  tui_progress_set(progress, current);
+  tui_progress_set_status(progress, status);
+  (void)tui_progress_tick(progress);
 }
 
 void tui_progress_destroy(tui_progress_t *progress) {
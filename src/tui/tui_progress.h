@@ -17,10 +17,33 @@ typedef struct tui_progress tui_progress_t;
 // Returns NULL on allocation failure.
 APP_NODISCARD tui_progress_t *tui_progress_create(const char *title, int max);
 
-// Update the progress bar. Pass current value and optional status text.
+// Default sampling rate of tui_progress_run().
+#define TUI_PROGRESS_DEFAULT_HZ 30
+
+// Update the progress bar from the UI thread and repaint what changed. Pass
+// current value and optional status text.
 void tui_progress_update(tui_progress_t *progress, int current,
                          const char *status);
 
+// Worker-side reporting. Safe from any thread and never touches ncurses:
+// add/set are a single atomic operation, so they can be called per item.
+// Status text is copied (truncated to 127 bytes).
+void tui_progress_add(tui_progress_t *progress, int delta);
+void tui_progress_set(tui_progress_t *progress, int current);
+void tui_progress_set_status(tui_progress_t *progress, const char *status);
+// Mark the work done even if the value never reached max.
+void tui_progress_finish(tui_progress_t *progress);
+
+// UI thread: sample the reported value and status and repaint only the bar
+// cells and lines that changed, including throughput and ETA. Returns true
+// once finished or the value has reached max.
+bool tui_progress_tick(tui_progress_t *progress);
+
+// UI thread: tick `hz` times per second (0 = TUI_PROGRESS_DEFAULT_HZ) until
+// the work is done. Returns APP_SUCCESS, or APP_ERROR_INTERRUPTED on
+// SIGINT/SIGTERM (see tui_take_interrupt_error()).
+app_error tui_progress_run(tui_progress_t *progress, int hz);
+
 // Destroy (free) the progress indicator and associated window.
 void tui_progress_destroy(tui_progress_t *progress);
 
@@ -0,0 +1,25 @@
+/*
+ * tui_progress_internal.h - the progress bar's pure formatters and a value
+ * accessor, exposed for unit tests. Not part of the public API.
+ */
+#pragma once
+
+#include <stddef.h>
+
+#include "tui_progress.h"
+
+/* Longest duration text plus NUL: "99:59:59". */
+#define TUI_PROGRESS_DURATION_MAX 9
+
+/* "950", "12.3k", "4.56M", "1.20G" for a count or a per-second rate. */
+void tui_progress_format_count(char *buf, size_t size, double value);
+/* "m:ss" below an hour, "h:mm:ss" above; rounded to the second and clamped
+ * to 0..99:59:59. */
+void tui_progress_format_duration(char *buf, size_t size, double seconds);
+/* The line under the bar: "<rate>/s  ETA <duration>", just "<rate>/s" once
+ * `value` reaches `max_value`, or empty while no rate is known. */
+void tui_progress_format_rate(char *buf, size_t size, double rate, int value,
+                              int max_value);
+
+/* The value reported through add/set so far (not clamped to 0..max). */
+int tui_progress_value(const tui_progress_t *progress);
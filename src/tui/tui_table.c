@@ -0,0 +1,487 @@
+/*
+ * tui_table.c - view + controller + orchestrator for the tui_table module.
+ *
+ * The model lives in tui_table_model.c (no ncurses). This file lays out the
+ * frame, draws only the rows in the viewport (each fetched through the
+ * cursor as it is painted) and runs tui_show_table on tui_run_frame_loop(),
+ * the frame pacing, resize and wake-up handling tui_show_menu uses too.
+ */
+#ifdef _WIN32
+#include <curses.h>
+#else
+#include <ncurses.h>
+#endif
+
+#include <stdio.h>
+#include <string.h>
+
+#include "../ui/text_layout.h"
+#include "tui.h"
+#include "tui_internal.h"
+#include "tui_table.h"
+#include "tui_table_internal.h"
+
+#define TABLE_PAD 3       /* left/right content padding, as in the menu */
+#define TABLE_MARKER 2    /* "▸ " selection marker */
+#define TABLE_GAP 2       /* columns between cells */
+#define TABLE_MIN_ROWS 3
+#define TABLE_CELL_MAX 512 /* bytes of one cell drawn */
+
+typedef struct {
+  tui_window_t *frame;
+  bool owns_frame;
+  int content_left;
+  int content_width;
+  int title_y;
+  int meta_y; /* -1 when compact */
+  int header_y;
+  int rule_y;
+  int row_area_y;
+  int row_area_h;
+  int footer_y;
+  int desired_h;
+  int desired_w;
+  int widths[TUI_TABLE_MAX_COLUMNS];
+} tui_table_layout_t;
+
+/* Same borderless stack as the menu: title, meta line, then the column
+ * header and a rule above the rows, and a key-hint footer. The compact
+ * variant for short terminals drops the padding and the meta line. */
+static bool tui_table_layout_compute(tui_table_layout_t *L,
+                                     const tui_table_state_t *s) {
+  const int H = L->frame->height;
+  const int W = L->frame->width;
+  if (W < 24)
+    return false;
+  L->content_left = TABLE_PAD;
+  L->content_width = W - 2 * TABLE_PAD;
+  if (H >= 14) {
+    L->title_y = 1;
+    L->meta_y = 3;
+    L->header_y = 5;
+    L->footer_y = H - 2;
+  } else {
+    L->title_y = 0;
+    L->meta_y = -1;
+    L->header_y = 1;
+    L->footer_y = H - 1;
+  }
+  L->rule_y = L->header_y + 1;
+  L->row_area_y = L->rule_y + 1;
+  L->row_area_h = (L->footer_y - 1) - L->row_area_y;
+  tui_table_state_fit_columns(s, L->content_width - TABLE_MARKER, L->widths);
+  return L->row_area_h >= TABLE_MIN_ROWS;
+}
+
+static bool tui_table_recenter_frame(tui_table_layout_t *L) {
+  if (!L->frame || !L->frame->win)
+    return false;
+  const int max_y = getmaxy(stdscr);
+  const int max_x = getmaxx(stdscr);
+  int height = L->desired_h > 0 ? L->desired_h : L->frame->height;
+  int width = L->desired_w > 0 ? L->desired_w : L->frame->width;
+  if (height > max_y)
+    height = max_y;
+  if (width > max_x)
+    width = max_x;
+  if (height < 8 || width < 24)
+    return false;
+  const int y = (max_y - height) / 2;
+  const int x = (max_x - width) / 2;
+  if (wresize(L->frame->win, height, width) == ERR ||
+      mvwin(L->frame->win, y, x) == ERR)
+    return false;
+  L->frame->height = height;
+  L->frame->width = width;
+  L->frame->y = y;
+  L->frame->x = x;
+  touchwin(stdscr);
+  return true;
+}
+
+/* Writes `text` into a `width`-column cell at (y, x), cut on a grapheme
+ * boundary and right-aligned on request. Control characters would move the
+ * curses cursor, so they are drawn as spaces. */
+static void tui_table_write_cell(WINDOW *win, int y, int x, int width,
+                                 const char *text, tui_table_align_t align) {
+  if (!text || width <= 0)
+    return;
+  char cell[TABLE_CELL_MAX];
+  size_t n = 0;
+  for (; text[n] && n + 1 < sizeof(cell); n++)
+    cell[n] = (unsigned char)text[n] < 0x20 ? ' ' : text[n];
+  cell[n] = '\0';
+  int cols = 0;
+  const size_t bytes = app_text_truncate_utf8_columns(cell, width, &cols);
+  if (align == TUI_TABLE_ALIGN_RIGHT)
+    x += width - cols;
+  mvwaddnstr(win, y, x, cell, (int)bytes);
+}
+
+/* Meta line: the subtitle or sort state on the left, "row N of M" right. */
+static void tui_table_render_meta(const tui_table_layout_t *L,
+                                  const tui_table_state_t *s) {
+  if (L->meta_y < 0)
+    return;
+  const tui_table_config_t *cfg = tui_table_state_config(s);
+  WINDOW *win = L->frame->win;
+  mvwhline(win, L->meta_y, L->content_left, ' ', L->content_width);
+
+  char right[64];
+  snprintf(right, sizeof(right), "row %d of %d",
+           cfg->row_count > 0 ? tui_table_state_selected(s) + 1 : 0,
+           cfg->row_count);
+  const int rcols = tui_display_cols(right);
+  tui_set_color(win, TUI_COLOR_DIM);
+  mvwaddstr(win, L->meta_y, L->content_left + L->content_width - rcols,
+            right);
+
+  char left[128];
+  const int sort_column = tui_table_state_sort_column(s);
+  if (tui_table_state_pending(s)) {
+    snprintf(left, sizeof(left), "sorting…");
+  } else if (sort_column >= 0) {
+    snprintf(left, sizeof(left), "sorted by %s, %s",
+             cfg->columns[sort_column].title ? cfg->columns[sort_column].title
+                                             : "column",
+             tui_table_state_sort_descending(s) ? "descending" : "ascending");
+  } else {
+    snprintf(left, sizeof(left), "%s", cfg->subtitle ? cfg->subtitle : "");
+  }
+  tui_table_write_cell(win, L->meta_y, L->content_left,
+                       L->content_width - rcols - 1, left,
+                       TUI_TABLE_ALIGN_LEFT);
+  tui_unset_color(win, TUI_COLOR_DIM);
+}
+
+static void tui_table_render_header(const tui_table_layout_t *L,
+                                    const tui_table_state_t *s) {
+  const tui_table_config_t *cfg = tui_table_state_config(s);
+  WINDOW *win = L->frame->win;
+
+  if (cfg->title) {
+    char up[64];
+    tui_ascii_upper_copy(up, sizeof(up), cfg->title);
+    const int tcols = tui_display_cols(up);
+    int tx = (L->frame->width - tcols) / 2;
+    if (tx < L->content_left)
+      tx = L->content_left;
+    tui_set_color(win, TUI_COLOR_TITLE);
+    wattron(win, A_BOLD);
+    tui_table_write_cell(win, L->title_y, tx, L->content_width, up,
+                         TUI_TABLE_ALIGN_LEFT);
+    wattroff(win, A_BOLD);
+    tui_unset_color(win, TUI_COLOR_TITLE);
+  }
+  tui_table_render_meta(L, s);
+
+  /* Column titles; the column cursor is accented and the sort column
+   * carries its direction. */
+  const int right = L->content_left + L->content_width;
+  const int sort_column = tui_table_state_sort_column(s);
+  int x = L->content_left + TABLE_MARKER;
+  for (int c = 0; c < cfg->column_count && x < right; c++) {
+    const tui_table_column_t *col = &cfg->columns[c];
+    int width = L->widths[c];
+    if (width > right - x)
+      width = right - x;
+    char title[96];
+    snprintf(title, sizeof(title), "%s%s", col->title ? col->title : "",
+             c != sort_column                   ? ""
+             : tui_table_state_sort_descending(s) ? " ▼"
+                                                  : " ▲");
+    const bool cursor = c == tui_table_state_column(s);
+    const tui_color_pair_t color = cursor ? TUI_COLOR_ACCENT : TUI_COLOR_INFO;
+    tui_set_color(win, color);
+    wattron(win, A_BOLD);
+    tui_table_write_cell(win, L->header_y, x, width, title, col->align);
+    wattroff(win, A_BOLD);
+    tui_unset_color(win, color);
+    x += L->widths[c] + TABLE_GAP;
+  }
+
+  tui_set_color(win, TUI_COLOR_BORDER);
+  mvwhline(win, L->rule_y, L->content_left, ACS_HLINE, L->content_width);
+  tui_unset_color(win, TUI_COLOR_BORDER);
+}
+
+/* Paints display position `position` after clearing its row; positions
+ * outside the viewport are ignored. This is the only place rows are
+ * fetched, so the cursor is asked for at most one screenful per frame. */
+static void tui_table_render_row(const tui_table_layout_t *L,
+                                 const tui_table_state_t *s, int position) {
+  const int row = position - tui_table_state_top(s);
+  if (row < 0 || row >= L->row_area_h)
+    return;
+  const tui_table_config_t *cfg = tui_table_state_config(s);
+  WINDOW *win = L->frame->win;
+  const int y = L->row_area_y + row;
+  mvwhline(win, y, L->content_left, ' ', L->content_width);
+
+  const char *cells[TUI_TABLE_MAX_COLUMNS];
+  char scratch[1024];
+  if (tui_table_state_fetch(s, position, cells, scratch, sizeof(scratch)) < 0)
+    return;
+
+  const bool selected = position == tui_table_state_selected(s);
+  if (selected) {
+    tui_set_color(win, TUI_COLOR_ACCENT);
+    mvwaddstr(win, y, L->content_left, "▸");
+    tui_unset_color(win, TUI_COLOR_ACCENT);
+  }
+  const tui_color_pair_t color =
+      selected ? TUI_COLOR_MENU_NORMAL : TUI_COLOR_DIM;
+  tui_set_color(win, color);
+  if (selected)
+    wattron(win, A_BOLD);
+  const int right = L->content_left + L->content_width;
+  int x = L->content_left + TABLE_MARKER;
+  for (int c = 0; c < cfg->column_count && x < right; c++) {
+    int width = L->widths[c];
+    if (width > right - x)
+      width = right - x;
+    tui_table_write_cell(win, y, x, width, cells[c], cfg->columns[c].align);
+    x += L->widths[c] + TABLE_GAP;
+  }
+  if (selected)
+    wattroff(win, A_BOLD);
+  tui_unset_color(win, color);
+}
+
+static void tui_table_render_footer(const tui_table_layout_t *L) {
+  WINDOW *win = L->frame->win;
+  tui_set_color(win, TUI_COLOR_DIM);
+  mvwhline(win, L->footer_y, L->content_left, ' ', L->content_width);
+  tui_table_write_cell(
+      win, L->footer_y, L->content_left, L->content_width,
+      "↑↓:row  pgup/pgdn:page  ←→:column  s:sort  enter:select  q:close",
+      TUI_TABLE_ALIGN_LEFT);
+  tui_unset_color(win, TUI_COLOR_DIM);
+}
+
+static void tui_table_paint(const tui_table_layout_t *L, tui_table_state_t *s,
+                            const tui_frame_t *frame) {
+  const tui_table_damage_t damage = tui_table_state_take_damage(s);
+  if (damage.full) {
+    werase(L->frame->win);
+    tui_table_render_header(L, s);
+    const int top = tui_table_state_top(s);
+    for (int row = 0; row < L->row_area_h; row++)
+      tui_table_render_row(L, s, top + row);
+    tui_table_render_footer(L);
+  } else {
+    if (damage.meta)
+      tui_table_render_meta(L, s);
+    for (int i = 0; i < damage.row_count; i++)
+      tui_table_render_row(L, s, damage.rows[i]);
+  }
+  wnoutrefresh(L->frame->win);
+  tui_frame_flush(frame);
+}
+
+/* Rebuilds (owned) or recenters (caller's) the frame, as in
+ * tui_show_menu. Returns false when the table no longer fits; an owned
+ * frame is then gone. */
+static bool tui_table_apply_resize(tui_table_layout_t *L,
+                                   tui_table_state_t *s) {
+  if (L->owns_frame) {
+    tui_window_t *old_frame = L->frame;
+    L->frame = tui_create_centered_window(L->desired_h, L->desired_w);
+    tui_replace_background(old_frame, L->frame);
+    tui_destroy_window(old_frame);
+    if (!L->frame)
+      return false;
+  } else if (!tui_table_recenter_frame(L)) {
+    return false;
+  }
+  tui_table_state_invalidate(s);
+  clear();
+  wnoutrefresh(stdscr);
+  return tui_table_layout_compute(L, s);
+}
+
+/* Applies one key. Returns true when it ends the table, with *result
+ * filled in. */
+static bool tui_table_dispatch(tui_table_state_t *s,
+                               const tui_table_layout_t *L, int ch,
+                               tui_table_result_t *result) {
+  const int page = L->row_area_h > 1 ? L->row_area_h - 1 : 1;
+  switch (ch) {
+  case KEY_UP:
+  case 'k':
+    tui_table_state_step(s, -1);
+    return false;
+  case KEY_DOWN:
+  case 'j':
+    tui_table_state_step(s, 1);
+    return false;
+  case KEY_PPAGE:
+    tui_table_state_page(s, -1, page);
+    return false;
+  case KEY_NPAGE:
+  case ' ':
+    tui_table_state_page(s, 1, page);
+    return false;
+  case KEY_HOME:
+  case 'g':
+    tui_table_state_home(s);
+    return false;
+  case KEY_END:
+  case 'G':
+    tui_table_state_end(s);
+    return false;
+  case KEY_LEFT:
+  case 'h':
+    tui_table_state_move_column(s, -1);
+    return false;
+  case KEY_RIGHT:
+  case 'l':
+    tui_table_state_move_column(s, 1);
+    return false;
+  case 's':
+  case 'S':
+    if (!tui_table_state_sort_column_toggle(s))
+      tui_beep();
+    return false;
+  case '\n':
+  case '\r':
+  case KEY_ENTER: {
+    const int row =
+        tui_table_state_source_row(s, tui_table_state_selected(s));
+    if (row < 0) {
+      tui_beep();
+      return false;
+    }
+    result->status = TUI_TABLE_OK;
+    result->selected_row = row;
+    return true;
+  }
+  case 27: /* Esc */
+  case 'q':
+  case 'Q':
+    result->status = TUI_TABLE_CANCELLED;
+    return true;
+  default:
+    return false;
+  }
+}
+
+/* The table as a tui_run_frame_loop() view. */
+typedef struct {
+  tui_table_layout_t *L;
+  tui_table_state_t *state;
+  tui_table_result_t *result;
+} tui_table_view_t;
+
+static WINDOW *tui_table_view_layout(void *view, bool resize) {
+  tui_table_view_t *v = view;
+  const bool fits = resize ? tui_table_apply_resize(v->L, v->state)
+                           : tui_table_layout_compute(v->L, v->state);
+  if (!fits)
+    return NULL;
+  tui_table_state_ensure_selection_visible(v->state, v->L->row_area_h);
+  return v->L->frame->win;
+}
+
+static bool tui_table_view_has_damage(void *view) {
+  const tui_table_view_t *v = view;
+  return tui_table_state_has_damage(v->state);
+}
+
+static void tui_table_view_paint(void *view, const tui_frame_t *frame) {
+  tui_table_view_t *v = view;
+  tui_table_paint(v->L, v->state, frame);
+}
+
+static tui_frame_loop_action_t tui_table_view_dispatch(void *view, int key) {
+  tui_table_view_t *v = view;
+  if (tui_table_dispatch(v->state, v->L, key, v->result))
+    return TUI_FRAME_LOOP_EXIT;
+  tui_table_state_ensure_selection_visible(v->state, v->L->row_area_h);
+  return TUI_FRAME_LOOP_CONTINUE;
+}
+
+static void tui_table_view_poll(void *view) {
+  tui_table_view_t *v = view;
+  tui_table_state_poll(v->state);
+}
+
+static bool tui_table_view_pending(void *view) {
+  const tui_table_view_t *v = view;
+  return tui_table_state_pending(v->state);
+}
+
+static void tui_table_view_invalidate(void *view) {
+  tui_table_view_t *v = view;
+  tui_table_state_invalidate(v->state);
+}
+
+tui_table_result_t tui_show_table(tui_window_t *window,
+                                  const tui_table_config_t *config) {
+  tui_table_result_t result = {.status = TUI_TABLE_INVALID_ARG,
+                               .selected_row = -1};
+  if (!config)
+    return result;
+
+  tui_table_state_t *state = NULL;
+  const tui_table_status_t st = tui_table_state_create(config, &state);
+  if (st != TUI_TABLE_OK) {
+    result.status = st;
+    return result;
+  }
+  tui_table_state_set_notify(state, tui_wake);
+
+  tui_table_layout_t L = {0};
+  L.frame = window;
+  L.owns_frame = window == NULL;
+  L.desired_h = config->frame_height > 0 ? config->frame_height
+                                         : (window ? window->height : 24);
+  L.desired_w = config->frame_width > 0 ? config->frame_width
+                                        : (window ? window->width : 96);
+  if (L.owns_frame) {
+    L.frame = tui_create_centered_window(L.desired_h, L.desired_w);
+    if (!L.frame) {
+      tui_table_state_destroy(state);
+      result.status = TUI_TABLE_TOO_SMALL;
+      return result;
+    }
+  } else if ((config->frame_height > 0 || config->frame_width > 0) &&
+             !tui_table_recenter_frame(&L)) {
+    tui_table_state_destroy(state);
+    result.status = TUI_TABLE_TOO_SMALL;
+    return result;
+  }
+  const bool pushed_background = tui_get_background_window() != L.frame;
+  if (pushed_background)
+    tui_push_background(L.frame);
+
+  tui_table_view_t view = {.L = &L, .state = state, .result = &result};
+  const tui_frame_loop_t loop = {
+      .view = &view,
+      .max_fps = config->max_fps,
+      .layout = tui_table_view_layout,
+      .has_damage = tui_table_view_has_damage,
+      .paint = tui_table_view_paint,
+      .dispatch = tui_table_view_dispatch,
+      .poll = tui_table_view_poll,
+      .pending = tui_table_view_pending,
+      .invalidate = tui_table_view_invalidate,
+  };
+  switch (tui_run_frame_loop(&loop)) {
+  case TUI_FRAME_LOOP_INTERRUPTED:
+    result.status = TUI_TABLE_INTERRUPTED;
+    break;
+  case TUI_FRAME_LOOP_TOO_SMALL:
+    result.status = TUI_TABLE_TOO_SMALL;
+    break;
+  case TUI_FRAME_LOOP_DONE:
+    break; /* tui_table_dispatch filled in the result */
+  }
+
+  if (pushed_background)
+    tui_pop_background();
+  if (L.owns_frame && L.frame)
+    tui_destroy_window(L.frame);
+  tui_table_state_destroy(state);
+  return result;
+}
@@ -0,0 +1,108 @@
+/*
+ * tui_table.h - virtual-scrolling ncurses table for large result sets.
+ *
+ * Rows are never materialized: a cursor callback produces the cells of one
+ * row at a time, and the table asks only for rows it is drawing, sampling
+ * for column widths or sorting. A table over millions of rows holds the
+ * visible page plus, once sorted, one permutation entry per row.
+ *
+ * Same shape as tui_show_menu: one entry point (tui_show_table), one config
+ * struct in, one result struct out. The implementation is split into a pure
+ * model layer (tui_table_model.c, no ncurses) and a view+controller layer
+ * (tui_table.c).
+ *
+ * Ownership contract: all pointers reachable from `config` must remain valid
+ * until tui_show_table returns. Strings handed out by the cursor only need
+ * to survive until the next cursor call on the same thread.
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "../core/error.h"
+#include "../core/types.h"
+
+typedef struct tui_window tui_window_t; /* defined in tui.h */
+
+/* Columns beyond this are rejected with TUI_TABLE_INVALID_ARG. */
+#define TUI_TABLE_MAX_COLUMNS 32
+
+/* Rows measured when sizing columns: spread evenly over the whole table, so
+ * a wide value far from the top still widens its column. */
+#define TUI_TABLE_WIDTH_SAMPLES 256
+
+typedef enum {
+  TUI_TABLE_ALIGN_LEFT = 0,
+  TUI_TABLE_ALIGN_RIGHT, /* numbers */
+} tui_table_align_t;
+
+typedef enum {
+  TUI_TABLE_SORT_TEXT = 0, /* byte order, ASCII letters case-folded */
+  TUI_TABLE_SORT_NUMBER,   /* strtod() value; non-numbers sort last */
+  TUI_TABLE_SORT_NONE,     /* column cannot be sorted */
+} tui_table_sort_kind_t;
+
+typedef struct {
+  const char *title; /* header text, UTF-8 */
+  int min_width;     /* columns; 0 uses the header width */
+  int max_width;     /* columns; 0 leaves only the frame as a limit */
+  tui_table_align_t align;
+  tui_table_sort_kind_t sort;
+} tui_table_column_t;
+
+/* One cursor call: set cells[c] for every column (NULL draws an empty cell).
+ * `scratch` is a per-call buffer the cursor may format values into. */
+typedef struct {
+  const char **cells;
+  char *scratch;
+  size_t scratch_size;
+} tui_table_row_t;
+
+/* Fill `out` with the cells of source row `row` (0..row_count-1) and return
+ * true, or return false to draw the row empty. Sorting runs on a background
+ * thread that calls the cursor while the UI thread may call it too, so the
+ * cursor must tolerate concurrent calls when any column is sortable. Must
+ * not call back into the table. */
+typedef bool (*tui_table_cursor_fn)(void *user, int row, tui_table_row_t *out);
+
+typedef struct {
+  const char *title;
+  const char *subtitle; /* optional; shown on the meta line */
+  const tui_table_column_t *columns;
+  int column_count; /* 1..TUI_TABLE_MAX_COLUMNS */
+  int row_count;
+  tui_table_cursor_fn cursor;
+  void *cursor_user;
+  int sort_column; /* initial sort; -1 keeps source order */
+  bool sort_descending;
+  int default_row;  /* source row selected on entry */
+  int frame_height; /* requested frame height; 0 uses the current/default */
+  int frame_width;  /* requested frame width; 0 uses the current/default */
+  int max_fps;      /* repaint cap for key bursts; 0 uses 60 */
+} tui_table_config_t;
+
+typedef enum {
+  TUI_TABLE_OK = 0,
+  TUI_TABLE_CANCELLED,
+  TUI_TABLE_INTERRUPTED,
+  TUI_TABLE_TOO_SMALL,
+  TUI_TABLE_INVALID_ARG,
+  TUI_TABLE_NO_MEMORY,
+} tui_table_status_t;
+
+typedef struct {
+  tui_table_status_t status;
+  int selected_row; /* source row; -1 unless status == TUI_TABLE_OK */
+} tui_table_result_t;
+
+/* Browse the table until Enter (TUI_TABLE_OK with the selected source row)
+ * or Esc/q. Left/Right pick a column and `s` sorts by it, toggling the
+ * direction when it is already the sort column.
+ *
+ * If window == NULL, the table owns its frame and recreates it on
+ * KEY_RESIZE; otherwise it draws into the caller's window, restored to
+ * frame_height/frame_width when those are set. Returns TUI_TABLE_TOO_SMALL
+ * when the terminal cannot host the frame. */
+APP_NODISCARD tui_table_result_t
+tui_show_table(tui_window_t *window, const tui_table_config_t *config);
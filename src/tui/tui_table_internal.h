@@ -0,0 +1,88 @@
+/*
+ * tui_table_internal.h - exposed for unit tests and for the view/controller
+ * layer in tui_table.c. Not part of the public API.
+ *
+ * Positions are indices into the display order (what the user scrolls
+ * through); rows are the cursor's source indices. They coincide until a
+ * sort lands.
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "tui_table.h"
+
+typedef struct tui_table_state tui_table_state_t;
+
+/* Lifecycle. Creating the state samples TUI_TABLE_WIDTH_SAMPLES rows for
+ * the natural column widths and, when config->sort_column is set, starts
+ * that sort. */
+APP_NODISCARD tui_table_status_t
+tui_table_state_create(const tui_table_config_t *cfg, tui_table_state_t **out);
+void tui_table_state_destroy(tui_table_state_t *s);
+const tui_table_config_t *tui_table_state_config(const tui_table_state_t *s);
+
+/* Widest sampled cell (or header) of `column`, clamped to its min/max. */
+int tui_table_state_natural_width(const tui_table_state_t *s, int column);
+/* Column widths for a row of `width` columns with a two-column gap between
+ * cells. Columns that do not fit at their natural width are narrowed,
+ * widest first, down to their min_width (4 when unset); whatever still
+ * overflows is clipped by the view. */
+void tui_table_state_fit_columns(const tui_table_state_t *s, int width,
+                                 int *out_widths);
+
+/* Cursor access through the display order: fills cells[0..column_count)
+ * for `position` (NULL cells for a failed fetch). Returns the source row,
+ * or -1 when position is out of range. */
+int tui_table_state_fetch(const tui_table_state_t *s, int position,
+                          const char **cells, char *scratch,
+                          size_t scratch_size);
+int tui_table_state_source_row(const tui_table_state_t *s, int position);
+
+/* Navigation - pure data ops, no ncurses. */
+int tui_table_state_selected(const tui_table_state_t *s); /* position */
+int tui_table_state_top(const tui_table_state_t *s);
+void tui_table_state_step(tui_table_state_t *s, int delta);
+void tui_table_state_page(tui_table_state_t *s, int direction, int page_size);
+void tui_table_state_home(tui_table_state_t *s);
+void tui_table_state_end(tui_table_state_t *s);
+void tui_table_state_ensure_selection_visible(tui_table_state_t *s,
+                                              int viewport_rows);
+/* Column cursor, the target of tui_table_state_sort_column_toggle(). */
+int tui_table_state_column(const tui_table_state_t *s);
+void tui_table_state_move_column(tui_table_state_t *s, int direction);
+
+/* Sorting. The display order is built on a background thread (inline where
+ * threads are unavailable) and swapped in by tui_table_state_poll(), which
+ * keeps the selection on the same source row. A newer request cancels the
+ * one in flight. Returns false for a TUI_TABLE_SORT_NONE column. */
+bool tui_table_state_sort(tui_table_state_t *s, int column, bool descending);
+/* Sort by the column cursor: ascending, or the reverse of the current
+ * direction when that column is already sorted (or being sorted). */
+bool tui_table_state_sort_column_toggle(tui_table_state_t *s);
+/* Column of the order on screen (-1 = source order) and its direction. */
+int tui_table_state_sort_column(const tui_table_state_t *s);
+bool tui_table_state_sort_descending(const tui_table_state_t *s);
+/* A sort is in flight; the caller should poll when notified. */
+bool tui_table_state_pending(const tui_table_state_t *s);
+void tui_table_state_poll(tui_table_state_t *s);
+/* Called from the sort thread when its order is ready; tui_show_table
+ * passes tui_wake. */
+typedef void (*tui_table_notify_fn)(void);
+void tui_table_state_set_notify(tui_table_state_t *s,
+                                tui_table_notify_fn notify);
+
+/* Damage since the view last painted, as in tui_menu_internal.h: `full`
+ * repaints everything; otherwise only `rows` (positions the selection left
+ * and entered) and, with `meta`, the meta line. */
+typedef struct {
+  bool full;
+  bool meta;
+  int row_count;
+  int rows[2];
+} tui_table_damage_t;
+
+tui_table_damage_t tui_table_state_take_damage(tui_table_state_t *s);
+void tui_table_state_invalidate(tui_table_state_t *s);
+bool tui_table_state_has_damage(const tui_table_state_t *s);
@@ -0,0 +1,664 @@
+/*
+ * tui_table_model.c - pure-data model for tui_table.
+ *
+ * No ncurses; unit-testable. Rows stay with the caller: the model holds the
+ * selection, the sampled natural column widths and, once sorted, a display
+ * order of one int per row.
+ *
+ * Sorting never loads the table into memory either. A worker reads each
+ * row's sort cell once and reduces it to an 8-byte order-preserving key (a
+ * case-folded text prefix or the bits of a double) and merge-sorts those;
+ * only text keys that tie on a truncated prefix fetch both rows again to
+ * compare the full cells. When every text cell shares a long prefix (paths,
+ * URLs, timestamps), the rows are read a second time and keyed from just
+ * past it, so the keys differ where the cells do. The finished order is
+ * swapped in on the UI thread by tui_table_state_poll().
+ */
+#include <limits.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if !defined(_WIN32)
+#include <pthread.h>
+#define TABLE_SORT_THREADS 1
+#else
+#define TABLE_SORT_THREADS 0
+#endif
+
+#include "../ui/text_layout.h"
+#include "tui_table_internal.h"
+
+#define TABLE_GAP 2           /* columns between cells */
+#define TABLE_MIN_WIDTH 4     /* narrowest a column shrinks without min_width */
+#define TABLE_SCRATCH 1024    /* per-fetch scratch for the cursor */
+#define TABLE_TIE_BYTES 256   /* full-text tie-break compares this much */
+#define TABLE_CANCEL_STRIDE 4096
+#define TABLE_REKEY_PREFIX 4  /* shared text prefix worth a second pass */
+
+enum {
+  TABLE_KEY_TRUNCATED = 1u << 0, /* text longer than the 8-byte key */
+  TABLE_KEY_MISSING = 1u << 1,   /* not a number: orders after numbers */
+};
+
+typedef struct {
+  uint64_t key;
+  int row;
+  unsigned flags;
+} table_sort_entry_t;
+
+typedef struct {
+  const tui_table_config_t *cfg;
+  int column;
+  bool descending;
+  size_t skip; /* text keys start past this shared prefix */
+  tui_table_notify_fn notify;
+  table_sort_entry_t *entries;
+  table_sort_entry_t *merge; /* merge-sort buffer */
+  int *order;                /* result: source row per position */
+  atomic_bool cancel;
+  atomic_bool done;
+  bool ok;
+#if TABLE_SORT_THREADS
+  pthread_t thread;
+  bool started;
+#endif
+} table_sort_job_t;
+
+struct tui_table_state {
+  const tui_table_config_t *cfg;
+  int natural[TUI_TABLE_MAX_COLUMNS];
+  int selected; /* position */
+  int top;      /* first position on screen */
+  int column;   /* column cursor */
+  int *order;   /* display order; NULL = source order */
+  int sort_column;
+  bool sort_descending;
+  table_sort_job_t *job; /* sort in flight */
+  _Atomic(tui_table_notify_fn) notify;
+  bool damage_full;
+  int painted_selected;
+  int painted_top;
+};
+
+/* ---- cursor access ------------------------------------------------------- */
+
+static bool table_fetch_row(const tui_table_config_t *cfg, int row,
+                            const char **cells, char *scratch,
+                            size_t scratch_size) {
+  for (int c = 0; c < cfg->column_count; c++)
+    cells[c] = NULL;
+  if (row < 0 || row >= cfg->row_count)
+    return false;
+  tui_table_row_t out = {
+      .cells = cells, .scratch = scratch, .scratch_size = scratch_size};
+  if (!cfg->cursor(cfg->cursor_user, row, &out)) {
+    for (int c = 0; c < cfg->column_count; c++)
+      cells[c] = NULL;
+    return false;
+  }
+  return true;
+}
+
+int tui_table_state_source_row(const tui_table_state_t *s, int position) {
+  if (!s || position < 0 || position >= s->cfg->row_count)
+    return -1;
+  return s->order ? s->order[position] : position;
+}
+
+int tui_table_state_fetch(const tui_table_state_t *s, int position,
+                          const char **cells, char *scratch,
+                          size_t scratch_size) {
+  const int row = tui_table_state_source_row(s, position);
+  if (row < 0)
+    return -1;
+  (void)table_fetch_row(s->cfg, row, cells, scratch, scratch_size);
+  return row;
+}
+
+/* ---- column widths ------------------------------------------------------- */
+
+static int table_clamp_width(const tui_table_column_t *col, int width) {
+  if (col->min_width > 0 && width < col->min_width)
+    width = col->min_width;
+  if (col->max_width > 0 && width > col->max_width)
+    width = col->max_width;
+  return width;
+}
+
+/* Header widths, widened by an even spread of sampled rows. */
+static void table_sample_widths(struct tui_table_state *s) {
+  const tui_table_config_t *cfg = s->cfg;
+  for (int c = 0; c < cfg->column_count; c++) {
+    const char *title = cfg->columns[c].title;
+    s->natural[c] = title ? app_text_width_utf8(title) : 0;
+  }
+  const int samples = cfg->row_count < TUI_TABLE_WIDTH_SAMPLES
+                          ? cfg->row_count
+                          : TUI_TABLE_WIDTH_SAMPLES;
+  const char *cells[TUI_TABLE_MAX_COLUMNS];
+  char scratch[TABLE_SCRATCH];
+  for (int i = 0; i < samples; i++) {
+    const int row = (int)((long long)cfg->row_count * i / samples);
+    if (!table_fetch_row(cfg, row, cells, scratch, sizeof(scratch)))
+      continue;
+    for (int c = 0; c < cfg->column_count; c++) {
+      if (!cells[c])
+        continue;
+      const int w = app_text_width_utf8(cells[c]);
+      if (w > s->natural[c])
+        s->natural[c] = w;
+    }
+  }
+  for (int c = 0; c < cfg->column_count; c++)
+    s->natural[c] = table_clamp_width(&cfg->columns[c], s->natural[c]);
+}
+
+int tui_table_state_natural_width(const tui_table_state_t *s, int column) {
+  if (!s || column < 0 || column >= s->cfg->column_count)
+    return 0;
+  return s->natural[column];
+}
+
+void tui_table_state_fit_columns(const tui_table_state_t *s, int width,
+                                 int *out_widths) {
+  if (!s || !out_widths)
+    return;
+  const int n = s->cfg->column_count;
+  int total = (n - 1) * TABLE_GAP;
+  for (int c = 0; c < n; c++) {
+    out_widths[c] = s->natural[c];
+    total += out_widths[c];
+  }
+  /* Take one column at a time from the widest shrinkable cell, so a long
+   * free-text column gives way before short key columns are touched. */
+  while (total > width) {
+    int widest = -1;
+    for (int c = 0; c < n; c++) {
+      const tui_table_column_t *col = &s->cfg->columns[c];
+      int floor = col->min_width > 0 ? col->min_width : TABLE_MIN_WIDTH;
+      if (floor > s->natural[c])
+        floor = s->natural[c];
+      if (out_widths[c] > floor &&
+          (widest < 0 || out_widths[c] > out_widths[widest]))
+        widest = c;
+    }
+    if (widest < 0)
+      break;
+    out_widths[widest]--;
+    total--;
+  }
+}
+
+/* ---- sorting ------------------------------------------------------------- */
+
+static unsigned char table_fold(unsigned char c) {
+  return c >= 'A' && c <= 'Z' ? (unsigned char)(c + ('a' - 'A')) : c;
+}
+
+/* `text` past its first `skip` bytes, or its end if shorter. */
+static const char *table_text_skip(const char *text, size_t skip) {
+  text = text ? text : "";
+  return text + strnlen(text, skip);
+}
+
+static table_sort_entry_t table_text_key(const char *text, size_t skip,
+                                         int row) {
+  table_sort_entry_t e = {.row = row};
+  if (!text)
+    return e;
+  text = table_text_skip(text, skip);
+  size_t i = 0;
+  for (; i < 8 && text[i]; i++)
+    e.key |= (uint64_t)table_fold((unsigned char)text[i]) << (56 - 8 * i);
+  if (i == 8 && text[8])
+    e.flags = TABLE_KEY_TRUNCATED;
+  return e;
+}
+
+/* Doubles mapped to unsigned integers that order the same way. */
+static table_sort_entry_t table_number_key(const char *text, int row) {
+  table_sort_entry_t e = {.row = row, .flags = TABLE_KEY_MISSING};
+  if (!text)
+    return e;
+  char *end = NULL;
+  const double v = strtod(text, &end);
+  if (end == text || v != v)
+    return e;
+  uint64_t bits;
+  memcpy(&bits, &v, sizeof(bits));
+  e.key = (bits >> 63) ? ~bits : bits | (UINT64_C(1) << 63);
+  e.flags = 0;
+  return e;
+}
+
+static int table_text_cmp(const char *a, const char *b) {
+  a = a ? a : "";
+  b = b ? b : "";
+  for (;; a++, b++) {
+    const unsigned char ca = table_fold((unsigned char)*a);
+    const unsigned char cb = table_fold((unsigned char)*b);
+    if (ca != cb || ca == 0)
+      return (ca > cb) - (ca < cb);
+  }
+}
+
+/* Length of the case-folded prefix `a` and `b` share, up to `limit`. */
+static size_t table_common_prefix(const char *a, const char *b,
+                                  size_t limit) {
+  a = a ? a : "";
+  b = b ? b : "";
+  size_t n = 0;
+  while (n < limit && a[n] &&
+         table_fold((unsigned char)a[n]) == table_fold((unsigned char)b[n]))
+    n++;
+  return n;
+}
+
+/* Full-text comparison of two rows whose keys tie on a truncated prefix.
+ * The first cell is copied out because the second fetch may reuse the
+ * storage the cursor returned it in. Both cells start with the job's shared
+ * prefix, so only what follows it is compared. */
+static int table_tie_break(const table_sort_job_t *job, int row_a,
+                           int row_b) {
+  const char *cells[TUI_TABLE_MAX_COLUMNS];
+  char scratch[TABLE_SCRATCH];
+  char a[TABLE_TIE_BYTES];
+  (void)table_fetch_row(job->cfg, row_a, cells, scratch, sizeof(scratch));
+  const char *cell = table_text_skip(cells[job->column], job->skip);
+  const size_t len = strnlen(cell, sizeof(a) - 1);
+  memcpy(a, cell, len);
+  a[len] = '\0';
+  (void)table_fetch_row(job->cfg, row_b, cells, scratch, sizeof(scratch));
+  char b[TABLE_TIE_BYTES];
+  cell = table_text_skip(cells[job->column], job->skip);
+  const size_t blen = strnlen(cell, sizeof(b) - 1);
+  memcpy(b, cell, blen);
+  b[blen] = '\0';
+  return table_text_cmp(a, b);
+}
+
+static int table_entry_cmp(const table_sort_job_t *job,
+                           const table_sort_entry_t *a,
+                           const table_sort_entry_t *b) {
+  const unsigned missing_a = a->flags & TABLE_KEY_MISSING;
+  const unsigned missing_b = b->flags & TABLE_KEY_MISSING;
+  if (missing_a != missing_b)
+    return missing_a ? 1 : -1; /* non-numbers last either way */
+  int cmp = (a->key > b->key) - (a->key < b->key);
+  if (cmp == 0) {
+    const unsigned long_a = a->flags & TABLE_KEY_TRUNCATED;
+    const unsigned long_b = b->flags & TABLE_KEY_TRUNCATED;
+    if (long_a && long_b)
+      cmp = table_tie_break(job, a->row, b->row);
+    else if (long_a != long_b)
+      cmp = long_a ? 1 : -1; /* a prefix orders before its extensions */
+  }
+  if (job->descending)
+    cmp = -cmp;
+  /* Equal cells keep source order, whichever the direction. */
+  return cmp ? cmp : (a->row > b->row) - (a->row < b->row);
+}
+
+/* Bottom-up merge sort: stable and able to carry the job as context. A
+ * comparison may fetch two rows, so cancellation is checked every
+ * TABLE_CANCEL_STRIDE comparisons, not once per pass. */
+static bool table_merge_sort(table_sort_job_t *job, int n) {
+  table_sort_entry_t *src = job->entries;
+  table_sort_entry_t *dst = job->merge;
+  unsigned compares = 0;
+  for (int run = 1; run < n; run *= 2) {
+    for (int lo = 0; lo < n; lo += 2 * run) {
+      const int mid = lo + run < n ? lo + run : n;
+      const int hi = lo + 2 * run < n ? lo + 2 * run : n;
+      int i = lo;
+      int j = mid;
+      int k = lo;
+      while (i < mid && j < hi) {
+        if (compares++ % TABLE_CANCEL_STRIDE == 0 &&
+            atomic_load_explicit(&job->cancel, memory_order_relaxed))
+          return false;
+        dst[k++] = table_entry_cmp(job, &src[j], &src[i]) < 0 ? src[j++]
+                                                               : src[i++];
+      }
+      while (i < mid)
+        dst[k++] = src[i++];
+      while (j < hi)
+        dst[k++] = src[j++];
+    }
+    table_sort_entry_t *swap = src;
+    src = dst;
+    dst = swap;
+  }
+  job->entries = src;
+  job->merge = dst;
+  return true;
+}
+
+static void table_sort_run(table_sort_job_t *job) {
+  const tui_table_config_t *cfg = job->cfg;
+  const int n = cfg->row_count;
+  const bool numeric =
+      cfg->columns[job->column].sort == TUI_TABLE_SORT_NUMBER;
+  const char *cells[TUI_TABLE_MAX_COLUMNS];
+  char scratch[TABLE_SCRATCH];
+  /* Text only: row 0's cell and the prefix every cell so far shares. */
+  char first[TABLE_TIE_BYTES] = "";
+  size_t shared = 0;
+  bool ok = true;
+  for (int pass = 0; ok && pass < 2; pass++) {
+    for (int row = 0; row < n; row++) {
+      if (row % TABLE_CANCEL_STRIDE == 0 &&
+          atomic_load_explicit(&job->cancel, memory_order_relaxed)) {
+        ok = false;
+        break;
+      }
+      (void)table_fetch_row(cfg, row, cells, scratch, sizeof(scratch));
+      const char *cell = cells[job->column];
+      if (numeric) {
+        job->entries[row] = table_number_key(cell, row);
+        continue;
+      }
+      job->entries[row] = table_text_key(cell, job->skip, row);
+      if (pass > 0) {
+        continue;
+      }
+      if (row == 0) {
+        shared = strnlen(cell ? cell : "", sizeof(first) - 1);
+        memcpy(first, cell ? cell : "", shared);
+        first[shared] = '\0';
+      } else if (shared > 0) {
+        shared = table_common_prefix(first, cell, shared);
+      }
+    }
+    /* Keys of a long shared prefix all tie and every comparison would
+     * fetch two rows; reading the table again is cheaper. */
+    if (numeric || shared < TABLE_REKEY_PREFIX)
+      break;
+    job->skip = shared;
+  }
+  if (ok)
+    ok = table_merge_sort(job, n);
+  if (ok) {
+    for (int p = 0; p < n; p++)
+      job->order[p] = job->entries[p].row;
+  }
+  job->ok = ok;
+  atomic_store_explicit(&job->done, true, memory_order_release);
+  if (job->notify)
+    job->notify();
+}
+
+#if TABLE_SORT_THREADS
+static void *table_sort_thread(void *arg) {
+  table_sort_run(arg);
+  return NULL;
+}
+#endif
+
+static void table_sort_free(table_sort_job_t *job) {
+  if (!job)
+    return;
+  free(job->entries);
+  free(job->merge);
+  free(job->order);
+  free(job);
+}
+
+/* Cancel the sort in flight and wait for its worker. */
+static void table_sort_stop(struct tui_table_state *s) {
+  table_sort_job_t *job = s->job;
+  if (!job)
+    return;
+  atomic_store(&job->cancel, true);
+#if TABLE_SORT_THREADS
+  if (job->started)
+    pthread_join(job->thread, NULL);
+#endif
+  table_sort_free(job);
+  s->job = NULL;
+}
+
+/* Swap in a finished order, keeping the selected source row selected. */
+static void table_sort_publish(struct tui_table_state *s) {
+  table_sort_job_t *job = s->job;
+  if (!job || !atomic_load_explicit(&job->done, memory_order_acquire))
+    return;
+#if TABLE_SORT_THREADS
+  if (job->started)
+    pthread_join(job->thread, NULL);
+  job->started = false;
+#endif
+  if (job->ok) {
+    const int selected_row = tui_table_state_source_row(s, s->selected);
+    free(s->order);
+    s->order = job->order;
+    job->order = NULL;
+    s->sort_column = job->column;
+    s->sort_descending = job->descending;
+    for (int p = 0; p < s->cfg->row_count; p++) {
+      if (s->order[p] == selected_row) {
+        s->selected = p;
+        break;
+      }
+    }
+  }
+  table_sort_free(job);
+  s->job = NULL;
+  s->damage_full = true;
+}
+
+bool tui_table_state_sort(tui_table_state_t *s, int column, bool descending) {
+  if (!s || column < 0 || column >= s->cfg->column_count ||
+      s->cfg->columns[column].sort == TUI_TABLE_SORT_NONE)
+    return false;
+  table_sort_stop(s);
+  s->damage_full = true; /* the meta line shows the sort in flight */
+  const int n = s->cfg->row_count;
+  table_sort_job_t *job = calloc(1, sizeof(*job));
+  if (!job)
+    return false;
+  job->cfg = s->cfg;
+  job->column = column;
+  job->descending = descending;
+  job->notify = atomic_load(&s->notify);
+  const size_t count = n > 0 ? (size_t)n : 1;
+  job->entries = malloc(count * sizeof(*job->entries));
+  job->merge = malloc(count * sizeof(*job->merge));
+  job->order = malloc(count * sizeof(*job->order));
+  if (!job->entries || !job->merge || !job->order) {
+    table_sort_free(job);
+    return false;
+  }
+  atomic_init(&job->cancel, false);
+  atomic_init(&job->done, false);
+  s->job = job;
+#if TABLE_SORT_THREADS
+  job->started =
+      pthread_create(&job->thread, NULL, table_sort_thread, job) == 0;
+  if (job->started)
+    return true;
+#endif
+  table_sort_run(job); /* inline, or the thread could not start */
+  table_sort_publish(s);
+  return true;
+}
+
+bool tui_table_state_sort_column_toggle(tui_table_state_t *s) {
+  if (!s)
+    return false;
+  const int column = s->job ? s->job->column : s->sort_column;
+  const bool descending = s->job ? s->job->descending : s->sort_descending;
+  return tui_table_state_sort(s, s->column,
+                              column == s->column ? !descending : false);
+}
+
+int tui_table_state_sort_column(const tui_table_state_t *s) {
+  return s ? s->sort_column : -1;
+}
+
+bool tui_table_state_sort_descending(const tui_table_state_t *s) {
+  return s && s->sort_descending;
+}
+
+bool tui_table_state_pending(const tui_table_state_t *s) {
+  return s && s->job;
+}
+
+void tui_table_state_poll(tui_table_state_t *s) {
+  if (s)
+    table_sort_publish(s);
+}
+
+void tui_table_state_set_notify(tui_table_state_t *s,
+                                tui_table_notify_fn notify) {
+  if (s)
+    atomic_store(&s->notify, notify);
+}
+
+/* ---- lifecycle ----------------------------------------------------------- */
+
+tui_table_status_t tui_table_state_create(const tui_table_config_t *cfg,
+                                          tui_table_state_t **out) {
+  if (!out)
+    return TUI_TABLE_INVALID_ARG;
+  *out = NULL;
+  if (!cfg || !cfg->columns || !cfg->cursor || cfg->column_count < 1 ||
+      cfg->column_count > TUI_TABLE_MAX_COLUMNS || cfg->row_count < 0)
+    return TUI_TABLE_INVALID_ARG;
+  struct tui_table_state *s = calloc(1, sizeof(*s));
+  if (!s)
+    return TUI_TABLE_NO_MEMORY;
+  s->cfg = cfg;
+  s->sort_column = -1;
+  s->damage_full = true;
+  s->painted_selected = -1;
+  s->painted_top = -1;
+  atomic_init(&s->notify, NULL);
+  if (cfg->default_row > 0 && cfg->default_row < cfg->row_count)
+    s->selected = cfg->default_row;
+  table_sample_widths(s);
+  const bool sortable = cfg->sort_column >= 0 &&
+                        cfg->sort_column < cfg->column_count &&
+                        cfg->columns[cfg->sort_column].sort !=
+                            TUI_TABLE_SORT_NONE;
+  if (sortable) {
+    s->column = cfg->sort_column;
+    if (!tui_table_state_sort(s, cfg->sort_column, cfg->sort_descending)) {
+      tui_table_state_destroy(s);
+      return TUI_TABLE_NO_MEMORY;
+    }
+  }
+  *out = s;
+  return TUI_TABLE_OK;
+}
+
+void tui_table_state_destroy(tui_table_state_t *s) {
+  if (!s)
+    return;
+  table_sort_stop(s);
+  free(s->order);
+  free(s);
+}
+
+const tui_table_config_t *tui_table_state_config(const tui_table_state_t *s) {
+  return s ? s->cfg : NULL;
+}
+
+/* ---- navigation ---------------------------------------------------------- */
+
+int tui_table_state_selected(const tui_table_state_t *s) {
+  return s ? s->selected : -1;
+}
+
+int tui_table_state_top(const tui_table_state_t *s) {
+  return s ? s->top : 0;
+}
+
+static void table_select(struct tui_table_state *s, long long position) {
+  const int last = s->cfg->row_count - 1;
+  if (position > last)
+    position = last;
+  if (position < 0)
+    position = 0;
+  s->selected = (int)position;
+}
+
+void tui_table_state_step(tui_table_state_t *s, int delta) {
+  if (s)
+    table_select(s, (long long)s->selected + delta);
+}
+
+void tui_table_state_page(tui_table_state_t *s, int direction,
+                          int page_size) {
+  if (s)
+    table_select(s, (long long)s->selected +
+                        (long long)direction * (page_size > 1 ? page_size : 1));
+}
+
+void tui_table_state_home(tui_table_state_t *s) {
+  if (s)
+    table_select(s, 0);
+}
+
+void tui_table_state_end(tui_table_state_t *s) {
+  if (s)
+    table_select(s, s->cfg->row_count - 1);
+}
+
+void tui_table_state_ensure_selection_visible(tui_table_state_t *s,
+                                              int viewport_rows) {
+  if (!s || viewport_rows < 1)
+    return;
+  if (s->selected < s->top)
+    s->top = s->selected;
+  else if (s->selected >= s->top + viewport_rows)
+    s->top = s->selected - viewport_rows + 1;
+  const int max_top = s->cfg->row_count - viewport_rows;
+  if (s->top > max_top)
+    s->top = max_top > 0 ? max_top : 0;
+}
+
+int tui_table_state_column(const tui_table_state_t *s) {
+  return s ? s->column : 0;
+}
+
+void tui_table_state_move_column(tui_table_state_t *s, int direction) {
+  if (!s)
+    return;
+  const int column = s->column + (direction < 0 ? -1 : 1);
+  if (column < 0 || column >= s->cfg->column_count)
+    return;
+  s->column = column;
+  s->damage_full = true; /* header highlight */
+}
+
+/* ---- damage -------------------------------------------------------------- */
+
+tui_table_damage_t tui_table_state_take_damage(tui_table_state_t *s) {
+  tui_table_damage_t damage = {0};
+  if (!s)
+    return damage;
+  if (s->damage_full || s->top != s->painted_top) {
+    damage.full = true;
+  } else if (s->selected != s->painted_selected) {
+    damage.meta = true;
+    damage.rows[damage.row_count++] = s->painted_selected;
+    damage.rows[damage.row_count++] = s->selected;
+  }
+  s->damage_full = false;
+  s->painted_selected = s->selected;
+  s->painted_top = s->top;
+  return damage;
+}
+
+bool tui_table_state_has_damage(const tui_table_state_t *s) {
+  return s && (s->damage_full || s->top != s->painted_top ||
+               s->selected != s->painted_selected);
+}
+
+void tui_table_state_invalidate(tui_table_state_t *s) {
+  if (s)
+    s->damage_full = true;
+}
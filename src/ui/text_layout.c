@@ -5,12 +5,63 @@
 #include <stdlib.h>
 #include <string.h>
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+#if APP_HAVE_UNICODE_WIDTH_TABLE
+/* Generated at build time by tools/gen_unicode_width.c from the vendored
+ * tools/unicode/ucd_width.txt: two-stage table of 2-bit column widths. */
+#include "unicode_width_table.h"
+#endif
+
+/* Grapheme_Cluster_Break classes (UAX #29), plus Extended_Pictographic, which
+ * only ever applies to code points whose break class is Other. The numbering
+ * is shared with tools/gen_unicode_grapheme.c. */
+typedef enum app_text_gcb_id {
+  APP_TEXT_GCB_OTHER = 0,
+  APP_TEXT_GCB_CR,
+  APP_TEXT_GCB_LF,
+  APP_TEXT_GCB_CONTROL,
+  APP_TEXT_GCB_EXTEND,
+  APP_TEXT_GCB_ZWJ,
+  APP_TEXT_GCB_REGIONAL_INDICATOR,
+  APP_TEXT_GCB_PREPEND,
+  APP_TEXT_GCB_SPACING_MARK,
+  APP_TEXT_GCB_L,
+  APP_TEXT_GCB_V,
+  APP_TEXT_GCB_T,
+  APP_TEXT_GCB_LV,
+  APP_TEXT_GCB_LVT,
+  APP_TEXT_GCB_EXT_PICT,
+} app_text_gcb_id;
+
+#if APP_HAVE_GRAPHEME_TABLE
+/* Generated at build time by tools/gen_unicode_grapheme.c from the vendored
+ * tools/unicode/ucd_grapheme.txt: two-stage table of 4-bit break classes. */
+#include "grapheme_break_table.h"
+#endif
+
 /* Display columns of a Unicode codepoint. Deliberately locale-independent (no
  * wcwidth/mbrtowc) so layout is identical on every platform and does not depend
  * on setlocale() picking a UTF-8 locale (Windows "" is a code page, not UTF-8).
- * Control and common combining marks are zero width; common East Asian wide and
- * fullwidth ranges are two; everything else is one. */
+ * With the generated table this is one two-stage lookup covering the full
+ * East Asian Width and emoji presentation data (policy in
+ * tools/gen_unicode_width.c). Without it, control and common combining marks
+ * are zero width; common East Asian wide and fullwidth ranges are two;
+ * everything else is one. */
 static int app_text_cp_columns(uint32_t cp) {
+#if APP_HAVE_UNICODE_WIDTH_TABLE
+  if (cp >= 0x110000u) {
+    return 1;
+  }
+  const uint8_t block =
+      APP_TEXT_WIDTH_STAGE1[cp >> APP_TEXT_WIDTH_BLOCK_SHIFT];
+  const uint32_t i = cp & ((1u << APP_TEXT_WIDTH_BLOCK_SHIFT) - 1u);
+  return (APP_TEXT_WIDTH_STAGE2[block][i >> 2] >> ((i & 3u) * 2u)) & 3;
+#else
   if (cp == 0) {
     return 0;
   }
@@ -31,26 +82,26 @@ static int app_text_cp_columns(uint32_t cp) {
     return 2; /* East Asian wide / fullwidth */
   }
   return 1;
+#endif
 }
 
-/* Decode one UTF-8 sequence without relying on the C locale. Sets *out_bytes to
- * the sequence length and *out_columns to its display width. Returns false on
- * an invalid or truncated sequence, consuming a single byte as width 1 so
- * callers still make forward progress. */
-static bool app_text_decode_one(const char *text, size_t remaining,
-                                size_t *out_bytes, int *out_columns) {
+/* Decode one UTF-8 sequence without relying on the C locale. Returns the
+ * sequence length (0 only when remaining is 0). An invalid or truncated
+ * sequence consumes a single byte and decodes as U+FFFD, which is one column
+ * wide, so callers still make forward progress. */
+static size_t app_text_decode_cp(const char *text, size_t remaining,
+                                 uint32_t *out_cp) {
   if (remaining == 0) {
-    *out_bytes = 0;
-    *out_columns = 0;
-    return false;
+    *out_cp = 0;
+    return 0;
   }
   const unsigned char *p = (const unsigned char *)text;
   const unsigned char c = p[0];
   uint32_t cp;
   size_t len;
   if (c < 0x80) {
-    cp = c;
-    len = 1;
+    *out_cp = c;
+    return 1;
   } else if ((c & 0xe0u) == 0xc0u) {
     cp = c & 0x1fu;
     len = 2;
@@ -61,43 +112,261 @@ static bool app_text_decode_one(const char *text, size_t remaining,
     cp = c & 0x07u;
     len = 4;
   } else {
-    *out_bytes = 1;
-    *out_columns = 1;
-    return false;
+    *out_cp = 0xfffd;
+    return 1;
   }
   if (len > remaining) {
-    *out_bytes = 1;
-    *out_columns = 1;
-    return false;
+    *out_cp = 0xfffd;
+    return 1;
   }
   for (size_t i = 1; i < len; i++) {
     if ((p[i] & 0xc0u) != 0x80u) {
-      *out_bytes = 1;
-      *out_columns = 1;
-      return false;
+      *out_cp = 0xfffd;
+      return 1;
     }
     cp = (cp << 6) | (p[i] & 0x3fu);
   }
-  *out_bytes = len;
-  *out_columns = app_text_cp_columns(cp);
-  return true;
+  *out_cp = cp;
+  return len;
+}
+
+/* Break class of a code point. Without the generated table only controls,
+ * the common combining ranges, ZWJ and variation selectors are classified,
+ * which keeps marks and emoji sequences attached to their base. */
+static app_text_gcb_id app_text_cp_gcb(uint32_t cp) {
+#if APP_HAVE_GRAPHEME_TABLE
+  if (cp >= 0x110000u) {
+    return APP_TEXT_GCB_OTHER;
+  }
+  const uint8_t block = APP_TEXT_GCB_STAGE1[cp >> APP_TEXT_GCB_BLOCK_SHIFT];
+  const uint32_t i = cp & ((1u << APP_TEXT_GCB_BLOCK_SHIFT) - 1u);
+  return (app_text_gcb_id)((APP_TEXT_GCB_STAGE2[block][i >> 1] >>
+                            ((i & 1u) * 4u)) &
+                           0x0fu);
+#else
+  if (cp == '\r') {
+    return APP_TEXT_GCB_CR;
+  }
+  if (cp == '\n') {
+    return APP_TEXT_GCB_LF;
+  }
+  if (cp < 0x20 || (cp >= 0x7f && cp < 0xa0)) {
+    return APP_TEXT_GCB_CONTROL;
+  }
+  if (cp == 0x200d) {
+    return APP_TEXT_GCB_ZWJ;
+  }
+  if ((cp >= 0x0300 && cp <= 0x036f) || (cp >= 0x1ab0 && cp <= 0x1aff) ||
+      (cp >= 0x1dc0 && cp <= 0x1dff) || (cp >= 0x20d0 && cp <= 0x20ff) ||
+      (cp >= 0xfe00 && cp <= 0xfe0f) || (cp >= 0x1f3fb && cp <= 0x1f3ff)) {
+    return APP_TEXT_GCB_EXTEND;
+  }
+  if (cp >= 0x1f1e6 && cp <= 0x1f1ff) {
+    return APP_TEXT_GCB_REGIONAL_INDICATOR;
+  }
+  if (cp >= 0x1f000 && cp <= 0x1faff) {
+    return APP_TEXT_GCB_EXT_PICT;
+  }
+  return APP_TEXT_GCB_OTHER;
+#endif
+}
+
+/* UAX #29 rules GB3-GB9b between two adjacent classes; the stateful emoji
+ * (GB11) and regional indicator (GB12/13) rules are applied by the caller.
+ * Returns true when the pair must stay in one cluster. */
+static bool app_text_gcb_joins(app_text_gcb_id prev, app_text_gcb_id next) {
+  if (prev == APP_TEXT_GCB_CR && next == APP_TEXT_GCB_LF) {
+    return true; /* GB3 */
+  }
+  if (prev == APP_TEXT_GCB_CR || prev == APP_TEXT_GCB_LF ||
+      prev == APP_TEXT_GCB_CONTROL || next == APP_TEXT_GCB_CR ||
+      next == APP_TEXT_GCB_LF || next == APP_TEXT_GCB_CONTROL) {
+    return false; /* GB4, GB5 */
+  }
+  switch (prev) {
+  case APP_TEXT_GCB_L:
+    if (next == APP_TEXT_GCB_L || next == APP_TEXT_GCB_V ||
+        next == APP_TEXT_GCB_LV || next == APP_TEXT_GCB_LVT) {
+      return true; /* GB6 */
+    }
+    break;
+  case APP_TEXT_GCB_LV:
+  case APP_TEXT_GCB_V:
+    if (next == APP_TEXT_GCB_V || next == APP_TEXT_GCB_T) {
+      return true; /* GB7 */
+    }
+    break;
+  case APP_TEXT_GCB_LVT:
+  case APP_TEXT_GCB_T:
+    if (next == APP_TEXT_GCB_T) {
+      return true; /* GB8 */
+    }
+    break;
+  case APP_TEXT_GCB_PREPEND:
+    return true; /* GB9b */
+  default:
+    break;
+  }
+  return next == APP_TEXT_GCB_EXTEND || next == APP_TEXT_GCB_ZWJ ||
+         next == APP_TEXT_GCB_SPACING_MARK; /* GB9, GB9a */
+}
+
+size_t app_text_grapheme_next(const char *text, size_t byte_count,
+                              int *out_columns) {
+  if (out_columns) {
+    *out_columns = 0;
+  }
+  if (!text || byte_count == 0 || text[0] == '\0') {
+    return 0;
+  }
+  uint32_t cp;
+  size_t offset = app_text_decode_cp(text, byte_count, &cp);
+  app_text_gcb_id prev = app_text_cp_gcb(cp);
+  /* A cluster is as wide as its base. Spacing marks add their own column,
+   * VS16 requests emoji presentation (two columns), and everything else that
+   * joins (combining marks, ZWJ-linked pictographs, skin tone modifiers, the
+   * second regional indicator of a flag, trailing Hangul jamo) is drawn
+   * within the base's cells. */
+  int columns = app_text_cp_columns(cp);
+  bool emoji_zwj = false; /* GB11: ExtPict Extend* ZWJ seen */
+  bool emoji_base = prev == APP_TEXT_GCB_EXT_PICT;
+  unsigned ri_count = prev == APP_TEXT_GCB_REGIONAL_INDICATOR ? 1u : 0u;
+
+  while (offset < byte_count && text[offset] != '\0') {
+    uint32_t next_cp;
+    const size_t bytes =
+        app_text_decode_cp(text + offset, byte_count - offset, &next_cp);
+    const app_text_gcb_id next = app_text_cp_gcb(next_cp);
+    bool joins = app_text_gcb_joins(prev, next);
+    if (!joins && next == APP_TEXT_GCB_EXT_PICT && emoji_zwj) {
+      joins = true; /* GB11 */
+    }
+    if (!joins && next == APP_TEXT_GCB_REGIONAL_INDICATOR &&
+        prev == APP_TEXT_GCB_REGIONAL_INDICATOR && ri_count % 2 == 1) {
+      joins = true; /* GB12, GB13 */
+    }
+    if (!joins) {
+      break;
+    }
+
+    if (next == APP_TEXT_GCB_SPACING_MARK) {
+      columns += app_text_cp_columns(next_cp);
+    } else if (next_cp == 0xfe0f && columns == 1) {
+      columns = 2;
+    } else if (next == APP_TEXT_GCB_REGIONAL_INDICATOR) {
+      columns = 2;
+    } else if (columns == 0) {
+      columns = app_text_cp_columns(next_cp);
+    }
+
+    emoji_zwj = emoji_base && next == APP_TEXT_GCB_ZWJ;
+    if (next == APP_TEXT_GCB_EXT_PICT) {
+      emoji_base = true;
+    } else if (next != APP_TEXT_GCB_EXTEND) {
+      emoji_base = false;
+    }
+    ri_count = next == APP_TEXT_GCB_REGIONAL_INDICATOR ? ri_count + 1 : 0;
+    prev = next;
+    offset += bytes;
+  }
+  if (out_columns) {
+    *out_columns = columns;
+  }
+  return offset;
+}
+
+/* Length of the leading run of printable ASCII (0x20..0x7e) in text[0..n).
+ * Every such byte is one column with no decoding, so callers add the run
+ * wholesale and only hand the byte that ends it (NUL, control, UTF-8 lead) to
+ * the grapheme segmenter. Scans 16 bytes per step with SSE2 or NEON and 8 with
+ * a portable word-at-a-time test otherwise. */
+static size_t app_text_ascii_run(const char *text, size_t n) {
+  size_t i = 0;
+#if defined(__SSE2__)
+  const __m128i below = _mm_set1_epi8(0x1f);
+  const __m128i above = _mm_set1_epi8(0x7f);
+  while (n - i >= 16) {
+    const __m128i v = _mm_loadu_si128((const __m128i *)(text + i));
+    /* Signed compares: bytes >= 0x80 are negative, so both tests reject
+     * them along with controls, DEL and NUL. */
+    const __m128i ok =
+        _mm_and_si128(_mm_cmpgt_epi8(v, below), _mm_cmplt_epi8(v, above));
+    const unsigned mask = (unsigned)_mm_movemask_epi8(ok);
+    if (mask != 0xffffu) {
+      return i + (size_t)__builtin_ctz(~mask);
+    }
+    i += 16;
+  }
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+  const uint8x16_t lo = vdupq_n_u8(0x20);
+  const uint8x16_t hi = vdupq_n_u8(0x7e);
+  while (n - i >= 16) {
+    const uint8x16_t v = vld1q_u8((const uint8_t *)text + i);
+    const uint8x16_t ok = vandq_u8(vcgeq_u8(v, lo), vcleq_u8(v, hi));
+    if (vminvq_u8(ok) != 0xffu) {
+      break; /* the scalar tail finds the exact byte */
+    }
+    i += 16;
+  }
+#else
+  const uint64_t ones = 0x0101010101010101ull;
+  const uint64_t highs = 0x8080808080808080ull;
+  while (n - i >= 8) {
+    uint64_t w;
+    memcpy(&w, text + i, sizeof(w));
+    /* Any byte < 0x20, or any byte > 0x7e (high bit set after adding 1). */
+    const uint64_t low = (w - ones * 0x20u) & ~w & highs;
+    const uint64_t high = ((w + ones) | w) & highs;
+    if (low | high) {
+      break;
+    }
+    i += 8;
+  }
+#endif
+  while (i < n) {
+    const unsigned char c = (unsigned char)text[i];
+    if (c < 0x20u || c > 0x7eu) {
+      break;
+    }
+    i++;
+  }
+  return i;
 }
 
+/* Printable ASCII run starting at text[0], shortened by one byte when a
+ * non-ASCII byte follows: that code point may extend the run's last
+ * character into a cluster (combining mark, VS16), so the segmenter has to
+ * start there. */
+static size_t app_text_ascii_clusters(const char *text, size_t n) {
+  size_t run = app_text_ascii_run(text, n);
+  if (run > 0 && run < n && (unsigned char)text[run] >= 0x80u) {
+    run--;
+  }
+  return run;
+}
+
+/* byte_count bytes must be readable; a NUL before that still ends the text. */
 int app_text_width_utf8_n(const char *text, size_t byte_count) {
   if (!text) {
     return 0;
   }
   int columns = 0;
   size_t offset = 0;
-  while (offset < byte_count && text[offset] != '\0') {
-    size_t bytes = 0;
-    int cell_width = 0;
-    (void)app_text_decode_one(text + offset, byte_count - offset, &bytes,
-                              &cell_width);
+  while (offset < byte_count) {
+    const size_t run =
+        app_text_ascii_clusters(text + offset, byte_count - offset);
+    columns += (int)run;
+    offset += run;
+    if (offset >= byte_count || text[offset] == '\0') {
+      break;
+    }
+    int cluster_width = 0;
+    const size_t bytes = app_text_grapheme_next(
+        text + offset, byte_count - offset, &cluster_width);
     if (bytes == 0) {
       break;
     }
-    columns += cell_width;
+    columns += cluster_width;
     offset += bytes;
   }
   return columns;
@@ -107,6 +376,86 @@ int app_text_width_utf8(const char *text) {
   return text ? app_text_width_utf8_n(text, strlen(text)) : 0;
 }
 
+int app_text_codepoint_columns(uint32_t cp) { return app_text_cp_columns(cp); }
+
+/* Per-thread cache of cluster boundaries for recently truncated strings, so
+ * truncating the same label at many widths (menu resize, status line redraw)
+ * segments it once. Entries are keyed on the pointer, length and a content
+ * hash, so a reused buffer with new text misses. Strings that are long or
+ * have many clusters are segmented directly instead. */
+#define APP_TEXT_SEG_CACHE_SLOTS 8
+#define APP_TEXT_SEG_MAX_CLUSTERS 256
+#define APP_TEXT_SEG_MAX_BYTES 4096
+
+typedef struct app_text_seg_entry {
+  const char *text;
+  size_t len;
+  uint64_t hash;
+  uint16_t count;
+  uint16_t end_byte[APP_TEXT_SEG_MAX_CLUSTERS];
+  uint16_t end_col[APP_TEXT_SEG_MAX_CLUSTERS]; /* cumulative columns */
+} app_text_seg_entry_t;
+
+static thread_local app_text_seg_entry_t
+    app_text_seg_cache[APP_TEXT_SEG_CACHE_SLOTS];
+static thread_local unsigned app_text_seg_next_slot;
+
+static uint64_t app_text_seg_hash(const char *text, size_t len) {
+  uint64_t hash = 0xcbf29ce484222325ull ^ len;
+  size_t i = 0;
+  for (; i + 8 <= len; i += 8) {
+    uint64_t word;
+    memcpy(&word, text + i, sizeof(word));
+    hash = (hash ^ word) * 0x100000001b3ull;
+    hash ^= hash >> 29;
+  }
+  for (; i < len; i++) {
+    hash = (hash ^ (unsigned char)text[i]) * 0x100000001b3ull;
+  }
+  return hash;
+}
+
+/* Cluster boundaries of text[0..len), from the cache or freshly segmented.
+ * Returns NULL when the string does not fit an entry. */
+static const app_text_seg_entry_t *app_text_segments(const char *text,
+                                                     size_t len) {
+  if (len > APP_TEXT_SEG_MAX_BYTES) {
+    return NULL;
+  }
+  const uint64_t hash = app_text_seg_hash(text, len);
+  for (unsigned i = 0; i < APP_TEXT_SEG_CACHE_SLOTS; i++) {
+    const app_text_seg_entry_t *entry = &app_text_seg_cache[i];
+    if (entry->text == text && entry->len == len && entry->hash == hash) {
+      return entry;
+    }
+  }
+
+  app_text_seg_entry_t *entry = &app_text_seg_cache[app_text_seg_next_slot];
+  size_t offset = 0;
+  int columns = 0;
+  uint16_t count = 0;
+  while (offset < len) {
+    if (count == APP_TEXT_SEG_MAX_CLUSTERS) {
+      entry->text = NULL; /* partially overwritten; never match it */
+      return NULL;
+    }
+    int cluster_width = 0;
+    offset +=
+        app_text_grapheme_next(text + offset, len - offset, &cluster_width);
+    columns += cluster_width;
+    entry->end_byte[count] = (uint16_t)offset;
+    entry->end_col[count] = (uint16_t)columns;
+    count++;
+  }
+  entry->text = text;
+  entry->len = len;
+  entry->hash = hash;
+  entry->count = count;
+  app_text_seg_next_slot =
+      (app_text_seg_next_slot + 1) % APP_TEXT_SEG_CACHE_SLOTS;
+  return entry;
+}
+
 size_t app_text_truncate_utf8_columns(const char *text, int max_columns,
                                       int *out_columns) {
   if (out_columns) {
@@ -116,18 +465,52 @@ size_t app_text_truncate_utf8_columns(const char *text, int max_columns,
     return 0;
   }
 
-  int columns = 0;
-  size_t offset = 0;
   const size_t len = strlen(text);
-  while (offset < len) {
-    size_t bytes = 0;
-    int cell_width = 0;
-    (void)app_text_decode_one(text + offset, len - offset, &bytes, &cell_width);
-    if (bytes == 0 || columns + cell_width > max_columns) {
-      break;
+  /* Printable ASCII is one column per byte and a cluster boundary before
+   * another ASCII byte, so when the leading run is the whole string or
+   * overshoots the budget no segmentation is needed. An exact fit still
+   * takes the slow path, which keeps zero-width clusters after the cut. */
+  const size_t budget = (size_t)max_columns;
+  const size_t run = app_text_ascii_clusters(text, len);
+  if (run >= len || run > budget) {
+    const size_t bytes = run < budget ? run : budget;
+    if (out_columns) {
+      *out_columns = (int)bytes;
+    }
+    return bytes;
+  }
+
+  /* Keep every cluster that fits, including zero-width ones after the last
+   * visible column. */
+  size_t offset = run;
+  int columns = (int)run;
+  const app_text_seg_entry_t *segments = app_text_segments(text, len);
+  if (segments) {
+    /* Cumulative columns never decrease: binary search for the last cluster
+     * whose end still fits. */
+    size_t lo = 0;
+    size_t hi = segments->count;
+    while (lo < hi) {
+      const size_t mid = lo + (hi - lo) / 2;
+      if (segments->end_col[mid] <= max_columns) {
+        lo = mid + 1;
+      } else {
+        hi = mid;
+      }
+    }
+    offset = lo > 0 ? segments->end_byte[lo - 1] : 0;
+    columns = lo > 0 ? segments->end_col[lo - 1] : 0;
+  } else {
+    while (offset < len) {
+      int cluster_width = 0;
+      const size_t bytes = app_text_grapheme_next(text + offset, len - offset,
+                                                  &cluster_width);
+      if (bytes == 0 || columns + cluster_width > max_columns) {
+        break;
+      }
+      columns += cluster_width;
+      offset += bytes;
     }
-    columns += cell_width;
-    offset += bytes;
   }
   if (out_columns) {
     *out_columns = columns;
@@ -135,20 +518,28 @@ size_t app_text_truncate_utf8_columns(const char *text, int max_columns,
   return offset;
 }
 
+/* True when the space at p is a break opportunity: the next code point does
+ * not extend it into a cluster (e.g. a combining mark drawn on a space). */
+static bool app_text_space_breaks(const char *p) {
+  if ((unsigned char)p[1] < 0x80u) {
+    return true;
+  }
+  uint32_t cp;
+  (void)app_text_decode_cp(p + 1, strnlen(p + 1, 4), &cp);
+  const app_text_gcb_id next = app_text_cp_gcb(cp);
+  return next != APP_TEXT_GCB_EXTEND && next != APP_TEXT_GCB_ZWJ &&
+         next != APP_TEXT_GCB_SPACING_MARK;
+}
+
 static bool emit_empty_line(app_text_line_emit_fn emit, void *user) {
   return emit ? emit(user, "", 0, 0) : false;
 }
 
-void app_text_wrap_utf8(const char *text, int width_columns,
-                        int first_indent_columns, int next_indent_columns,
-                        app_text_line_emit_fn emit, void *user) {
-  if (!text || !emit) {
-    return;
-  }
-  if (width_columns <= 0) {
-    (void)emit_empty_line(emit, user);
-    return;
-  }
+/* Greedy word wrap; the uncached core of app_text_wrap_utf8(). */
+static void app_text_wrap_compute(const char *text, int width_columns,
+                                  int first_indent_columns,
+                                  int next_indent_columns,
+                                  app_text_line_emit_fn emit, void *user) {
 
   int indent = first_indent_columns < 0 ? 0 : first_indent_columns;
   const int next_indent = next_indent_columns < 0 ? 0 : next_indent_columns;
@@ -187,7 +578,7 @@ void app_text_wrap_utf8(const char *text, int width_columns,
       segment_start = word;
       continue;
     }
-    if (*word == ' ') {
+    if (*word == ' ' && app_text_space_breaks(word)) {
       word++;
       continue;
     }
@@ -209,7 +600,8 @@ void app_text_wrap_utf8(const char *text, int width_columns,
     }
 
     const char *end = word;
-    while (*end && *end != ' ' && *end != '\n') {
+    while (*end && *end != '\n' &&
+           !(*end == ' ' && app_text_space_breaks(end))) {
       end++;
     }
     const size_t word_bytes = (size_t)(end - word);
@@ -257,3 +649,172 @@ void app_text_wrap_utf8(const char *text, int width_columns,
     }
   }
 }
+
+/* Per-thread cache of wrapped layouts, so a paragraph redrawn on every
+ * keystroke or resize replays its line spans instead of re-measuring every
+ * cluster. Entries are keyed on a content hash, the length, the width and the
+ * indents, and hold spans as byte offsets, so any buffer with the same text
+ * hits. All entries share a fixed span pool (the memory cap); the least
+ * recently used entries are evicted until a new layout fits. */
+#define APP_TEXT_WRAP_CACHE_ENTRIES 32
+#define APP_TEXT_WRAP_POOL_SPANS 2048
+#define APP_TEXT_WRAP_MAX_SPANS 256
+#define APP_TEXT_WRAP_MAX_BYTES 65536
+
+typedef struct app_text_wrap_span {
+  uint32_t offset;
+  uint32_t bytes;
+  int32_t columns;
+} app_text_wrap_span_t;
+
+typedef struct app_text_wrap_entry {
+  uint64_t hash;
+  uint32_t len;
+  int width;
+  int first_indent;
+  int next_indent;
+  uint32_t first_span;
+  uint32_t span_count;
+  uint64_t last_used;
+} app_text_wrap_entry_t;
+
+typedef struct app_text_wrap_cache {
+  app_text_wrap_entry_t entries[APP_TEXT_WRAP_CACHE_ENTRIES];
+  unsigned entry_count;
+  uint32_t spans_used;
+  uint64_t clock;
+  app_text_wrap_span_t spans[APP_TEXT_WRAP_POOL_SPANS];
+} app_text_wrap_cache_t;
+
+static thread_local app_text_wrap_cache_t app_text_wrap_cache;
+/* Set while spans are replayed, so an emit callback that wraps other text
+ * bypasses the cache instead of moving spans under the outer replay. */
+static thread_local bool app_text_wrap_busy;
+
+typedef struct app_text_wrap_recorder {
+  const char *text;
+  uint32_t count;
+  bool overflow;
+  app_text_wrap_span_t spans[APP_TEXT_WRAP_MAX_SPANS];
+} app_text_wrap_recorder_t;
+
+static bool app_text_wrap_record(void *user, const char *bytes,
+                                 size_t byte_count, int columns) {
+  app_text_wrap_recorder_t *rec = user;
+  if (rec->count == APP_TEXT_WRAP_MAX_SPANS) {
+    rec->overflow = true;
+    return false;
+  }
+  /* Empty lines are emitted from a literal, not from the text. */
+  const uint32_t offset =
+      byte_count > 0 ? (uint32_t)(bytes - rec->text) : 0;
+  rec->spans[rec->count++] = (app_text_wrap_span_t){
+      .offset = offset, .bytes = (uint32_t)byte_count, .columns = columns};
+  return true;
+}
+
+static void app_text_wrap_evict(app_text_wrap_cache_t *cache, unsigned victim) {
+  const app_text_wrap_entry_t gone = cache->entries[victim];
+  const uint32_t tail = gone.first_span + gone.span_count;
+  memmove(&cache->spans[gone.first_span], &cache->spans[tail],
+          (cache->spans_used - tail) * sizeof(cache->spans[0]));
+  cache->spans_used -= gone.span_count;
+  cache->entries[victim] = cache->entries[--cache->entry_count];
+  for (unsigned i = 0; i < cache->entry_count; i++) {
+    if (cache->entries[i].first_span > gone.first_span) {
+      cache->entries[i].first_span -= gone.span_count;
+    }
+  }
+}
+
+static void app_text_wrap_insert(app_text_wrap_cache_t *cache,
+                                 app_text_wrap_entry_t entry,
+                                 const app_text_wrap_span_t *spans) {
+  while (cache->entry_count == APP_TEXT_WRAP_CACHE_ENTRIES ||
+         cache->spans_used + entry.span_count > APP_TEXT_WRAP_POOL_SPANS) {
+    unsigned victim = 0;
+    for (unsigned i = 1; i < cache->entry_count; i++) {
+      if (cache->entries[i].last_used < cache->entries[victim].last_used) {
+        victim = i;
+      }
+    }
+    app_text_wrap_evict(cache, victim);
+  }
+  entry.first_span = cache->spans_used;
+  memcpy(&cache->spans[entry.first_span], spans,
+         entry.span_count * sizeof(spans[0]));
+  cache->spans_used += entry.span_count;
+  cache->entries[cache->entry_count++] = entry;
+}
+
+void app_text_wrap_utf8(const char *text, int width_columns,
+                        int first_indent_columns, int next_indent_columns,
+                        app_text_line_emit_fn emit, void *user) {
+  if (!text || !emit) {
+    return;
+  }
+  if (width_columns <= 0) {
+    (void)emit_empty_line(emit, user);
+    return;
+  }
+
+  const size_t len = strlen(text);
+  if (len > APP_TEXT_WRAP_MAX_BYTES || app_text_wrap_busy) {
+    app_text_wrap_compute(text, width_columns, first_indent_columns,
+                          next_indent_columns, emit, user);
+    return;
+  }
+
+  app_text_wrap_cache_t *cache = &app_text_wrap_cache;
+  const app_text_wrap_entry_t key = {
+      .hash = app_text_seg_hash(text, len),
+      .len = (uint32_t)len,
+      .width = width_columns,
+      .first_indent = first_indent_columns,
+      .next_indent = next_indent_columns,
+  };
+  const app_text_wrap_span_t *spans = NULL;
+  uint32_t span_count = 0;
+  for (unsigned i = 0; i < cache->entry_count; i++) {
+    app_text_wrap_entry_t *entry = &cache->entries[i];
+    if (entry->hash == key.hash && entry->len == key.len &&
+        entry->width == key.width && entry->first_indent == key.first_indent &&
+        entry->next_indent == key.next_indent) {
+      entry->last_used = ++cache->clock;
+      spans = &cache->spans[entry->first_span];
+      span_count = entry->span_count;
+      break;
+    }
+  }
+
+  static thread_local app_text_wrap_recorder_t rec;
+  if (!spans) {
+    rec.text = text;
+    rec.count = 0;
+    rec.overflow = false;
+    app_text_wrap_compute(text, width_columns, first_indent_columns,
+                          next_indent_columns, app_text_wrap_record, &rec);
+    if (rec.overflow) {
+      /* Too many lines to cache: lay it out directly. */
+      app_text_wrap_compute(text, width_columns, first_indent_columns,
+                            next_indent_columns, emit, user);
+      return;
+    }
+    app_text_wrap_entry_t entry = key;
+    entry.span_count = rec.count;
+    entry.last_used = ++cache->clock;
+    app_text_wrap_insert(cache, entry, rec.spans);
+    spans = rec.spans;
+    span_count = rec.count;
+  }
+
+  app_text_wrap_busy = true;
+  for (uint32_t i = 0; i < span_count; i++) {
+    const app_text_wrap_span_t *span = &spans[i];
+    const char *bytes = span->bytes > 0 ? text + span->offset : "";
+    if (!emit(user, bytes, span->bytes, span->columns)) {
+      break;
+    }
+  }
+  app_text_wrap_busy = false;
+}
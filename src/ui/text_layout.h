@@ -6,14 +6,32 @@
 
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 
 typedef bool (*app_text_line_emit_fn)(void *user, const char *bytes,
                                       size_t byte_count, int columns);
 
+// Display columns of UTF-8 text, measured per grapheme cluster (UAX #29) so
+// combining sequences, emoji ZWJ sequences and flags count as one glyph.
 int app_text_width_utf8(const char *text);
+// Width of at most byte_count bytes. All byte_count bytes must be readable:
+// the ASCII fast path loads whole blocks and only afterwards looks for a NUL,
+// which still ends the text.
 int app_text_width_utf8_n(const char *text, size_t byte_count);
+// Columns of a single code point outside any cluster context (0 for controls
+// and combining marks), for renderers that place wide characters one by one.
+int app_text_codepoint_columns(uint32_t cp);
+// Longest prefix (in bytes) that fits in max_columns without splitting a
+// grapheme cluster. Boundaries of recently seen strings are cached per thread.
 size_t app_text_truncate_utf8_columns(const char *text, int max_columns,
                                       int *out_columns);
+// Length in bytes of the grapheme cluster starting at text (0 at the end or
+// a NUL), with its display columns in *out_columns.
+size_t app_text_grapheme_next(const char *text, size_t byte_count,
+                              int *out_columns);
+// Greedy word wrap, emitting one span of `text` per line. Layouts are cached
+// per thread by content, width and indents, so rewrapping unchanged text
+// replays the spans without measuring it again.
 void app_text_wrap_utf8(const char *text, int width_columns,
                         int first_indent_columns, int next_indent_columns,
                         app_text_line_emit_fn emit, void *user);
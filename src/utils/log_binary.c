@@ -0,0 +1,667 @@
+/*
+ * Binary log file layout: encoding, reading, and deferred rendering.
+ *
+ * Kept free of I/O policy: logging.c decides when entries are written and
+ * the log-decode command decides how decoded records are printed.
+ */
+
+#include "log_binary.h"
+
+#include <ctype.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+
+enum {
+  LOG_ENTRY_SITE = 1,
+  LOG_ENTRY_RECORD = 2,
+};
+
+static const uint32_t k_byte_order_mark = 0x01020304u;
+
+static void log_put(uint8_t **p, const void *value, size_t size) {
+  memcpy(*p, value, size);
+  *p += size;
+}
+
+static void log_put_u8(uint8_t **p, uint8_t value) {
+  log_put(p, &value, sizeof(value));
+}
+
+static void log_put_u16(uint8_t **p, uint16_t value) {
+  log_put(p, &value, sizeof(value));
+}
+
+static void log_put_u32(uint8_t **p, uint32_t value) {
+  log_put(p, &value, sizeof(value));
+}
+
+static void log_put_u64(uint8_t **p, uint64_t value) {
+  log_put(p, &value, sizeof(value));
+}
+
+// Length-prefixed bytes, cut at `max`.
+static void log_put_text(uint8_t **p, const char *text, size_t max) {
+  const size_t len = strnlen(text, max);
+  log_put_u16(p, (uint16_t)len);
+  log_put(p, text, len);
+}
+
+// Fills in the kind and payload length once the payload is in place.
+static size_t log_finish_entry(uint8_t *buf, uint8_t kind, const uint8_t *end) {
+  const size_t size = (size_t)(end - buf);
+  uint8_t *p = buf;
+  log_put_u8(&p, kind);
+  log_put_u16(&p, (uint16_t)(size - 3));
+  return size;
+}
+
+size_t app_log_binary_encode_header(uint8_t *buf) {
+  uint8_t *p = buf;
+  log_put(&p, APP_LOG_BINARY_MAGIC, 8);
+  log_put_u32(&p, APP_LOG_BINARY_VERSION);
+  log_put_u32(&p, k_byte_order_mark);
+  return (size_t)(p - buf);
+}
+
+size_t app_log_binary_encode_site(uint8_t *buf, uint32_t id,
+                                  const app_log_site_t *site) {
+  uint8_t *p = buf + 3;
+  log_put_u32(&p, id);
+  log_put_u8(&p, (uint8_t)site->level);
+  log_put_u32(&p, (uint32_t)site->line);
+  log_put_text(&p, site->file ? site->file : "", APP_LOG_BINARY_FILE_MAX);
+  log_put_text(&p, site->fmt ? site->fmt : "", APP_LOG_BINARY_FORMAT_MAX);
+  return log_finish_entry(buf, LOG_ENTRY_SITE, p);
+}
+
+size_t app_log_binary_encode_record(uint8_t *buf, uint32_t id,
+                                    uint64_t micros, const app_log_arg_t *args,
+                                    uint32_t strings) {
+  uint8_t *p = buf + 3;
+  log_put_u32(&p, id);
+  log_put_u64(&p, micros);
+  uint8_t *count = p++;
+  uint8_t n = 0;
+  for (; n < APP_LOG_MAX_ARGS && args[n].type != APP_LOG_ARG_END; n++) {
+    const app_log_arg_t *arg = &args[n];
+    app_log_arg_type type = arg->type;
+    if (type == APP_LOG_ARG_STRING && !(strings & (1u << n))) {
+      // Not read by %s: the text path prints no more than the address, and
+      // the bytes behind it may be anything, including freed memory.
+      type = APP_LOG_ARG_POINTER;
+    }
+    log_put_u8(&p, (uint8_t)type);
+    switch (type) {
+    case APP_LOG_ARG_INT:
+      log_put_u8(&p, arg->size);
+      log_put_u64(&p, (uint64_t)arg->i);
+      break;
+    case APP_LOG_ARG_UINT:
+      log_put_u8(&p, arg->size);
+      log_put_u64(&p, (uint64_t)arg->u);
+      break;
+    case APP_LOG_ARG_DOUBLE:
+      log_put(&p, &arg->d, sizeof(arg->d));
+      break;
+    case APP_LOG_ARG_STRING:
+      // Copied now: the caller's buffer may be gone by the time it is read.
+      log_put_text(&p, arg->s ? arg->s : "(null)", APP_LOG_BINARY_STRING_MAX);
+      break;
+    case APP_LOG_ARG_POINTER:
+    default:
+      log_put_u64(&p, (uint64_t)(uintptr_t)arg->p);
+      break;
+    }
+  }
+  *count = n;
+  return log_finish_entry(buf, LOG_ENTRY_RECORD, p);
+}
+
+// ---- rendering ------------------------------------------------------------
+
+typedef struct {
+  char *buf;
+  size_t size;
+  size_t len;
+} log_writer_t;
+
+static void log_write(log_writer_t *w, const char *text, size_t n) {
+  if (w->len + 1 >= w->size) {
+    return;
+  }
+  const size_t room = w->size - 1 - w->len;
+  if (n > room) {
+    n = room;
+  }
+  memcpy(w->buf + w->len, text, n);
+  w->len += n;
+  w->buf[w->len] = '\0';
+}
+
+// `spec` is a single conversion assembled by app_log_render_message, with
+// the length modifier matching the value passed.
+static void log_writef(log_writer_t *w, const char *spec, ...) {
+  if (w->len + 1 >= w->size) {
+    return;
+  }
+  const size_t room = w->size - w->len;
+  va_list args;
+  va_start(args, spec);
+  const int n = vsnprintf(w->buf + w->len, room, spec, args);
+  va_end(args);
+  if (n > 0) {
+    w->len += (size_t)n < room ? (size_t)n : room - 1;
+  }
+}
+
+// Conversions that take an argument.
+static const char k_conversions[] = "diuoxXceEfFgGaAspn";
+
+// Skips a length modifier and returns the size of the integer it names, or
+// 0 without one (and for L, which only applies to doubles).
+static size_t log_take_length(const char **p) {
+  const char *s = *p;
+  size_t size = 0;
+  if (s[0] == 'h' && s[1] == 'h') {
+    size = sizeof(char);
+    s += 2;
+  } else if (s[0] == 'l' && s[1] == 'l') {
+    size = sizeof(long long);
+    s += 2;
+  } else if (*s == 'h') {
+    size = sizeof(short);
+    s++;
+  } else if (*s == 'l') {
+    size = sizeof(long);
+    s++;
+  } else if (*s == 'q') {
+    size = sizeof(long long);
+    s++;
+  } else if (*s == 'j') {
+    size = sizeof(intmax_t);
+    s++;
+  } else if (*s == 'z') {
+    size = sizeof(size_t);
+    s++;
+  } else if (*s == 't') {
+    size = sizeof(ptrdiff_t);
+    s++;
+  } else if (*s == 'L') {
+    s++;
+  }
+  *p = s;
+  return size;
+}
+
+// The integer printf would have read: `size` bytes, or without a length
+// modifier the argument after default promotion to int.
+static unsigned long long log_int_bits(const app_log_arg_t *arg, size_t size,
+                                       bool is_signed) {
+  if (size == 0) {
+    size = arg->size > sizeof(int) ? arg->size : sizeof(int);
+  }
+  if (size >= sizeof(unsigned long long)) {
+    return arg->u;
+  }
+  const unsigned bits = (unsigned)size * 8u;
+  const unsigned long long mask = (1ull << bits) - 1;
+  unsigned long long value = arg->u & mask;
+  if (is_signed && (value >> (bits - 1)) != 0) {
+    value |= ~mask; // sign-extend back to long long
+  }
+  return value;
+}
+
+uint32_t app_log_binary_string_args(const char *fmt) {
+  uint32_t strings = 0;
+  unsigned next = 0;
+  const char *p = fmt ? strchr(fmt, '%') : NULL;
+  while (p != NULL) {
+    p++;
+    if (*p == '%') {
+      p = strchr(p + 1, '%');
+      continue;
+    }
+    // Same grammar as app_log_render_message, counting arguments only.
+    while (*p != '\0' && strchr("-+ #0'", *p) != NULL) {
+      p++;
+    }
+    if (*p == '*') {
+      p++;
+      next++;
+    } else {
+      while (isdigit((unsigned char)*p)) {
+        p++;
+      }
+    }
+    if (*p == '.') {
+      p++;
+      if (*p == '*') {
+        p++;
+        next++;
+      } else {
+        while (isdigit((unsigned char)*p)) {
+          p++;
+        }
+      }
+    }
+    (void)log_take_length(&p);
+    if (*p == '\0') {
+      break;
+    }
+    if (strchr(k_conversions, *p) != NULL) {
+      if (*p == 's' && next < 32) {
+        strings |= 1u << next;
+      }
+      next++;
+    }
+    p = strchr(p + 1, '%');
+  }
+  return strings;
+}
+
+static bool log_arg_is_integer(const app_log_arg_t *arg) {
+  return arg &&
+         (arg->type == APP_LOG_ARG_INT || arg->type == APP_LOG_ARG_UINT);
+}
+
+// Appends a `*` width or precision taken from the next argument.
+static bool log_take_star(char *spec, size_t *len, size_t cap,
+                          const app_log_arg_t *args, size_t count,
+                          size_t *next) {
+  const app_log_arg_t *arg = *next < count ? &args[(*next)++] : NULL;
+  if (!log_arg_is_integer(arg)) {
+    return false;
+  }
+  const int n = snprintf(spec + *len, cap - *len, "%d", (int)arg->i);
+  if (n < 0 || (size_t)n >= cap - *len) {
+    return false;
+  }
+  *len += (size_t)n;
+  return true;
+}
+
+size_t app_log_render_message(char *buf, size_t size, const char *fmt,
+                              const app_log_arg_t *args, size_t count) {
+  log_writer_t w = {.buf = buf, .size = size, .len = 0};
+  if (size > 0) {
+    buf[0] = '\0';
+  }
+  size_t next = 0;
+  const char *p = fmt ? fmt : "";
+  while (*p != '\0') {
+    if (*p != '%') {
+      const char *percent = strchr(p, '%');
+      const size_t n = percent ? (size_t)(percent - p) : strlen(p);
+      log_write(&w, p, n);
+      p += n;
+      continue;
+    }
+    if (p[1] == '%') {
+      log_write(&w, "%", 1);
+      p += 2;
+      continue;
+    }
+
+    // Rebuild the conversion with only what snprintf needs: flags, width,
+    // precision, and the length modifier for the captured type.
+    char spec[48];
+    size_t len = 0;
+    bool ok = true;
+    spec[len++] = *p++;
+    while (*p != '\0' && strchr("-+ #0'", *p) != NULL && len < 8) {
+      spec[len++] = *p++;
+    }
+    if (*p == '*') {
+      p++;
+      ok = log_take_star(spec, &len, sizeof(spec) - 4, args, count, &next);
+    } else {
+      while (isdigit((unsigned char)*p) && len < 20) {
+        spec[len++] = *p++;
+      }
+    }
+    if (*p == '.') {
+      spec[len++] = *p++;
+      if (*p == '*') {
+        p++;
+        ok = log_take_star(spec, &len, sizeof(spec) - 4, args, count, &next) &&
+             ok;
+      } else {
+        while (isdigit((unsigned char)*p) && len < 36) {
+          spec[len++] = *p++;
+        }
+      }
+    }
+    const size_t length = log_take_length(&p);
+    const char conv = *p;
+    if (conv == '\0') {
+      break;
+    }
+    p++;
+    // Only conversions this renderer knows take an argument: a typo or an
+    // extension such as %m shows as <?> without shifting the ones after it.
+    const bool known = strchr(k_conversions, conv) != NULL;
+    const app_log_arg_t *arg = known && next < count ? &args[next++] : NULL;
+
+    switch (conv) {
+    case 'd':
+    case 'i':
+      ok = ok && log_arg_is_integer(arg);
+      if (ok) {
+        memcpy(spec + len, "lld", 4);
+        log_writef(&w, spec, (long long)log_int_bits(arg, length, true));
+      }
+      break;
+    case 'u':
+    case 'o':
+    case 'x':
+    case 'X':
+      ok = ok && log_arg_is_integer(arg);
+      if (ok) {
+        spec[len++] = 'l';
+        spec[len++] = 'l';
+        spec[len++] = conv;
+        spec[len] = '\0';
+        log_writef(&w, spec, log_int_bits(arg, length, false));
+      }
+      break;
+    case 'c':
+      ok = ok && log_arg_is_integer(arg);
+      if (ok) {
+        memcpy(spec + len, "c", 2);
+        log_writef(&w, spec, (int)arg->i);
+      }
+      break;
+    case 'e':
+    case 'E':
+    case 'f':
+    case 'F':
+    case 'g':
+    case 'G':
+    case 'a':
+    case 'A':
+      ok = ok && arg && arg->type == APP_LOG_ARG_DOUBLE;
+      if (ok) {
+        spec[len++] = conv;
+        spec[len] = '\0';
+        log_writef(&w, spec, arg->d);
+      }
+      break;
+    case 's':
+      ok = ok && arg && arg->type == APP_LOG_ARG_STRING;
+      if (ok) {
+        memcpy(spec + len, "s", 2);
+        log_writef(&w, spec, arg->s ? arg->s : "(null)");
+      }
+      break;
+    case 'p':
+      // A string read by %p prints its address, as printf would.
+      ok = ok && arg &&
+           (arg->type == APP_LOG_ARG_POINTER ||
+            arg->type == APP_LOG_ARG_STRING);
+      if (ok) {
+        memcpy(spec + len, "p", 2);
+        log_writef(&w, spec, arg->p);
+      }
+      break;
+    case 'n':
+      // Consumes its argument and prints nothing, as printf would.
+      break;
+    default:
+      ok = false;
+      break;
+    }
+    if (!ok) {
+      log_write(&w, "<?>", 3);
+    }
+  }
+  return w.len;
+}
+
+// ---- reading --------------------------------------------------------------
+
+typedef struct {
+  bool defined;
+  app_log_level level;
+  int line;
+  char *file;
+  char *fmt;
+} log_site_def_t;
+
+// Site ids are dense from 1, so they index the table directly; the cap
+// keeps a corrupt id from allocating without bound.
+#define LOG_READER_MAX_SITES (1u << 20)
+
+struct app_log_reader {
+  FILE *in;
+  log_site_def_t *sites;
+  size_t site_capacity;
+  uint8_t payload[UINT16_MAX];
+  char strings[APP_LOG_MAX_ARGS][APP_LOG_BINARY_STRING_MAX + 1];
+  char message[APP_LOG_MESSAGE_MAX];
+};
+
+typedef struct {
+  const uint8_t *p;
+  const uint8_t *end;
+} log_cursor_t;
+
+static bool log_get(log_cursor_t *c, void *out, size_t size) {
+  if ((size_t)(c->end - c->p) < size) {
+    return false;
+  }
+  memcpy(out, c->p, size);
+  c->p += size;
+  return true;
+}
+
+// Copies a length-prefixed string into `out` (capacity `cap`, cut to fit).
+static bool log_get_text(log_cursor_t *c, char *out, size_t cap) {
+  uint16_t len = 0;
+  if (!log_get(c, &len, sizeof(len)) || (size_t)(c->end - c->p) < len) {
+    return false;
+  }
+  const size_t n = len < cap ? len : cap - 1;
+  memcpy(out, c->p, n);
+  out[n] = '\0';
+  c->p += len;
+  return true;
+}
+
+static void log_reader_reset_sites(app_log_reader_t *reader) {
+  for (size_t i = 0; i < reader->site_capacity; i++) {
+    free(reader->sites[i].file);
+    free(reader->sites[i].fmt);
+  }
+  free(reader->sites);
+  reader->sites = NULL;
+  reader->site_capacity = 0;
+}
+
+// Checks the 15 header bytes that follow the first magic byte.
+static bool log_reader_header_rest(app_log_reader_t *reader) {
+  uint8_t header[APP_LOG_BINARY_HEADER_SIZE];
+  header[0] = (uint8_t)APP_LOG_BINARY_MAGIC[0];
+  if (fread(header + 1, 1, sizeof(header) - 1, reader->in) !=
+      sizeof(header) - 1) {
+    return false;
+  }
+  uint32_t version = 0;
+  uint32_t mark = 0;
+  memcpy(&version, header + 8, sizeof(version));
+  memcpy(&mark, header + 12, sizeof(mark));
+  return memcmp(header, APP_LOG_BINARY_MAGIC, 8) == 0 &&
+         version == APP_LOG_BINARY_VERSION && mark == k_byte_order_mark;
+}
+
+static app_error log_reader_define_site(app_log_reader_t *reader,
+                                        log_cursor_t *c) {
+  uint32_t id = 0;
+  uint8_t level = 0;
+  uint32_t line = 0;
+  char file[APP_LOG_BINARY_FILE_MAX + 1];
+  char fmt[APP_LOG_BINARY_FORMAT_MAX + 1];
+  if (!log_get(c, &id, sizeof(id)) || !log_get(c, &level, sizeof(level)) ||
+      !log_get(c, &line, sizeof(line)) ||
+      !log_get_text(c, file, sizeof(file)) ||
+      !log_get_text(c, fmt, sizeof(fmt)) || id == 0 ||
+      id > LOG_READER_MAX_SITES || level > LOG_LEVEL_DEBUG) {
+    return APP_ERROR_INVALID_DATA;
+  }
+  if (id > reader->site_capacity) {
+    size_t capacity = reader->site_capacity ? reader->site_capacity : 64;
+    while (capacity < id) {
+      capacity *= 2;
+    }
+    log_site_def_t *sites =
+        realloc(reader->sites, capacity * sizeof(*reader->sites));
+    if (!sites) {
+      return APP_ERROR_MEMORY;
+    }
+    memset(sites + reader->site_capacity, 0,
+           (capacity - reader->site_capacity) * sizeof(*sites));
+    reader->sites = sites;
+    reader->site_capacity = capacity;
+  }
+  log_site_def_t *site = &reader->sites[id - 1];
+  char *file_copy = malloc(strlen(file) + 1);
+  char *fmt_copy = malloc(strlen(fmt) + 1);
+  if (!file_copy || !fmt_copy) {
+    free(file_copy);
+    free(fmt_copy);
+    return APP_ERROR_MEMORY;
+  }
+  strcpy(file_copy, file);
+  strcpy(fmt_copy, fmt);
+  free(site->file);
+  free(site->fmt);
+  *site = (log_site_def_t){.defined = true,
+                           .level = (app_log_level)level,
+                           .line = (int)line,
+                           .file = file_copy,
+                           .fmt = fmt_copy};
+  return APP_SUCCESS;
+}
+
+static app_error log_reader_record(app_log_reader_t *reader, log_cursor_t *c,
+                                   app_log_entry_t *entry) {
+  uint32_t id = 0;
+  uint64_t micros = 0;
+  uint8_t count = 0;
+  if (!log_get(c, &id, sizeof(id)) || !log_get(c, &micros, sizeof(micros)) ||
+      !log_get(c, &count, sizeof(count)) || count > APP_LOG_MAX_ARGS ||
+      id == 0 || id > reader->site_capacity ||
+      !reader->sites[id - 1].defined) {
+    return APP_ERROR_INVALID_DATA;
+  }
+  app_log_arg_t args[APP_LOG_MAX_ARGS];
+  for (uint8_t i = 0; i < count; i++) {
+    uint8_t type = 0;
+    uint64_t bits = 0;
+    if (!log_get(c, &type, sizeof(type))) {
+      return APP_ERROR_INVALID_DATA;
+    }
+    args[i].type = (app_log_arg_type)type;
+    if (type == APP_LOG_ARG_STRING) {
+      if (!log_get_text(c, reader->strings[i], sizeof(reader->strings[i]))) {
+        return APP_ERROR_INVALID_DATA;
+      }
+      args[i].s = reader->strings[i];
+      continue;
+    }
+    uint8_t size = 0;
+    if (type == APP_LOG_ARG_END || type > APP_LOG_ARG_POINTER ||
+        ((type == APP_LOG_ARG_INT || type == APP_LOG_ARG_UINT) &&
+         (!log_get(c, &size, sizeof(size)) || size == 0 ||
+          size > sizeof(bits))) ||
+        !log_get(c, &bits, sizeof(bits))) {
+      return APP_ERROR_INVALID_DATA;
+    }
+    args[i].size = size;
+    if (type == APP_LOG_ARG_DOUBLE) {
+      memcpy(&args[i].d, &bits, sizeof(args[i].d));
+    } else if (type == APP_LOG_ARG_POINTER) {
+      args[i].p = (const void *)(uintptr_t)bits;
+    } else {
+      args[i].u = bits;
+    }
+  }
+
+  const log_site_def_t *site = &reader->sites[id - 1];
+  app_log_render_message(reader->message, sizeof(reader->message), site->fmt,
+                         args, count);
+  *entry = (app_log_entry_t){.level = site->level,
+                             .file = site->file,
+                             .line = site->line,
+                             .micros = micros,
+                             .message = reader->message};
+  return APP_SUCCESS;
+}
+
+app_error app_log_reader_open(FILE *in, app_log_reader_t **out) {
+  if (!in || !out) {
+    return APP_ERROR_INVALID_ARG;
+  }
+  *out = NULL;
+  app_log_reader_t *reader = calloc(1, sizeof(*reader));
+  if (!reader) {
+    return APP_ERROR_MEMORY;
+  }
+  reader->in = in;
+  const int first = fgetc(in);
+  if (first != (unsigned char)APP_LOG_BINARY_MAGIC[0] ||
+      !log_reader_header_rest(reader)) {
+    free(reader);
+    return APP_ERROR_INVALID_DATA;
+  }
+  *out = reader;
+  return APP_SUCCESS;
+}
+
+app_error app_log_reader_next(app_log_reader_t *reader, app_log_entry_t *entry,
+                              bool *done) {
+  if (!reader || !entry || !done) {
+    return APP_ERROR_INVALID_ARG;
+  }
+  *done = false;
+  for (;;) {
+    const int kind = fgetc(reader->in);
+    if (kind == EOF) {
+      *done = true;
+      return ferror(reader->in) ? APP_ERROR_IO : APP_SUCCESS;
+    }
+    // Another run appended to the same file: its ids start over.
+    if (kind == (unsigned char)APP_LOG_BINARY_MAGIC[0]) {
+      if (!log_reader_header_rest(reader)) {
+        return APP_ERROR_INVALID_DATA;
+      }
+      log_reader_reset_sites(reader);
+      continue;
+    }
+
+    uint16_t len = 0;
+    if (fread(&len, sizeof(len), 1, reader->in) != 1 ||
+        fread(reader->payload, 1, len, reader->in) != len) {
+      return APP_ERROR_INVALID_DATA;
+    }
+    log_cursor_t c = {.p = reader->payload, .end = reader->payload + len};
+    if (kind == LOG_ENTRY_SITE) {
+      const app_error err = log_reader_define_site(reader, &c);
+      if (err != APP_SUCCESS) {
+        return err;
+      }
+    } else if (kind == LOG_ENTRY_RECORD) {
+      return log_reader_record(reader, &c, entry);
+    }
+    // Unknown kinds are skipped so newer writers stay readable.
+  }
+}
+
+void app_log_reader_close(app_log_reader_t *reader) {
+  if (!reader) {
+    return;
+  }
+  log_reader_reset_sites(reader);
+  free(reader);
+}
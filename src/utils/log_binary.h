@@ -0,0 +1,91 @@
+/*
+ * Binary log records for deferred formatting.
+ *
+ * In binary mode (logging.h) a LOG_* call copies its raw argument values into
+ * a record instead of running printf; formatting happens later, when
+ * `myapp log-decode` reads the file back. This module owns the file layout:
+ * encoding entries for the writer in logging.c, reading them back, and
+ * rendering a format string with captured arguments the way printf would.
+ *
+ * Layout (native byte order, checked by the header's byte-order mark):
+ *   header - "APPLOGB\n", u32 version, u32 0x01020304. Written each time the
+ *            file is opened, so appended runs each start with one.
+ *   entry  - u8 kind, u16 payload length, payload:
+ *     site   (kind 1) - u32 id, u8 level, u32 line, u16 length + file,
+ *                       u16 length + format
+ *     record (kind 2) - u32 site id, u64 microseconds since the epoch,
+ *                       u8 argument count, then per argument a u8 type and
+ *                       u8 size + 8 value bytes (integers), 8 value bytes
+ *                       (doubles, pointers) or u16 length + string bytes
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "../core/error.h"
+#include "../core/types.h"
+#include "logging.h"
+
+#define APP_LOG_BINARY_MAGIC "APPLOGB\n"
+#define APP_LOG_BINARY_VERSION 2u
+#define APP_LOG_BINARY_HEADER_SIZE 16
+
+// Per-entry limits. Strings are cut at APP_LOG_BINARY_STRING_MAX bytes; site
+// file names and formats at the larger limits below.
+#define APP_LOG_BINARY_STRING_MAX 256
+#define APP_LOG_BINARY_FILE_MAX 512
+#define APP_LOG_BINARY_FORMAT_MAX 2048
+#define APP_LOG_BINARY_ENTRY_MAX \
+  (3 + 13 + APP_LOG_MAX_ARGS * (3 + APP_LOG_BINARY_STRING_MAX))
+
+// Longest message log-decode renders; the rest of a line is cut.
+#define APP_LOG_MESSAGE_MAX 4096
+
+// Encoders for the writer. Each fills `buf` (at least
+// APP_LOG_BINARY_ENTRY_MAX bytes) and returns the bytes used.
+size_t app_log_binary_encode_header(uint8_t *buf);
+size_t app_log_binary_encode_site(uint8_t *buf, uint32_t id,
+                                  const app_log_site_t *site);
+// `strings` comes from app_log_binary_string_args() for the site's format:
+// a string argument whose bit is clear is recorded as its address, so a %p
+// never reads through it.
+size_t app_log_binary_encode_record(uint8_t *buf, uint32_t id,
+                                    uint64_t micros, const app_log_arg_t *args,
+                                    uint32_t strings);
+
+// Bit i is set when argument i of `fmt` is read by a %s conversion.
+uint32_t app_log_binary_string_args(const char *fmt);
+
+// Renders `fmt` with captured arguments into buf (always NUL-terminated when
+// size > 0). Conversions take the next argument whatever their length
+// modifier says, since the capture already knows the type; the value is then
+// cut to the modifier's width, or without one to the argument's promoted
+// size, as printf would read it. `*` widths and precisions take one too. A
+// conversion whose argument is missing or of the wrong kind prints "<?>".
+// Returns the length of the rendered text.
+size_t app_log_render_message(char *buf, size_t size, const char *fmt,
+                              const app_log_arg_t *args, size_t count);
+
+// One decoded record. Pointers stay valid until the next call on the reader.
+typedef struct {
+  app_log_level level;
+  const char *file;
+  int line;
+  uint64_t micros;
+  const char *message;
+} app_log_entry_t;
+
+typedef struct app_log_reader app_log_reader_t;
+
+// Starts reading a binary log; fails with APP_ERROR_INVALID_DATA when the
+// stream does not begin with a header this build can read.
+APP_NODISCARD app_error app_log_reader_open(FILE *in, app_log_reader_t **out);
+// Reads the next record into *entry. Sets *done at a clean end of stream;
+// returns APP_ERROR_INVALID_DATA for a truncated or malformed entry.
+APP_NODISCARD app_error app_log_reader_next(app_log_reader_t *reader,
+                                            app_log_entry_t *entry,
+                                            bool *done);
+void app_log_reader_close(app_log_reader_t *reader);
@@ -8,6 +8,9 @@
 
 #include "logging.h"
 
+#include <errno.h>
+#include <stdatomic.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -15,10 +18,13 @@
 #ifdef _WIN32
 #include <windows.h>
 #else
+#include <pthread.h>
+#include <sched.h>
 #include <sys/time.h>
 #endif
 
 #include "../core/types.h"
+#include "log_binary.h"
 
 // Global log level defaults to ERROR to minimize output in production
 // environments. Developers can increase verbosity via APP_LOG_LEVEL when
@@ -28,6 +34,75 @@
 static app_log_level g_log_level = LOG_LEVEL_ERROR;
 static bool g_log_initialized = false;
 
+// Async mode needs threads and atomics; Windows builds stay synchronous.
+#ifdef _WIN32
+#define LOG_ASYNC 0
+#else
+#define LOG_ASYNC 1
+#endif
+
+// Binary sink (see app_log_binary_open). `generation` changes with every
+// open, so call sites registered against an earlier file register again and
+// ids in each file start from 1. `lock` guards site registration; `control`
+// serializes open and close. Both are held only briefly and never on the
+// record path.
+#define LOG_BINARY_BUFFER 65536
+
+static struct {
+  FILE *file;
+  _Atomic bool active;
+  _Atomic int writers; // record writers between the active check and fwrite
+  _Atomic uint32_t generation;
+  uint32_t next_id;
+  bool atexit_registered;
+  atomic_flag lock;
+  atomic_flag control;
+} g_binary = {.lock = ATOMIC_FLAG_INIT, .control = ATOMIC_FLAG_INIT};
+
+#if LOG_ASYNC
+// Ring geometry. The slot count is a power of two so a position maps to its
+// slot with a mask; 2048 slots of about 512 bytes keep the ring at 1 MiB,
+// enough to absorb bursts while the flusher is writing a batch.
+#define LOG_RING_SLOTS 2048u
+#define LOG_RING_PAYLOAD 456
+// The flusher formats records into one buffer and writes it with a single
+// call. A record that does not fit what is left waits for the next batch.
+#define LOG_BATCH_BYTES 65536
+
+// One record. `seq` follows Vyukov's bounded queue: it equals the position
+// when the slot is free for that lap, position + 1 once the record is
+// published, and position + LOG_RING_SLOTS after the flusher consumed it.
+typedef struct {
+  _Atomic size_t seq;
+  const char *file;
+  int line;
+  app_log_level level;
+  struct timeval tv;
+  size_t len;
+  char payload[LOG_RING_PAYLOAD];
+} log_record_t;
+
+static struct {
+  log_record_t *ring;
+  _Atomic size_t tail;   // next position producers claim
+  size_t head;           // next position the flusher reads; flusher only
+  _Atomic bool running;  // producers may enqueue
+  _Atomic bool stopping; // flusher drains to empty and exits
+  _Atomic bool sleeping; // flusher is (about to be) waiting on `wake`
+  _Atomic int writers;   // producers between the running check and publish
+  _Atomic size_t written; // positions below this are on stderr
+  bool atexit_registered;
+  pthread_t thread;
+  pthread_mutex_t control; // serializes start/stop
+  pthread_mutex_t lock;    // pairs with `wake`
+  pthread_cond_t wake;
+} g_async = {
+    .control = PTHREAD_MUTEX_INITIALIZER,
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .wake = PTHREAD_COND_INITIALIZER,
+};
+#endif
+
 void app_log_init(void) {
   // Initialize only once to ensure consistent logging behavior throughout the
   // program's lifetime. Reading environment variables multiple times could lead
@@ -35,6 +110,19 @@ void app_log_init(void) {
   if (!g_log_initialized) {
     app_log_update_level();
     g_log_initialized = true;
+    // Async mode is opt-in per process, like the level, so long-running
+    // request and batch runs can turn it on without a rebuild.
+    const char *async = getenv("APP_LOG_ASYNC");
+    if (async != nullptr && strcmp(async, "1") == 0) {
+      (void)app_log_async_start();
+    }
+    const char *binary = getenv("APP_LOG_BINARY");
+    if (binary != nullptr && binary[0] != '\0' &&
+        !app_log_binary_open(binary)) {
+      app_log_with_location(LOG_LEVEL_ERROR, __FILE__, __LINE__,
+                            "Cannot open binary log %s: %s", binary,
+                            strerror(errno));
+    }
   }
 }
 
@@ -70,7 +158,7 @@ void app_log_set_level(app_log_level level) {
   g_log_initialized = true;
 }
 
-static const char *log_level_to_string(app_log_level level) {
+const char *app_log_level_name(app_log_level level) {
   switch (level) {
   case LOG_LEVEL_ERROR:
     return "ERROR";
@@ -85,6 +173,362 @@ static const char *log_level_to_string(app_log_level level) {
   }
 }
 
+#if LOG_ASYNC
+// Formatted seconds of the last record; consecutive records almost always
+// share them, so localtime_r/strftime run about once per second of logs.
+typedef struct {
+  time_t seconds;
+  char text[32];
+} log_time_cache_t;
+
+static const char *log_cached_time(log_time_cache_t *cache, time_t seconds) {
+  if (cache->text[0] == '\0' || cache->seconds != seconds) {
+    struct tm tm_info_buf;
+    localtime_r(&seconds, &tm_info_buf);
+    strftime(cache->text, sizeof(cache->text), "%Y-%m-%d %H:%M:%S",
+             &tm_info_buf);
+    cache->seconds = seconds;
+  }
+  return cache->text;
+}
+
+static bool log_async_ready(void) {
+  const log_record_t *slot =
+      &g_async.ring[g_async.head & (LOG_RING_SLOTS - 1)];
+  return atomic_load(&slot->seq) == g_async.head + 1;
+}
+
+// Formats published records into `batch` until the ring is empty or the
+// batch is full, releasing each slot as it goes. Returns the bytes used.
+// The line matches the synchronous one byte for byte.
+static size_t log_async_drain(char *batch, log_time_cache_t *cache) {
+  size_t used = 0;
+  while (used < LOG_BATCH_BYTES && log_async_ready()) {
+    log_record_t *slot = &g_async.ring[g_async.head & (LOG_RING_SLOTS - 1)];
+    const size_t room = LOG_BATCH_BYTES - used;
+    const int n = snprintf(batch + used, room, "[%s.%03ld] [%s] %s:%d: %.*s\n",
+                           log_cached_time(cache, slot->tv.tv_sec),
+                           (long)(slot->tv.tv_usec / 1000),
+                           app_log_level_name(slot->level), slot->file,
+                           slot->line, (int)slot->len, slot->payload);
+    if (n > 0 && (size_t)n >= room) {
+      if (used > 0) {
+        break; // leads the next batch
+      }
+      // Longer than a whole batch (only a runaway file name gets here).
+      used = room - 1;
+      batch[used - 1] = '\n';
+    } else if (n > 0) {
+      used += (size_t)n;
+    }
+    atomic_store_explicit(&slot->seq, g_async.head + LOG_RING_SLOTS,
+                          memory_order_release);
+    g_async.head++;
+  }
+  return used;
+}
+
+static void *log_async_thread(void *arg) {
+  (void)arg;
+  static char batch[LOG_BATCH_BYTES];
+  log_time_cache_t cache = {.seconds = 0, .text = ""};
+  for (;;) {
+    // Read the stop flag before draining: once it is set no producer is left,
+    // so an empty drain after seeing it means every record was written.
+    const bool stopping = atomic_load(&g_async.stopping);
+    const size_t used = log_async_drain(batch, &cache);
+    if (used > 0) {
+      fwrite(batch, 1, used, stderr);
+      fflush(stderr);
+      atomic_store(&g_async.written, g_async.head);
+      continue;
+    }
+    if (stopping) {
+      break;
+    }
+
+    // Announce the wait before the final emptiness check; producers check
+    // `sleeping` after publishing, and all four accesses are seq_cst, so one
+    // of the two sides always sees the other.
+    pthread_mutex_lock(&g_async.lock);
+    atomic_store(&g_async.sleeping, true);
+    if (!log_async_ready() && !atomic_load(&g_async.stopping)) {
+      struct timespec deadline;
+      clock_gettime(CLOCK_REALTIME, &deadline);
+      deadline.tv_nsec += 100 * 1000000L;
+      if (deadline.tv_nsec >= 1000000000L) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000L;
+      }
+      pthread_cond_timedwait(&g_async.wake, &g_async.lock, &deadline);
+    }
+    atomic_store(&g_async.sleeping, false);
+    pthread_mutex_unlock(&g_async.lock);
+  }
+  return nullptr;
+}
+
+static void log_async_wake(void) {
+  if (atomic_load(&g_async.sleeping)) {
+    pthread_mutex_lock(&g_async.lock);
+    pthread_cond_signal(&g_async.wake);
+    pthread_mutex_unlock(&g_async.lock);
+  }
+}
+
+// Claims a slot, formats the payload into it and publishes it. Returns false
+// when async mode is off; the caller then logs synchronously.
+static bool log_async_enqueue(app_log_level level, const char *file, int line,
+                              const char *fmt, va_list args) {
+  atomic_fetch_add(&g_async.writers, 1);
+  if (!atomic_load(&g_async.running)) {
+    atomic_fetch_sub(&g_async.writers, 1);
+    return false;
+  }
+
+  size_t pos = atomic_load_explicit(&g_async.tail, memory_order_relaxed);
+  log_record_t *slot = nullptr;
+  for (;;) {
+    slot = &g_async.ring[pos & (LOG_RING_SLOTS - 1)];
+    const size_t seq = atomic_load_explicit(&slot->seq, memory_order_acquire);
+    const intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+    if (diff == 0) {
+      if (atomic_compare_exchange_weak_explicit(&g_async.tail, &pos, pos + 1,
+                                                memory_order_relaxed,
+                                                memory_order_relaxed)) {
+        break;
+      }
+    } else if (diff < 0) {
+      // Full: the flusher has not released this slot from the previous lap.
+      // Waiting keeps every record and their order; only a sustained rate
+      // above what stderr absorbs ever gets here.
+      log_async_wake();
+      sched_yield();
+      pos = atomic_load_explicit(&g_async.tail, memory_order_relaxed);
+    } else {
+      pos = atomic_load_explicit(&g_async.tail, memory_order_relaxed);
+    }
+  }
+
+  gettimeofday(&slot->tv, nullptr);
+  slot->file = file;
+  slot->line = line;
+  slot->level = level;
+  const int n = vsnprintf(slot->payload, sizeof(slot->payload), fmt, args);
+  if (n < 0) {
+    slot->len = 0;
+  } else if ((size_t)n >= sizeof(slot->payload)) {
+    memcpy(slot->payload + sizeof(slot->payload) - 4, "...", 3);
+    slot->len = sizeof(slot->payload) - 1;
+  } else {
+    slot->len = (size_t)n;
+  }
+  atomic_store(&slot->seq, pos + 1);
+  log_async_wake();
+  if (level == LOG_LEVEL_ERROR) {
+    // Errors are what someone reads after a crash: return only once this
+    // record, and everything queued before it, is on stderr. Stopping waits
+    // for this writer, so the flusher is still running.
+    while (atomic_load(&g_async.written) <= pos) {
+      log_async_wake();
+      sched_yield();
+    }
+  }
+  atomic_fetch_sub(&g_async.writers, 1);
+  return true;
+}
+#endif
+
+bool app_log_async_start(void) {
+#if LOG_ASYNC
+  pthread_mutex_lock(&g_async.control);
+  bool ok = atomic_load(&g_async.running);
+  if (!ok) {
+    log_record_t *ring = calloc(LOG_RING_SLOTS, sizeof(*ring));
+    if (ring != nullptr) {
+      for (size_t i = 0; i < LOG_RING_SLOTS; i++) {
+        atomic_init(&ring[i].seq, i);
+      }
+      g_async.ring = ring;
+      g_async.head = 0;
+      atomic_store(&g_async.tail, 0);
+      atomic_store(&g_async.written, 0);
+      atomic_store(&g_async.stopping, false);
+      if (pthread_create(&g_async.thread, nullptr, log_async_thread, nullptr) ==
+          0) {
+        atomic_store(&g_async.running, true);
+        ok = true;
+        if (!g_async.atexit_registered) {
+          g_async.atexit_registered = atexit(app_log_async_stop) == 0;
+        }
+      } else {
+        g_async.ring = nullptr;
+        free(ring);
+      }
+    }
+  }
+  pthread_mutex_unlock(&g_async.control);
+  return ok;
+#else
+  return false;
+#endif
+}
+
+void app_log_async_stop(void) {
+#if LOG_ASYNC
+  pthread_mutex_lock(&g_async.control);
+  if (atomic_load(&g_async.running)) {
+    // Close the door, then wait out producers that got past it; after that
+    // every claimed slot is published and the flusher can drain to empty.
+    atomic_store(&g_async.running, false);
+    while (atomic_load(&g_async.writers) > 0) {
+      sched_yield();
+    }
+    pthread_mutex_lock(&g_async.lock);
+    atomic_store(&g_async.stopping, true);
+    pthread_cond_signal(&g_async.wake);
+    pthread_mutex_unlock(&g_async.lock);
+    pthread_join(g_async.thread, nullptr);
+    free(g_async.ring);
+    g_async.ring = nullptr;
+  }
+  pthread_mutex_unlock(&g_async.control);
+#endif
+}
+
+bool app_log_async_active(void) {
+#if LOG_ASYNC
+  return atomic_load(&g_async.running);
+#else
+  return false;
+#endif
+}
+
+static void log_yield(void) {
+#ifdef _WIN32
+  SwitchToThread();
+#else
+  sched_yield();
+#endif
+}
+
+static void log_spin_lock(atomic_flag *flag) {
+  while (atomic_flag_test_and_set_explicit(flag, memory_order_acquire)) {
+    log_yield();
+  }
+}
+
+static void log_spin_unlock(atomic_flag *flag) {
+  atomic_flag_clear_explicit(flag, memory_order_release);
+}
+
+static void log_binary_close_locked(void) {
+  if (!atomic_load(&g_binary.active)) {
+    return;
+  }
+  // Same door as the async ring: stop new writers, wait out the ones inside,
+  // then nothing can touch the FILE while it closes.
+  atomic_store(&g_binary.active, false);
+  while (atomic_load(&g_binary.writers) > 0) {
+    log_yield();
+  }
+  log_spin_lock(&g_binary.lock);
+  fclose(g_binary.file);
+  g_binary.file = nullptr;
+  log_spin_unlock(&g_binary.lock);
+}
+
+bool app_log_binary_open(const char *path) {
+  if (path == nullptr || path[0] == '\0') {
+    errno = EINVAL;
+    return false;
+  }
+  log_spin_lock(&g_binary.control);
+  log_binary_close_locked();
+  FILE *file = fopen(path, "ab");
+  const bool ok = file != nullptr;
+  if (ok) {
+    setvbuf(file, nullptr, _IOFBF, LOG_BINARY_BUFFER);
+    uint8_t header[APP_LOG_BINARY_HEADER_SIZE];
+    fwrite(header, 1, app_log_binary_encode_header(header), file);
+    g_binary.file = file;
+    g_binary.next_id = 0;
+    atomic_fetch_add(&g_binary.generation, 1);
+    atomic_store(&g_binary.active, true);
+    if (!g_binary.atexit_registered) {
+      g_binary.atexit_registered = atexit(app_log_binary_close) == 0;
+    }
+  }
+  log_spin_unlock(&g_binary.control);
+  return ok;
+}
+
+void app_log_binary_close(void) {
+  log_spin_lock(&g_binary.control);
+  log_binary_close_locked();
+  log_spin_unlock(&g_binary.control);
+}
+
+bool app_log_binary_wants(app_log_level level) {
+  if (!g_log_initialized) {
+    app_log_init();
+  }
+  return atomic_load_explicit(&g_binary.active, memory_order_relaxed) &&
+         level <= g_log_level;
+}
+
+// Gives a call site its id in the current file, writing the site entry
+// (location and format string) ahead of the site's first record.
+static uint64_t log_binary_register(app_log_site_t *site,
+                                    uint32_t generation) {
+  log_spin_lock(&g_binary.lock);
+  uint64_t key = atomic_load_explicit(&site->key, memory_order_relaxed);
+  if ((uint32_t)(key >> 32) != generation) {
+    const uint32_t id = ++g_binary.next_id;
+    atomic_store_explicit(&site->strings,
+                          app_log_binary_string_args(site->fmt),
+                          memory_order_relaxed);
+    uint8_t buf[APP_LOG_BINARY_ENTRY_MAX];
+    fwrite(buf, 1, app_log_binary_encode_site(buf, id, site), g_binary.file);
+    key = ((uint64_t)generation << 32) | id;
+    atomic_store_explicit(&site->key, key, memory_order_release);
+  }
+  log_spin_unlock(&g_binary.lock);
+  return key;
+}
+
+void app_log_deferred(app_log_site_t *site, const app_log_arg_t *args) {
+  if (site == nullptr || args == nullptr) {
+    return;
+  }
+  atomic_fetch_add(&g_binary.writers, 1);
+  if (atomic_load(&g_binary.active)) {
+    const uint32_t generation =
+        atomic_load_explicit(&g_binary.generation, memory_order_relaxed);
+    uint64_t key = atomic_load_explicit(&site->key, memory_order_acquire);
+    if ((uint32_t)(key >> 32) != generation) {
+      key = log_binary_register(site, generation);
+    }
+    struct timespec now;
+    timespec_get(&now, TIME_UTC);
+    const uint64_t micros =
+        (uint64_t)now.tv_sec * 1000000u + (uint64_t)now.tv_nsec / 1000u;
+    const uint32_t strings =
+        atomic_load_explicit(&site->strings, memory_order_relaxed);
+    uint8_t buf[APP_LOG_BINARY_ENTRY_MAX];
+    const size_t size = app_log_binary_encode_record(buf, (uint32_t)key,
+                                                     micros, args, strings);
+    // One fwrite per record: stdio's stream lock keeps records whole.
+    fwrite(buf, 1, size, g_binary.file);
+    if (site->level == LOG_LEVEL_ERROR) {
+      // Errors are what someone reads after a crash; do not leave them in
+      // the buffer.
+      fflush(g_binary.file);
+    }
+  }
+  atomic_fetch_sub(&g_binary.writers, 1);
+}
+
 void app_log_with_location(app_log_level level, const char *file, int line,
                            const char *fmt, ...) {
   // Lazy initialization allows logging to work immediately without requiring
@@ -101,6 +545,18 @@ void app_log_with_location(app_log_level level, const char *file, int line,
     return;
   }
 
+#if LOG_ASYNC
+  if (atomic_load_explicit(&g_async.running, memory_order_relaxed)) {
+    va_list args;
+    va_start(args, fmt);
+    const bool queued = log_async_enqueue(level, file, line, fmt, args);
+    va_end(args);
+    if (queued) {
+      return;
+    }
+  }
+#endif
+
   char time_buf[32];
   struct tm tm_info_buf;
   long milliseconds = 0;
@@ -124,7 +580,7 @@ void app_log_with_location(app_log_level level, const char *file, int line,
   strftime(time_buf, sizeof(time_buf), "%Y-%m-%d %H:%M:%S", &tm_info_buf);
 
   fprintf(stderr, "[%s.%03ld] [%s] %s:%d: ", time_buf, milliseconds,
-          log_level_to_string(level), file, line);
+          app_log_level_name(level), file, line);
 
   va_list args;
   va_start(args, fmt);
@@ -10,7 +10,10 @@
 #pragma once
 
 #include <stdarg.h>
+#include <stdatomic.h>
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 
 // Logging levels follow standard severity hierarchy.
 // Lower values = higher severity. This ordering ensures that setting a level
@@ -42,31 +45,206 @@ app_log_level app_log_get_level(void);
 // to ensure consistent logging behavior regardless of environment.
 void app_log_set_level(app_log_level level);
 
+// Asynchronous mode: callers format the message into a slot of a fixed
+// lock-free ring and return; a background thread adds the timestamp text and
+// writes whole batches to stderr. Keeps debug logging on hot paths (headless
+// requests, batch loops) from paying for stderr writes and time formatting.
+// Records longer than the slot payload are cut and end in "...". When the
+// ring is full the caller waits for the flusher to free a slot, so records
+// are never lost or reordered. An ERROR call returns only once its record
+// (and all before it) is on stderr, so a crash cannot swallow it. Setting
+// APP_LOG_ASYNC=1 starts this mode from app_log_init(). Returns false where
+// threads are unavailable (Windows) or the ring cannot be allocated; logging
+// then stays synchronous.
+bool app_log_async_start(void);
+
+// Drain the ring, stop the flusher, and return to synchronous logging.
+// Registered with atexit() by app_log_async_start(), so records logged before
+// a normal exit are not lost. Safe to call when async mode is off.
+void app_log_async_stop(void);
+
+// Whether records currently go through the ring.
+bool app_log_async_active(void);
+
+// Binary mode: LOG_* calls skip printf entirely. Each call copies its raw
+// argument values, tagged by type, into a record that names the call site;
+// the site's format string and location are written to the file once. The
+// file is fully buffered and flushed when the buffer fills, after ERROR
+// records, and at exit. `myapp log-decode FILE` renders it to the same text
+// lines stderr would have shown (see log_binary.h for the layout). Records go
+// only to the file while it is open, taking precedence over async mode.
+// Setting APP_LOG_BINARY=path opens it from app_log_init(). The file is
+// appended to, so several runs can share one. Returns false if it cannot be
+// opened (errno is set).
+bool app_log_binary_open(const char *path);
+
+// Flush and close the binary file and return to text logging. Registered with
+// atexit() by app_log_binary_open(). Safe to call when binary mode is off.
+void app_log_binary_close(void);
+
+// Level name as printed in log lines ("ERROR", "WARNING", ...).
+const char *app_log_level_name(app_log_level level);
+
 // Internal logging function captures source location for debugging.
 // Don't call directly - use LOG_* macros which automatically provide
 // file and line information, making log messages much more actionable.
 void app_log_with_location(app_log_level level, const char *file, int line,
                            const char *fmt, ...);
 
+// Argument captured for binary mode. Every integer type is widened to 64
+// bits with its original size kept, so unsigned conversions print what printf
+// would have; float and long double become double. Char pointers are copied
+// as strings when the record is encoded, but only where the format reads them
+// with %s; elsewhere, and for any other pointer, only the address is kept.
+typedef enum {
+  APP_LOG_ARG_END = 0,
+  APP_LOG_ARG_INT,
+  APP_LOG_ARG_UINT,
+  APP_LOG_ARG_DOUBLE,
+  APP_LOG_ARG_STRING,
+  APP_LOG_ARG_POINTER,
+} app_log_arg_type;
+
+typedef struct {
+  app_log_arg_type type;
+  uint8_t size; // sizeof the captured integer
+  union {
+    long long i;
+    unsigned long long u;
+    double d;
+    const char *s;
+    const void *p;
+  };
+} app_log_arg_t;
+
+// A LOG_* call site. Each expansion owns one static instance; `key` caches
+// the id the site was given in the current binary file (0 = not yet).
+typedef struct {
+  app_log_level level;
+  const char *file;
+  int line;
+  const char *fmt;
+  _Atomic uint32_t strings; // arguments read by %s, set with `key`
+  _Atomic uint64_t key;
+} app_log_site_t;
+
+static inline app_log_arg_t app_log_arg_int(long long value, size_t size) {
+  return (app_log_arg_t){
+      .type = APP_LOG_ARG_INT, .size = (uint8_t)size, .i = value};
+}
+static inline app_log_arg_t app_log_arg_uint(unsigned long long value,
+                                             size_t size) {
+  return (app_log_arg_t){
+      .type = APP_LOG_ARG_UINT, .size = (uint8_t)size, .u = value};
+}
+static inline app_log_arg_t app_log_arg_double(double value, size_t size) {
+  (void)size;
+  return (app_log_arg_t){.type = APP_LOG_ARG_DOUBLE, .d = value};
+}
+static inline app_log_arg_t app_log_arg_string(const char *value,
+                                               size_t size) {
+  (void)size;
+  return (app_log_arg_t){.type = APP_LOG_ARG_STRING, .s = value};
+}
+static inline app_log_arg_t app_log_arg_pointer(const void *value,
+                                                size_t size) {
+  (void)size;
+  return (app_log_arg_t){.type = APP_LOG_ARG_POINTER, .p = value};
+}
+
+// Type-generic capture of one argument. Enums match their underlying integer
+// type; arrays decay to pointers, so string literals and char buffers are
+// strings.
+#define APP_LOG_ARG(x)                          \
+  _Generic((x),                                 \
+      bool: app_log_arg_int,                    \
+      char: app_log_arg_int,                    \
+      signed char: app_log_arg_int,             \
+      short: app_log_arg_int,                   \
+      int: app_log_arg_int,                     \
+      long: app_log_arg_int,                    \
+      long long: app_log_arg_int,               \
+      unsigned char: app_log_arg_uint,          \
+      unsigned short: app_log_arg_uint,         \
+      unsigned int: app_log_arg_uint,           \
+      unsigned long: app_log_arg_uint,          \
+      unsigned long long: app_log_arg_uint,     \
+      float: app_log_arg_double,                \
+      double: app_log_arg_double,               \
+      long double: app_log_arg_double,          \
+      char *: app_log_arg_string,               \
+      const char *: app_log_arg_string,         \
+      default: app_log_arg_pointer)((x), sizeof(x))
+
+// Maps APP_LOG_ARG over up to APP_LOG_MAX_ARGS arguments.
+#define APP_LOG_MAX_ARGS 16
+#define APP_LOG_CAT(a, b) APP_LOG_CAT_(a, b)
+#define APP_LOG_CAT_(a, b) a##b
+#define APP_LOG_COUNT(...)                                                  \
+  APP_LOG_COUNT_(__VA_ARGS__, 16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, \
+                 3, 2, 1, )
+#define APP_LOG_COUNT_(_1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, \
+                       _13, _14, _15, _16, n, ...)                        \
+  n
+#define APP_LOG_ARGS(...) \
+  APP_LOG_CAT(APP_LOG_ARGS_, APP_LOG_COUNT(__VA_ARGS__))(__VA_ARGS__)
+#define APP_LOG_ARGS_1(a) APP_LOG_ARG(a)
+#define APP_LOG_ARGS_2(a, ...) APP_LOG_ARG(a), APP_LOG_ARGS_1(__VA_ARGS__)
+#define APP_LOG_ARGS_3(a, ...) APP_LOG_ARG(a), APP_LOG_ARGS_2(__VA_ARGS__)
+#define APP_LOG_ARGS_4(a, ...) APP_LOG_ARG(a), APP_LOG_ARGS_3(__VA_ARGS__)
+#define APP_LOG_ARGS_5(a, ...) APP_LOG_ARG(a), APP_LOG_ARGS_4(__VA_ARGS__)
+#define APP_LOG_ARGS_6(a, ...) APP_LOG_ARG(a), APP_LOG_ARGS_5(__VA_ARGS__)
+#define APP_LOG_ARGS_7(a, ...) APP_LOG_ARG(a), APP_LOG_ARGS_6(__VA_ARGS__)
+#define APP_LOG_ARGS_8(a, ...) APP_LOG_ARG(a), APP_LOG_ARGS_7(__VA_ARGS__)
+#define APP_LOG_ARGS_9(a, ...) APP_LOG_ARG(a), APP_LOG_ARGS_8(__VA_ARGS__)
+#define APP_LOG_ARGS_10(a, ...) APP_LOG_ARG(a), APP_LOG_ARGS_9(__VA_ARGS__)
+#define APP_LOG_ARGS_11(a, ...) APP_LOG_ARG(a), APP_LOG_ARGS_10(__VA_ARGS__)
+#define APP_LOG_ARGS_12(a, ...) APP_LOG_ARG(a), APP_LOG_ARGS_11(__VA_ARGS__)
+#define APP_LOG_ARGS_13(a, ...) APP_LOG_ARG(a), APP_LOG_ARGS_12(__VA_ARGS__)
+#define APP_LOG_ARGS_14(a, ...) APP_LOG_ARG(a), APP_LOG_ARGS_13(__VA_ARGS__)
+#define APP_LOG_ARGS_15(a, ...) APP_LOG_ARG(a), APP_LOG_ARGS_14(__VA_ARGS__)
+#define APP_LOG_ARGS_16(a, ...) APP_LOG_ARG(a), APP_LOG_ARGS_15(__VA_ARGS__)
+
+// Whether a record at `level` goes to the binary file.
+bool app_log_binary_wants(app_log_level level);
+
+// Binary-mode entry point used by the LOG_* macros. `args` ends with an
+// APP_LOG_ARG_END entry.
+void app_log_deferred(app_log_site_t *site, const app_log_arg_t *args);
+
+// Routes one LOG_* call: binary capture when the binary file is open,
+// printf-style text otherwise. Arguments are evaluated on one path only.
+#define APP_LOG_AT(level, fmt, ...)                                       \
+  do {                                                                    \
+    if (app_log_binary_wants(level)) {                                    \
+      static app_log_site_t app_log_site_ = {                             \
+          (level), __FILE__, __LINE__, (fmt), 0, 0};                      \
+      app_log_deferred(&app_log_site_,                                    \
+                       (const app_log_arg_t[]){                           \
+                           __VA_OPT__(APP_LOG_ARGS(__VA_ARGS__), ){       \
+                               .type = APP_LOG_ARG_END}});                \
+    } else {                                                              \
+      app_log_with_location((level), __FILE__, __LINE__,                  \
+                            fmt __VA_OPT__(, ) __VA_ARGS__);              \
+    }                                                                     \
+  } while (0)
+
 // Convenience macros automatically capture source location.
 // These macros make logging effortless while providing crucial debugging
 // context. C23's __VA_OPT__ handles both with and without arguments without
-// relying on the GNU ##__VA_ARGS__ extension.
-#define LOG_ERROR(fmt, ...)                                  \
-  app_log_with_location(LOG_LEVEL_ERROR, __FILE__, __LINE__, \
-                        fmt __VA_OPT__(, ) __VA_ARGS__)
-
-#define LOG_WARNING(fmt, ...)                                  \
-  app_log_with_location(LOG_LEVEL_WARNING, __FILE__, __LINE__, \
-                        fmt __VA_OPT__(, ) __VA_ARGS__)
-
-#define LOG_INFO(fmt, ...)                                  \
-  app_log_with_location(LOG_LEVEL_INFO, __FILE__, __LINE__, \
-                        fmt __VA_OPT__(, ) __VA_ARGS__)
-
-#define LOG_DEBUG(fmt, ...)                                  \
-  app_log_with_location(LOG_LEVEL_DEBUG, __FILE__, __LINE__, \
-                        fmt __VA_OPT__(, ) __VA_ARGS__)
+// relying on the GNU ##__VA_ARGS__ extension. Format strings must be literals:
+// binary mode keeps them in a static per call site.
+#define LOG_ERROR(fmt, ...) \
+  APP_LOG_AT(LOG_LEVEL_ERROR, fmt __VA_OPT__(, ) __VA_ARGS__)
+
+#define LOG_WARNING(fmt, ...) \
+  APP_LOG_AT(LOG_LEVEL_WARNING, fmt __VA_OPT__(, ) __VA_ARGS__)
+
+#define LOG_INFO(fmt, ...) \
+  APP_LOG_AT(LOG_LEVEL_INFO, fmt __VA_OPT__(, ) __VA_ARGS__)
+
+#define LOG_DEBUG(fmt, ...) \
+  APP_LOG_AT(LOG_LEVEL_DEBUG, fmt __VA_OPT__(, ) __VA_ARGS__)
 
 // Verification macro for debug-mode sanity checks.
 // Use for conditions that should always be true in correct code.
@@ -60,6 +60,12 @@ char *cc_binary_name(const char *path);
 char *cc_replace_all(const char *input, const char *needle,
                      const char *replacement);
 void cc_strip_carriage_returns(char *text);
+// Point XDG_CACHE_HOME at a fresh temporary directory for the rest of the run
+// so the binary's caches (help documents) never land in the real ~/.cache.
+// Returns the directory for cc_remove_cache_home(), or NULL when there is
+// nothing to redirect.
+char *cc_isolate_cache_home(void);
+void cc_remove_cache_home(char *dir);
 
 // Test cases (cases.c)
 extern const test_case_t cli_contract_cases[];
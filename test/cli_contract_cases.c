@@ -356,6 +356,53 @@ static bool test_terminal_command_requires_tty(test_context_t *ctx) {
   return ok;
 }
 
+static bool test_binary_log_round_trips_through_log_decode(
+    test_context_t *ctx) {
+  char *log_path = NULL;
+  if (!cc_write_temp_config("not a binary log", &log_path)) {
+    fprintf(stderr, "failed to write temporary log\n");
+    return false;
+  }
+
+  const char *junk_args[] = {"--plain", "log-decode", log_path};
+  command_result_t result =
+      cc_run_cli(ctx, junk_args, ARRAY_LEN(junk_args), NULL, 0);
+  bool ok = cc_expect_exit(&result, APP_ERROR_INVALID_DATA) &&
+            cc_expect_stderr_contains(&result, "Not a binary log");
+  cc_command_result_free(&result);
+
+  // A missing file is not found; a directory is not, whatever the platform
+  // reports for it.
+  (void)unlink(log_path);
+  result = cc_run_cli(ctx, junk_args, ARRAY_LEN(junk_args), NULL, 0);
+  ok = cc_expect_exit(&result, APP_ERROR_NOT_FOUND) &&
+       cc_expect_stderr_contains(&result, "Cannot open binary log") && ok;
+  cc_command_result_free(&result);
+  const char *dir_args[] = {"--plain", "log-decode", "."};
+  result = cc_run_cli(ctx, dir_args, ARRAY_LEN(dir_args), NULL, 0);
+  ok = cc_expect_not_exit(&result, APP_ERROR_NOT_FOUND) &&
+       cc_expect_not_exit(&result, 0) && ok;
+  cc_command_result_free(&result);
+
+  const char *log_args[] = {"--plain", "--debug", "hello"};
+  const env_var_t env[] = {{"APP_LOG_BINARY", log_path}};
+  result = cc_run_cli(ctx, log_args, ARRAY_LEN(log_args), env, ARRAY_LEN(env));
+  ok = cc_expect_exit(&result, 0) &&
+       cc_expect_stdout_contains(&result, "Hello, World!") && ok;
+  cc_command_result_free(&result);
+
+  const char *decode_args[] = {"--plain", "log-decode", log_path};
+  result = cc_run_cli(ctx, decode_args, ARRAY_LEN(decode_args), NULL, 0);
+  ok = cc_expect_exit(&result, 0) &&
+       cc_expect_stdout_contains(&result, "] [DEBUG] ") &&
+       cc_expect_stdout_contains(&result, "Command 'hello' completed") && ok;
+  cc_command_result_free(&result);
+
+  (void)unlink(log_path);
+  free(log_path);
+  return ok;
+}
+
 static bool test_opencli_contract_matches_checked_in_spec(test_context_t *ctx) {
   const char *args[] = {"opencli"};
   command_result_t result = cc_run_cli(ctx, args, ARRAY_LEN(args), NULL, 0);
@@ -446,6 +493,8 @@ const test_case_t cli_contract_cases[] = {
      test_headless_json_request_dispatches_command},
     {"headless json rejects empty stdin",
      test_headless_json_rejects_empty_stdin},
+    {"binary log round-trips through log-decode",
+     test_binary_log_round_trips_through_log_decode},
     {"opencli contract matches checked-in spec",
      test_opencli_contract_matches_checked_in_spec},
 };
@@ -30,6 +30,7 @@
 #define unlink _unlink
 #else
 #include <fcntl.h>
+#include <ftw.h>
 #include <sys/wait.h>
 #include <unistd.h>
 #endif
@@ -682,3 +683,40 @@ bool cc_file_exists(const char *path) {
   fclose(stream);
   return true;
 }
+
+#ifndef _WIN32
+static int remove_tree_entry(const char *path, const struct stat *st, int flag,
+                             struct FTW *ftw) {
+  (void)st;
+  (void)flag;
+  (void)ftw;
+  (void)remove(path);
+  return 0;
+}
+#endif
+
+char *cc_isolate_cache_home(void) {
+#ifdef _WIN32
+  // The help cache only exists on Linux; nothing to redirect.
+  return NULL;
+#else
+  char *dir = temp_template("cache");
+  if (dir && mkdtemp(dir) != NULL && setenv("XDG_CACHE_HOME", dir, 1) == 0) {
+    return dir;
+  }
+  free(dir);
+  // Better no cache at all than writing into the developer's ~/.cache.
+  (void)setenv("APP_CLI_HELP_CACHE", "0", 1);
+  return NULL;
+#endif
+}
+
+void cc_remove_cache_home(char *dir) {
+  if (!dir) {
+    return;
+  }
+#ifndef _WIN32
+  (void)nftw(dir, remove_tree_entry, 16, FTW_DEPTH | FTW_PHYS);
+#endif
+  free(dir);
+}
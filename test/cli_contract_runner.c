@@ -39,12 +39,14 @@ int main(int argc, char **argv) {
   }
 
   test_context_t ctx = {.binary = binary, .passed = 0, .failed = 0};
+  char *cache_home = cc_isolate_cache_home();
 
   printf("TAP version 13\n");
   for (size_t i = 0; i < cli_contract_cases_count; i++) {
     run_test(&ctx, &cli_contract_cases[i]);
   }
   printf("1..%zu\n", cli_contract_cases_count);
+  cc_remove_cache_home(cache_home);
   fprintf(stderr, "%d passed, %d failed\n", ctx.passed, ctx.failed);
   return ctx.failed == 0 ? 0 : 1;
 }
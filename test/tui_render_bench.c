@@ -0,0 +1,446 @@
+/*
+ * tui_render_bench.c - headless render benchmark for tui_show_menu() and
+ * tui_progress_update().
+ *
+ * The real TUI runs in-process on the slave side of a PTY: stdin and stdout
+ * are moved onto it before tui_init(), exactly where a terminal would host
+ * the app. A driver thread plays scripted keystrokes into the master and
+ * reads back everything ncurses writes. Frame timings come from the TUI
+ * frame observer, so each frame is reported with its layout, render and
+ * doupdate() time plus the terminal bytes it produced. No terminal emulator
+ * is involved: bytes are counted, not interpreted.
+ *
+ *   zig build bench-tui -- [--items 10,1000,100000] [--size 120x40] [--frames]
+ *
+ * Results go to the original stdout as one JSON document.
+ */
+#include <errno.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <termios.h>
+#include <unistd.h>
+
+#if defined(__APPLE__) || defined(__FreeBSD__) || defined(__OpenBSD__) || \
+    defined(__NetBSD__)
+#include <util.h>
+#else
+#include <pty.h>
+#endif
+
+#include "terminal_vt_support.h"
+#include "tui/tui.h"
+#include "tui/tui_internal.h"
+
+#define BENCH_MAX_SIZES 16
+#define BENCH_FRAME_TIMEOUT_MS 250 /* a key that repaints nothing */
+#define BENCH_PROGRESS_STEPS 200
+
+typedef struct {
+  uint64_t layout_us;
+  uint64_t render_us;
+  uint64_t update_us;
+  size_t bytes;
+} bench_frame_t;
+
+typedef struct {
+  int master_fd;
+  int notify[2]; /* observer -> driver: each frame's index (size_t) */
+  /* Appended by the frame observer on the UI thread; capacity is fixed up
+   * front so the driver can fill in `bytes` without locking. The driver
+   * only writes the entry whose index the observer sent. */
+  bench_frame_t *frames;
+  size_t frame_count;
+  size_t frame_capacity;
+  uint64_t started_us;
+  uint64_t first_frame_us;
+  /* Driver script: terminal byte sequences, the last one ends the run. */
+  const char *script[32];
+  size_t script_len;
+  size_t keys_without_frame;
+} bench_session_t;
+
+static void bench_on_frame(const tui_frame_stats_t *stats, void *user) {
+  bench_session_t *session = user;
+  if (session->frame_count == 0) {
+    session->first_frame_us = tui_clock_us();
+  }
+  /* SIZE_MAX once the log is full: the frame is counted nowhere. */
+  size_t index = SIZE_MAX;
+  if (session->frame_count < session->frame_capacity) {
+    index = session->frame_count++;
+    session->frames[index] = (bench_frame_t){
+        .layout_us = stats->layout_us,
+        .render_us = stats->render_us,
+        .update_us = stats->update_us,
+    };
+  }
+  (void)!write(session->notify[1], &index, sizeof(index));
+}
+
+/* Read whatever the master has buffered; returns the byte count. */
+static size_t bench_drain(int fd) {
+  size_t total = 0;
+  char chunk[8192];
+  for (;;) {
+    const ssize_t n = read(fd, chunk, sizeof(chunk));
+    if (n > 0) {
+      total += (size_t)n;
+    } else if (n < 0 && errno == EINTR) {
+      continue;
+    } else {
+      return total;
+    }
+  }
+}
+
+/* Wait for the next frame, counting terminal output meanwhile, and return
+ * the observer's index for it in `frame`. Every byte of a frame is in the
+ * PTY before its notification is sent, so a final drain after it attributes
+ * exactly that frame's output. */
+static bool bench_wait_frame(bench_session_t *session, size_t *bytes,
+                             size_t *frame) {
+  const int64_t deadline = monotonic_ms() + BENCH_FRAME_TIMEOUT_MS;
+  for (;;) {
+    const int64_t left = deadline - monotonic_ms();
+    if (left <= 0) {
+      return false;
+    }
+    struct pollfd fds[2] = {
+        {.fd = session->master_fd, .events = POLLIN},
+        {.fd = session->notify[0], .events = POLLIN},
+    };
+    if (poll(fds, 2, (int)left) < 0 && errno != EINTR) {
+      return false;
+    }
+    if (fds[0].revents & POLLIN) {
+      *bytes += bench_drain(session->master_fd);
+    }
+    if (fds[1].revents & POLLIN) {
+      /* Writes of sizeof(size_t) bytes to a pipe are atomic. */
+      if (read(session->notify[0], frame, sizeof(*frame)) ==
+          (ssize_t)sizeof(*frame)) {
+        *bytes += bench_drain(session->master_fd);
+        return true;
+      }
+    }
+  }
+}
+
+/* Credit `bytes` to the frame the observer logged, if it logged it. */
+static void bench_record_bytes(bench_session_t *session, size_t frame,
+                               size_t bytes) {
+  if (frame < session->frame_capacity) {
+    session->frames[frame].bytes += bytes;
+  }
+}
+
+static void *bench_driver(void *arg) {
+  bench_session_t *session = arg;
+  size_t bytes = 0;
+  size_t frame = SIZE_MAX;
+  if (bench_wait_frame(session, &bytes, &frame)) {
+    bench_record_bytes(session, frame, bytes); /* opening frame */
+  }
+  for (size_t k = 0; k < session->script_len; k++) {
+    const char *keys = session->script[k];
+    if (!write_nonblocking_all(session->master_fd, keys, strlen(keys),
+                               1000)) {
+      break;
+    }
+    if (k + 1 == session->script_len) {
+      break; /* the final key closes the menu */
+    }
+    bytes = 0;
+    if (bench_wait_frame(session, &bytes, &frame)) {
+      bench_record_bytes(session, frame, bytes);
+    } else {
+      session->keys_without_frame++;
+    }
+  }
+  return NULL;
+}
+
+static int bench_cmp_u64(const void *a, const void *b) {
+  const uint64_t x = *(const uint64_t *)a;
+  const uint64_t y = *(const uint64_t *)b;
+  return (x > y) - (x < y);
+}
+
+/* {"p50":..,"p95":..,"max":..,"total":..} over one column of the frames. */
+static void bench_print_summary(FILE *out, const char *name,
+                                const bench_frame_t *frames, size_t count,
+                                size_t column) {
+  uint64_t values[count > 0 ? count : 1];
+  uint64_t total = 0;
+  for (size_t i = 0; i < count; i++) {
+    const bench_frame_t *f = &frames[i];
+    const uint64_t v = column == 0   ? f->layout_us
+                       : column == 1 ? f->render_us
+                       : column == 2 ? f->update_us
+                                     : (uint64_t)f->bytes;
+    values[i] = v;
+    total += v;
+  }
+  qsort(values, count, sizeof(values[0]), bench_cmp_u64);
+  const uint64_t p50 = count ? values[(count - 1) * 50 / 100] : 0;
+  const uint64_t p95 = count ? values[(count - 1) * 95 / 100] : 0;
+  const uint64_t max = count ? values[count - 1] : 0;
+  fprintf(out,
+          "\"%s\":{\"p50\":%llu,\"p95\":%llu,\"max\":%llu,\"total\":%llu}",
+          name, (unsigned long long)p50, (unsigned long long)p95,
+          (unsigned long long)max, (unsigned long long)total);
+}
+
+static void bench_print_frames(FILE *out, const bench_session_t *session,
+                               bool frame_log) {
+  const bench_frame_t *frames = session->frames;
+  const size_t count = session->frame_count;
+  fprintf(out, "\"frames\":%zu,", count);
+  bench_print_summary(out, "layout_us", frames, count, 0);
+  fputc(',', out);
+  bench_print_summary(out, "render_us", frames, count, 1);
+  fputc(',', out);
+  bench_print_summary(out, "update_us", frames, count, 2);
+  fputc(',', out);
+  bench_print_summary(out, "bytes", frames, count, 3);
+  if (frame_log) {
+    fputs(",\"frame_log\":[", out);
+    for (size_t i = 0; i < count; i++) {
+      fprintf(out, "%s[%llu,%llu,%llu,%zu]", i ? "," : "",
+              (unsigned long long)frames[i].layout_us,
+              (unsigned long long)frames[i].render_us,
+              (unsigned long long)frames[i].update_us, frames[i].bytes);
+    }
+    fputc(']', out);
+  }
+}
+
+static bool bench_reset(bench_session_t *session, size_t capacity) {
+  free(session->frames);
+  session->frames = calloc(capacity, sizeof(*session->frames));
+  session->frame_count = 0;
+  session->frame_capacity = session->frames ? capacity : 0;
+  session->keys_without_frame = 0;
+  session->first_frame_us = 0;
+  return session->frames != NULL;
+}
+
+/* A terminfo key string, falling back to the xterm sequence. */
+static const char *bench_key(const char *capname, const char *fallback) {
+  const char *seq = tigetstr((char *)capname);
+  return seq && seq != (char *)-1 ? seq : fallback;
+}
+
+static void bench_build_script(bench_session_t *session) {
+  const char *down = bench_key("kcud1", "\033OB");
+  size_t n = 0;
+  for (int i = 0; i < 8; i++) {
+    session->script[n++] = down; /* moves inside the viewport */
+  }
+  session->script[n++] = bench_key("kend", "\033OF");   /* jump + scroll */
+  session->script[n++] = bench_key("khome", "\033OH");  /* and back */
+  session->script[n++] = bench_key("knp", "\033[6~");   /* page down */
+  session->script[n++] = bench_key("kpp", "\033[5~");   /* page up */
+  session->script[n++] = "/";                          /* open search */
+  static const char *const query[] = {"i", "t", "e", "m", " ", "1"};
+  for (size_t i = 0; i < sizeof(query) / sizeof(query[0]); i++) {
+    session->script[n++] = query[i]; /* each key narrows the matches */
+  }
+  for (int i = 0; i < 3; i++) {
+    session->script[n++] = "\177"; /* backspace widens them again */
+  }
+  session->script[n++] = "\r"; /* confirm: ends the run */
+  session->script_len = n;
+}
+
+static bool bench_menu(FILE *out, bench_session_t *session, int item_count,
+                       bool frame_log) {
+  tui_menu_item_t *items = calloc((size_t)item_count, sizeof(*items));
+  char *text = malloc((size_t)item_count * 64);
+  if (!items || !text || !bench_reset(session, session->script_len + 8)) {
+    free(items);
+    free(text);
+    return false;
+  }
+  for (int i = 0; i < item_count; i++) {
+    char *label = text + (size_t)i * 64;
+    snprintf(label, 24, "Item %d", i);
+    snprintf(label + 24, 40, "Bench entry %d of %d", i, item_count);
+    items[i] = (tui_menu_item_t){
+        .label = label, .description = label + 24, .id = i + 1};
+  }
+  const tui_menu_config_t cfg = {
+      .title = "Render bench",
+      .items = items,
+      .item_count = item_count,
+      .default_index = 0,
+      .frame_height = tui_get_max_y() - 2,
+      .frame_width = tui_get_max_x() - 4,
+      .max_fps = 1000000, /* no pacing: one frame per scripted key */
+      .enable_search = true,
+  };
+
+  pthread_t driver;
+  session->started_us = tui_clock_us();
+  if (pthread_create(&driver, NULL, bench_driver, session) != 0) {
+    free(items);
+    free(text);
+    return false;
+  }
+  const tui_menu_result_t result = tui_show_menu(NULL, &cfg);
+  pthread_join(driver, NULL);
+  (void)bench_drain(session->master_fd);
+
+  fprintf(out,
+          "{\"items\":%d,\"status\":%d,\"open_us\":%llu,\"keys\":%zu,"
+          "\"keys_without_frame\":%zu,",
+          item_count, (int)result.status,
+          (unsigned long long)(session->first_frame_us
+                                   ? session->first_frame_us -
+                                         session->started_us
+                                   : 0),
+          session->script_len, session->keys_without_frame);
+  bench_print_frames(out, session, frame_log);
+  fputc('}', out);
+  free(items);
+  free(text);
+  return result.status == TUI_MENU_OK;
+}
+
+static bool bench_progress(FILE *out, bench_session_t *session,
+                           bool frame_log) {
+  if (!bench_reset(session, BENCH_PROGRESS_STEPS + 8)) {
+    return false;
+  }
+  tui_progress_t *progress =
+      tui_progress_create("Render bench", BENCH_PROGRESS_STEPS);
+  if (!progress) {
+    return false;
+  }
+  size_t done = session->frame_count;
+  for (int i = 1; i <= BENCH_PROGRESS_STEPS; i++) {
+    char status[48];
+    snprintf(status, sizeof(status), "Step %d of %d", i,
+             BENCH_PROGRESS_STEPS);
+    tui_progress_update(progress, i, status);
+    /* Updates draw synchronously: their output is already in the PTY. */
+    const size_t bytes = bench_drain(session->master_fd);
+    (void)bench_drain(session->notify[0]);
+    if (session->frame_count > done) {
+      session->frames[session->frame_count - 1].bytes += bytes;
+      done = session->frame_count;
+    }
+  }
+  tui_progress_destroy(progress);
+  (void)bench_drain(session->master_fd);
+  (void)bench_drain(session->notify[0]);
+
+  fprintf(out, "{\"updates\":%d,", BENCH_PROGRESS_STEPS);
+  bench_print_frames(out, session, frame_log);
+  fputc('}', out);
+  return true;
+}
+
+static int bench_parse_sizes(const char *arg, int *sizes) {
+  int n = 0;
+  for (const char *p = arg; *p && n < BENCH_MAX_SIZES;) {
+    char *end = NULL;
+    const long v = strtol(p, &end, 10);
+    if (end == p || v <= 0 || v > 10000000) {
+      return -1;
+    }
+    sizes[n++] = (int)v;
+    p = *end == ',' ? end + 1 : end;
+    if (*end != ',' && *end != '\0') {
+      return -1;
+    }
+  }
+  return n;
+}
+
+int main(int argc, char **argv) {
+  int sizes[BENCH_MAX_SIZES] = {10, 100, 1000, 10000, 100000};
+  int size_count = 5;
+  unsigned cols = 120;
+  unsigned rows = 40;
+  bool frame_log = false;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--items") == 0 && i + 1 < argc) {
+      size_count = bench_parse_sizes(argv[++i], sizes);
+    } else if (strcmp(argv[i], "--size") == 0 && i + 1 < argc) {
+      if (sscanf(argv[++i], "%ux%u", &cols, &rows) != 2 || cols < 48 ||
+          rows < 12 || cols > 1000 || rows > 1000) {
+        size_count = -1;
+      }
+    } else if (strcmp(argv[i], "--frames") == 0) {
+      frame_log = true;
+    } else {
+      size_count = -1;
+    }
+    if (size_count <= 0) {
+      fprintf(stderr,
+              "usage: %s [--items N[,N...]] [--size COLSxROWS] [--frames]\n",
+              argv[0]);
+      return 2;
+    }
+  }
+
+  /* JSON goes to the caller's stdout; the TUI gets the PTY. */
+  const int json_fd = dup(STDOUT_FILENO);
+  FILE *out = json_fd >= 0 ? fdopen(json_fd, "w") : NULL;
+  bench_session_t session = {.master_fd = -1, .notify = {-1, -1}};
+  int slave_fd = -1;
+  struct winsize ws = {.ws_row = (unsigned short)rows,
+                       .ws_col = (unsigned short)cols};
+  if (!out || openpty(&session.master_fd, &slave_fd, NULL, NULL, &ws) != 0 ||
+      pipe(session.notify) != 0) {
+    perror("tui-render-bench: setup");
+    return 1;
+  }
+  if (dup2(slave_fd, STDIN_FILENO) < 0 || dup2(slave_fd, STDOUT_FILENO) < 0) {
+    perror("tui-render-bench: dup2");
+    return 1;
+  }
+  close(slave_fd);
+  if (!set_nonblocking(session.master_fd) ||
+      !set_nonblocking(session.notify[0])) {
+    perror("tui-render-bench: fcntl");
+    return 1;
+  }
+  setenv("TERM", "xterm-256color", 0);
+
+  if (tui_init() != APP_SUCCESS) {
+    fputs("tui-render-bench: tui_init failed\n", stderr);
+    return 1;
+  }
+  (void)bench_drain(session.master_fd);
+  bench_build_script(&session);
+  tui_set_frame_observer(bench_on_frame, &session);
+
+  bool ok = true;
+  fprintf(out,
+          "{\"benchmark\":\"tui-render\",\"term\":\"%s\",\"cols\":%u,"
+          "\"rows\":%u,\"menus\":[",
+          getenv("TERM"), cols, rows);
+  for (int i = 0; i < size_count; i++) {
+    if (i > 0) {
+      fputc(',', out);
+    }
+    ok = bench_menu(out, &session, sizes[i], frame_log) && ok;
+  }
+  fputs("],\"progress\":", out);
+  ok = bench_progress(out, &session, frame_log) && ok;
+  fputs("}\n", out);
+
+  tui_set_frame_observer(NULL, NULL);
+  tui_cleanup();
+  (void)bench_drain(session.master_fd);
+  fclose(out);
+  free(session.frames);
+  return ok ? 0 : 1;
+}
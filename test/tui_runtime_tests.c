@@ -0,0 +1,503 @@
+/*
+ * tui_runtime_tests.c - in-process tests for the parts of the TUI that need
+ * a real terminal: tui_wait_event(), tui_wake() and hangup handling, the
+ * progress bar (its formatters and worker-side accounting), the frame
+ * statistics overlay and the shared paced loop, tui_run_frame_loop().
+ *
+ * Like tui_render_bench.c, the TUI runs on the slave side of a PTY moved onto
+ * stdin and stdout, and the test plays the terminal through the master. TAP
+ * output is collected while the PTY owns stdout and printed once the
+ * original stdout is back. POSIX only (openpty).
+ */
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+#if defined(__APPLE__) || defined(__FreeBSD__) || defined(__OpenBSD__) || \
+    defined(__NetBSD__)
+#include <util.h>
+#else
+#include <pty.h>
+#endif
+
+#include "tui/tui.h"
+#include "tui/tui_internal.h"
+#include "tui/tui_progress_internal.h"
+#include "unit_support.h"
+
+#define RUNTIME_MAX_RESULTS 32
+/* Upper bound for a wait that should return at once; generous for CI. */
+#define RUNTIME_PROMPT_MS 2000
+
+typedef struct {
+  bool ok;
+  const char *name;
+} runtime_result_t;
+
+static runtime_result_t runtime_results[RUNTIME_MAX_RESULTS];
+static size_t runtime_result_count = 0;
+static int runtime_master_fd = -1;
+
+static void runtime_record(bool ok, const char *name) {
+  if (runtime_result_count < RUNTIME_MAX_RESULTS) {
+    runtime_results[runtime_result_count++] =
+        (runtime_result_t){.ok = ok, .name = name};
+  }
+}
+
+/* Discard what ncurses wrote so the PTY buffer never fills. */
+static void runtime_drain_master(void) {
+  char chunk[4096];
+  while (read(runtime_master_fd, chunk, sizeof(chunk)) > 0) {
+  }
+}
+
+static void *runtime_wake_later(void *arg) {
+  (void)arg;
+  const struct timespec delay = {.tv_sec = 0, .tv_nsec = 20 * 1000 * 1000};
+  nanosleep(&delay, NULL);
+  tui_wake();
+  return NULL;
+}
+
+/* A wait blocked in poll() wakes for another thread; wake-ups that arrive
+ * before the next wait coalesce into one event. */
+static bool test_wake_from_thread(void) {
+  pthread_t thread;
+  if (!tui_wake_supported() ||
+      pthread_create(&thread, NULL, runtime_wake_later, NULL) != 0) {
+    return false;
+  }
+  const tui_event_t blocked = tui_wait_event(stdscr, RUNTIME_PROMPT_MS);
+  pthread_join(thread, NULL);
+  tui_wake();
+  tui_wake();
+  const tui_event_t pending = tui_wait_event(stdscr, RUNTIME_PROMPT_MS);
+  const tui_event_t idle = tui_wait_event(stdscr, 30);
+  return blocked.kind == TUI_EVENT_WAKE && pending.kind == TUI_EVENT_WAKE &&
+         idle.kind == TUI_EVENT_TIMER;
+}
+
+static bool test_key_and_timer(void) {
+  const uint64_t start = tui_clock_ms();
+  const tui_event_t idle = tui_wait_event(stdscr, 40);
+  const uint64_t waited = tui_clock_ms() - start;
+  if (write(runtime_master_fd, "x", 1) != 1) {
+    return false;
+  }
+  const tui_event_t key = tui_wait_event(stdscr, RUNTIME_PROMPT_MS);
+  return idle.kind == TUI_EVENT_TIMER && waited >= 30 &&
+         key.kind == TUI_EVENT_KEY && key.key == 'x';
+}
+
+/* tui_wake() after tui_cleanup() must be harmless, and the stale wake-up
+ * must not leak into the next session. */
+static bool test_late_wake_after_cleanup(void) {
+  tui_cleanup();
+  runtime_drain_master();
+  tui_wake();
+  const bool still_supported = tui_wake_supported();
+  if (tui_init() != APP_SUCCESS) {
+    return false;
+  }
+  runtime_drain_master();
+  const tui_event_t event = tui_wait_event(stdscr, 30);
+  return still_supported && event.kind == TUI_EVENT_TIMER;
+}
+
+/* Closing the master hangs the terminal up. A blocking wait must return
+ * once instead of spinning; SIGALRM fails the run if it never does. */
+static bool test_hangup_ends_blocking_wait(void) {
+  close(runtime_master_fd);
+  runtime_master_fd = -1;
+  alarm(5);
+  const tui_event_t event = tui_wait_event(stdscr, -1);
+  alarm(0);
+  const bool interrupted = tui_interrupted();
+  return event.kind == TUI_EVENT_SIGNAL && interrupted &&
+         tui_take_interrupt_error() == APP_ERROR_IO && !tui_interrupted();
+}
+
+static bool format_count_is(double value, const char *want) {
+  char buf[16];
+  tui_progress_format_count(buf, sizeof(buf), value);
+  return strcmp(buf, want) == 0;
+}
+
+static bool test_progress_format_count(void) {
+  return format_count_is(0.0, "0") && format_count_is(950.0, "950") &&
+         format_count_is(9999.0, "9999") &&
+         format_count_is(12345.0, "12.3k") &&
+         format_count_is(4560000.0, "4.56M") &&
+         format_count_is(1.2e9, "1.20G");
+}
+
+static bool format_duration_is(double seconds, const char *want) {
+  char buf[TUI_PROGRESS_DURATION_MAX];
+  tui_progress_format_duration(buf, sizeof(buf), seconds);
+  return strcmp(buf, want) == 0;
+}
+
+static bool test_progress_format_duration(void) {
+  return format_duration_is(0.0, "0:00") &&
+         format_duration_is(-3.0, "0:00") &&
+         format_duration_is(59.4, "0:59") &&
+         format_duration_is(59.6, "1:00") &&
+         format_duration_is(3599.0, "59:59") &&
+         format_duration_is(3600.0, "1:00:00") &&
+         format_duration_is(86400.0, "24:00:00") &&
+         format_duration_is(1e12, "99:59:59");
+}
+
+static bool format_rate_is(double rate, int value, int max, const char *want) {
+  char buf[48];
+  tui_progress_format_rate(buf, sizeof(buf), rate, value, max);
+  return strcmp(buf, want) == 0;
+}
+
+static bool test_progress_format_rate(void) {
+  return format_rate_is(0.0, 0, 100, "") &&
+         format_rate_is(2500.0, 0, 10000, "2500/s  ETA 0:04") &&
+         format_rate_is(2500.0, 10000, 10000, "2500/s") &&
+         format_rate_is(2e6, 0, 1000000000, "2.00M/s  ETA 8:20") &&
+         format_rate_is(0.5, 0, 1000000, "0/s  ETA 99:59:59");
+}
+
+#define RUNTIME_PROGRESS_WORKERS 4
+#define RUNTIME_PROGRESS_ADDS 10000
+
+static void *runtime_progress_worker(void *arg) {
+  for (int i = 0; i < RUNTIME_PROGRESS_ADDS; i++) {
+    tui_progress_add(arg, 1);
+  }
+  return NULL;
+}
+
+/* add/set only move the value; a tick reports done at max or after
+ * finish(), whichever comes first. */
+static bool test_progress_accounting(void) {
+  const int max = RUNTIME_PROGRESS_WORKERS * RUNTIME_PROGRESS_ADDS;
+  tui_progress_t *progress = tui_progress_create("Accounting", max);
+  if (!progress) {
+    return false;
+  }
+  pthread_t threads[RUNTIME_PROGRESS_WORKERS];
+  int started = 0;
+  while (started < RUNTIME_PROGRESS_WORKERS &&
+         pthread_create(&threads[started], NULL, runtime_progress_worker,
+                        progress) == 0) {
+    started++;
+  }
+  for (int i = 0; i < started; i++) {
+    pthread_join(threads[i], NULL);
+  }
+  bool ok = started == RUNTIME_PROGRESS_WORKERS &&
+            tui_progress_value(progress) == max && tui_progress_tick(progress);
+
+  tui_progress_set(progress, 10);
+  tui_progress_add(progress, -4);
+  ok = ok && tui_progress_value(progress) == 6 && !tui_progress_tick(progress);
+  tui_progress_set(progress, max + 5);
+  ok = ok && tui_progress_value(progress) == max + 5 &&
+       tui_progress_tick(progress);
+
+  tui_progress_set(progress, 0);
+  ok = ok && !tui_progress_tick(progress);
+  tui_progress_finish(progress);
+  ok = ok && tui_progress_value(progress) == 0 && tui_progress_tick(progress);
+  /* finish() wakes the UI thread. */
+  ok = ok && tui_wait_event(stdscr, RUNTIME_PROMPT_MS).kind == TUI_EVENT_WAKE;
+  tui_progress_destroy(progress);
+  runtime_drain_master();
+  return ok;
+}
+
+/* The count on the histogram line for `bucket`, or -1. */
+static long histogram_count(const char *text, const char *bucket) {
+  const size_t len = strlen(bucket);
+  for (const char *line = text; line && *line;) {
+    const char *end = strchr(line, '\n');
+    if (strncmp(line, bucket, len) == 0 && line[len] == ' ') {
+      const char *last = end ? end : line + strlen(line);
+      while (last > line && last[-1] != ' ') {
+        last--;
+      }
+      return strtol(last, NULL, 10);
+    }
+    line = end ? end + 1 : NULL;
+  }
+  return -1;
+}
+
+static void record_debug_frames(size_t count, uint64_t phase_us,
+                                uint64_t bytes) {
+  const tui_frame_stats_t stats = {.layout_us = phase_us,
+                                   .render_us = phase_us,
+                                   .update_us = phase_us,
+                                   .output_bytes = bytes};
+  for (size_t i = 0; i < count; i++) {
+    tui_debug_record_frame(&stats);
+  }
+}
+
+static bool test_debug_histogram(void) {
+  static const char *const buckets[] = {"<0.5", "<1",  "<2",  "<4",
+                                        "<8",   "<17", ">=17"};
+  char text[1024];
+  tui_debug_set_enabled(true);
+  tui_debug_format_histogram(text, sizeof(text));
+  bool ok = strstr(text, "No frames recorded yet") != NULL;
+
+  /* One 3 ms frame without a byte count. */
+  record_debug_frames(1, 1000, TUI_FRAME_OUTPUT_UNKNOWN);
+  tui_debug_format_histogram(text, sizeof(text));
+  for (size_t b = 0; b < sizeof(buckets) / sizeof(buckets[0]); b++) {
+    ok = ok && histogram_count(text, buckets[b]) == (b == 3 ? 1 : 0);
+  }
+  ok = ok && strstr(text, "Last 1 frames") && strstr(text, "    n/a");
+
+  /* Past the ring's capacity: only the newest 256 frames count, and 20 ms
+   * frames land in the open-ended bucket. */
+  record_debug_frames(300, 20000 / 3, 100);
+  tui_debug_format_histogram(text, sizeof(text));
+  for (size_t b = 0; b < sizeof(buckets) / sizeof(buckets[0]); b++) {
+    ok = ok && histogram_count(text, buckets[b]) == (b == 6 ? 256 : 0);
+  }
+  ok = ok && strstr(text, "Last 256 frames") &&
+       strstr(text, "output      100    100    100 B");
+
+  /* A short buffer is cut and still terminated. */
+  char small[16];
+  ok = ok && tui_debug_format_histogram(small, sizeof(small)) == 15 &&
+       strlen(small) == 15;
+  tui_debug_set_enabled(false);
+  return ok;
+}
+
+static atomic_bool runtime_noise_stop;
+
+/* Writes from another thread that a process-wide counter would charge to
+ * the frame. */
+static void *runtime_write_noise(void *arg) {
+  const int fd = *(const int *)arg;
+  static const char chunk[4096];
+  while (!atomic_load(&runtime_noise_stop)) {
+    (void)!write(fd, chunk, sizeof(chunk));
+  }
+  return NULL;
+}
+
+static void runtime_keep_stats(const tui_frame_stats_t *stats, void *user) {
+  *(tui_frame_stats_t *)user = *stats;
+}
+
+/* The overlay's byte count is exactly what reached the terminal. */
+static bool test_debug_counts_terminal_bytes(void) {
+#if defined(__linux__)
+  int null_fd = open("/dev/null", O_WRONLY);
+  pthread_t noise;
+  atomic_store(&runtime_noise_stop, false);
+  if (null_fd < 0 ||
+      pthread_create(&noise, NULL, runtime_write_noise, &null_fd) != 0) {
+    if (null_fd >= 0) {
+      close(null_fd);
+    }
+    return false;
+  }
+  tui_frame_stats_t stats = {0};
+  tui_debug_set_enabled(true);
+  tui_set_frame_observer(runtime_keep_stats, &stats);
+  runtime_drain_master();
+  bool ok = true;
+  for (int round = 0; round < 3 && ok; round++) {
+    tui_frame_t frame = tui_frame_begin();
+    tui_frame_layout_done(&frame);
+    for (int y = 0; y < LINES; y++) {
+      mvwhline(stdscr, y, 0, round % 2 ? 'x' : 'o', COLS);
+    }
+    wnoutrefresh(stdscr);
+    tui_frame_flush(&frame);
+    size_t written = 0;
+    char chunk[4096];
+    ssize_t n;
+    while ((n = read(runtime_master_fd, chunk, sizeof(chunk))) > 0) {
+      written += (size_t)n;
+    }
+    ok = stats.output_bytes == written && written > 0;
+  }
+  tui_set_frame_observer(NULL, NULL);
+  tui_debug_set_enabled(false);
+  atomic_store(&runtime_noise_stop, true);
+  pthread_join(noise, NULL);
+  close(null_fd);
+  return ok;
+#else
+  return true;
+#endif
+}
+
+/* F12 shows the HUD without an event and hiding it asks for a repaint. */
+static bool test_debug_hud_hide_repaints(void) {
+  const char *f12 = tigetstr("kf12");
+  if (!f12 || f12 == (char *)-1) {
+    f12 = "\033[24~";
+  }
+  const size_t len = strlen(f12);
+  tui_debug_set_enabled(true);
+  bool ok = write(runtime_master_fd, f12, len) == (ssize_t)len;
+  const tui_event_t shown = tui_wait_event(stdscr, 100);
+  ok = ok && write(runtime_master_fd, f12, len) == (ssize_t)len;
+  const tui_event_t hidden = tui_wait_event(stdscr, RUNTIME_PROMPT_MS);
+  tui_debug_set_enabled(false);
+  runtime_drain_master();
+  return ok && shown.kind == TUI_EVENT_TIMER &&
+         hidden.kind == TUI_EVENT_REPAINT;
+}
+
+typedef struct {
+  bool dirty;
+  int paints;
+  int keys;
+} runtime_view_t;
+
+static WINDOW *runtime_view_layout(void *view, bool resize) {
+  (void)view;
+  (void)resize;
+  return stdscr;
+}
+
+static bool runtime_view_has_damage(void *view) {
+  return ((runtime_view_t *)view)->dirty;
+}
+
+static void runtime_view_paint(void *view, const tui_frame_t *frame) {
+  runtime_view_t *v = view;
+  v->dirty = false;
+  v->paints++;
+  wnoutrefresh(stdscr);
+  tui_frame_flush(frame);
+}
+
+static tui_frame_loop_action_t runtime_view_dispatch(void *view, int key) {
+  runtime_view_t *v = view;
+  if (key == 'q') {
+    return TUI_FRAME_LOOP_EXIT;
+  }
+  v->dirty = true;
+  v->keys++;
+  return TUI_FRAME_LOOP_CONTINUE;
+}
+
+static void runtime_view_ignore(void *view) {
+  (void)view;
+}
+
+static bool runtime_view_idle(void *view) {
+  (void)view;
+  return false;
+}
+
+/* Keys queued behind one another are all applied before the next paint,
+ * which waits for the frame. */
+static bool test_frame_loop_coalesces_keys(void) {
+  runtime_view_t view = {.dirty = true};
+  const tui_frame_loop_t loop = {
+      .view = &view,
+      .max_fps = 10,
+      .layout = runtime_view_layout,
+      .has_damage = runtime_view_has_damage,
+      .paint = runtime_view_paint,
+      .dispatch = runtime_view_dispatch,
+      .poll = runtime_view_ignore,
+      .pending = runtime_view_idle,
+      .invalidate = runtime_view_ignore,
+  };
+  if (write(runtime_master_fd, "abcq", 4) != 4) {
+    return false;
+  }
+  const struct timespec settle = {.tv_sec = 0, .tv_nsec = 20 * 1000 * 1000};
+  nanosleep(&settle, NULL);
+  const tui_frame_loop_status_t status = tui_run_frame_loop(&loop);
+  runtime_drain_master();
+  return status == TUI_FRAME_LOOP_DONE && view.keys == 3 &&
+         view.paints == 1;
+}
+
+int main(void) {
+  const int saved_stdin = dup(STDIN_FILENO);
+  const int saved_stdout = dup(STDOUT_FILENO);
+  int slave_fd = -1;
+  struct winsize ws = {.ws_row = 24, .ws_col = 80};
+  if (saved_stdin < 0 || saved_stdout < 0 ||
+      openpty(&runtime_master_fd, &slave_fd, NULL, NULL, &ws) != 0) {
+    perror("tui-runtime-tests: setup");
+    return 1;
+  }
+  fflush(stdout);
+  if (dup2(slave_fd, STDIN_FILENO) < 0 || dup2(slave_fd, STDOUT_FILENO) < 0) {
+    perror("tui-runtime-tests: dup2");
+    return 1;
+  }
+  close(slave_fd);
+  (void)fcntl(runtime_master_fd, F_SETFL,
+              fcntl(runtime_master_fd, F_GETFL) | O_NONBLOCK);
+  setenv("TERM", "xterm-256color", 0);
+
+  runtime_record(test_progress_format_count(),
+                 "tui_progress_format_count scales to k/M/G");
+  runtime_record(test_progress_format_duration(),
+                 "tui_progress_format_duration rounds and clamps");
+  runtime_record(test_progress_format_rate(),
+                 "tui_progress_format_rate shows the ETA until done");
+
+  const bool started = tui_init() == APP_SUCCESS;
+  runtime_record(started, "tui_init on a PTY");
+  if (started) {
+    runtime_drain_master();
+    runtime_record(test_wake_from_thread(),
+                   "tui_wake ends a blocked wait and coalesces");
+    runtime_record(test_key_and_timer(),
+                   "tui_wait_event reports timeouts and typed keys");
+    runtime_record(test_progress_accounting(),
+                   "tui_progress add/set/finish drive the tick result");
+    runtime_record(test_debug_histogram(),
+                   "tui_debug_format_histogram: empty, one bucket, overflow");
+    runtime_record(test_debug_counts_terminal_bytes(),
+                   "frame output bytes match what reached the terminal");
+    runtime_record(test_debug_hud_hide_repaints(),
+                   "hiding the F12 HUD reports TUI_EVENT_REPAINT");
+    runtime_record(test_frame_loop_coalesces_keys(),
+                   "tui_run_frame_loop applies queued keys, paints once");
+    runtime_record(test_late_wake_after_cleanup(),
+                   "tui_wake after tui_cleanup is harmless and drained");
+    runtime_record(test_hangup_ends_blocking_wait(),
+                   "terminal hangup ends a blocking wait with an I/O error");
+    tui_cleanup();
+  }
+
+  fflush(stdout);
+  dup2(saved_stdin, STDIN_FILENO);
+  dup2(saved_stdout, STDOUT_FILENO);
+  close(saved_stdin);
+  close(saved_stdout);
+  if (runtime_master_fd >= 0) {
+    close(runtime_master_fd);
+  }
+
+  unit_stats_t stats = {0};
+  printf("TAP version 13\n");
+  for (size_t i = 0; i < runtime_result_count; i++) {
+    unit_record(&stats, runtime_results[i].ok, runtime_results[i].name);
+  }
+  printf("1..%d\n", stats.passed + stats.failed);
+  fprintf(stderr, "%d passed, %d failed\n", stats.passed, stats.failed);
+  return stats.failed == 0 ? 0 : 1;
+}
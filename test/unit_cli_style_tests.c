@@ -6,11 +6,19 @@
  */
 
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#ifndef _WIN32
+#include <unistd.h>
+#else
+#include <direct.h>
+#define getcwd _getcwd
+#endif
 
 #include "../src/cli/style/cli_error_render.h"
+#include "../src/cli/style/cli_help_cache.h"
 #include "../src/cli/style/cli_layout.h"
 #include "../src/cli/style/cli_theme.h"
 #include "../src/style/color_math.h"
@@ -65,6 +73,43 @@ static bool test_rgb_to_ansi16(void) {
          app_color_rgb_to_ansi16((app_rgb_t){255, 0, 0}) == 9;
 }
 
+// The table-assisted lookup must agree with a full palette scan everywhere;
+// a stride that is coprime with the 8-wide cells still hits every cell edge
+// class, and the batch form must match the scalar one element for element.
+static bool test_rgb_to_ansi16_matches_full_scan(void) {
+  const app_rgb_t *palette = app_color_ansi16_palette();
+  app_rgb_t row[86];
+  uint8_t quantized[86];
+  uint8_t xterm[86];
+  for (unsigned r = 0; r < 256; r += 3) {
+    for (unsigned g = 0; g < 256; g += 3) {
+      size_t n = 0;
+      for (unsigned b = 0; b < 256; b += 3) {
+        row[n++] = (app_rgb_t){(uint8_t)r, (uint8_t)g, (uint8_t)b};
+      }
+      app_color_rgb_to_ansi16_n(row, quantized, n);
+      app_color_rgb_to_xterm256_n(row, xterm, n);
+      for (size_t i = 0; i < n; i++) {
+        uint8_t best = 0;
+        uint32_t best_dist = UINT32_MAX;
+        for (uint8_t p = 0; p < 16; p++) {
+          const uint32_t d = app_color_dist2(row[i], palette[p]);
+          if (d < best_dist) {
+            best = p;
+            best_dist = d;
+          }
+        }
+        if (quantized[i] != best ||
+            app_color_rgb_to_ansi16(row[i]) != best ||
+            xterm[i] != app_color_rgb_to_xterm256(row[i])) {
+          return false;
+        }
+      }
+    }
+  }
+  return true;
+}
+
 // Compile the default scheme and inspect the resolved Title token (amber).
 static bool test_theme_truecolor_keeps_rgb(void) {
   app_cli_styles_t styles;
@@ -111,6 +156,65 @@ static bool test_theme_16_uses_hint_and_folds(void) {
   return ok;
 }
 
+static bool resolved_color_equal(app_cli_resolved_color_t a,
+                                 app_cli_resolved_color_t b) {
+  return a.kind == b.kind && a.index == b.index && a.rgb.r == b.rgb.r &&
+         a.rgb.g == b.rgb.g && a.rgb.b == b.rgb.b;
+}
+
+static bool style_equal(const app_cli_style_t *a, const app_cli_style_t *b) {
+  return resolved_color_equal(a->fg, b->fg) &&
+         resolved_color_equal(a->bg, b->bg) && a->attrs == b->attrs;
+}
+
+static bool styles_equal(const app_cli_styles_t *a, const app_cli_styles_t *b) {
+  for (int i = 0; i < APP_CLI_COLOR_TOKEN_COUNT; i++) {
+    if (!style_equal(&a->tokens[i], &b->tokens[i])) {
+      return false;
+    }
+  }
+  return style_equal(&a->error_header, &b->error_header);
+}
+
+// The precompiled default styles must match a runtime compile for every
+// profile, mode and color count, and an accent override must bypass them.
+static bool test_default_styles_match_runtime_compile(void) {
+  char *previous = copy_env("APP_CLI_ACCENT");
+  unsetenv("APP_CLI_ACCENT");
+  static const int color_counts[] = {0, 8, 16, 256};
+  bool ok = true;
+  for (int profile = APP_CLI_COLOR_PROFILE_NONE;
+       profile <= APP_CLI_COLOR_PROFILE_TRUECOLOR; profile++) {
+    for (int mode = APP_CLI_THEME_MODE_DARK; mode <= APP_CLI_THEME_MODE_LIGHT;
+         mode++) {
+      for (size_t i = 0; i < sizeof(color_counts) / sizeof(color_counts[0]);
+           i++) {
+        app_cli_styles_t fast;
+        app_cli_styles_t slow;
+        app_cli_styles_compile_default(&fast, (app_cli_theme_mode_id)mode,
+                                       (app_cli_color_profile_id)profile,
+                                       color_counts[i]);
+        app_cli_styles_compile(&slow, app_cli_theme_default_scheme(),
+                               (app_cli_theme_mode_id)mode,
+                               (app_cli_color_profile_id)profile,
+                               color_counts[i]);
+        ok = ok && styles_equal(&fast, &slow);
+      }
+    }
+  }
+
+  app_cli_styles_t accented;
+  ok = ok && setenv("APP_CLI_ACCENT", "#102030", 1) == 0;
+  app_cli_styles_compile_default(&accented, APP_CLI_THEME_MODE_DARK,
+                                 APP_CLI_COLOR_PROFILE_TRUECOLOR, 256);
+  restore_env("APP_CLI_ACCENT", previous);
+  const app_cli_style_t *title =
+      app_cli_style(&accented, APP_CLI_COLOR_TOKEN_TITLE);
+  return ok && title->fg.kind == APP_CLI_RESOLVED_COLOR_RGB &&
+         title->fg.rgb.r == 0x10 && title->fg.rgb.g == 0x20 &&
+         title->fg.rgb.b == 0x30;
+}
+
 static bool test_text_width_utf8(void) {
   // "café" = c a f + 2-byte é => 4 display columns, 5 bytes.
   return app_cli_text_width("hello") == 5 &&
@@ -118,6 +222,18 @@ static bool test_text_width_utf8(void) {
          app_cli_text_width_n("hello", 3) == 3;
 }
 
+// Batch measurement matches the single-string engine, including wide glyphs
+// the CLI layer used to count as one column each.
+static bool test_text_widths_batch(void) {
+  const char *labels[] = {"--json", "\xe6\xbc\xa2\xe5\xad\x97", "",
+                          "e\xcc\x81"};
+  size_t widths[4] = {0};
+  return app_cli_text_widths(labels, 4, widths) == 6 && widths[0] == 6 &&
+         widths[1] == 4 && widths[2] == 0 && widths[3] == 1 &&
+         app_cli_text_widths(labels + 1, 1, NULL) == 4 &&
+         app_cli_text_widths(labels, 0, NULL) == 0;
+}
+
 // The plain error fallback (non-TTY memory stream) title-cases the first word
 // and appends the usage hint.
 static bool test_error_plain_fallback(void) {
@@ -256,18 +372,233 @@ static bool test_theme_env_light_and_accent_integration(void) {
   return ok;
 }
 
+static size_t count_substr(const char *haystack, const char *needle) {
+  size_t count = 0;
+  for (const char *p = strstr(haystack, needle); p;
+       p = strstr(p + strlen(needle), needle)) {
+    count++;
+  }
+  return count;
+}
+
+// Same-style runs and blank padding share one SGR run; dropping bold forces a
+// reset; the newline closes the line with a single reset.
+static bool test_sgr_elides_redundant_transitions(void) {
+  char *previous_no_color = copy_env("NO_COLOR");
+  unsetenv("NO_COLOR");
+  FILE *stream = tmpfile();
+  if (!stream) {
+    restore_env("NO_COLOR", previous_no_color);
+    return false;
+  }
+
+  app_cli_term_opts_t opts = {.force_profile = "256"};
+  app_cli_render_ctx_t ctx;
+  bool ok = app_cli_render_ctx_init(&ctx, NULL, stream, "myapp", &opts);
+  const app_cli_style_t bold = {
+      .fg = {.kind = APP_CLI_RESOLVED_COLOR_INDEXED, .index = 180},
+      .attrs = APP_CLI_ATTR_BOLD};
+  const app_cli_style_t plain = {
+      .fg = {.kind = APP_CLI_RESOLVED_COLOR_INDEXED, .index = 252}};
+  app_cli_write_style(&ctx, &bold, "a");
+  app_cli_repeat(&ctx, ' ', 2);
+  app_cli_write_style(&ctx, &bold, "b");
+  app_cli_write_style(&ctx, &plain, "c");
+  app_cli_write_style(&ctx, &plain, "d");
+  app_cli_newline(&ctx);
+  app_cli_render_ctx_deinit(&ctx);
+  fflush(stream);
+  rewind(stream);
+
+  char buf[256];
+  const size_t n = fread(buf, 1, sizeof(buf) - 1, stream);
+  buf[n] = '\0';
+  fclose(stream);
+  restore_env("NO_COLOR", previous_no_color);
+
+  return ok && count_substr(buf, "\033[1m") == 1 &&
+         count_substr(buf, "\033[38;5;180m") == 1 &&
+         count_substr(buf, "\033[38;5;252m") == 1 &&
+         count_substr(buf, "\033[0m") == 2 &&
+         strstr(buf, "a  b\033[0m\033[38;5;252mcd\033[0m\n") != NULL;
+}
+
+// A render context holds the whole document in its buffer and reaches the
+// stream in one flush at deinit, so two interleaved contexts cannot mix.
+static bool test_render_ctx_buffers_until_deinit(void) {
+  FILE *first = tmpfile();
+  FILE *second = tmpfile();
+  if (!first || !second) {
+    if (first) {
+      fclose(first);
+    }
+    if (second) {
+      fclose(second);
+    }
+    return false;
+  }
+
+  app_cli_render_ctx_t a;
+  app_cli_render_ctx_t b;
+  app_cli_render_ctx_init(&a, NULL, first, "myapp", NULL);
+  app_cli_render_ctx_init(&b, NULL, second, "myapp", NULL);
+  app_cli_write(&a, "first");
+  app_cli_write(&b, "second");
+  app_cli_newline(&a);
+  app_cli_newline(&b);
+  fflush(first);
+  bool ok = ftell(first) == 0 && a.out.len == strlen("first\n");
+  app_cli_render_ctx_deinit(&b);
+  app_cli_render_ctx_deinit(&a);
+
+  char buf[64];
+  rewind(first);
+  size_t n = fread(buf, 1, sizeof(buf) - 1, first);
+  buf[n] = '\0';
+  ok = ok && strcmp(buf, "first\n") == 0;
+  rewind(second);
+  n = fread(buf, 1, sizeof(buf) - 1, second);
+  buf[n] = '\0';
+  ok = ok && strcmp(buf, "second\n") == 0;
+  fclose(first);
+  fclose(second);
+  return ok;
+}
+
+// A stored document replays byte-for-byte under the same key, a different
+// width misses, and APP_CLI_HELP_CACHE=0 bypasses the cache. Hosts that cannot
+// identify the executable never cache, which is also a pass.
+static bool test_help_cache_roundtrip(void) {
+  char *previous_xdg = copy_env("XDG_CACHE_HOME");
+  char *previous_toggle = copy_env("APP_CLI_HELP_CACHE");
+  char *previous_width = copy_env("APP_CLI_TEST_WIDTH");
+  char cwd[512];
+  char dir[640];
+  FILE *stream = tmpfile();
+  bool ok = stream && getcwd(cwd, sizeof(cwd)) != NULL;
+  if (ok) {
+    snprintf(dir, sizeof(dir), "%s/.zig-cache/unit-help-cache", cwd);
+    setenv("XDG_CACHE_HOME", dir, 1);
+    unsetenv("APP_CLI_HELP_CACHE");
+    setenv("APP_CLI_TEST_WIDTH", "77", 1);
+  }
+
+  app_cli_help_cache_t cache;
+  if (ok && app_cli_help_cache_prepare(&cache, NULL, stream, "myapp", NULL,
+                                       "unit-test")) {
+    // Entries from earlier runs are keyed on an older test binary.
+    static const char doc[] = "USAGE\n  myapp\n";
+    app_cli_help_cache_store(&cache, doc, sizeof(doc) - 1);
+    ok = app_cli_help_cache_replay(&cache, stream);
+    fflush(stream);
+    rewind(stream);
+    char buf[64];
+    const size_t n = fread(buf, 1, sizeof(buf) - 1, stream);
+    buf[n] = '\0';
+    ok = ok && strcmp(buf, doc) == 0;
+
+    app_cli_help_cache_t other;
+    setenv("APP_CLI_TEST_WIDTH", "78", 1);
+    ok = ok &&
+         app_cli_help_cache_prepare(&other, NULL, stream, "myapp", NULL,
+                                    "unit-test") &&
+         strcmp(other.path, cache.path) != 0 &&
+         !app_cli_help_cache_replay(&other, stream);
+
+    setenv("APP_CLI_HELP_CACHE", "0", 1);
+    ok = ok && !app_cli_help_cache_prepare(&other, NULL, stream, "myapp",
+                                           NULL, "unit-test");
+    (void)remove(cache.path);
+  }
+  if (stream) {
+    fclose(stream);
+  }
+
+  restore_env("XDG_CACHE_HOME", previous_xdg);
+  restore_env("APP_CLI_HELP_CACHE", previous_toggle);
+  restore_env("APP_CLI_TEST_WIDTH", previous_width);
+  return ok;
+}
+
+static bool file_exists(const char *path) {
+  FILE *file = fopen(path, "rb");
+  if (file) {
+    fclose(file);
+  }
+  return file != NULL;
+}
+
+// Storing an entry removes entries from other builds, including the older
+// unprefixed layout, and leaves unrelated files alone.
+static bool test_help_cache_prunes_other_builds(void) {
+  char *previous_xdg = copy_env("XDG_CACHE_HOME");
+  char *previous_toggle = copy_env("APP_CLI_HELP_CACHE");
+  char cwd[512];
+  char dir[640];
+  char help_dir[700];
+  FILE *stream = tmpfile();
+  bool ok = stream && getcwd(cwd, sizeof(cwd)) != NULL;
+  if (ok) {
+    snprintf(dir, sizeof(dir), "%s/.zig-cache/unit-help-prune", cwd);
+    snprintf(help_dir, sizeof(help_dir), "%s/%s/help", dir, APP_NAME);
+    setenv("XDG_CACHE_HOME", dir, 1);
+    unsetenv("APP_CLI_HELP_CACHE");
+  }
+
+  app_cli_help_cache_t cache;
+  if (ok && app_cli_help_cache_prepare(&cache, NULL, stream, "myapp", NULL,
+                                       "unit-prune")) {
+    static const char doc[] = "USAGE\n";
+    app_cli_help_cache_store(&cache, doc, sizeof(doc) - 1);
+    static const char *const names[] = {
+        "0123456789abcdef-0123456789abcdef.txt",
+        "0123456789abcdef.txt",
+        "notes.txt",
+    };
+    char paths[3][800];
+    for (size_t i = 0; i < 3; i++) {
+      snprintf(paths[i], sizeof(paths[i]), "%s/%s", help_dir, names[i]);
+      FILE *file = fopen(paths[i], "w");
+      ok = ok && file != NULL;
+      if (file) {
+        fclose(file);
+      }
+    }
+    app_cli_help_cache_store(&cache, doc, sizeof(doc) - 1);
+    ok = ok && !file_exists(paths[0]) && !file_exists(paths[1]) &&
+         file_exists(paths[2]) && file_exists(cache.path);
+    for (size_t i = 0; i < 3; i++) {
+      (void)remove(paths[i]);
+    }
+    (void)remove(cache.path);
+  }
+  if (stream) {
+    fclose(stream);
+  }
+
+  restore_env("XDG_CACHE_HOME", previous_xdg);
+  restore_env("APP_CLI_HELP_CACHE", previous_toggle);
+  return ok;
+}
+
 void run_cli_style_unit_tests(unit_stats_t *stats) {
   unit_record(stats, test_luma_light_dark(), "color luma light/dark threshold");
   unit_record(stats, test_channel_to_u8(), "color channel 16->8 bit");
   unit_record(stats, test_rgb_to_xterm256(), "rgb -> xterm256 cube/gray");
   unit_record(stats, test_rgb_to_ansi16(), "rgb -> ansi16 nearest");
+  unit_record(stats, test_rgb_to_ansi16_matches_full_scan(),
+              "rgb -> ansi16 table matches full scan (scalar + batch)");
   unit_record(stats, test_theme_truecolor_keeps_rgb(),
               "theme truecolor keeps RGB + bold");
   unit_record(stats, test_theme_256_downsamples(),
               "theme 256 downsamples amber to 180");
   unit_record(stats, test_theme_16_uses_hint_and_folds(),
               "theme 16 uses semantic hint and folds bright->base");
+  unit_record(stats, test_default_styles_match_runtime_compile(),
+              "theme precompiled defaults match runtime compile");
   unit_record(stats, test_text_width_utf8(), "layout utf8 display width");
+  unit_record(stats, test_text_widths_batch(),
+              "layout batch width matches per-string width");
   unit_record(stats, test_error_plain_fallback(),
               "error plain fallback title-cases + usage hint");
   unit_record(stats, test_color_parse(), "color spec parse (hex/index)");
@@ -277,4 +608,12 @@ void run_cli_style_unit_tests(unit_stats_t *stats) {
               "APP_CLI_COLOR forces profile and never wins");
   unit_record(stats, test_theme_env_light_and_accent_integration(),
               "APP_CLI_THEME light mode and accent override integrate");
+  unit_record(stats, test_sgr_elides_redundant_transitions(),
+              "sgr state machine elides redundant transitions");
+  unit_record(stats, test_render_ctx_buffers_until_deinit(),
+              "render ctx buffers the document until deinit");
+  unit_record(stats, test_help_cache_roundtrip(),
+              "help cache replays stored documents by key");
+  unit_record(stats, test_help_cache_prunes_other_builds(),
+              "help cache store prunes entries from other builds");
 }
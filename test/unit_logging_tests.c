@@ -0,0 +1,458 @@
+/*
+ * Unit tests for the logging module's asynchronous and binary modes.
+ *
+ * Text records are written to stderr, so the async tests point fd 2 at a
+ * temporary file while they log and read the file back afterwards. Binary
+ * records are read back with the log-decode reader.
+ */
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if !defined(_WIN32)
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+#include "../src/utils/log_binary.h"
+#include "../src/utils/logging.h"
+#include "unit_support.h"
+
+static bool log_render_is(const char *expected, const char *fmt,
+                          const app_log_arg_t *args, size_t count) {
+  char buf[128];
+  const size_t len = app_log_render_message(buf, sizeof(buf), fmt, args, count);
+  return len == strlen(expected) && strcmp(buf, expected) == 0;
+}
+
+static bool test_render_matches_printf(void) {
+  const app_log_arg_t mixed[] = {
+      APP_LOG_ARG(-42),         APP_LOG_ARG((unsigned char)200),
+      APP_LOG_ARG(3.14159),     APP_LOG_ARG("str"),
+      APP_LOG_ARG((size_t)255), APP_LOG_ARG('x'),
+  };
+  const app_log_arg_t star[] = {APP_LOG_ARG(6), APP_LOG_ARG(2),
+                                APP_LOG_ARG(2.5)};
+  return log_render_is("-42 200 3.14 [str  ] ff x 100%",
+                       "%d %hhu %.2f [%-5s] %zx %c 100%%", mixed, 6) &&
+         log_render_is("[  2.50]", "[%*.*f]", star, 3) &&
+         log_render_is("-42 <?>", "%ld %s", mixed, 1) &&
+         log_render_is("n=<?>", "n=%s", mixed, 1) &&
+         log_render_is("plain", "plain", NULL, 0);
+}
+
+static bool test_render_skips_unknown_conversions(void) {
+  const app_log_arg_t args[] = {APP_LOG_ARG(5), APP_LOG_ARG(7),
+                                APP_LOG_ARG(1234)};
+  return log_render_is("<?> 5 <?> 7 1234", "%m %d %y %d %'d", args, 3);
+}
+
+/* Unsigned conversions of signed values, and narrowing length modifiers, see
+ * the bits printf would have read. */
+static bool test_render_narrows_like_printf(void) {
+  const int negative = -5;
+  const short small = -300;
+  const signed char tiny = -2;
+  const app_log_arg_t args[] = {
+      APP_LOG_ARG(negative), APP_LOG_ARG(negative), APP_LOG_ARG(small),
+      APP_LOG_ARG(small),    APP_LOG_ARG(small),    APP_LOG_ARG(negative),
+      APP_LOG_ARG(tiny),     APP_LOG_ARG(300),      APP_LOG_ARG(-5L)};
+  const char *fmt = "%x %u %x %o %hx %hhx %u %hhd %lx";
+  char expected[128];
+  snprintf(expected, sizeof(expected), fmt, negative, negative, small, small,
+           small, negative, tiny, 300, -5L);
+  return log_render_is(expected, fmt, args, 9);
+}
+
+/* Only arguments read by %s are copied, so %p never reads through a char
+ * pointer; it prints the address like the text path. */
+static bool test_encode_copies_only_string_conversions(void) {
+  char text[] = "abc";
+  const app_log_arg_t args[] = {APP_LOG_ARG(text), APP_LOG_ARG(3),
+                                APP_LOG_ARG(text), APP_LOG_ARG(text),
+                                {.type = APP_LOG_ARG_END}};
+  const char *fmt = "%p %*s [%s]";
+  const uint32_t strings = app_log_binary_string_args(fmt);
+  uint8_t buf[APP_LOG_BINARY_ENTRY_MAX];
+  const size_t size = app_log_binary_encode_record(buf, 1, 0, args, strings);
+  // type + size + value for the pointer and the int, type + length + 3
+  // bytes for each string.
+  bool ok = strings == 0xcu && size == 3 + 13 + 9 + 10 + 6 + 6;
+  char expected[64];
+  snprintf(expected, sizeof(expected), "%p abc [abc]", (void *)text);
+  return ok && log_render_is(expected, fmt, args, 4) &&
+         app_log_binary_string_args("%% %d %.*s %-4s %m %s") == 0x1cu;
+}
+
+static bool test_render_cuts_at_buffer(void) {
+  const app_log_arg_t args[] = {APP_LOG_ARG("abcdefghij")};
+  char buf[6];
+  const size_t len =
+      app_log_render_message(buf, sizeof(buf), "%s!", args, 1);
+  return len == 5 && strcmp(buf, "abcde") == 0;
+}
+
+/* Encoded entries read back; a second header mid-stream starts over. */
+static bool test_reader_round_trip(void) {
+  FILE *file = tmpfile();
+  if (file == NULL) {
+    return false;
+  }
+  static app_log_site_t site = {LOG_LEVEL_WARNING, "demo.c", 12,
+                                "%s has %d items", 0, 0};
+  const uint32_t strings = app_log_binary_string_args(site.fmt);
+  const app_log_arg_t args[] = {APP_LOG_ARG("cart"), APP_LOG_ARG(3),
+                                {.type = APP_LOG_ARG_END}};
+  uint8_t buf[APP_LOG_BINARY_ENTRY_MAX];
+  for (int session = 0; session < 2; session++) {
+    fwrite(buf, 1, app_log_binary_encode_header(buf), file);
+    fwrite(buf, 1, app_log_binary_encode_site(buf, 1, &site), file);
+    fwrite(buf, 1,
+           app_log_binary_encode_record(buf, 1, 1234567u, args, strings),
+           file);
+  }
+  // A record for a site this session never defined.
+  fwrite(buf, 1, app_log_binary_encode_record(buf, 2, 1u, args, strings),
+         file);
+  rewind(file);
+
+  app_log_reader_t *reader = NULL;
+  bool ok = app_log_reader_open(file, &reader) == APP_SUCCESS;
+  for (int i = 0; ok && i < 2; i++) {
+    app_log_entry_t entry;
+    bool done = true;
+    ok = app_log_reader_next(reader, &entry, &done) == APP_SUCCESS &&
+         !done && entry.level == LOG_LEVEL_WARNING &&
+         strcmp(entry.file, "demo.c") == 0 && entry.line == 12 &&
+         entry.micros == 1234567u &&
+         strcmp(entry.message, "cart has 3 items") == 0;
+  }
+  app_log_entry_t entry;
+  bool done = false;
+  ok = ok && app_log_reader_next(reader, &entry, &done) ==
+                 APP_ERROR_INVALID_DATA;
+  app_log_reader_close(reader);
+  fclose(file);
+
+  FILE *junk = tmpfile();
+  if (junk == NULL) {
+    return false;
+  }
+  fputs("not a binary log\n", junk);
+  rewind(junk);
+  reader = NULL;
+  ok = ok && app_log_reader_open(junk, &reader) == APP_ERROR_INVALID_DATA &&
+       reader == NULL;
+  fclose(junk);
+  return ok;
+}
+
+#if !defined(_WIN32)
+
+typedef struct {
+  FILE *file;
+  int saved_fd;
+  app_log_level saved_level;
+} log_capture_t;
+
+static bool log_capture_begin(log_capture_t *capture) {
+  capture->file = tmpfile();
+  if (capture->file == NULL) {
+    return false;
+  }
+  fflush(stderr);
+  capture->saved_fd = dup(STDERR_FILENO);
+  if (capture->saved_fd < 0 ||
+      dup2(fileno(capture->file), STDERR_FILENO) < 0) {
+    fclose(capture->file);
+    return false;
+  }
+  capture->saved_level = app_log_get_level();
+  app_log_set_level(LOG_LEVEL_DEBUG);
+  return true;
+}
+
+/* Restores stderr and returns everything written to it, NUL-terminated. */
+static char *log_capture_end(log_capture_t *capture) {
+  app_log_set_level(capture->saved_level);
+  fflush(stderr);
+  dup2(capture->saved_fd, STDERR_FILENO);
+  close(capture->saved_fd);
+
+  char *text = NULL;
+  long size = -1;
+  if (fseek(capture->file, 0, SEEK_END) == 0) {
+    size = ftell(capture->file);
+  }
+  if (size >= 0 && fseek(capture->file, 0, SEEK_SET) == 0) {
+    text = malloc((size_t)size + 1);
+  }
+  if (text != NULL) {
+    const size_t read = fread(text, 1, (size_t)size, capture->file);
+    text[read] = '\0';
+  }
+  fclose(capture->file);
+  return text;
+}
+
+#define LOG_TEST_THREADS 4
+#define LOG_TEST_RECORDS 1500
+
+static void *log_test_producer(void *arg) {
+  const int id = *(const int *)arg;
+  for (int i = 0; i < LOG_TEST_RECORDS; i++) {
+    LOG_DEBUG("producer %d record %d", id, i);
+  }
+  return NULL;
+}
+
+/* More records than ring slots, so producers also wait on a full ring; none
+ * may be lost and each producer's records must stay in order. */
+static bool test_async_keeps_every_record_in_order(void) {
+  log_capture_t capture;
+  if (!log_capture_begin(&capture)) {
+    return false;
+  }
+  bool ok = app_log_async_start() && app_log_async_active();
+  pthread_t threads[LOG_TEST_THREADS];
+  int ids[LOG_TEST_THREADS];
+  int started = 0;
+  for (int t = 0; ok && t < LOG_TEST_THREADS; t++) {
+    ids[t] = t;
+    if (pthread_create(&threads[t], NULL, log_test_producer, &ids[t]) != 0) {
+      ok = false;
+      break;
+    }
+    started++;
+  }
+  for (int t = 0; t < started; t++) {
+    pthread_join(threads[t], NULL);
+  }
+  app_log_async_stop();
+  ok = ok && !app_log_async_active();
+  char *text = log_capture_end(&capture);
+  if (text == NULL) {
+    return false;
+  }
+
+  int next[LOG_TEST_THREADS] = {0};
+  for (char *line = strtok(text, "\n"); ok && line != NULL;
+       line = strtok(NULL, "\n")) {
+    const char *body = strstr(line, "] [DEBUG] ");
+    const char *message = body ? strstr(body, ": producer ") : NULL;
+    int id = -1;
+    int record = -1;
+    if (line[0] != '[' || message == NULL ||
+        sscanf(message, ": producer %d record %d", &id, &record) != 2 ||
+        id < 0 || id >= LOG_TEST_THREADS || record != next[id]) {
+      ok = false;
+      break;
+    }
+    next[id]++;
+  }
+  for (int t = 0; t < LOG_TEST_THREADS; t++) {
+    ok = ok && next[t] == LOG_TEST_RECORDS;
+  }
+  free(text);
+  return ok;
+}
+
+static bool test_async_cuts_long_records(void) {
+  char long_text[1024];
+  memset(long_text, 'x', sizeof(long_text) - 1);
+  long_text[sizeof(long_text) - 1] = '\0';
+
+  log_capture_t capture;
+  if (!log_capture_begin(&capture)) {
+    return false;
+  }
+  bool ok = app_log_async_start();
+  LOG_INFO("%s", long_text);
+  LOG_INFO("after");
+  app_log_async_stop();
+  char *text = log_capture_end(&capture);
+  if (text == NULL) {
+    return false;
+  }
+  const char *cut = strstr(text, "xxx...\n");
+  ok = ok && cut != NULL && strstr(cut, ": after\n") != NULL &&
+       strlen(text) < 1024;
+  free(text);
+  return ok;
+}
+
+/* Both modes print the caller's file name whole, however long. */
+static bool test_async_and_sync_lines_match(void) {
+  char file[300];
+  memset(file, 'f', sizeof(file) - 1);
+  file[sizeof(file) - 1] = '\0';
+  char expected[sizeof(file) + 32];
+  snprintf(expected, sizeof(expected), "] [INFO] %s:7: same\n", file);
+
+  log_capture_t capture;
+  if (!log_capture_begin(&capture)) {
+    return false;
+  }
+  bool ok = app_log_async_start();
+  app_log_with_location(LOG_LEVEL_INFO, file, 7, "same");
+  app_log_async_stop();
+  app_log_with_location(LOG_LEVEL_INFO, file, 7, "same");
+  char *text = log_capture_end(&capture);
+  const char *first = text ? strstr(text, expected) : NULL;
+  ok = ok && first != NULL && strstr(first + 1, expected) != NULL;
+  free(text);
+  return ok;
+}
+
+/* An error is on stderr before the call returns, as if logged directly. */
+static bool test_async_writes_errors_before_returning(void) {
+  log_capture_t capture;
+  if (!log_capture_begin(&capture)) {
+    return false;
+  }
+  bool ok = app_log_async_start();
+  LOG_INFO("queued first");
+  LOG_ERROR("failed %d", 3);
+  long size = -1;
+  if (fseek(capture.file, 0, SEEK_END) == 0) {
+    size = ftell(capture.file);
+  }
+  app_log_async_stop();
+  char *text = log_capture_end(&capture);
+  const char *info = text ? strstr(text, ": queued first\n") : NULL;
+  const char *error = text ? strstr(text, ": failed 3\n") : NULL;
+  ok = ok && info != NULL && error != NULL && info < error &&
+       size == (long)(error - text) + (long)strlen(": failed 3\n");
+  free(text);
+  return ok;
+}
+
+/* Once stopped, a record is on stderr as soon as the call returns. */
+static bool test_stop_returns_to_synchronous_logging(void) {
+  log_capture_t capture;
+  if (!log_capture_begin(&capture)) {
+    return false;
+  }
+  bool ok = app_log_async_start();
+  app_log_async_stop();
+  app_log_async_stop();
+  LOG_WARNING("synchronous %d", 7);
+  fflush(stderr);
+  long size = -1;
+  if (fseek(capture.file, 0, SEEK_END) == 0) {
+    size = ftell(capture.file);
+  }
+  char *text = log_capture_end(&capture);
+  ok = ok && size > 0 && text != NULL &&
+       strstr(text, "[WARNING] ") != NULL &&
+       strstr(text, ": synchronous 7\n") != NULL;
+  free(text);
+  return ok;
+}
+
+/* LOG_* calls from several threads land in the binary file whole and in
+ * per-thread order, and render like their printf equivalents. */
+static bool test_binary_mode_captures_log_calls(void) {
+  char path[] = "/tmp/myapp-log-XXXXXX";
+  const int fd = mkstemp(path);
+  if (fd < 0) {
+    return false;
+  }
+  close(fd);
+  const app_log_level saved_level = app_log_get_level();
+  app_log_set_level(LOG_LEVEL_DEBUG);
+  bool ok = app_log_binary_open(path);
+  LOG_WARNING("mixed %s %u %.1f %c %p", "text", 7u, 0.5, 'z', (void *)NULL);
+  LOG_ERROR("no arguments");
+  pthread_t threads[LOG_TEST_THREADS];
+  int ids[LOG_TEST_THREADS];
+  int started = 0;
+  for (int t = 0; ok && t < LOG_TEST_THREADS; t++) {
+    ids[t] = t;
+    if (pthread_create(&threads[t], NULL, log_test_producer, &ids[t]) != 0) {
+      ok = false;
+      break;
+    }
+    started++;
+  }
+  for (int t = 0; t < started; t++) {
+    pthread_join(threads[t], NULL);
+  }
+  app_log_binary_close();
+  app_log_set_level(saved_level);
+
+  char expected[64];
+  snprintf(expected, sizeof(expected), "mixed text 7 0.5 z %p", (void *)NULL);
+  FILE *in = fopen(path, "rb");
+  app_log_reader_t *reader = NULL;
+  ok = ok && in != NULL && app_log_reader_open(in, &reader) == APP_SUCCESS;
+  int next[LOG_TEST_THREADS] = {0};
+  for (int index = 0; ok; index++) {
+    app_log_entry_t entry;
+    bool done = false;
+    if (app_log_reader_next(reader, &entry, &done) != APP_SUCCESS) {
+      ok = false;
+    } else if (done) {
+      break;
+    } else if (index == 0) {
+      ok = entry.level == LOG_LEVEL_WARNING &&
+           strcmp(entry.message, expected) == 0 &&
+           strstr(entry.file, "unit_logging_tests.c") != NULL;
+    } else if (index == 1) {
+      ok = entry.level == LOG_LEVEL_ERROR &&
+           strcmp(entry.message, "no arguments") == 0;
+    } else {
+      int id = -1;
+      int record = -1;
+      ok = sscanf(entry.message, "producer %d record %d", &id, &record) ==
+               2 &&
+           id >= 0 && id < LOG_TEST_THREADS && record == next[id];
+      if (ok) {
+        next[id]++;
+      }
+    }
+  }
+  for (int t = 0; t < LOG_TEST_THREADS; t++) {
+    ok = ok && next[t] == LOG_TEST_RECORDS;
+  }
+  app_log_reader_close(reader);
+  if (in != NULL) {
+    fclose(in);
+  }
+  remove(path);
+  return ok;
+}
+
+#endif
+
+void run_logging_unit_tests(unit_stats_t *stats) {
+  unit_record(stats, test_render_matches_printf(),
+              "binary log rendering matches printf for captured arguments");
+  unit_record(stats, test_render_skips_unknown_conversions(),
+              "binary log rendering leaves arguments to known conversions");
+  unit_record(stats, test_render_narrows_like_printf(),
+              "binary log rendering narrows integers like printf");
+  unit_record(stats, test_encode_copies_only_string_conversions(),
+              "binary log records copy only arguments read by %s");
+  unit_record(stats, test_render_cuts_at_buffer(),
+              "binary log rendering cuts at the buffer size");
+  unit_record(stats, test_reader_round_trip(),
+              "binary log reader round-trips sessions and rejects bad input");
+#if !defined(_WIN32)
+  unit_record(stats, test_async_keeps_every_record_in_order(),
+              "async logging keeps every record in per-thread order");
+  unit_record(stats, test_async_cuts_long_records(),
+              "async logging cuts records longer than a ring slot");
+  unit_record(stats, test_async_and_sync_lines_match(),
+              "async logging prints long file names like synchronous logging");
+  unit_record(stats, test_async_writes_errors_before_returning(),
+              "async logging writes errors out before the call returns");
+  unit_record(stats, test_stop_returns_to_synchronous_logging(),
+              "async logging stop drains and returns to synchronous writes");
+  unit_record(stats, test_binary_mode_captures_log_calls(),
+              "binary logging captures LOG_* calls from several threads");
+#else
+  unit_record(stats, !app_log_async_start() && !app_log_async_active(),
+              "async logging reports unsupported on Windows");
+#endif
+}
@@ -15,6 +15,9 @@ int main(void) {
   run_config_unit_tests(&stats);
   run_input_unit_tests(&stats);
   run_tui_menu_unit_tests(&stats);
+  run_tui_table_unit_tests(&stats);
+  run_tui_logview_unit_tests(&stats);
+  run_logging_unit_tests(&stats);
   run_cli_style_unit_tests(&stats);
   run_cli_osc11_unit_tests(&stats);
   run_shared_primitives_unit_tests(&stats);
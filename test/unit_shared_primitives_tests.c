@@ -70,6 +70,104 @@ static bool test_text_layout_width_and_truncate(void) {
          app_text_width_utf8("é") >= 1;
 }
 
+/* Long ASCII runs take the block-at-a-time path; the bytes that end a run
+ * (wide, control, invalid, NUL) must land exactly where the scalar decoder
+ * would have put them, including inside and at the edge of a block. */
+static bool test_text_layout_ascii_runs(void) {
+  char text[160];
+  memset(text, 'a', 40);
+  memcpy(text + 40, "\xe6\xbc\xa2", 3); /* U+6F22, 2 columns */
+  memset(text + 43, 'b', 40);
+  text[83] = '\t';
+  text[84] = '\xff'; /* invalid lead byte: 1 column */
+  memset(text + 85, 'c', 20);
+  text[105] = '\0';
+  if (app_text_width_utf8(text) != 40 + 2 + 40 + 0 + 1 + 20 ||
+      app_text_width_utf8_n(text, 17) != 17 ||
+      /* A cut inside U+6F22 leaves two stray bytes of one column each. */
+      app_text_width_utf8_n(text, 42) != 40 + 1 + 1) {
+    return false;
+  }
+
+  int cols = 0;
+  size_t bytes = app_text_truncate_utf8_columns(text, 41, &cols);
+  if (bytes != 40 || cols != 40) {
+    return false;
+  }
+  bytes = app_text_truncate_utf8_columns(text, 42, &cols);
+  if (bytes != 43 || cols != 42) {
+    return false;
+  }
+  /* The zero-width tab rides along with the last column that fits. */
+  bytes = app_text_truncate_utf8_columns(text, 82, &cols);
+  if (bytes != 84 || cols != 82) {
+    return false;
+  }
+
+  char nul_inside[40];
+  memset(nul_inside, 'x', sizeof(nul_inside));
+  nul_inside[20] = '\0';
+  return app_text_width_utf8_n(nul_inside, sizeof(nul_inside)) == 20;
+}
+
+/* Generated width table: full East Asian Width and emoji presentation, with
+ * combining marks, format characters and trailing Hangul jamo at zero. */
+static bool test_text_layout_unicode_widths(void) {
+  static const struct {
+    const char *text;
+    int columns;
+  } cases[] = {
+      {"\xe6\xbc\xa2", 2},                     /* U+6F22 CJK */
+      {"\xef\xbc\xa1", 2},                     /* U+FF21 fullwidth A */
+      {"\xf0\x9f\x98\x80", 2},                 /* U+1F600 emoji */
+      {"\xe2\x8c\x9a", 2},                     /* U+231A watch */
+      {"e\xcc\x81", 1},                        /* e + U+0301 */
+      {"\xe2\x80\x8d", 0},                     /* U+200D ZWJ */
+      {"\xe1\x84\x80\xe1\x85\xa1", 2},         /* Hangul jamo L + V */
+      {"\xc2\xb1", 1},                         /* ambiguous +- */
+      {"\xc2\xad", 1},                         /* soft hyphen */
+      {"\xf0\x9f\x87\xba\xf0\x9f\x87\xb8", 2}, /* flag pair */
+  };
+  for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+    if (app_text_width_utf8(cases[i].text) != cases[i].columns) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/* Truncation never splits a grapheme cluster, and the per-thread boundary
+ * cache must notice when a buffer is reused for different text. */
+static bool test_text_layout_grapheme_truncation(void) {
+  /* "ab" + man ZWJ woman ZWJ girl (18 bytes, one 2-column glyph) + "c". */
+  char text[32] = "ab\xf0\x9f\x91\xa8\xe2\x80\x8d\xf0\x9f\x91\xa9"
+                  "\xe2\x80\x8d\xf0\x9f\x91\xa7"
+                  "c";
+  int cols = 0;
+  if (app_text_width_utf8(text) != 5 ||
+      app_text_truncate_utf8_columns(text, 3, &cols) != 2 || cols != 2 ||
+      app_text_truncate_utf8_columns(text, 4, &cols) != 20 || cols != 4 ||
+      app_text_truncate_utf8_columns(text, 5, &cols) != 21 || cols != 5) {
+    return false;
+  }
+
+  /* Same buffer and length, new text: "x", "e" + U+0301, a flag pair and
+   * nine "y"s must be re-segmented rather than served from the cache. */
+  memcpy(text,
+         "xe\xcc\x81\xf0\x9f\x87\xba\xf0\x9f\x87\xb8"
+         "yyyyyyyyy",
+         21);
+  if (app_text_width_utf8(text) != 13 ||
+      app_text_truncate_utf8_columns(text, 2, &cols) != 4 || cols != 2 ||
+      app_text_truncate_utf8_columns(text, 3, &cols) != 4 || cols != 2 ||
+      app_text_truncate_utf8_columns(text, 4, &cols) != 12 || cols != 4) {
+    return false;
+  }
+
+  const char *next = "e\xcc\x81!";
+  return app_text_grapheme_next(next, strlen(next), &cols) == 3 && cols == 1;
+}
+
 typedef struct {
   size_t count;
   char text[8][64];
@@ -144,6 +242,57 @@ static bool test_text_layout_wrap_preserves_leading_indent(void) {
   return true;
 }
 
+typedef struct {
+  const char *base;
+  size_t len;
+  size_t lines;
+  bool inside;
+} wrap_origin_t;
+
+static bool wrap_origin_emit(void *user, const char *bytes, size_t byte_count,
+                             int columns) {
+  (void)columns;
+  wrap_origin_t *origin = user;
+  origin->lines++;
+  if (byte_count > 0 && (bytes < origin->base ||
+                         bytes + byte_count > origin->base + origin->len)) {
+    origin->inside = false;
+  }
+  return true;
+}
+
+static bool test_text_layout_wrap_cache_replays(void) {
+  /* Repeated wraps replay cached spans; they must match the first layout,
+   * point into the caller's buffer, and follow content and width changes. */
+  char text[] = "one two three four five";
+  wrap_capture_t first = {0};
+  wrap_capture_t again = {0};
+  app_text_wrap_utf8(text, 9, 0, 0, wrap_capture_emit, &first);
+  app_text_wrap_utf8(text, 9, 0, 0, wrap_capture_emit, &again);
+  if (first.count != 3 || again.count != first.count ||
+      strcmp(again.text[0], "one two") != 0 ||
+      strcmp(again.text[2], "four five") != 0 || again.columns[2] != 9) {
+    return false;
+  }
+
+  char copy[sizeof(text)];
+  memcpy(copy, text, sizeof(text));
+  wrap_origin_t origin = {.base = copy, .len = strlen(copy), .inside = true};
+  app_text_wrap_utf8(copy, 9, 0, 0, wrap_origin_emit, &origin);
+  if (origin.lines != 3 || !origin.inside) {
+    return false;
+  }
+
+  /* Same length, different words; then the original at another width. */
+  memcpy(copy, "a b c d e f g h i j k l", sizeof(text));
+  wrap_capture_t changed = {0};
+  app_text_wrap_utf8(copy, 9, 0, 0, wrap_capture_emit, &changed);
+  wrap_capture_t wide = {0};
+  app_text_wrap_utf8(text, 40, 0, 0, wrap_capture_emit, &wide);
+  return changed.count == 3 && strcmp(changed.text[0], "a b c d e") == 0 &&
+         wide.count == 1 && strcmp(wide.text[0], text) == 0;
+}
+
 static bool test_terminal_query_is_safe(void) {
   app_terminal_size_t size = app_terminal_query_size();
   return !size.known || (size.cols > 0 && size.rows > 0);
@@ -192,6 +341,14 @@ void run_shared_primitives_unit_tests(unit_stats_t *stats) {
               "option_meta matches and formats CLI labels");
   unit_record(stats, test_text_layout_width_and_truncate(),
               "text_layout measures and truncates utf8 text");
+  unit_record(stats, test_text_layout_ascii_runs(),
+              "text layout ascii fast path matches scalar");
+  unit_record(stats, test_text_layout_unicode_widths(),
+              "text layout unicode width table (cjk, emoji, marks)");
+  unit_record(stats, test_text_layout_grapheme_truncation(),
+              "text layout truncation keeps grapheme clusters whole");
+  unit_record(stats, test_text_layout_wrap_cache_replays(),
+              "text layout wrap cache replays matching spans");
   unit_record(stats, test_text_layout_wrap_multi_space(),
               "text_layout wraps with multi-space column accounting");
   unit_record(stats, test_text_layout_wrap_preserves_leading_indent(),
@@ -37,6 +37,9 @@ static inline void unit_record(unit_stats_t *stats, bool ok, const char *name) {
 void run_config_unit_tests(unit_stats_t *stats);
 void run_input_unit_tests(unit_stats_t *stats);
 void run_tui_menu_unit_tests(unit_stats_t *stats);
+void run_tui_table_unit_tests(unit_stats_t *stats);
+void run_tui_logview_unit_tests(unit_stats_t *stats);
+void run_logging_unit_tests(unit_stats_t *stats);
 void run_cli_style_unit_tests(unit_stats_t *stats);
 void run_cli_osc11_unit_tests(unit_stats_t *stats);
 void run_shared_primitives_unit_tests(unit_stats_t *stats);
@@ -0,0 +1,358 @@
+/*
+ * Unit tests for the pure-data TUI log viewer model.
+ */
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if !defined(_WIN32)
+#include <time.h>
+#include <unistd.h>
+#endif
+
+#include "../src/tui/tui_logview.h"
+#include "../src/tui/tui_logview_internal.h"
+#include "unit_support.h"
+
+static size_t naive_find(const char *hay, size_t n, const char *needle,
+                         size_t m, bool last) {
+  size_t found = SIZE_MAX;
+  for (size_t i = 0; m > 0 && i + m <= n; i++) {
+    if (memcmp(hay + i, needle, m) == 0) {
+      found = i;
+      if (!last)
+        break;
+    }
+  }
+  return found;
+}
+
+static bool test_find_matches_naive_scan(void) {
+  /* A small alphabet makes near-misses on the first/last byte common. */
+  char hay[300];
+  uint32_t seed = 12345;
+  for (size_t i = 0; i < sizeof(hay); i++) {
+    seed = seed * 1103515245u + 12345u;
+    hay[i] = "abc"[(seed >> 16) % 3];
+  }
+  for (size_t m = 1; m <= 7; m++) {
+    for (size_t start = 0; start + m <= sizeof(hay); start += 7) {
+      const char *needle = hay + start;
+      for (size_t n = m; n <= sizeof(hay); n += 37) {
+        if (tui_logview_find(hay, n, needle, m) !=
+                naive_find(hay, n, needle, m, false) ||
+            tui_logview_find_last(hay, n, needle, m) !=
+                naive_find(hay, n, needle, m, true))
+          return false;
+      }
+    }
+  }
+  return tui_logview_find(hay, 3, "abcd", 4) == SIZE_MAX &&
+         tui_logview_find(hay, sizeof(hay), "", 0) == SIZE_MAX;
+}
+
+#if !defined(_WIN32)
+
+typedef struct {
+  char path[64];
+  FILE *fp;
+} log_fixture_t;
+
+static bool log_fixture_open(log_fixture_t *f, const char *text) {
+  const char *dir = getenv("TMPDIR");
+  snprintf(f->path, sizeof(f->path), "%s/logview-XXXXXX",
+           dir && strlen(dir) < 40 ? dir : "/tmp");
+  const int fd = mkstemp(f->path);
+  if (fd < 0)
+    return false;
+  f->fp = fdopen(fd, "w");
+  if (!f->fp) {
+    close(fd);
+    unlink(f->path);
+    return false;
+  }
+  fputs(text, f->fp);
+  fflush(f->fp);
+  return true;
+}
+
+static void log_fixture_close(log_fixture_t *f) {
+  fclose(f->fp);
+  unlink(f->path);
+}
+
+static void log_sleep_ms(long ms) {
+  struct timespec ts = {.tv_sec = 0, .tv_nsec = ms * 1000000L};
+  nanosleep(&ts, NULL);
+}
+
+/* Polls until `done` holds or two seconds pass. */
+static bool log_wait(tui_logview_state_t *s,
+                     bool (*done)(const tui_logview_state_t *, int64_t),
+                     int64_t arg) {
+  for (int i = 0; i < 400; i++) {
+    tui_logview_state_poll(s);
+    if (done(s, arg))
+      return true;
+    log_sleep_ms(5);
+  }
+  return false;
+}
+
+static bool log_idle(const tui_logview_state_t *s, int64_t arg) {
+  (void)arg;
+  return !tui_logview_state_pending(s);
+}
+
+static bool log_has_lines(const tui_logview_state_t *s, int64_t lines) {
+  return tui_logview_state_progress(s).lines == lines;
+}
+
+static bool log_line_is(const tui_logview_state_t *s, int64_t n,
+                        const char *expected) {
+  char bytes[256];
+  size_t len = 0;
+  return tui_logview_state_line(s, n, bytes, sizeof(bytes), &len) &&
+         len == strlen(expected) && memcmp(bytes, expected, len) == 0;
+}
+
+static bool test_open_rejects_missing_and_directories(void) {
+  tui_logview_state_t *s = NULL;
+  return tui_logview_state_open("/nonexistent/logview", false, &s) ==
+             TUI_LOGVIEW_IO_ERROR &&
+         errno == ENOENT && !s &&
+         tui_logview_state_open("/", false, &s) == TUI_LOGVIEW_IO_ERROR &&
+         errno == EISDIR && !s &&
+         tui_logview_state_open("", false, &s) == TUI_LOGVIEW_INVALID_ARG;
+}
+
+static bool test_index_finds_every_line(void) {
+  /* More lines than one index stride, CRLF endings, no final newline. */
+  char *text = malloc(200 * 16);
+  if (!text)
+    return false;
+  size_t len = 0;
+  for (int i = 0; i < 199; i++)
+    len += (size_t)sprintf(text + len, "line %d\r\n", i);
+  strcpy(text + len, "partial");
+  log_fixture_t f;
+  bool ok = log_fixture_open(&f, text);
+  free(text);
+  if (!ok)
+    return false;
+  tui_logview_state_t *s = NULL;
+  ok = tui_logview_state_open(f.path, false, &s) == TUI_LOGVIEW_OK &&
+       log_wait(s, log_idle, 0);
+  ok = ok && tui_logview_state_progress(s).lines == 200 &&
+       log_line_is(s, 0, "line 0") && log_line_is(s, 63, "line 63") &&
+       log_line_is(s, 64, "line 64") && log_line_is(s, 130, "line 130") &&
+       log_line_is(s, 199, "partial") && !log_line_is(s, 200, "");
+  tui_logview_state_close(s);
+  log_fixture_close(&f);
+  return ok;
+}
+
+static bool test_format_expands_tabs_and_controls(void) {
+  log_fixture_t f;
+  if (!log_fixture_open(&f, "a\tb\x01" "c\n"))
+    return false;
+  tui_logview_state_t *s = NULL;
+  char buf[64];
+  bool ok = tui_logview_state_open(f.path, false, &s) == TUI_LOGVIEW_OK &&
+            log_wait(s, log_idle, 0) &&
+            tui_logview_state_format_line(s, 0, buf, sizeof(buf)) &&
+            strcmp(buf, "a       b c") == 0;
+  tui_logview_state_close(s);
+  log_fixture_close(&f);
+  return ok;
+}
+
+static bool test_follow_indexes_appended_lines(void) {
+  log_fixture_t f;
+  if (!log_fixture_open(&f, "one\ntwo\n"))
+    return false;
+  tui_logview_state_t *s = NULL;
+  bool ok = tui_logview_state_open(f.path, true, &s) == TUI_LOGVIEW_OK &&
+            log_wait(s, log_has_lines, 2);
+  tui_logview_state_settle(s, 10, 40);
+  fputs("three\nfour", f.fp);
+  fflush(f.fp);
+  ok = ok && log_wait(s, log_has_lines, 4) && log_line_is(s, 3, "four");
+  fputs("ty\n", f.fp);
+  fflush(f.fp);
+  for (int i = 0; ok && i < 400 && !log_line_is(s, 3, "fourty"); i++) {
+    log_sleep_ms(5);
+    tui_logview_state_poll(s);
+  }
+  ok = ok && log_line_is(s, 3, "fourty") && tui_logview_state_following(s);
+  tui_logview_state_close(s);
+  log_fixture_close(&f);
+  return ok;
+}
+
+static bool test_follow_reloads_truncated_file(void) {
+  log_fixture_t f;
+  if (!log_fixture_open(&f, "old 1\nold 2\nold 3\n"))
+    return false;
+  tui_logview_state_t *s = NULL;
+  bool ok = tui_logview_state_open(f.path, true, &s) == TUI_LOGVIEW_OK &&
+            log_wait(s, log_has_lines, 3);
+  ok = ok && ftruncate(fileno(f.fp), 0) == 0;
+  rewind(f.fp);
+  fputs("new\n", f.fp);
+  fflush(f.fp);
+  ok = ok && log_wait(s, log_has_lines, 1) && log_line_is(s, 0, "new");
+  tui_logview_state_close(s);
+  log_fixture_close(&f);
+  return ok;
+}
+
+static bool log_search_done(const tui_logview_state_t *s, int64_t arg) {
+  (void)arg;
+  return tui_logview_state_search_status(s) != TUI_LOGVIEW_SEARCH_RUNNING;
+}
+
+/* Without follow nothing notices the truncation, so reads still aim at the
+ * old bytes; they must fail instead of dying of SIGBUS. */
+static bool test_reads_survive_truncation_under_mapping(void) {
+  char text[16384];
+  size_t len = 0;
+  int lines = 0;
+  while (len + 32 < sizeof(text))
+    len += (size_t)sprintf(text + len, "line %d\n", lines++);
+  char last[32];
+  snprintf(last, sizeof(last), "line %d", lines - 1);
+  log_fixture_t f;
+  if (!log_fixture_open(&f, text))
+    return false;
+  tui_logview_state_t *s = NULL;
+  bool ok = tui_logview_state_open(f.path, false, &s) == TUI_LOGVIEW_OK &&
+            log_wait(s, log_idle, 0) && log_line_is(s, lines - 1, last);
+  ok = ok && ftruncate(fileno(f.fp), 0) == 0;
+  char buf[64];
+  size_t got = 0;
+  ok = ok && !tui_logview_state_line(s, lines - 1, buf, sizeof(buf), &got) &&
+       !tui_logview_state_format_line(s, 0, buf, sizeof(buf)) &&
+       tui_logview_state_search(s, "line 1", 1) &&
+       log_wait(s, log_search_done, 0) &&
+       tui_logview_state_search_status(s) == TUI_LOGVIEW_SEARCH_NOT_FOUND;
+  tui_logview_state_close(s);
+  log_fixture_close(&f);
+  return ok;
+}
+
+static bool test_search_moves_between_matches(void) {
+  char text[4096];
+  size_t len = 0;
+  for (int i = 0; i < 150; i++)
+    len += (size_t)sprintf(text + len, "%s %d\n",
+                           i % 50 == 7 ? "ERROR disk" : "info ok", i);
+  log_fixture_t f;
+  if (!log_fixture_open(&f, text))
+    return false;
+  tui_logview_state_t *s = NULL;
+  bool ok = tui_logview_state_open(f.path, false, &s) == TUI_LOGVIEW_OK &&
+            log_wait(s, log_idle, 0);
+  tui_logview_state_settle(s, 10, 80);
+  ok = ok && tui_logview_state_search(s, "ERROR", 1) &&
+       log_wait(s, log_search_done, 0) &&
+       tui_logview_state_match_line(s) == 7 && tui_logview_state_top(s) == 7;
+  ok = ok && tui_logview_state_search_again(s, 1) &&
+       log_wait(s, log_search_done, 0) && tui_logview_state_match_line(s) == 57;
+  ok = ok && tui_logview_state_search_again(s, 1) &&
+       log_wait(s, log_search_done, 0) &&
+       tui_logview_state_match_line(s) == 107;
+  ok = ok && tui_logview_state_search_again(s, -1) &&
+       log_wait(s, log_search_done, 0) && tui_logview_state_match_line(s) == 57;
+  ok = ok && tui_logview_state_search_again(s, 1) &&
+       log_wait(s, log_search_done, 0) &&
+       tui_logview_state_search_again(s, 1) &&
+       log_wait(s, log_search_done, 0) &&
+       tui_logview_state_search_status(s) == TUI_LOGVIEW_SEARCH_NOT_FOUND &&
+       tui_logview_state_top(s) == 107;
+  tui_logview_state_close(s);
+  log_fixture_close(&f);
+  return ok;
+}
+
+static bool test_navigation_and_follow_mode(void) {
+  char text[2048];
+  size_t len = 0;
+  for (int i = 0; i < 100; i++)
+    len += (size_t)sprintf(text + len, "%d\n", i);
+  log_fixture_t f;
+  if (!log_fixture_open(&f, text))
+    return false;
+  tui_logview_state_t *s = NULL;
+  bool ok = tui_logview_state_open(f.path, true, &s) == TUI_LOGVIEW_OK &&
+            log_wait(s, log_has_lines, 100);
+  /* Follow mode starts pinned to the end. */
+  tui_logview_state_settle(s, 10, 40);
+  ok = ok && tui_logview_state_top(s) == 90 && tui_logview_state_following(s);
+  tui_logview_state_page(s, -1, 10, 40);
+  ok = ok && tui_logview_state_top(s) == 80 && !tui_logview_state_following(s);
+  tui_logview_state_scroll(s, 100, 10, 40);
+  ok = ok && tui_logview_state_top(s) == 90;
+  tui_logview_state_home(s);
+  tui_logview_state_page(s, 1, 10, 40);
+  ok = ok && tui_logview_state_top(s) == 10;
+  tui_logview_state_end(s, 10, 40);
+  ok = ok && tui_logview_state_top(s) == 90 && tui_logview_state_following(s);
+  tui_logview_state_close(s);
+  log_fixture_close(&f);
+  return ok;
+}
+
+static bool test_wrap_counts_rows_per_line(void) {
+  log_fixture_t f;
+  if (!log_fixture_open(&f, "short\nthe quick brown fox jumps over\nend\n"
+                            "abcdefghijklmnopqrstuvwxy\n"))
+    return false;
+  tui_logview_state_t *s = NULL;
+  bool ok = tui_logview_state_open(f.path, false, &s) == TUI_LOGVIEW_OK &&
+            log_wait(s, log_idle, 0);
+  ok = ok && tui_logview_state_line_rows(s, 1, 10) == 1;
+  tui_logview_state_toggle_wrap(s);
+  ok = ok && tui_logview_state_line_rows(s, 0, 10) == 1 &&
+       tui_logview_state_line_rows(s, 1, 10) == 3 &&
+       tui_logview_state_line_rows(s, 3, 10) == 3;
+  /* A word wider than the row is cut into row-sized pieces, so the last
+   * three lines take seven rows; one row fewer drops the wrapped one. */
+  tui_logview_state_end(s, 7, 10);
+  ok = ok && tui_logview_state_top(s) == 1;
+  tui_logview_state_end(s, 6, 10);
+  ok = ok && tui_logview_state_top(s) == 2;
+  tui_logview_state_close(s);
+  log_fixture_close(&f);
+  return ok;
+}
+
+#endif
+
+void run_tui_logview_unit_tests(unit_stats_t *stats) {
+  unit_record(stats, test_find_matches_naive_scan(),
+              "tui_logview find agrees with a naive scan at every offset");
+#if !defined(_WIN32)
+  unit_record(stats, test_open_rejects_missing_and_directories(),
+              "tui_logview refuses missing files and directories");
+  unit_record(stats, test_index_finds_every_line(),
+              "tui_logview index reaches lines between checkpoints");
+  unit_record(stats, test_format_expands_tabs_and_controls(),
+              "tui_logview formats tabs and control bytes for display");
+  unit_record(stats, test_follow_indexes_appended_lines(),
+              "tui_logview follow indexes lines appended to the file");
+  unit_record(stats, test_follow_reloads_truncated_file(),
+              "tui_logview follow reloads a file truncated in place");
+  unit_record(stats, test_search_moves_between_matches(),
+              "tui_logview search steps forward and back between matches");
+  unit_record(stats, test_reads_survive_truncation_under_mapping(),
+              "tui_logview reads fail cleanly on a file cut short");
+  unit_record(stats, test_navigation_and_follow_mode(),
+              "tui_logview paging leaves follow mode and G resumes it");
+  unit_record(stats, test_wrap_counts_rows_per_line(),
+              "tui_logview wrapping counts rows per line for the last page");
+#endif
+}
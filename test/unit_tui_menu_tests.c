@@ -2,9 +2,15 @@
  * Unit tests for the pure-data TUI menu model.
  */
 
+#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <wchar.h>
 
+#if !defined(_WIN32)
+#include <pthread.h>
+#endif
+
 #include "../src/tui/tui_menu.h"
 #include "../src/tui/tui_menu_internal.h"
 #include "unit_support.h"
@@ -299,6 +305,232 @@ static bool test_search_backspace_removes_one_wchar(void) {
   return ok;
 }
 
+static bool test_search_backspace_restores_order(void) {
+  const tui_menu_item_t items[] = {
+      {.label = "Alpha", .id = 1},
+      {.label = "Alpine", .id = 2},
+      {.kind = TUI_MENU_ITEM_SEPARATOR},
+      {.label = "Palace", .id = 4},
+      {.label = "Beta", .id = 5},
+      {.label = "ALPACA", .id = 6},
+  };
+  const tui_menu_config_t cfg = {.items = items, .item_count = 6};
+  tui_menu_state_t *s = NULL;
+  if (tui_menu_state_create(&cfg, &s) != TUI_MENU_OK)
+    return false;
+  tui_menu_state_search_open(s);
+  tui_menu_state_search_append(s, L'a');
+  tui_menu_state_search_append(s, L'L');
+  /* "al" matches 0, 1, 3, 5; "alp" narrows to 0, 1, 5. */
+  bool ok = tui_menu_state_visible_count(s) == 4;
+  tui_menu_state_search_append(s, L'p');
+  ok = ok && tui_menu_state_visible_count(s) == 3 &&
+       tui_menu_state_visible_at(s, 2) == 5;
+  /* Backspace merges the dropped row back in its original position. */
+  tui_menu_state_search_backspace(s);
+  ok = ok && tui_menu_state_visible_count(s) == 4 &&
+       tui_menu_state_visible_at(s, 0) == 0 &&
+       tui_menu_state_visible_at(s, 1) == 1 &&
+       tui_menu_state_visible_at(s, 2) == 3 &&
+       tui_menu_state_visible_at(s, 3) == 5;
+  tui_menu_state_search_backspace(s);
+  tui_menu_state_search_backspace(s);
+  ok = ok && tui_menu_state_visible_count(s) == 6;
+  tui_menu_state_destroy(s);
+  return ok;
+}
+
+static bool test_fuzzy_search_ranks_matches(void) {
+  const tui_menu_item_t items[] = {
+      {.label = "Buffer Flush", .id = 1},
+      {.label = "Find File", .id = 2},
+      {.label = "Offline", .id = 3},
+      {.label = "Config", .id = 4},
+  };
+  const tui_menu_config_t cfg = {
+      .items = items, .item_count = 4, .fuzzy_search = true};
+  tui_menu_state_t *s = NULL;
+  if (tui_menu_state_create(&cfg, &s) != TUI_MENU_OK)
+    return false;
+  tui_menu_state_search_open(s);
+  tui_menu_state_search_append(s, L'F');
+  tui_menu_state_search_append(s, L'f');
+  /* Word starts beat a mid-word run; equal scores prefer the shorter label. */
+  bool ok = !tui_menu_state_pending(s) &&
+            tui_menu_state_match_count(s) == 3 &&
+            tui_menu_state_visible_at(s, 0) == 1 &&
+            tui_menu_state_visible_at(s, 1) == 2 &&
+            tui_menu_state_visible_at(s, 2) == 0 &&
+            tui_menu_state_selected_index(s) == 1;
+  tui_menu_state_destroy(s);
+  return ok;
+}
+
+static bool test_fuzzy_search_scores_in_background(void) {
+  enum { kCount = 20000 };
+  tui_menu_item_t *items = calloc(kCount, sizeof(*items));
+  if (!items)
+    return false;
+  for (int i = 0; i < kCount; i++) {
+    items[i].label = (i % 2) ? "queue depth" : "quick exit";
+    items[i].id = i + 1;
+  }
+  items[12345].label = "qed tool";
+  const tui_menu_config_t cfg = {
+      .items = items, .item_count = kCount, .fuzzy_search = true};
+  tui_menu_state_t *s = NULL;
+  if (tui_menu_state_create(&cfg, &s) != TUI_MENU_OK) {
+    free(items);
+    return false;
+  }
+  tui_menu_state_search_open(s);
+  /* Superseded queries are cancelled; only the last one is published. */
+  tui_menu_state_search_append(s, L'q');
+  tui_menu_state_search_append(s, L'e');
+  tui_menu_state_search_append(s, L'd');
+  while (tui_menu_state_pending(s))
+    tui_menu_state_poll(s);
+  bool ok = tui_menu_state_match_count(s) == kCount / 2 &&
+            tui_menu_state_visible_count(s) < kCount / 2 &&
+            tui_menu_state_selected_index(s) == 12345;
+  tui_menu_state_destroy(s);
+  free(items);
+  return ok;
+}
+
+static bool test_feed_appends_while_open(void) {
+  tui_menu_feed_t *feed = tui_menu_feed_create();
+  if (!feed)
+    return false;
+  const tui_menu_config_t cfg = {.feed = feed, .default_index = -1};
+  tui_menu_state_t *s = NULL;
+  if (tui_menu_state_create(&cfg, &s) != TUI_MENU_OK) {
+    tui_menu_feed_destroy(feed);
+    return false;
+  }
+  /* An empty feed menu opens immediately with nothing selected. */
+  bool ok = tui_menu_state_loading(s) && tui_menu_state_pending(s) &&
+            tui_menu_state_selected_index(s) == -1;
+
+  tui_menu_state_search_open(s);
+  tui_menu_state_search_append(s, L'r');
+  char label[16] = "&Router";
+  ok = ok && tui_menu_feed_push(feed, &(tui_menu_item_t){.label = "Switch",
+                                                         .id = 1}) &&
+       tui_menu_feed_push(feed, &(tui_menu_item_t){.label = label, .id = 2});
+  label[0] = 'X'; /* pushed items are copies */
+  tui_menu_state_poll(s);
+  /* Arrivals are filtered by the live query. */
+  ok = ok && tui_menu_state_item_count(s) == 2 &&
+       tui_menu_state_visible_count(s) == 1 &&
+       tui_menu_state_selected_index(s) == 1 &&
+       wcscmp(tui_menu_state_label_wcs(s, 1), L"Router") == 0 &&
+       tui_menu_state_mnemonic(s, 1) == L'r';
+  tui_menu_state_search_close(s);
+  tui_menu_feed_finish(feed);
+  ok = ok && !tui_menu_feed_push(feed, &(tui_menu_item_t){.label = "late"});
+  tui_menu_state_poll(s);
+  ok = ok && !tui_menu_state_loading(s) && !tui_menu_state_pending(s) &&
+       tui_menu_state_visible_count(s) == 2;
+  tui_menu_state_destroy(s);
+  tui_menu_feed_destroy(feed);
+  return ok;
+}
+
+static bool test_labels_survive_arena_growth(void) {
+  const tui_menu_item_t items[] = {
+      {.label = "&Alpha", .id = 1},
+      {.label = "Beta", .id = 2},
+  };
+  tui_menu_feed_t *feed = tui_menu_feed_create();
+  if (!feed)
+    return false;
+  const tui_menu_config_t cfg = {
+      .items = items, .item_count = 2, .feed = feed, .enable_search = true};
+  tui_menu_state_t *s = NULL;
+  if (tui_menu_state_create(&cfg, &s) != TUI_MENU_OK) {
+    tui_menu_feed_destroy(feed);
+    return false;
+  }
+  /* The label arenas start sized for the initial items; pushing thousands
+   * more reallocates them many times over. */
+  bool ok = true;
+  for (int i = 0; i < 3000 && ok; i++) {
+    char label[32];
+    snprintf(label, sizeof(label), "Item %d", i);
+    ok = tui_menu_feed_push(feed, &(tui_menu_item_t){.label = label,
+                                                     .id = 100 + i});
+  }
+  ok = ok && tui_menu_feed_push(feed, &(tui_menu_item_t){
+                                          .kind = TUI_MENU_ITEM_SEPARATOR});
+  tui_menu_feed_finish(feed);
+  tui_menu_state_poll(s);
+  ok = ok && tui_menu_state_item_count(s) == 3003 &&
+       wcscmp(tui_menu_state_label_wcs(s, 0), L"Alpha") == 0 &&
+       tui_menu_state_mnemonic(s, 0) == L'a' &&
+       wcscmp(tui_menu_state_label_wcs(s, 2001), L"Item 1999") == 0 &&
+       wcscmp(tui_menu_state_label_wcs(s, 3002), L"") == 0;
+
+  /* Matching reads the folded arena: "item 29" hits 29, 290-299 and
+   * 2900-2999, never the separator. */
+  tui_menu_state_search_open(s);
+  for (const wchar_t *q = L"ITEM 29"; *q; q++)
+    tui_menu_state_search_append(s, *q);
+  ok = ok && tui_menu_state_visible_count(s) == 111 &&
+       tui_menu_state_selected_index(s) == 31;
+  tui_menu_state_destroy(s);
+  tui_menu_feed_destroy(feed);
+  return ok;
+}
+
+#if !defined(_WIN32)
+enum { kInventorySize = 5000 };
+
+/* Stand-in for a slow remote inventory: enumerates from another thread. */
+static void *inventory_producer(void *arg) {
+  tui_menu_feed_t *feed = arg;
+  for (int i = 0; i < kInventorySize; i++) {
+    char label[32];
+    snprintf(label, sizeof(label), "host-%04d", i);
+    tui_menu_item_t item = {.label = label, .id = i + 1};
+    if (!tui_menu_feed_push(feed, &item))
+      break;
+  }
+  tui_menu_feed_finish(feed);
+  return NULL;
+}
+
+static bool test_feed_streams_from_producer_thread(void) {
+  tui_menu_feed_t *feed = tui_menu_feed_create();
+  if (!feed)
+    return false;
+  const tui_menu_config_t cfg = {.feed = feed, .default_index = -1};
+  tui_menu_state_t *s = NULL;
+  pthread_t producer;
+  if (tui_menu_state_create(&cfg, &s) != TUI_MENU_OK ||
+      pthread_create(&producer, NULL, inventory_producer, feed) != 0) {
+    tui_menu_state_destroy(s);
+    tui_menu_feed_destroy(feed);
+    return false;
+  }
+  while (tui_menu_state_pending(s))
+    tui_menu_state_poll(s);
+  pthread_join(producer, NULL);
+  /* Every item arrives exactly once, in push order. */
+  bool ok = tui_menu_state_item_count(s) == kInventorySize &&
+            tui_menu_state_selected_index(s) == 0;
+  for (int i = 0; ok && i < kInventorySize; i++) {
+    wchar_t expect[32];
+    swprintf(expect, 32, L"host-%04d", i);
+    ok = tui_menu_state_item(s, i).id == i + 1 &&
+         wcscmp(tui_menu_state_label_wcs(s, i), expect) == 0;
+  }
+  tui_menu_state_destroy(s);
+  tui_menu_feed_destroy(feed);
+  return ok;
+}
+#endif
+
 static bool test_select_visible_rejects_disabled(void) {
   const tui_menu_item_t items[] = {
       {.label = "a", .id = 1},
@@ -382,6 +614,123 @@ static bool test_numbering_skips_separators(void) {
   return ok;
 }
 
+static bool test_damage_tracks_selection_rows(void) {
+  const tui_menu_item_t items[] = {
+      {.label = "a", .id = 1},
+      {.label = "b", .id = 2},
+      {.label = "c", .id = 3},
+      {.label = "d", .id = 4},
+  };
+  const tui_menu_config_t cfg = {.items = items, .item_count = 4};
+  tui_menu_state_t *s = NULL;
+  if (tui_menu_state_create(&cfg, &s) != TUI_MENU_OK)
+    return false;
+  /* First paint is full; an unchanged state then reports nothing. */
+  tui_menu_damage_t d = tui_menu_state_take_damage(s);
+  bool ok = d.full;
+  d = tui_menu_state_take_damage(s);
+  ok = ok && !d.full && !d.meta && d.row_count == 0;
+
+  /* A cursor move inside the viewport touches the old and new rows only. */
+  tui_menu_state_step(s, 1);
+  tui_menu_state_ensure_selection_visible(s, 2);
+  d = tui_menu_state_take_damage(s);
+  ok = ok && !d.full && d.meta && d.row_count == 2 && d.rows[0] == 0 &&
+       d.rows[1] == 1;
+
+  /* Scrolling, filtering and invalidation each force a full repaint. */
+  tui_menu_state_step(s, 1);
+  tui_menu_state_ensure_selection_visible(s, 2);
+  ok = ok && tui_menu_state_take_damage(s).full;
+  tui_menu_state_search_open(s);
+  ok = ok && tui_menu_state_take_damage(s).full;
+  tui_menu_state_invalidate(s);
+  ok = ok && tui_menu_state_take_damage(s).full;
+  tui_menu_state_destroy(s);
+  return ok;
+}
+
+static bool test_damage_coalesces_keys_within_a_frame(void) {
+  const tui_menu_item_t items[] = {
+      {.label = "a", .id = 1},
+      {.label = "b", .id = 2},
+      {.label = "c", .id = 3},
+      {.label = "d", .id = 4},
+  };
+  const tui_menu_config_t cfg = {.items = items, .item_count = 4};
+  tui_menu_state_t *s = NULL;
+  if (tui_menu_state_create(&cfg, &s) != TUI_MENU_OK)
+    return false;
+  (void)tui_menu_state_take_damage(s);
+  bool ok = !tui_menu_state_has_damage(s);
+
+  /* Peeking does not consume: the frame loop asks before it is due. */
+  tui_menu_state_step(s, 1);
+  tui_menu_state_step(s, 1);
+  ok = ok && tui_menu_state_has_damage(s) && tui_menu_state_has_damage(s);
+  /* Several moves between paints repaint only where the cursor started and
+   * where it ended up. */
+  tui_menu_damage_t d = tui_menu_state_take_damage(s);
+  ok = ok && !d.full && d.row_count == 2 && d.rows[0] == 0 && d.rows[1] == 2;
+
+  /* Moves that cancel out within a frame leave nothing to draw. */
+  tui_menu_state_step(s, 1);
+  tui_menu_state_step(s, -1);
+  ok = ok && !tui_menu_state_has_damage(s);
+  tui_menu_state_destroy(s);
+  return ok;
+}
+
+typedef struct {
+  int count;
+  int calls;
+} virtual_items_t;
+
+static bool virtual_item_at(void *user, int index, tui_menu_item_t *out) {
+  static const char *const kLabels[] = {"alpha", "b&&c", "gamma"};
+  virtual_items_t *v = user;
+  v->calls++;
+  if (index < 0 || index >= v->count)
+    return false;
+  out->label = index == v->count - 1 ? "needle" : kLabels[index % 3];
+  out->id = index + 1;
+  out->disabled = index == 0;
+  return true;
+}
+
+static bool test_item_source_is_fetched_lazily(void) {
+  virtual_items_t v = {.count = 200000};
+  const tui_menu_config_t cfg = {.item_source = virtual_item_at,
+                                 .item_source_user = &v,
+                                 .item_count = v.count,
+                                 .default_index = -1};
+  tui_menu_state_t *s = NULL;
+  if (tui_menu_state_create(&cfg, &s) != TUI_MENU_OK)
+    return false;
+  /* Opening touches a handful of items, not all of them. */
+  bool ok = v.calls < 16 && tui_menu_state_selected_index(s) == 1 &&
+            tui_menu_state_listable_count(s) == v.count &&
+            tui_menu_state_visible_count(s) == v.count;
+  ok = ok && wcscmp(tui_menu_state_label_wcs(s, 1), L"b&c") == 0 &&
+       wcscmp(tui_menu_state_label_wcs(s, 2), L"gamma") == 0 &&
+       tui_menu_state_mnemonic(s, 1) == 0;
+
+  tui_menu_state_end(s);
+  ok = ok && tui_menu_state_selected_index(s) == v.count - 1 &&
+       tui_menu_state_item(s, v.count - 1).id == v.count &&
+       tui_menu_state_item(s, v.count).disabled;
+
+  tui_menu_state_search_open(s);
+  tui_menu_state_search_append(s, L'N');
+  tui_menu_state_search_append(s, L'e');
+  ok = ok && tui_menu_state_visible_count(s) == 1 &&
+       tui_menu_state_selected_index(s) == v.count - 1;
+  tui_menu_state_search_close(s);
+  ok = ok && tui_menu_state_visible_count(s) == v.count;
+  tui_menu_state_destroy(s);
+  return ok;
+}
+
 void run_tui_menu_unit_tests(unit_stats_t *stats) {
   {
     const tui_menu_item_t item = {
@@ -446,6 +795,20 @@ void run_tui_menu_unit_tests(unit_stats_t *stats) {
               "tui_menu search_close clears the query");
   unit_record(stats, test_search_backspace_removes_one_wchar(),
               "tui_menu search backspace pops one wchar");
+  unit_record(stats, test_search_backspace_restores_order(),
+              "tui_menu search backspace restores the wider match set");
+  unit_record(stats, test_fuzzy_search_ranks_matches(),
+              "tui_menu fuzzy search ranks word-start matches first");
+  unit_record(stats, test_fuzzy_search_scores_in_background(),
+              "tui_menu fuzzy search merges background worker results");
+  unit_record(stats, test_feed_appends_while_open(),
+              "tui_menu feed appends items while the menu is open");
+  unit_record(stats, test_labels_survive_arena_growth(),
+              "tui_menu labels stay intact as the label arena grows");
+#if !defined(_WIN32)
+  unit_record(stats, test_feed_streams_from_producer_thread(),
+              "tui_menu feed delivers a producer thread's items in order");
+#endif
   unit_record(stats, test_select_visible_rejects_disabled(),
               "tui_menu select_visible rejects disabled rows");
   unit_record(stats, test_ensure_selection_visible_updates_top(),
@@ -454,4 +817,10 @@ void run_tui_menu_unit_tests(unit_stats_t *stats) {
               "tui_menu numeric jump targets visible row, skips disabled");
   unit_record(stats, test_numbering_skips_separators(),
               "tui_menu numeric labels stay contiguous across separators");
+  unit_record(stats, test_damage_tracks_selection_rows(),
+              "tui_menu damage limits a cursor move to two rows");
+  unit_record(stats, test_damage_coalesces_keys_within_a_frame(),
+              "tui_menu damage coalesces moves between frames");
+  unit_record(stats, test_item_source_is_fetched_lazily(),
+              "tui_menu item_source fetches items on demand");
 }
@@ -0,0 +1,309 @@
+/*
+ * Unit tests for the pure-data TUI table model.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "../src/tui/tui_table.h"
+#include "../src/tui/tui_table_internal.h"
+#include "unit_support.h"
+
+/* A synthetic table: row r has id r, a name from `names` (cycled) and a
+ * score of (r * 7) % 10. Counts cursor calls to check rows stay virtual. */
+typedef struct {
+  const char *const *names;
+  int name_count;
+  int calls;
+} table_fixture_t;
+
+static bool table_fixture_cursor(void *user, int row, tui_table_row_t *out) {
+  table_fixture_t *f = user;
+  __atomic_fetch_add(&f->calls, 1, __ATOMIC_RELAXED);
+  const int n = snprintf(out->scratch, out->scratch_size, "%d", row);
+  out->cells[0] = out->scratch;
+  out->cells[1] = f->names[row % f->name_count];
+  char *score = out->scratch + n + 1;
+  snprintf(score, out->scratch_size - (size_t)n - 1, "%d", (row * 7) % 10);
+  out->cells[2] = score;
+  return true;
+}
+
+static const tui_table_column_t table_columns[] = {
+    {.title = "Id", .align = TUI_TABLE_ALIGN_RIGHT,
+     .sort = TUI_TABLE_SORT_NUMBER},
+    {.title = "Name", .max_width = 12},
+    {.title = "Score", .align = TUI_TABLE_ALIGN_RIGHT,
+     .sort = TUI_TABLE_SORT_NUMBER},
+};
+
+static tui_table_config_t table_config(table_fixture_t *f, int rows) {
+  return (tui_table_config_t){.columns = table_columns,
+                              .column_count = 3,
+                              .row_count = rows,
+                              .cursor = table_fixture_cursor,
+                              .cursor_user = f,
+                              .sort_column = -1};
+}
+
+static void table_wait(tui_table_state_t *s) {
+  while (tui_table_state_pending(s))
+    tui_table_state_poll(s);
+}
+
+/* Source row at each of the first `n` positions. */
+static bool table_order_is(const tui_table_state_t *s, const int *rows,
+                           int n) {
+  for (int p = 0; p < n; p++) {
+    if (tui_table_state_source_row(s, p) != rows[p])
+      return false;
+  }
+  return true;
+}
+
+static bool test_table_rejects_bad_config(void) {
+  static const char *const names[] = {"a"};
+  table_fixture_t f = {.names = names, .name_count = 1};
+  tui_table_config_t cfg = table_config(&f, 3);
+  cfg.column_count = 0;
+  tui_table_state_t *s = NULL;
+  bool ok = tui_table_state_create(&cfg, &s) == TUI_TABLE_INVALID_ARG && !s;
+  cfg.column_count = TUI_TABLE_MAX_COLUMNS + 1;
+  ok = ok && tui_table_state_create(&cfg, &s) == TUI_TABLE_INVALID_ARG;
+  cfg = table_config(&f, 3);
+  cfg.cursor = NULL;
+  return ok && tui_table_state_create(&cfg, &s) == TUI_TABLE_INVALID_ARG;
+}
+
+static bool test_table_samples_widths_across_rows(void) {
+  /* The long name sits deep in the table, past the first screenful, and is
+   * longer than the column's max_width. */
+  static const char *const names[] = {"ab", "a very long name indeed"};
+  table_fixture_t f = {.names = names, .name_count = 2};
+  const tui_table_config_t cfg = table_config(&f, 100000);
+  tui_table_state_t *s = NULL;
+  if (tui_table_state_create(&cfg, &s) != TUI_TABLE_OK)
+    return false;
+  bool ok = tui_table_state_natural_width(s, 0) == 5 && /* "99609" */
+            tui_table_state_natural_width(s, 1) == 12 &&
+            tui_table_state_natural_width(s, 2) == 5 && /* header */
+            f.calls <= TUI_TABLE_WIDTH_SAMPLES;
+  tui_table_state_destroy(s);
+  return ok;
+}
+
+static bool test_table_fit_shrinks_widest_first(void) {
+  static const char *const names[] = {"a fairly long name"};
+  table_fixture_t f = {.names = names, .name_count = 1};
+  const tui_table_config_t cfg = table_config(&f, 10);
+  tui_table_state_t *s = NULL;
+  if (tui_table_state_create(&cfg, &s) != TUI_TABLE_OK)
+    return false;
+  int widths[3];
+  tui_table_state_fit_columns(s, 100, widths);
+  bool ok = widths[0] == 2 && widths[1] == 12 && widths[2] == 5;
+  /* 2 + 2 + 8 + 2 + 5 = 19: only the name column gives way. */
+  tui_table_state_fit_columns(s, 19, widths);
+  ok = ok && widths[0] == 2 && widths[1] == 8 && widths[2] == 5;
+  /* Far too narrow: every column stops at its floor. */
+  tui_table_state_fit_columns(s, 1, widths);
+  ok = ok && widths[0] == 2 && widths[1] == 4 && widths[2] == 4;
+  tui_table_state_destroy(s);
+  return ok;
+}
+
+static bool test_table_fetches_only_requested_rows(void) {
+  static const char *const names[] = {"x"};
+  table_fixture_t f = {.names = names, .name_count = 1};
+  const tui_table_config_t cfg = table_config(&f, 2000000);
+  tui_table_state_t *s = NULL;
+  if (tui_table_state_create(&cfg, &s) != TUI_TABLE_OK)
+    return false;
+  f.calls = 0;
+  tui_table_state_end(s);
+  tui_table_state_ensure_selection_visible(s, 20);
+  const char *cells[3];
+  char scratch[64];
+  const int row = tui_table_state_fetch(s, tui_table_state_selected(s), cells,
+                                        scratch, sizeof(scratch));
+  bool ok = row == 1999999 && strcmp(cells[0], "1999999") == 0 &&
+            tui_table_state_top(s) == 1999980 && f.calls == 1 &&
+            tui_table_state_fetch(s, 2000000, cells, scratch,
+                                  sizeof(scratch)) == -1;
+  tui_table_state_destroy(s);
+  return ok;
+}
+
+static bool test_table_navigation_clamps(void) {
+  static const char *const names[] = {"x"};
+  table_fixture_t f = {.names = names, .name_count = 1};
+  tui_table_config_t cfg = table_config(&f, 50);
+  cfg.default_row = 10;
+  tui_table_state_t *s = NULL;
+  if (tui_table_state_create(&cfg, &s) != TUI_TABLE_OK)
+    return false;
+  bool ok = tui_table_state_selected(s) == 10;
+  tui_table_state_page(s, 1, 30);
+  ok = ok && tui_table_state_selected(s) == 40;
+  tui_table_state_page(s, 1, 30);
+  ok = ok && tui_table_state_selected(s) == 49;
+  tui_table_state_step(s, -100);
+  ok = ok && tui_table_state_selected(s) == 0;
+  tui_table_state_move_column(s, -1);
+  ok = ok && tui_table_state_column(s) == 0;
+  tui_table_state_move_column(s, 1);
+  tui_table_state_move_column(s, 1);
+  tui_table_state_move_column(s, 1);
+  ok = ok && tui_table_state_column(s) == 2;
+  tui_table_state_destroy(s);
+  return ok;
+}
+
+static bool test_table_damage_tracks_selection_rows(void) {
+  static const char *const names[] = {"x"};
+  table_fixture_t f = {.names = names, .name_count = 1};
+  const tui_table_config_t cfg = table_config(&f, 50);
+  tui_table_state_t *s = NULL;
+  if (tui_table_state_create(&cfg, &s) != TUI_TABLE_OK)
+    return false;
+  tui_table_state_ensure_selection_visible(s, 10);
+  bool ok = tui_table_state_take_damage(s).full &&
+            !tui_table_state_has_damage(s);
+  tui_table_state_step(s, 1);
+  tui_table_state_step(s, 1);
+  tui_table_state_ensure_selection_visible(s, 10);
+  const tui_table_damage_t d = tui_table_state_take_damage(s);
+  ok = ok && !d.full && d.meta && d.row_count == 2 && d.rows[0] == 0 &&
+       d.rows[1] == 2;
+  tui_table_state_step(s, 20);
+  tui_table_state_ensure_selection_visible(s, 10);
+  ok = ok && tui_table_state_take_damage(s).full;
+  tui_table_state_destroy(s);
+  return ok;
+}
+
+static bool test_table_numeric_sort_keeps_selection(void) {
+  static const char *const names[] = {"x"};
+  table_fixture_t f = {.names = names, .name_count = 1};
+  tui_table_config_t cfg = table_config(&f, 10);
+  cfg.default_row = 3; /* score 1 */
+  tui_table_state_t *s = NULL;
+  if (tui_table_state_create(&cfg, &s) != TUI_TABLE_OK)
+    return false;
+  /* Scores by row: 0 7 4 1 8 5 2 9 6 3. */
+  bool ok = tui_table_state_sort(s, 2, false);
+  table_wait(s);
+  static const int ascending[] = {0, 3, 6, 9, 2, 5, 8, 1, 4, 7};
+  ok = ok && table_order_is(s, ascending, 10) &&
+       tui_table_state_sort_column(s) == 2 &&
+       !tui_table_state_sort_descending(s) &&
+       tui_table_state_selected(s) == 1;
+  tui_table_state_move_column(s, 1);
+  tui_table_state_move_column(s, 1);
+  ok = ok && tui_table_state_sort_column_toggle(s);
+  table_wait(s);
+  static const int descending[] = {7, 4, 1, 8, 5, 2, 9, 6, 3, 0};
+  ok = ok && table_order_is(s, descending, 10) &&
+       tui_table_state_sort_descending(s) && tui_table_state_selected(s) == 8;
+  tui_table_state_destroy(s);
+  return ok;
+}
+
+static bool test_table_text_sort_breaks_prefix_ties(void) {
+  /* Equal 8-byte prefixes must fall back to the full cell; case is folded
+   * and a bare prefix orders before its extensions. */
+  static const char *const names[] = {"Interval-b", "interval-a", "Interval",
+                                      "beta", "interval-c"};
+  table_fixture_t f = {.names = names, .name_count = 5};
+  tui_table_config_t cfg = table_config(&f, 5);
+  cfg.sort_column = 1;
+  tui_table_state_t *s = NULL;
+  if (tui_table_state_create(&cfg, &s) != TUI_TABLE_OK)
+    return false;
+  table_wait(s);
+  static const int expected[] = {3, 2, 1, 0, 4};
+  bool ok = table_order_is(s, expected, 5) && tui_table_state_column(s) == 1;
+  tui_table_state_destroy(s);
+  return ok;
+}
+
+static bool test_table_text_sort_skips_shared_prefix(void) {
+  /* Every cell shares a 13-byte prefix, so 8-byte keys from the start would
+   * all tie and each comparison would fetch two rows. Keyed past the
+   * prefix, the sort reads each row at most twice. */
+  static const char *const names[] = {
+      "/var/log/app/c-3.log", "/VAR/log/app/a-9.log", "/var/log/app/e-1.log",
+      "/var/log/app/b-7.log", "/var/log/app/d-5.log", "/var/log/app/a-1.log"};
+  table_fixture_t f = {.names = names, .name_count = 6};
+  const tui_table_config_t cfg = table_config(&f, 6);
+  tui_table_state_t *s = NULL;
+  if (tui_table_state_create(&cfg, &s) != TUI_TABLE_OK)
+    return false;
+  const int before = __atomic_load_n(&f.calls, __ATOMIC_RELAXED);
+  bool ok = tui_table_state_sort(s, 1, false);
+  table_wait(s);
+  const int fetched = __atomic_load_n(&f.calls, __ATOMIC_RELAXED) - before;
+  static const int expected[] = {5, 1, 3, 0, 4, 2};
+  ok = ok && table_order_is(s, expected, 6) && fetched <= 2 * 6;
+  tui_table_state_destroy(s);
+  return ok;
+}
+
+static bool test_table_sort_none_is_refused(void) {
+  static const tui_table_column_t columns[] = {
+      {.title = "Id", .sort = TUI_TABLE_SORT_NONE},
+  };
+  static const char *const names[] = {"x"};
+  table_fixture_t f = {.names = names, .name_count = 1};
+  tui_table_config_t cfg = table_config(&f, 3);
+  cfg.columns = columns;
+  cfg.column_count = 1;
+  tui_table_state_t *s = NULL;
+  if (tui_table_state_create(&cfg, &s) != TUI_TABLE_OK)
+    return false;
+  bool ok = !tui_table_state_sort_column_toggle(s) &&
+            !tui_table_state_pending(s) && tui_table_state_sort_column(s) == -1;
+  tui_table_state_destroy(s);
+  return ok;
+}
+
+static bool test_table_newer_sort_supersedes(void) {
+  static const char *const names[] = {"x"};
+  table_fixture_t f = {.names = names, .name_count = 1};
+  const tui_table_config_t cfg = table_config(&f, 200000);
+  tui_table_state_t *s = NULL;
+  if (tui_table_state_create(&cfg, &s) != TUI_TABLE_OK)
+    return false;
+  bool ok = tui_table_state_sort(s, 2, false) &&
+            tui_table_state_sort(s, 0, true);
+  table_wait(s);
+  ok = ok && tui_table_state_sort_column(s) == 0 &&
+       tui_table_state_source_row(s, 0) == 199999;
+  tui_table_state_destroy(s);
+  return ok;
+}
+
+void run_tui_table_unit_tests(unit_stats_t *stats) {
+  unit_record(stats, test_table_rejects_bad_config(),
+              "tui_table rejects invalid column counts and missing cursor");
+  unit_record(stats, test_table_samples_widths_across_rows(),
+              "tui_table sizes columns from rows sampled across the table");
+  unit_record(stats, test_table_fit_shrinks_widest_first(),
+              "tui_table narrows the widest column first, down to its floor");
+  unit_record(stats, test_table_fetches_only_requested_rows(),
+              "tui_table fetches only the rows asked for");
+  unit_record(stats, test_table_navigation_clamps(),
+              "tui_table navigation clamps to the first and last row");
+  unit_record(stats, test_table_damage_tracks_selection_rows(),
+              "tui_table damage limits a cursor move to two rows");
+  unit_record(stats, test_table_numeric_sort_keeps_selection(),
+              "tui_table numeric sort keeps the selected row selected");
+  unit_record(stats, test_table_text_sort_breaks_prefix_ties(),
+              "tui_table text sort compares full cells on prefix ties");
+  unit_record(stats, test_table_text_sort_skips_shared_prefix(),
+              "tui_table text sort keys past a prefix every cell shares");
+  unit_record(stats, test_table_sort_none_is_refused(),
+              "tui_table refuses to sort an unsortable column");
+  unit_record(stats, test_table_newer_sort_supersedes(),
+              "tui_table a newer sort request replaces the one in flight");
+}
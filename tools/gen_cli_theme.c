@@ -0,0 +1,111 @@
+/*
+ * Build-time generator for cli_theme_table.h (see cli_theme.c).
+ *
+ * The built-in scheme is fixed at build time, so its compiled styles are too:
+ * they depend only on the theme mode, the color profile and whether an
+ * ANSI-16 terminal folds bright colors (fewer than 16 colors). This tool runs
+ * app_cli_styles_compile() for every combination and writes the results as a
+ * constant table, so a styled invocation without overrides skips scheme setup
+ * and token resolution entirely.
+ *
+ * Linked against the real cli_theme.c (built without APP_HAVE_CLI_THEME_TABLE)
+ * so the table is exactly what the runtime compiler would produce.
+ *
+ * Usage: gen-cli-theme <output-header>
+ */
+
+#include <stdio.h>
+
+#include "../src/cli/style/cli_theme.h"
+
+static const char *const RESOLVED_KIND_NAMES[] = {
+    [APP_CLI_RESOLVED_COLOR_NONE] = "APP_CLI_RESOLVED_COLOR_NONE",
+    [APP_CLI_RESOLVED_COLOR_INDEXED] = "APP_CLI_RESOLVED_COLOR_INDEXED",
+    [APP_CLI_RESOLVED_COLOR_RGB] = "APP_CLI_RESOLVED_COLOR_RGB",
+    [APP_CLI_RESOLVED_COLOR_DEFAULT] = "APP_CLI_RESOLVED_COLOR_DEFAULT",
+};
+
+static const char *const PROFILE_NAMES[] = {
+    [APP_CLI_COLOR_PROFILE_NONE] = "APP_CLI_COLOR_PROFILE_NONE",
+    [APP_CLI_COLOR_PROFILE_ANSI16] = "APP_CLI_COLOR_PROFILE_ANSI16",
+    [APP_CLI_COLOR_PROFILE_ANSI256] = "APP_CLI_COLOR_PROFILE_ANSI256",
+    [APP_CLI_COLOR_PROFILE_TRUECOLOR] = "APP_CLI_COLOR_PROFILE_TRUECOLOR",
+};
+
+static const char *const MODE_NAMES[] = {
+    [APP_CLI_THEME_MODE_DARK] = "APP_CLI_THEME_MODE_DARK",
+    [APP_CLI_THEME_MODE_LIGHT] = "APP_CLI_THEME_MODE_LIGHT",
+};
+
+static void emit_color(FILE *out, const char *field,
+                       app_cli_resolved_color_t color) {
+  fprintf(out, ".%s = {.kind = %s, .index = %u, .rgb = {%u, %u, %u}}", field,
+          RESOLVED_KIND_NAMES[color.kind], (unsigned)color.index,
+          (unsigned)color.rgb.r, (unsigned)color.rgb.g, (unsigned)color.rgb.b);
+}
+
+static void emit_style(FILE *out, const char *indent,
+                       const app_cli_style_t *style) {
+  fprintf(out, "%s{", indent);
+  emit_color(out, "fg", style->fg);
+  fputs(",\n", out);
+  fprintf(out, "%s ", indent);
+  emit_color(out, "bg", style->bg);
+  fprintf(out, ",\n%s .attrs = 0x%xu},\n", indent, (unsigned)style->attrs);
+}
+
+int main(int argc, char **argv) {
+  if (argc != 2) {
+    fprintf(stderr, "usage: %s <output-header>\n", argv[0]);
+    return 2;
+  }
+  FILE *out = fopen(argv[1], "w");
+  if (!out) {
+    perror(argv[1]);
+    return 1;
+  }
+
+  fputs("/* Generated by tools/gen_cli_theme.c. Do not edit. */\n\n"
+        "#pragma once\n\n"
+        "// Indexed by [profile][folds bright colors][mode]; see\n"
+        "// app_cli_styles_compile_default().\n"
+        "static const app_cli_styles_t APP_CLI_DEFAULT_STYLES[4][2][2] = {\n",
+        out);
+  const app_cli_color_scheme_t *scheme = app_cli_theme_default_scheme();
+  for (int profile = APP_CLI_COLOR_PROFILE_NONE;
+       profile <= APP_CLI_COLOR_PROFILE_TRUECOLOR; profile++) {
+    fprintf(out, "    [%s] =\n        {\n", PROFILE_NAMES[profile]);
+    for (int folded = 0; folded < 2; folded++) {
+      fprintf(out, "            [%d] =\n                {\n", folded);
+      for (int mode = APP_CLI_THEME_MODE_DARK; mode <= APP_CLI_THEME_MODE_LIGHT;
+           mode++) {
+        app_cli_styles_t styles;
+        app_cli_styles_compile(&styles, scheme, (app_cli_theme_mode_id)mode,
+                               (app_cli_color_profile_id)profile,
+                               folded ? 8 : 256);
+        fprintf(out, "                    [%s] =\n", MODE_NAMES[mode]);
+        fputs("                        {.tokens =\n"
+              "                             {\n",
+              out);
+        for (int i = 0; i < APP_CLI_COLOR_TOKEN_COUNT; i++) {
+          emit_style(out, "                                 ",
+                     &styles.tokens[i]);
+        }
+        fputs("                             },\n"
+              "                         .error_header =\n",
+              out);
+        emit_style(out, "                             ", &styles.error_header);
+        fputs("                        },\n", out);
+      }
+      fputs("                },\n", out);
+    }
+    fputs("        },\n", out);
+  }
+  fputs("};\n", out);
+
+  if (fclose(out) != 0) {
+    perror(argv[1]);
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,104 @@
+/*
+ * Build-time generator for src/style/color_lut.h (see color_math.c).
+ *
+ * Splits RGB space into 32x32x32 cells (5 bits per channel) and records, per
+ * cell, the mask of ANSI-16 palette entries that are nearest for at least one
+ * color inside it. Entry i qualifies when its smallest possible distance to
+ * the cell is no larger than the smallest worst-case distance of any entry;
+ * the metric is separable per channel, so both bounds come from one
+ * app_color_dist2() call each. The runtime then only compares the masked
+ * entries, which is exact because the true winner is always in the mask.
+ *
+ * Linked against the real color_math.c (built without APP_HAVE_COLOR_LUT) so
+ * the table and the scalar metric cannot disagree.
+ *
+ * Usage: gen-color-lut <output-header>
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "../src/style/color_math.h"
+
+#define LUT_BITS 5
+#define LUT_SIDE (1u << LUT_BITS)
+#define LUT_STEP (256u / LUT_SIDE)
+
+static uint8_t clamp_channel(uint8_t v, unsigned lo, unsigned hi) {
+  return (uint8_t)(v < lo ? lo : v > hi ? hi : v);
+}
+
+static uint8_t far_channel(uint8_t v, unsigned lo, unsigned hi) {
+  const unsigned mid = (lo + hi) / 2;
+  return (uint8_t)(v > mid ? lo : hi);
+}
+
+static uint16_t cell_candidates(const app_rgb_t *palette, unsigned r,
+                                unsigned g, unsigned b) {
+  const unsigned lo[3] = {r * LUT_STEP, g * LUT_STEP, b * LUT_STEP};
+  const unsigned hi[3] = {lo[0] + LUT_STEP - 1, lo[1] + LUT_STEP - 1,
+                          lo[2] + LUT_STEP - 1};
+  uint32_t min_d[16];
+  uint32_t best_max = UINT32_MAX;
+  for (unsigned i = 0; i < 16; i++) {
+    const app_rgb_t p = palette[i];
+    const app_rgb_t near = {clamp_channel(p.r, lo[0], hi[0]),
+                            clamp_channel(p.g, lo[1], hi[1]),
+                            clamp_channel(p.b, lo[2], hi[2])};
+    const app_rgb_t far = {far_channel(p.r, lo[0], hi[0]),
+                           far_channel(p.g, lo[1], hi[1]),
+                           far_channel(p.b, lo[2], hi[2])};
+    min_d[i] = app_color_dist2(p, near);
+    const uint32_t max_d = app_color_dist2(p, far);
+    if (max_d < best_max) {
+      best_max = max_d;
+    }
+  }
+  uint16_t mask = 0;
+  for (unsigned i = 0; i < 16; i++) {
+    if (min_d[i] <= best_max) {
+      mask |= (uint16_t)(1u << i);
+    }
+  }
+  return mask;
+}
+
+int main(int argc, char **argv) {
+  if (argc != 2) {
+    fprintf(stderr, "usage: %s <output-header>\n", argv[0]);
+    return 2;
+  }
+  FILE *out = fopen(argv[1], "w");
+  if (!out) {
+    perror(argv[1]);
+    return 1;
+  }
+
+  const app_rgb_t *palette = app_color_ansi16_palette();
+  fprintf(out,
+          "/* Generated by tools/gen_color_lut.c. Do not edit. */\n\n"
+          "#pragma once\n\n"
+          "#include <stdint.h>\n\n"
+          "static const uint16_t APP_COLOR_ANSI16_CANDIDATES[%u] = {\n",
+          LUT_SIDE * LUT_SIDE * LUT_SIDE);
+  unsigned column = 0;
+  for (unsigned r = 0; r < LUT_SIDE; r++) {
+    for (unsigned g = 0; g < LUT_SIDE; g++) {
+      for (unsigned b = 0; b < LUT_SIDE; b++) {
+        fprintf(out, "%s0x%04x,", column == 0 ? "    " : " ",
+                cell_candidates(palette, r, g, b));
+        if (++column == 10) {
+          fputc('\n', out);
+          column = 0;
+        }
+      }
+    }
+  }
+  fprintf(out, "%s};\n", column == 0 ? "" : "\n");
+
+  if (fclose(out) != 0) {
+    perror(argv[1]);
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,188 @@
+/*
+ * Build-time generator for grapheme_break_table.h (see src/ui/text_layout.c).
+ *
+ * Reads the vendored Grapheme_Cluster_Break and Extended_Pictographic ranges
+ * in tools/unicode/ucd_grapheme.txt and writes a two-stage lookup table of
+ * break classes: stage 1 maps each 256-code-point block to a deduplicated
+ * stage 2 block, which packs two 4-bit classes per byte. The class numbering
+ * is app_text_gcb_id in text_layout.c; the header asserts it at compile time.
+ *
+ * Usage: gen-unicode-grapheme <ucd_grapheme.txt> <output-header>
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define CP_COUNT 0x110000u
+#define BLOCK_SHIFT 8
+#define BLOCK_SIZE (1u << BLOCK_SHIFT)
+#define BLOCK_COUNT (CP_COUNT >> BLOCK_SHIFT)
+#define PACKED_BLOCK (BLOCK_SIZE / 2)
+
+// Index = class value; [0] (Other) is the default for unlisted code points.
+static const struct {
+  const char *label;
+  const char *name;
+} CLASSES[] = {
+    {"", "APP_TEXT_GCB_OTHER"},
+    {"GCB=CR", "APP_TEXT_GCB_CR"},
+    {"GCB=LF", "APP_TEXT_GCB_LF"},
+    {"GCB=Control", "APP_TEXT_GCB_CONTROL"},
+    {"GCB=Extend", "APP_TEXT_GCB_EXTEND"},
+    {"GCB=ZWJ", "APP_TEXT_GCB_ZWJ"},
+    {"GCB=Regional_Indicator", "APP_TEXT_GCB_REGIONAL_INDICATOR"},
+    {"GCB=Prepend", "APP_TEXT_GCB_PREPEND"},
+    {"GCB=SpacingMark", "APP_TEXT_GCB_SPACING_MARK"},
+    {"GCB=L", "APP_TEXT_GCB_L"},
+    {"GCB=V", "APP_TEXT_GCB_V"},
+    {"GCB=T", "APP_TEXT_GCB_T"},
+    {"GCB=LV", "APP_TEXT_GCB_LV"},
+    {"GCB=LVT", "APP_TEXT_GCB_LVT"},
+    {"ExtPict", "APP_TEXT_GCB_EXT_PICT"},
+};
+#define CLASS_COUNT (sizeof(CLASSES) / sizeof(CLASSES[0]))
+
+static uint8_t classes[CP_COUNT];
+
+static int class_of(const char *label) {
+  for (size_t i = 1; i < CLASS_COUNT; i++) {
+    if (strcmp(label, CLASSES[i].label) == 0) {
+      return (int)i;
+    }
+  }
+  return -1;
+}
+
+static bool load_classes(const char *path) {
+  FILE *in = fopen(path, "r");
+  if (!in) {
+    perror(path);
+    return false;
+  }
+  char line[256];
+  unsigned line_no = 0;
+  while (fgets(line, sizeof(line), in)) {
+    line_no++;
+    char *comment = strchr(line, '#');
+    if (comment) {
+      *comment = '\0';
+    }
+    unsigned first;
+    unsigned last;
+    char label[40];
+    if (sscanf(line, "%x..%x ; %39s", &first, &last, label) == 3) {
+      // Range form.
+    } else if (sscanf(line, "%x ; %39s", &first, label) == 2) {
+      last = first;
+    } else if (strspn(line, " \t\r\n") == strlen(line)) {
+      continue;
+    } else {
+      fprintf(stderr, "%s:%u: malformed line\n", path, line_no);
+      fclose(in);
+      return false;
+    }
+    const int value = class_of(label);
+    if (value < 0 || first > last || last >= CP_COUNT) {
+      fprintf(stderr, "%s:%u: bad range or unknown property '%s'\n", path,
+              line_no, label);
+      fclose(in);
+      return false;
+    }
+    for (unsigned cp = first; cp <= last; cp++) {
+      // Extended_Pictographic code points all have GCB=Other, so the classes
+      // never collide; refuse data where they would.
+      if (classes[cp] != 0) {
+        fprintf(stderr, "%s:%u: U+%04X already has a break class\n", path,
+                line_no, cp);
+        fclose(in);
+        return false;
+      }
+      classes[cp] = (uint8_t)value;
+    }
+  }
+  fclose(in);
+  return true;
+}
+
+int main(int argc, char **argv) {
+  if (argc != 3) {
+    fprintf(stderr, "usage: %s <ucd_grapheme.txt> <output-header>\n", argv[0]);
+    return 2;
+  }
+  if (!load_classes(argv[1])) {
+    return 1;
+  }
+
+  static uint8_t blocks[BLOCK_COUNT][PACKED_BLOCK];
+  static uint8_t stage1[BLOCK_COUNT];
+  unsigned block_count = 0;
+  for (unsigned b = 0; b < BLOCK_COUNT; b++) {
+    uint8_t packed[PACKED_BLOCK] = {0};
+    for (unsigned i = 0; i < BLOCK_SIZE; i++) {
+      const unsigned cp = (b << BLOCK_SHIFT) | i;
+      packed[i / 2] |= (uint8_t)(classes[cp] << ((i % 2) * 4));
+    }
+    unsigned found = block_count;
+    for (unsigned j = 0; j < block_count; j++) {
+      if (memcmp(blocks[j], packed, sizeof(packed)) == 0) {
+        found = j;
+        break;
+      }
+    }
+    if (found == block_count) {
+      if (block_count == 256) {
+        fprintf(stderr, "too many distinct blocks for an 8-bit stage 1\n");
+        return 1;
+      }
+      memcpy(blocks[block_count++], packed, sizeof(packed));
+    }
+    stage1[b] = (uint8_t)found;
+  }
+
+  FILE *out = fopen(argv[2], "w");
+  if (!out) {
+    perror(argv[2]);
+    return 1;
+  }
+  fputs("/* Generated by tools/gen_unicode_grapheme.c from "
+        "tools/unicode/ucd_grapheme.txt.\n"
+        " * Do not edit. */\n\n"
+        "#pragma once\n\n"
+        "#include <assert.h>\n"
+        "#include <stdint.h>\n\n",
+        out);
+  for (size_t i = 0; i < CLASS_COUNT; i++) {
+    fprintf(out, "static_assert(%s == %zu, \"break class numbering\");\n",
+            CLASSES[i].name, i);
+  }
+  fprintf(out,
+          "\n#define APP_TEXT_GCB_BLOCK_SHIFT %u\n\n"
+          "static const uint8_t APP_TEXT_GCB_STAGE1[%u] = {",
+          BLOCK_SHIFT, BLOCK_COUNT);
+  for (unsigned b = 0; b < BLOCK_COUNT; b++) {
+    fprintf(out, "%s%u,", b % 16 == 0 ? "\n    " : " ", stage1[b]);
+  }
+  fprintf(out,
+          "\n};\n\n"
+          "// Two 4-bit classes per byte, lowest code point in the low bits.\n"
+          "static const uint8_t APP_TEXT_GCB_STAGE2[%u][%u] = {\n",
+          block_count, PACKED_BLOCK);
+  for (unsigned j = 0; j < block_count; j++) {
+    fputs("    {", out);
+    for (unsigned i = 0; i < PACKED_BLOCK; i++) {
+      fprintf(out, "%s0x%02x,", i == 0 ? "" : i % 12 == 0 ? "\n     " : " ",
+              blocks[j][i]);
+    }
+    fputs("},\n", out);
+  }
+  fputs("};\n", out);
+
+  if (fclose(out) != 0) {
+    perror(argv[2]);
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,188 @@
+/*
+ * Build-time generator for unicode_width_table.h (see src/ui/text_layout.c).
+ *
+ * Reads the vendored property ranges in tools/unicode/ucd_width.txt, applies
+ * the display width policy below to every code point, and writes a two-stage
+ * lookup table: stage 1 maps each 256-code-point block to a deduplicated
+ * stage 2 block, which packs four 2-bit widths per byte. Most of Unicode
+ * shares a handful of blocks, so the whole table stays a few kilobytes.
+ *
+ * Width policy (locale-independent, like the scalar fallback it replaces):
+ *   0  NUL, C0/C1 controls, nonspacing/enclosing marks (gc=Mn/Me), format
+ *      characters (gc=Cf) except U+00AD SOFT HYPHEN and the visible
+ *      prepended concatenation marks (PCM), and Hangul medial vowel and final
+ *      consonant jamo (hst=V/T), which combine with a leading jamo;
+ *   2  East Asian Wide/Fullwidth (ea=W/F, which already covers unassigned
+ *      CJK planes) and Emoji_Presentation, except regional indicators;
+ *   1  everything else, including East Asian Ambiguous and each regional
+ *      indicator (U+1F1E6..U+1F1FF), so a flag pair measures two columns.
+ *
+ * Usage: gen-unicode-width <ucd_width.txt> <output-header>
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define CP_COUNT 0x110000u
+#define BLOCK_SHIFT 8
+#define BLOCK_SIZE (1u << BLOCK_SHIFT)
+#define BLOCK_COUNT (CP_COUNT >> BLOCK_SHIFT)
+#define PACKED_BLOCK (BLOCK_SIZE / 4)
+
+enum {
+  PROP_WIDE = 1u << 0,
+  PROP_ZERO = 1u << 1,
+  PROP_VISIBLE = 1u << 2,
+};
+
+static uint8_t props[CP_COUNT];
+
+static int property_bits(const char *name) {
+  if (strcmp(name, "ea=W") == 0 || strcmp(name, "ea=F") == 0 ||
+      strcmp(name, "EPres") == 0) {
+    return PROP_WIDE;
+  }
+  if (strcmp(name, "gc=Mn") == 0 || strcmp(name, "gc=Me") == 0 ||
+      strcmp(name, "gc=Cf") == 0 || strcmp(name, "hst=V") == 0 ||
+      strcmp(name, "hst=T") == 0) {
+    return PROP_ZERO;
+  }
+  if (strcmp(name, "PCM") == 0) {
+    return PROP_VISIBLE;
+  }
+  return -1;
+}
+
+static bool load_properties(const char *path) {
+  FILE *in = fopen(path, "r");
+  if (!in) {
+    perror(path);
+    return false;
+  }
+  char line[256];
+  unsigned line_no = 0;
+  while (fgets(line, sizeof(line), in)) {
+    line_no++;
+    char *comment = strchr(line, '#');
+    if (comment) {
+      *comment = '\0';
+    }
+    unsigned first;
+    unsigned last;
+    char name[32];
+    if (sscanf(line, "%x..%x ; %31s", &first, &last, name) == 3) {
+      // Range form.
+    } else if (sscanf(line, "%x ; %31s", &first, name) == 2) {
+      last = first;
+    } else if (strspn(line, " \t\r\n") == strlen(line)) {
+      continue;
+    } else {
+      fprintf(stderr, "%s:%u: malformed line\n", path, line_no);
+      fclose(in);
+      return false;
+    }
+    const int bits = property_bits(name);
+    if (bits < 0 || first > last || last >= CP_COUNT) {
+      fprintf(stderr, "%s:%u: bad range or unknown property '%s'\n", path,
+              line_no, name);
+      fclose(in);
+      return false;
+    }
+    for (unsigned cp = first; cp <= last; cp++) {
+      props[cp] |= (uint8_t)bits;
+    }
+  }
+  fclose(in);
+  return true;
+}
+
+static unsigned cp_width(unsigned cp) {
+  if (cp < 0x20 || (cp >= 0x7f && cp < 0xa0)) {
+    return 0;
+  }
+  if ((props[cp] & PROP_ZERO) && !(props[cp] & PROP_VISIBLE) &&
+      cp != 0x00ad) {
+    return 0;
+  }
+  if (cp >= 0x1f1e6 && cp <= 0x1f1ff) {
+    return 1;
+  }
+  return (props[cp] & PROP_WIDE) ? 2 : 1;
+}
+
+int main(int argc, char **argv) {
+  if (argc != 3) {
+    fprintf(stderr, "usage: %s <ucd_width.txt> <output-header>\n", argv[0]);
+    return 2;
+  }
+  if (!load_properties(argv[1])) {
+    return 1;
+  }
+
+  static uint8_t blocks[BLOCK_COUNT][PACKED_BLOCK];
+  static uint8_t stage1[BLOCK_COUNT];
+  unsigned block_count = 0;
+  for (unsigned b = 0; b < BLOCK_COUNT; b++) {
+    uint8_t packed[PACKED_BLOCK] = {0};
+    for (unsigned i = 0; i < BLOCK_SIZE; i++) {
+      const unsigned cp = (b << BLOCK_SHIFT) | i;
+      packed[i / 4] |= (uint8_t)(cp_width(cp) << ((i % 4) * 2));
+    }
+    unsigned found = block_count;
+    for (unsigned j = 0; j < block_count; j++) {
+      if (memcmp(blocks[j], packed, sizeof(packed)) == 0) {
+        found = j;
+        break;
+      }
+    }
+    if (found == block_count) {
+      if (block_count == 256) {
+        fprintf(stderr, "too many distinct blocks for an 8-bit stage 1\n");
+        return 1;
+      }
+      memcpy(blocks[block_count++], packed, sizeof(packed));
+    }
+    stage1[b] = (uint8_t)found;
+  }
+
+  FILE *out = fopen(argv[2], "w");
+  if (!out) {
+    perror(argv[2]);
+    return 1;
+  }
+  fprintf(out,
+          "/* Generated by tools/gen_unicode_width.c from "
+          "tools/unicode/ucd_width.txt.\n"
+          " * Do not edit. */\n\n"
+          "#pragma once\n\n"
+          "#include <stdint.h>\n\n"
+          "#define APP_TEXT_WIDTH_BLOCK_SHIFT %u\n\n"
+          "static const uint8_t APP_TEXT_WIDTH_STAGE1[%u] = {",
+          BLOCK_SHIFT, BLOCK_COUNT);
+  for (unsigned b = 0; b < BLOCK_COUNT; b++) {
+    fprintf(out, "%s%u,", b % 16 == 0 ? "\n    " : " ", stage1[b]);
+  }
+  fprintf(out,
+          "\n};\n\n"
+          "// Four 2-bit widths per byte, lowest code point in the low bits.\n"
+          "static const uint8_t APP_TEXT_WIDTH_STAGE2[%u][%u] = {\n",
+          block_count, PACKED_BLOCK);
+  for (unsigned j = 0; j < block_count; j++) {
+    fputs("    {", out);
+    for (unsigned i = 0; i < PACKED_BLOCK; i++) {
+      fprintf(out, "%s0x%02x,", i == 0 ? "" : i % 12 == 0 ? "\n     " : " ",
+              blocks[j][i]);
+    }
+    fputs("},\n", out);
+  }
+  fputs("};\n", out);
+
+  if (fclose(out) != 0) {
+    perror(argv[2]);
+    return 1;
+  }
+  return 0;
+}
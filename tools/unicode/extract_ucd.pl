@@ -0,0 +1,67 @@
+#!/usr/bin/env perl
+# Extract the Unicode properties used by src/ui/text_layout.c into compact
+# UCD-style range files. The build never runs this; it reads the checked-in
+# output. Rerun it with a newer Perl to move to a newer Unicode version:
+#
+#   perl tools/unicode/extract_ucd.pl width > tools/unicode/ucd_width.txt
+#   perl tools/unicode/extract_ucd.pl grapheme > tools/unicode/ucd_grapheme.txt
+
+use strict;
+use warnings;
+use Unicode::UCD qw(prop_invlist);
+
+# [label written to the file, property query for prop_invlist]
+my %sets = (
+    width => {
+        reader     => 'tools/gen_unicode_width.c',
+        what       => 'display width',
+        properties => [
+            [ 'ea=W',  'East_Asian_Width=Wide' ],
+            [ 'ea=F',  'East_Asian_Width=Fullwidth' ],
+            [ 'EPres', 'Emoji_Presentation' ],
+            [ 'gc=Mn', 'General_Category=Nonspacing_Mark' ],
+            [ 'gc=Me', 'General_Category=Enclosing_Mark' ],
+            [ 'gc=Cf', 'General_Category=Format' ],
+            [ 'PCM',   'Prepended_Concatenation_Mark' ],
+            [ 'hst=V', 'Hangul_Syllable_Type=V' ],
+            [ 'hst=T', 'Hangul_Syllable_Type=T' ],
+        ],
+    },
+    grapheme => {
+        reader     => 'tools/gen_unicode_grapheme.c',
+        what       => 'grapheme cluster segmentation (UAX #29)',
+        properties => [
+            map( { [ "GCB=$_", "Grapheme_Cluster_Break=$_" ] }
+                qw(CR LF Control Extend ZWJ Regional_Indicator Prepend
+                  SpacingMark L V T LV LVT) ),
+            [ 'ExtPict', 'Extended_Pictographic' ],
+        ],
+    },
+);
+
+my $name = shift // '';
+my $set  = $sets{$name}
+  or die "usage: $0 width|grapheme > tools/unicode/ucd_<set>.txt\n";
+
+printf "# Unicode %s properties for %s.\n", Unicode::UCD::UnicodeVersion(),
+  $set->{what};
+print "# Generated by tools/unicode/extract_ucd.pl from Perl's Unicode::UCD.\n";
+print "# Read at build time by $set->{reader}. Do not edit.\n";
+print "#\n";
+print "# Format: first[..last] ; property\n";
+
+for my $property ( @{ $set->{properties} } ) {
+    my ( $label, $query ) = @$property;
+    my @list = prop_invlist($query);
+    push @list, 0x110000 if @list % 2;
+    print "\n# $query\n";
+    for ( my $i = 0 ; $i < @list ; $i += 2 ) {
+        my ( $first, $last ) = ( $list[$i], $list[ $i + 1 ] - 1 );
+        if ( $first == $last ) {
+            printf "%04X ; %s\n", $first, $label;
+        }
+        else {
+            printf "%04X..%04X ; %s\n", $first, $last, $label;
+        }
+    }
+}